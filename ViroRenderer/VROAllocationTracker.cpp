@@ -90,5 +90,6 @@ void VROAllocationTracker::printNow() {
     pinfo("    VBO:                 %d", (sBytesAllocated[static_cast<int>(VROAllocationBucket::VBO)].load()));
     pinfo("    Task Queues:         %d", (sBytesAllocated[static_cast<int>(VROAllocationBucket::TaskQueues)].load()));
     pinfo("    Anchors:             %d", (sBytesAllocated[static_cast<int>(VROAllocationBucket::Anchors)].load()));
+    pinfo("    Frame Arena Allocs:  %d", (sBytesAllocated[static_cast<int>(VROAllocationBucket::FrameArenaAllocations)].load()));
     VROTaskQueue::printTaskQueues();
 }
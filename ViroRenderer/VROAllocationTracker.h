@@ -73,6 +73,7 @@ enum class VROAllocationBucket {
     VBO,
     TaskQueues,
     Anchors,
+    FrameArenaAllocations,
     NUM_BUCKETS
 };
 
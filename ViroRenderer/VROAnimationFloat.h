@@ -30,6 +30,7 @@
 #include "VROAnimation.h"
 #include "VROAnimatable.h"
 #include "VROMath.h"
+#include "VROKeyframeCursor.h"
 
 class VROAnimationFloat : public VROAnimation {
     
@@ -72,7 +73,7 @@ public:
     {}
     
     void processAnimationFrame(float t) {
-        float value = VROMathInterpolateKeyFrame(t, _keyTimes, _keyValues);
+        float value = VROMathInterpolateKeyFrame(t, _keyTimes, _keyValues, &_cursor);
         
         std::shared_ptr<VROAnimatable> animatable = _animatable.lock();
         if (animatable) {
@@ -93,6 +94,12 @@ private:
     std::vector<float> _keyValues;
     std::function<void(VROAnimatable *const, float)>  _method;
     
+    /*
+     Cached segment lookup; playback is monotonic so each frame is usually
+     resolved without searching the key times.
+     */
+    VROKeyframeCursor _cursor;
+    
 };
 
 #endif /* VROAnimationFloat_h */
@@ -12,6 +12,7 @@
 #include "VROAnimation.h"
 #include "VROAnimatable.h"
 #include "VROMath.h"
+#include "VROKeyframeCursor.h"
 
 class VROAnimationKeyframeIndex : public VROAnimation {
     
@@ -33,7 +34,7 @@ public:
     {}
     
     void processAnimationFrame(float t) {
-        int frame = VROMathInterpolateKeyFrameIndex(t, _keyTimes);
+        int frame = VROMathInterpolateKeyFrameIndex(t, _keyTimes, &_cursor);
         
         std::shared_ptr<VROAnimatable> animatable = _animatable.lock();
         if (animatable) {
@@ -53,6 +54,12 @@ private:
     std::vector<float> _keyTimes;
     std::function<void(VROAnimatable *const, int)>  _method;
     
+    /*
+     Cached segment lookup; playback is monotonic so each frame is usually
+     resolved without searching the key times.
+     */
+    VROKeyframeCursor _cursor;
+    
 };
 
 #endif /* VROAnimationKeyFrameIndex_h */
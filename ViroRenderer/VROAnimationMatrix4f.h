@@ -31,6 +31,7 @@
 #include "VROAnimation.h"
 #include "VROAnimatable.h"
 #include "VROMath.h"
+#include "VROKeyframeCursor.h"
 
 class VROAnimationMatrix4f : public VROAnimation {
     
@@ -75,7 +76,7 @@ public:
     {}
     
     void processAnimationFrame(float t) {
-        VROMatrix4f value = VROMathInterpolateKeyFrameMatrix4f(t, _keyTimes, _keyValues);
+        VROMatrix4f value = VROMathInterpolateKeyFrameMatrix4f(t, _keyTimes, _keyValues, &_cursor);
         
         std::shared_ptr<VROAnimatable> animatable = _animatable.lock();
         if (animatable) {
@@ -96,6 +97,12 @@ private:
     std::vector<VROMatrix4f> _keyValues;
     std::function<void(VROAnimatable *const, VROMatrix4f)> _method;
     
+    /*
+     Cached segment lookup; playback is monotonic so each frame is usually
+     resolved without searching the key times.
+     */
+    VROKeyframeCursor _cursor;
+    
 };
 
 #endif /* VROAnimationMatrix4f_h */
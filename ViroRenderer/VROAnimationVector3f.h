@@ -32,6 +32,7 @@
 #include "VROAnimation.h"
 #include "VROAnimatable.h"
 #include "VROMath.h"
+#include "VROKeyframeCursor.h"
 
 class VROAnimationVector3f : public VROAnimation {
     
@@ -76,7 +77,7 @@ public:
     {}
     
     void processAnimationFrame(float t) {
-        VROVector3f value = VROMathInterpolateKeyFrameVector3f(t, _keyTimes, _keyValues);
+        VROVector3f value = VROMathInterpolateKeyFrameVector3f(t, _keyTimes, _keyValues, &_cursor);
         
         std::shared_ptr<VROAnimatable> animatable = _animatable.lock();
         if (animatable) {
@@ -97,6 +98,12 @@ private:
     std::vector<VROVector3f> _keyValues;
     std::function<void(VROAnimatable *const, VROVector3f)> _method;
     
+    /*
+     Cached segment lookup; playback is monotonic so each frame is usually
+     resolved without searching the key times.
+     */
+    VROKeyframeCursor _cursor;
+    
 };
 
 #endif /* VROAnimationVector3f_h */
@@ -0,0 +1,255 @@
+//
+//  VROAssetCache.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/29/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROAssetCache.h"
+#include "VROTexture.h"
+#include "VROVertexBuffer.h"
+#include "VROMaterial.h"
+#include <string.h>
+
+// Dead entries are swept after this many insertions
+static const int kSweepInterval = 64;
+
+uint64_t VROAssetCache::hash(const void *bytes, size_t length) {
+    /*
+     MurmurHash64A: a single pass over the data, eight bytes at a time, with no
+     limit on the length. Keys are only compared within the process, so the
+     native byte order is used.
+     */
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ ((uint64_t) length * m);
+    const uint8_t *data = (const uint8_t *) bytes;
+    const uint8_t *end = data + (length & ~(size_t) 7);
+    
+    for (; data != end; data += 8) {
+        uint64_t k;
+        memcpy(&k, data, sizeof(uint64_t));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        
+        h ^= k;
+        h *= m;
+    }
+    
+    size_t tail = length & 7;
+    if (tail > 0) {
+        uint64_t k = 0;
+        for (size_t i = 0; i < tail; i++) {
+            k |= (uint64_t) data[i] << (8 * i);
+        }
+        h ^= k;
+        h *= m;
+    }
+    
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+uint64_t VROAssetCache::combine(uint64_t key, uint64_t value) {
+    // Mix in the value with the 64-bit golden ratio, as in boost::hash_combine
+    return key ^ (value + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2));
+}
+
+size_t VROAssetCache::estimateTextureBytes(int width, int height, const std::vector<uint32_t> &mipSizes) {
+    if (!mipSizes.empty()) {
+        size_t bytes = 0;
+        for (uint32_t size : mipSizes) {
+            bytes += size;
+        }
+        return bytes;
+    }
+    // A full mip chain adds a third to the size of the top level
+    return (size_t) width * height * 4 * 4 / 3;
+}
+
+VROAssetCache::VROAssetCache(size_t budgetBytes) :
+    _budget(budgetBytes),
+    _retainedBytes(0),
+    _insertionsSinceSweep(0) {
+    
+}
+
+VROAssetCache::~VROAssetCache() {
+    
+}
+
+#pragma mark - Lookup and Insertion
+
+std::shared_ptr<VROTexture> VROAssetCache::getTexture(uint64_t key) {
+    return std::static_pointer_cast<VROTexture>(get(Kind::Texture, key));
+}
+
+std::shared_ptr<VROVertexBuffer> VROAssetCache::getVertexBuffer(uint64_t key) {
+    return std::static_pointer_cast<VROVertexBuffer>(get(Kind::VertexBuffer, key));
+}
+
+std::shared_ptr<VROMaterial> VROAssetCache::getMaterial(uint64_t key) {
+    std::shared_ptr<VROMaterial> material = std::static_pointer_cast<VROMaterial>(get(Kind::Material, key));
+    if (!material) {
+        return nullptr;
+    }
+    return std::make_shared<VROMaterial>(material);
+}
+
+void VROAssetCache::putTexture(uint64_t key, std::shared_ptr<VROTexture> texture, size_t bytes) {
+    put(Kind::Texture, key, texture, bytes);
+}
+
+void VROAssetCache::putVertexBuffer(uint64_t key, std::shared_ptr<VROVertexBuffer> vbo, size_t bytes) {
+    put(Kind::VertexBuffer, key, vbo, bytes);
+}
+
+void VROAssetCache::putMaterial(uint64_t key, std::shared_ptr<VROMaterial> material) {
+    // The template is only referenced by the cache, so it is charged its own
+    // size only; its textures are charged through their own entries
+    put(Kind::Material, key, std::make_shared<VROMaterial>(material), sizeof(VROMaterial));
+}
+
+std::shared_ptr<void> VROAssetCache::get(Kind kind, uint64_t key) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    auto it = _entries.find({ kind, key });
+    if (it == _entries.end()) {
+        return nullptr;
+    }
+    Entry &entry = it->second;
+    if (entry.retained) {
+        _lru.splice(_lru.begin(), _lru, entry.lruPosition);
+        return entry.retained;
+    }
+    
+    // Evicted, but possibly still alive elsewhere: retain it again, since it
+    // is in use. The budget is not enforced here, as doing so could evict the
+    // asset being returned; the next insertion restores it
+    std::shared_ptr<void> asset = entry.asset.lock();
+    if (!asset) {
+        _entries.erase(it);
+        return nullptr;
+    }
+    entry.retained = asset;
+    _lru.push_front(it->first);
+    entry.lruPosition = _lru.begin();
+    _retainedBytes += entry.bytes;
+    return asset;
+}
+
+void VROAssetCache::put(Kind kind, uint64_t key, std::shared_ptr<void> asset, size_t bytes) {
+    std::vector<std::shared_ptr<void>> released;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        
+        Key k = { kind, key };
+        auto it = _entries.find(k);
+        if (it != _entries.end()) {
+            if (it->second.retained) {
+                _lru.erase(it->second.lruPosition);
+                _retainedBytes -= it->second.bytes;
+                released.push_back(it->second.retained);
+            }
+            _entries.erase(it);
+        }
+        
+        _lru.push_front(k);
+        Entry &entry = _entries[k];
+        entry.asset = asset;
+        entry.retained = asset;
+        entry.bytes = bytes;
+        entry.lruPosition = _lru.begin();
+        _retainedBytes += bytes;
+        
+        evict(released);
+        if (++_insertionsSinceSweep >= kSweepInterval) {
+            sweep();
+        }
+    }
+}
+
+#pragma mark - Budget
+
+void VROAssetCache::setBudget(size_t budgetBytes) {
+    std::vector<std::shared_ptr<void>> released;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _budget = budgetBytes;
+        evict(released);
+    }
+}
+
+size_t VROAssetCache::getRetainedBytes() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _retainedBytes;
+}
+
+int VROAssetCache::getNumEntries() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    sweep();
+    return (int) _entries.size();
+}
+
+void VROAssetCache::clear() {
+    std::vector<std::shared_ptr<void>> released;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &kv : _entries) {
+            if (kv.second.retained) {
+                released.push_back(kv.second.retained);
+            }
+        }
+        _entries.clear();
+        _lru.clear();
+        _retainedBytes = 0;
+    }
+}
+
+void VROAssetCache::evict(std::vector<std::shared_ptr<void>> &released) {
+    // Always keep the most recently used asset, even if it alone exceeds the budget
+    while (_retainedBytes > _budget && _lru.size() > 1) {
+        Entry &entry = _entries[_lru.back()];
+        _lru.pop_back();
+        _retainedBytes -= entry.bytes;
+        
+        // The weak reference remains, so the asset is still found while it is in use
+        released.push_back(entry.retained);
+        entry.retained.reset();
+    }
+}
+
+void VROAssetCache::sweep() {
+    _insertionsSinceSweep = 0;
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (!it->second.retained && it->second.asset.expired()) {
+            it = _entries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
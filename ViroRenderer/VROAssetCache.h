@@ -0,0 +1,200 @@
+//
+//  VROAssetCache.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/29/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROAssetCache_h
+#define VROAssetCache_h
+
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+class VROTexture;
+class VROVertexBuffer;
+class VROMaterial;
+
+// Default budget for assets retained between scenes
+static const size_t kDefaultAssetCacheBudgetBytes = 64 * 1024 * 1024;
+
+/*
+ Cache of loaded assets, shared by all model loaders and scenes that
+ render with the same driver, and keyed by the content of the asset (see
+ hash() and combine()). Loading the same model or texture again, from any
+ loader, returns the textures and vertex buffers created by the previous
+ load instead of decoding and uploading them again.
+
+ Cached assets hold the GPU resources of the driver they were loaded
+ with, so each driver owns its own cache (see VRODriver::getAssetCache()).
+
+ Every entry references its asset weakly, so an asset is found for as
+ long as anything in the process still uses it. In addition, the most
+ recently used assets are retained strongly, up to a memory budget, so
+ that assets survive between scenes that use them; when the budget is
+ exceeded, the least recently used assets are released first.
+
+ Materials are cached as templates: each hit returns a copy of the
+ cached material, which shares its textures, so that one model's
+ material edits do not leak into other instances of the model.
+
+ The cache is thread-safe. Assets released by eviction are destroyed on
+ the thread that caused the eviction; the GL resources they hold are
+ queued for deletion on the rendering thread by the driver.
+ */
+class VROAssetCache {
+
+public:
+
+    /*
+     Content key of the given bytes. Keys of assets derived from several
+     inputs (e.g. an image and the sampler and color space it is
+     uploaded with) are formed by combining keys with combine().
+
+     hash() reads every byte, so large data should be hashed on a loader
+     thread, or keyed by where it came from instead (see
+     VROGeometryPack::getBlobKey()).
+     */
+    static uint64_t hash(const void *bytes, size_t length);
+    static uint64_t combine(uint64_t key, uint64_t value);
+
+    /*
+     Estimated GPU memory of a texture with the given dimensions. If the
+     texture has pregenerated mipmaps, their sizes are summed; otherwise
+     an RGBA8 texture with a runtime generated mip chain is assumed.
+     */
+    static size_t estimateTextureBytes(int width, int height, const std::vector<uint32_t> &mipSizes);
+
+    VROAssetCache(size_t budgetBytes = kDefaultAssetCacheBudgetBytes);
+    virtual ~VROAssetCache();
+
+    /*
+     Return the cached asset for the given key, or null if there is none
+     (or it has been released). A hit marks the asset most recently used.
+     */
+    std::shared_ptr<VROTexture> getTexture(uint64_t key);
+    std::shared_ptr<VROVertexBuffer> getVertexBuffer(uint64_t key);
+    std::shared_ptr<VROMaterial> getMaterial(uint64_t key);
+
+    /*
+     Add the given asset to the cache under the given key, replacing any
+     previous entry. The size in bytes is charged against the budget.
+     Materials are copied into the cache.
+     */
+    void putTexture(uint64_t key, std::shared_ptr<VROTexture> texture, size_t bytes);
+    void putVertexBuffer(uint64_t key, std::shared_ptr<VROVertexBuffer> vbo, size_t bytes);
+    void putMaterial(uint64_t key, std::shared_ptr<VROMaterial> material);
+
+    /*
+     Memory budget for assets retained by the cache. Lowering the budget
+     releases least recently used assets immediately.
+     */
+    void setBudget(size_t budgetBytes);
+    size_t getBudget() const {
+        return _budget;
+    }
+
+    /*
+     Total size of the assets currently retained strongly by the cache.
+     */
+    size_t getRetainedBytes();
+
+    /*
+     Number of entries whose assets are still alive.
+     */
+    int getNumEntries();
+
+    /*
+     Release every asset retained by the cache and forget every entry.
+     Assets still in use elsewhere are unaffected.
+     */
+    void clear();
+
+private:
+
+    enum class Kind {
+        Texture,
+        VertexBuffer,
+        Material,
+    };
+    typedef std::pair<Kind, uint64_t> Key;
+
+    struct Entry {
+        std::weak_ptr<void> asset;
+
+        /*
+         Strong reference held while the entry is within the budget, and
+         null once it has been evicted.
+         */
+        std::shared_ptr<void> retained;
+        size_t bytes;
+
+        /*
+         Position in _lru, valid only while retained.
+         */
+        std::list<Key>::iterator lruPosition;
+    };
+
+    /*
+     Guards everything below.
+     */
+    std::mutex _mutex;
+
+    size_t _budget;
+    size_t _retainedBytes;
+    std::map<Key, Entry> _entries;
+
+    /*
+     Retained entries, most recently used first.
+     */
+    std::list<Key> _lru;
+
+    /*
+     Number of insertions since dead entries were last swept.
+     */
+    int _insertionsSinceSweep;
+
+    std::shared_ptr<void> get(Kind kind, uint64_t key);
+    void put(Kind kind, uint64_t key, std::shared_ptr<void> asset, size_t bytes);
+
+    /*
+     Release least recently used assets until the retained assets fit in
+     the budget. The released references are moved into the given vector,
+     so that the assets are destroyed after the mutex is released. Must be
+     invoked with the mutex held.
+     */
+    void evict(std::vector<std::shared_ptr<void>> &released);
+
+    /*
+     Remove entries whose assets are neither retained nor alive. Must be
+     invoked with the mutex held.
+     */
+    void sweep();
+
+};
+
+#endif /* VROAssetCache_h */
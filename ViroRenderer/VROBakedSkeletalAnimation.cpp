@@ -0,0 +1,227 @@
+//
+//  VROBakedSkeletalAnimation.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/1/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROBakedSkeletalAnimation.h"
+#include "VROSkeletalAnimation.h"
+#include "VROSkeletalClip.h"
+#include "VROKeyframeCursor.h"
+#include "VROSkinner.h"
+#include "VROSkeleton.h"
+#include "VROBone.h"
+#include "VROBoneUBO.h"
+#include "VROCrowdUBO.h"
+#include "VROGeometry.h"
+#include "VROTexture.h"
+#include "VROData.h"
+#include "VROShaderModifier.h"
+#include "VROShaderProgram.h"
+#include "VROStringUtil.h"
+#include "VROLog.h"
+#include <cmath>
+
+std::shared_ptr<VROBakedSkeletalAnimation> VROBakedSkeletalAnimation::bake(std::shared_ptr<VROSkeletalAnimation> animation,
+                                                                           float framesPerSecond) {
+    if (animation->getFrames().empty() || animation->getDuration() <= 0) {
+        return nullptr;
+    }
+    
+    std::shared_ptr<VROSkinner> skinner = animation->getSkinner();
+    std::shared_ptr<VROSkeleton> skeleton = skinner->getSkeleton();
+    std::shared_ptr<VROSkeletalClip> clip = animation->getClip();
+    
+    float duration = animation->getDuration();
+    int numBones = std::min(skeleton->getNumBones(), kMaxBones);
+    int numFrames = std::max(2, std::min(kMaxBakedFrames, (int) ceilf(duration * framesPerSecond) + 1));
+    if (numFrames == kMaxBakedFrames) {
+        pwarn("Animation [%s] is too long to bake at %f FPS, baking at reduced frame rate",
+              animation->getName().c_str(), framesPerSecond);
+    }
+    
+    /*
+     Save the skeleton's current pose, so it can be restored once baking is complete.
+     */
+    std::vector<VROMatrix4f> savedTransforms;
+    for (int i = 0; i < skeleton->getNumBones(); i++) {
+        savedTransforms.push_back(skeleton->getBone(i)->getTransform());
+    }
+    
+    /*
+     Pose the skeleton at each frame and record the skinning transform of each bone.
+     Frames are visited in order, so the track cursors find each key in constant time.
+     */
+    std::vector<VROMatrix4f> pose(clip->getNumTracks());
+    std::vector<VROKeyframeCursor> cursors(clip->getNumTracks());
+    std::shared_ptr<std::vector<float>> data = std::make_shared<std::vector<float>>(numFrames * numBones * kTexelsPerBakedBone * 4);
+    
+    for (int f = 0; f < numFrames; f++) {
+        clip->sample(f / (float) (numFrames - 1), pose.data(), cursors.data());
+        skeleton->setBoneTransforms(clip->getTrackBones(), pose.data());
+        
+        for (int b = 0; b < numBones; b++) {
+            VROMatrix4f transform = skinner->getModelTransform(b);
+            
+            // Store the first three rows; the matrix is column-major
+            float *texels = &(*data)[(f * numBones + b) * kTexelsPerBakedBone * 4];
+            for (int row = 0; row < kTexelsPerBakedBone; row++) {
+                for (int column = 0; column < 4; column++) {
+                    texels[row * 4 + column] = transform[column * 4 + row];
+                }
+            }
+        }
+    }
+    
+    for (int i = 0; i < skeleton->getNumBones(); i++) {
+        std::shared_ptr<VROBone> bone = skeleton->getBone(i);
+        bone->setTransform(savedTransforms[i], bone->getTransformType());
+    }
+    
+    pinfo("Baked animation [%s]: %d bones, %d frames, %d KB", animation->getName().c_str(), numBones, numFrames,
+          (int) (data->size() * sizeof(float) / 1024));
+    return std::make_shared<VROBakedSkeletalAnimation>(skinner, data, numBones, numFrames, duration);
+}
+
+VROBakedSkeletalAnimation::VROBakedSkeletalAnimation(std::shared_ptr<VROSkinner> skinner,
+                                                     std::shared_ptr<std::vector<float>> data,
+                                                     int numBones, int numFrames, float duration) :
+    _skinner(skinner),
+    _data(data),
+    _numBones(numBones),
+    _numFrames(numFrames),
+    _duration(duration) {
+    
+    // The texture reads from the baked data in place; the data is kept alive
+    // by both this animation and the texture
+    std::vector<std::shared_ptr<VROData>> textureData = {
+        std::make_shared<VROData>((void *) data->data(), data->size() * sizeof(float), std::static_pointer_cast<void>(data))
+    };
+    std::vector<uint32_t> mipSizes;
+    _texture = std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::RGBA32F,
+                                            VROTextureInternalFormat::RGBA32F, false, VROMipmapMode::None,
+                                            textureData, numBones * kTexelsPerBakedBone, numFrames, mipSizes);
+    _texture->setMinificationFilter(VROFilterMode::Nearest);
+    _texture->setMagnificationFilter(VROFilterMode::Nearest);
+    _texture->setMipFilter(VROFilterMode::None);
+    _texture->setWrapS(VROWrapMode::Clamp);
+    _texture->setWrapT(VROWrapMode::Clamp);
+}
+
+VROBakedSkeletalAnimation::~VROBakedSkeletalAnimation() {
+    
+}
+
+size_t VROBakedSkeletalAnimation::getDataSize() const {
+    return _data->size() * sizeof(float);
+}
+
+VROMatrix4f VROBakedSkeletalAnimation::getBoneTransform(int frame, int bone) const {
+    const float *texels = &(*_data)[(frame * _numBones + bone) * kTexelsPerBakedBone * 4];
+    
+    VROMatrix4f transform;
+    for (int row = 0; row < kTexelsPerBakedBone; row++) {
+        for (int column = 0; column < 4; column++) {
+            transform[column * 4 + row] = texels[row * 4 + column];
+        }
+    }
+    return transform;
+}
+
+VROBoundingBox VROBakedSkeletalAnimation::getAnimatedBounds(const VROBoundingBox &bindBounds) const {
+    /*
+     Each skinned vertex is a weighted average of the vertex transformed by its
+     bones, so it lies within the bounds of the geometry transformed by every
+     bone at every frame.
+     */
+    VROBoundingBox bounds = bindBounds.transform(getBoneTransform(0, 0));
+    for (int f = 0; f < _numFrames; f++) {
+        for (int b = 0; b < _numBones; b++) {
+            bounds.unionDestructive(bindBounds.transform(getBoneTransform(f, b)));
+        }
+    }
+    return bounds;
+}
+
+std::shared_ptr<VROShaderModifier> VROBakedSkeletalAnimation::getCrowdModifier() {
+    if (_crowdModifier) {
+        return _crowdModifier;
+    }
+    
+    std::string maxInstances = VROStringUtil::toString(kMaxCrowdInstancesPerUBO);
+    std::string duration = VROStringUtil::toString(_duration, 6);
+    std::string framesPerSecond = VROStringUtil::toString((_numFrames - 1) / _duration, 6);
+    std::string lastSegment = VROStringUtil::toString(_numFrames - 2);
+    
+    /*
+     Modifier that places each instance using its transform in the crowd UBO, and
+     skins it with the bone transforms of the two frames bracketing its animation
+     time. The weighted rows of the bone transforms are summed first, so that each
+     vertex is transformed only once. The layout of the uniform block must match
+     VROCrowdUBOVertexData.
+     */
+    std::vector<std::string> modifierCode = {
+        "layout (std140) uniform crowd_vertex_data { highp mat4 crowd_transforms[" + maxInstances + "]; "
+            "highp vec4 crowd_animation[" + maxInstances + "]; };",
+        "uniform highp sampler2D crowd_bone_texture;",
+        "uniform highp float crowd_time;",
+        
+        "highp vec4 crowd_instance = crowd_animation[v_instance_id];",
+        "highp float crowd_frame = mod(crowd_time * crowd_instance.y + crowd_instance.x, " + duration + ") * " + framesPerSecond + ";",
+        "int crowd_segment = min(int(crowd_frame), " + lastSegment + ");",
+        "highp float crowd_blend = crowd_frame - float(crowd_segment);",
+        "highp vec4 crowd_weights[2];",
+        "crowd_weights[0] = _geometry.bone_weights * (1.0 - crowd_blend);",
+        "crowd_weights[1] = _geometry.bone_weights * crowd_blend;",
+        "highp vec4 crowd_rows[3];",
+        "crowd_rows[0] = vec4(0.0); crowd_rows[1] = vec4(0.0); crowd_rows[2] = vec4(0.0);",
+        "for (int k = 0; k < 2; k++) {",
+        "    for (int r = 0; r < 3; r++) {",
+        "        crowd_rows[r] += texelFetch(crowd_bone_texture, ivec2(_geometry.bone_indices.x * 3 + r, crowd_segment + k), 0) * crowd_weights[k].x +",
+        "                         texelFetch(crowd_bone_texture, ivec2(_geometry.bone_indices.y * 3 + r, crowd_segment + k), 0) * crowd_weights[k].y +",
+        "                         texelFetch(crowd_bone_texture, ivec2(_geometry.bone_indices.z * 3 + r, crowd_segment + k), 0) * crowd_weights[k].z +",
+        "                         texelFetch(crowd_bone_texture, ivec2(_geometry.bone_indices.w * 3 + r, crowd_segment + k), 0) * crowd_weights[k].w;",
+        "    }",
+        "}",
+        "highp vec4 crowd_position = vec4(_geometry.position, 1.0);",
+        "_geometry.position = vec3(dot(crowd_rows[0], crowd_position), dot(crowd_rows[1], crowd_position), dot(crowd_rows[2], crowd_position));",
+        "_geometry.normal = vec3(dot(crowd_rows[0].xyz, _geometry.normal), dot(crowd_rows[1].xyz, _geometry.normal), dot(crowd_rows[2].xyz, _geometry.normal));",
+        
+        // Instances are expected to have uniform scale, so the model matrix can
+        // serve as the normal matrix
+        "_transforms.model_matrix = crowd_transforms[v_instance_id];",
+        "_transforms.normal_matrix = crowd_transforms[v_instance_id];",
+    };
+    
+    _crowdModifier = std::make_shared<VROShaderModifier>(VROShaderEntryPoint::Geometry, modifierCode);
+    _crowdModifier->setName("crowd");
+    _crowdModifier->setAttributes((int) VROShaderMask::BoneIndex | (int) VROShaderMask::BoneWeight);
+    _crowdModifier->addSampler("crowd_bone_texture", _texture);
+    _crowdModifier->setUniformBinder("crowd_time", VROShaderProperty::Float,
+                                     [](VROUniform *uniform,
+                                        const VROGeometry *geometry, const VROMaterial *material) {
+        const VROCrowdUBO *crowd = dynamic_cast<const VROCrowdUBO *>(geometry->getInstancedUBO().get());
+        uniform->setFloat(crowd != nullptr ? crowd->getTime() : 0);
+    });
+    return _crowdModifier;
+}
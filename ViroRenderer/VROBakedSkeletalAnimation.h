@@ -0,0 +1,152 @@
+//
+//  VROBakedSkeletalAnimation.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/1/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROBakedSkeletalAnimation_h
+#define VROBakedSkeletalAnimation_h
+
+#include <memory>
+#include <vector>
+#include "VROMatrix4f.h"
+#include "VROBoundingBox.h"
+
+class VROTexture;
+class VROSkinner;
+class VROShaderModifier;
+class VROSkeletalAnimation;
+
+// Frame rate at which animations are baked, unless otherwise specified
+static const float kDefaultBakeFramesPerSecond = 30;
+
+// Maximum number of frames in a baked animation; this is the minimum maximum
+// texture size guaranteed by OpenGL ES 3.0
+static const int kMaxBakedFrames = 2048;
+
+// Each bone is stored as the three rows of its affine transform
+static const int kTexelsPerBakedBone = 3;
+
+/*
+ A skeletal animation baked into a float texture, for rendering many instances
+ of a skinned model without any per-instance CPU work (see VROCrowdUBO).
+ 
+ Baking samples the animation at a fixed frame rate and, for each frame,
+ records the final skinning transform of every bone: the transform
+ VROSkinner::getModelTransform() would compute, and VROBoneUBO would upload,
+ for that pose. Row f of the texture holds frame f, and bone b occupies the
+ texels [b * 3, b * 3 + 3) of the row, one per row of its affine transform.
+ The vertex shader reads the two frames bracketing each instance's time with
+ texelFetch and blends between them.
+ 
+ Bone transforms are stored as matrices rather than dual quaternions, as
+ dual-quaternion skinning is disabled in VROBoneUBO.
+ */
+class VROBakedSkeletalAnimation {
+    
+public:
+    
+    /*
+     Bake the given animation at the given frame rate. The animation's skeleton
+     is posed for each frame, and restored to its current pose afterward, so
+     this must be invoked on the rendering thread. Returns nullptr if the
+     animation is empty.
+     */
+    static std::shared_ptr<VROBakedSkeletalAnimation> bake(std::shared_ptr<VROSkeletalAnimation> animation,
+                                                           float framesPerSecond = kDefaultBakeFramesPerSecond);
+    
+    VROBakedSkeletalAnimation(std::shared_ptr<VROSkinner> skinner, std::shared_ptr<std::vector<float>> data,
+                              int numBones, int numFrames, float duration);
+    virtual ~VROBakedSkeletalAnimation();
+    
+    std::shared_ptr<VROSkinner> getSkinner() const {
+        return _skinner;
+    }
+    int getNumBones() const {
+        return _numBones;
+    }
+    int getNumFrames() const {
+        return _numFrames;
+    }
+    float getDuration() const {
+        return _duration;
+    }
+    
+    /*
+     The bone transform texture, in RGBA32F format.
+     */
+    std::shared_ptr<VROTexture> getTexture() const {
+        return _texture;
+    }
+    
+    /*
+     Size of the baked data, in bytes.
+     */
+    size_t getDataSize() const;
+    
+    /*
+     Get the skinning transform of the given bone at the given frame, as stored
+     in the texture.
+     */
+    VROMatrix4f getBoneTransform(int frame, int bone) const;
+    
+    /*
+     Get conservative bounds of the skinned geometry over the entire animation,
+     given the bounds of the geometry in its original (encoded) position.
+     */
+    VROBoundingBox getAnimatedBounds(const VROBoundingBox &bindBounds) const;
+    
+    /*
+     Get the geometry modifier that skins and places crowd instances using this
+     animation. The modifier is shared by all crowds using this animation, so that
+     they share a shader.
+     */
+    std::shared_ptr<VROShaderModifier> getCrowdModifier();
+    
+private:
+    
+    /*
+     The skinner of the baked animation, which maps the skinned geometry to
+     the skeleton.
+     */
+    std::shared_ptr<VROSkinner> _skinner;
+    
+    /*
+     The baked bone transforms, as RGBA texels, and their dimensions. The
+     texture reads directly from this data.
+     */
+    std::shared_ptr<std::vector<float>> _data;
+    int _numBones;
+    int _numFrames;
+    
+    /*
+     Duration of the animation in seconds.
+     */
+    float _duration;
+    
+    std::shared_ptr<VROTexture> _texture;
+    std::shared_ptr<VROShaderModifier> _crowdModifier;
+    
+};
+
+#endif /* VROBakedSkeletalAnimation_h */
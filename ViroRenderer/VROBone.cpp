@@ -27,7 +27,10 @@
 #include "VROBone.h"
 #include "VROAnimationMatrix4f.h"
 
+std::atomic<uint64_t> VROBone::sPoseVersion(0);
+
 void VROBone::setTransform(VROMatrix4f transform, VROBoneTransformType type) {
     _transform = transform;
     _transformType = type;
+    _transformVersion = ++sPoseVersion;
 }
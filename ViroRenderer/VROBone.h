@@ -28,6 +28,8 @@
 #define VROBone_h
 
 #include <map>
+#include <atomic>
+#include <stdint.h>
 #include "VROMatrix4f.h"
 #include "VROAnimatable.h"
 
@@ -86,7 +88,8 @@ public:
         _name(name),
         _localTransform(localTransform),
         _bindTransform(bindTransform),
-        _transformType(VROBoneTransformType::Legacy) {
+        _transformType(VROBoneTransformType::Legacy),
+        _transformVersion(0) {
     }
     virtual ~VROBone() {}
     
@@ -120,6 +123,25 @@ public:
         return _transformType;
     }
 
+    /*
+     Returns the pose version at which this bone's transform was last set. Pose
+     versions are drawn from a single counter shared by all bones, so a skeleton
+     whose cached pose is at version V only has to recompute the bones whose
+     transform version is greater than V (and their descendants).
+     */
+    uint64_t getTransformVersion() const {
+        return _transformVersion;
+    }
+
+    /*
+     Returns the latest pose version handed out to any bone. If this matches the
+     version at which a skeleton last computed its pose, no bone has been moved
+     since.
+     */
+    static uint64_t getPoseVersion() {
+        return sPoseVersion.load(std::memory_order_relaxed);
+    }
+
     /*
      Get the (non-animated) local transform for this bone, which moves from the
      bone's local space in bind position to the parent bone's space in bind position.
@@ -195,6 +217,13 @@ private:
      */
     VROBoneTransformType _transformType;
 
+    /*
+     The pose version at which _transform was last set, and the counter from
+     which these versions are drawn.
+     */
+    uint64_t _transformVersion;
+    static std::atomic<uint64_t> sPoseVersion;
+
     /*
      The binding transformation to use when moving from model space into bone local
      space that is configured in the "T-pose" bind position.
@@ -29,6 +29,7 @@
 #include <limits>
 #include "VROVector3f.h"
 #include <float.h>
+#include <algorithm>
 
 //Epsilon value for point containment to account for precision errors
 #define kContainsPointEpsilon 0.01
@@ -261,6 +262,39 @@ bool VROBoundingBox::intersectsRay(const VROVector3f &ray, const VROVector3f &or
     return foundIntersection;
 }
 
+bool VROBoundingBox::intersectsRay(const VROVector3f &ray, const VROVector3f &origin) const {
+    float tmin = 0;
+    float tmax = FLT_MAX;
+    
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float d[3] = { ray.x, ray.y, ray.z };
+    for (int axis = 0; axis < 3; axis++) {
+        float min = _planes[axis * 2];
+        float max = _planes[axis * 2 + 1];
+        
+        // Rays parallel to this slab intersect it only if they start within it
+        if (d[axis] == 0) {
+            if (o[axis] < min || o[axis] > max) {
+                return false;
+            }
+            continue;
+        }
+        
+        float inv = 1.0f / d[axis];
+        float t0 = (min - o[axis]) * inv;
+        float t1 = (max - o[axis]) * inv;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        tmin = std::max(tmin, t0);
+        tmax = std::min(tmax, t1);
+        if (tmin > tmax) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool VROBoundingBox::containsPoint(const VROVector3f &point) const {
     if (point.x - _planes[VROBoxPlaneMinX] < -kContainsPointEpsilon) {
         return false;
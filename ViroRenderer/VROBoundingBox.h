@@ -54,11 +54,33 @@ public:
     VROBoundingBox() noexcept;
     VROBoundingBox(float left, float right, float bottom, float top, float zmin, float zmax);
 
+    /*
+     Exact comparison of the box extremities.
+     */
+    bool operator==(const VROBoundingBox &r) const {
+        for (int i = 0; i < 6; i++) {
+            if (_planes[i] != r._planes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool operator!=(const VROBoundingBox &r) const {
+        return !(*this == r);
+    }
+
     /*
      Ray intersection. The intersection result will be stored in *intPt. If there are multiple intersection
      points, only one will be returned.
      */
     bool intersectsRay(const VROVector3f &ray, const VROVector3f &origin, VROVector3f *intPt);
+    
+    /*
+     Fast ray intersection test (slab method) that does not compute the intersection
+     point. Returns true if the ray, starting at the origin, passes through or starts
+     inside the box.
+     */
+    bool intersectsRay(const VROVector3f &ray, const VROVector3f &origin) const;
 
     /*
      Point containment functions. The first function checks for full containment; the remaining functions
@@ -0,0 +1,180 @@
+//
+//  VROCrowdTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/5/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROCrowdTest.h"
+#include "VROTestUtil.h"
+#include "VROPortal.h"
+#include "VROCrowdUBO.h"
+#include "VROBakedSkeletalAnimation.h"
+#include "VROSkeletalAnimation.h"
+#include "VROAnimationChain.h"
+#include "VROGeometry.h"
+
+static const std::string kCrowdAnimation = "Take 001";
+static const int kGridSize = 20;
+static const int kNumInstances = kGridSize * kGridSize;
+
+// Number of frames to render the crowd before checking draws
+static const int kSettleFrames = 60;
+
+VROCrowdTest::VROCrowdTest() :
+    VRORendererTest(VRORendererTestType::Crowd),
+    _loaded(false),
+    _numFrames(0) {
+        
+}
+
+VROCrowdTest::~VROCrowdTest() {
+    
+}
+
+void VROCrowdTest::build(std::shared_ptr<VRORenderer> renderer,
+                         std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                         std::shared_ptr<VRODriver> driver) {
+    _driver = driver;
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    std::shared_ptr<VROLight> ambient = std::make_shared<VROLight>(VROLightType::Ambient);
+    ambient->setColor({ 1.0, 1.0, 1.0 });
+    ambient->setIntensity(600);
+    rootNode->addLight(ambient);
+    
+    _model = VROTestUtil::loadFBXModel("worm", { 0, 0, -3 }, { .2, .2, .2 }, { 0, 0, 0 }, 1, kCrowdAnimation, driver,
+                                       [this](std::shared_ptr<VRONode> node, bool success) {
+                                           _loaded = success;
+                                       });
+    rootNode->addChildNode(_model);
+    
+    _crowdNode = std::make_shared<VRONode>();
+    rootNode->addChildNode(_crowdNode);
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+    frameSynchronizer->addFrameListener(shared_from_this());
+}
+
+std::shared_ptr<VRONode> VROCrowdTest::findSkinnedNode(std::shared_ptr<VRONode> node) {
+    if (node->getGeometry() && node->getGeometry()->getSkinner()) {
+        return node;
+    }
+    for (std::shared_ptr<VRONode> child : node->getChildNodes()) {
+        std::shared_ptr<VRONode> skinned = findSkinnedNode(child);
+        if (skinned) {
+            return skinned;
+        }
+    }
+    return nullptr;
+}
+
+void VROCrowdTest::buildCrowd() {
+    std::shared_ptr<VRONode> skinnedNode = findSkinnedNode(_model);
+    passert_msg(skinnedNode != nullptr, "Crowd model has no skinned geometry");
+    
+    std::shared_ptr<VROSkeletalAnimation> clip;
+    std::shared_ptr<VROAnimationChain> chain = std::dynamic_pointer_cast<VROAnimationChain>(_model->getAnimation(kCrowdAnimation, true));
+    for (const std::shared_ptr<VROExecutableAnimation> &animation : chain->getAnimations()) {
+        clip = std::dynamic_pointer_cast<VROSkeletalAnimation>(animation);
+        if (clip) {
+            break;
+        }
+    }
+    passert_msg(clip != nullptr, "Crowd model has no skeletal animation [%s]", kCrowdAnimation.c_str());
+    
+    std::shared_ptr<VROBakedSkeletalAnimation> baked = VROBakedSkeletalAnimation::bake(clip);
+    passert_msg(baked != nullptr, "Failed to bake skeletal animation [%s]", kCrowdAnimation.c_str());
+    
+    _crowd = std::make_shared<VROCrowdUBO>(_driver, baked);
+    for (int x = 0; x < kGridSize; x++) {
+        for (int z = 0; z < kGridSize; z++) {
+            VROMatrix4f transform;
+            transform.scale(0.05, 0.05, 0.05);
+            transform.translate((x - kGridSize / 2.0f + 0.5f) * 0.5f, -1.5, -4 - z * 0.5f);
+            _crowd->addInstance(transform, (x * kGridSize + z) * 0.1f);
+        }
+    }
+    
+    std::shared_ptr<VROGeometry> skinnedGeometry = skinnedNode->getGeometry();
+    std::shared_ptr<VROGeometry> crowdGeometry = _crowd->createGeometry(skinnedGeometry);
+    
+    if (_driver->isInstancedRenderingSupported()) {
+        passert_msg(crowdGeometry != skinnedGeometry, "Crowd returned the skinned geometry on a GPU that supports instancing");
+        passert_msg(crowdGeometry->getSkinner() == nullptr, "Crowd geometry should not be skinned on the CPU");
+        
+        _crowdNode->setGeometry(crowdGeometry);
+        _model->setHidden(true);
+    }
+    else {
+        // Adreno 330 and older: the model is left as is, skinned regularly
+        passert_msg(crowdGeometry == skinnedGeometry, "Expected the crowd to fall back to the skinned geometry on GPU type %d",
+                    (int) _driver->getGPUType());
+    }
+}
+
+void VROCrowdTest::onFrameWillRender(const VRORenderContext &context) {
+    if (_loaded && !_crowd) {
+        buildCrowd();
+    }
+}
+
+void VROCrowdTest::onFrameDidRender(const VRORenderContext &context) {
+    if (!_crowd) {
+        return;
+    }
+    if (++_numFrames != kSettleFrames) {
+        return;
+    }
+    
+    int expectedDraws = (kNumInstances + kMaxCrowdInstancesPerUBO - 1) / kMaxCrowdInstancesPerUBO;
+    int numDraws = _crowd->getNumberOfDrawCalls();
+    pinfo("Rendered a crowd of %d instances with %d instanced draws (instancing supported: %d)",
+          _crowd->getNumInstances(), numDraws, _driver->isInstancedRenderingSupported());
+    
+    passert_msg(_crowd->getNumInstances() == kNumInstances, "Expected %d crowd instances, found %d",
+                kNumInstances, _crowd->getNumInstances());
+    passert_msg(numDraws == expectedDraws, "Expected %d instanced draws for %d instances, found %d",
+                expectedDraws, kNumInstances, numDraws);
+    
+    // Each geometry element of the crowd is one instanced batch (VROPortal counts a
+    // batch as a single draw), however many instances it holds
+    int numSceneDraws = _sceneController->getScene()->getRootNode()->getNumDraws();
+    if (_driver->isInstancedRenderingSupported()) {
+        int numElements = (int) _crowdNode->getGeometry()->getGeometryElements().size();
+        passert_msg(numSceneDraws > 0 && numSceneDraws <= numElements,
+                    "Expected at most %d batches for the crowd, found %d", numElements, numSceneDraws);
+    }
+    else {
+        passert_msg(_crowdNode->getGeometry() == nullptr, "Crowd geometry should not be rendered without instancing");
+    }
+}
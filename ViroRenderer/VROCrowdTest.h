@@ -0,0 +1,88 @@
+//
+//  VROCrowdTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/5/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROCrowdTest_h
+#define VROCrowdTest_h
+
+#include "VRORendererTest.h"
+
+class VROCrowdUBO;
+class VROGeometry;
+
+/*
+ Verifies crowd rendering of a skinned model. Loads an animated FBX model, bakes its
+ skeletal animation, and draws a grid of crowd instances playing the baked clip at
+ staggered offsets. Asserts that the crowd is drawn with one instanced draw per
+ kMaxCrowdInstancesPerUBO instances, or, on GPUs without instanced rendering (the
+ Adreno 330 and older), that the crowd falls back to regular skinning of the model.
+ */
+class VROCrowdTest : public VROFrameListener, public VRORendererTest, public std::enable_shared_from_this<VROFrameListener> {
+public:
+    
+    VROCrowdTest();
+    virtual ~VROCrowdTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+    void onFrameWillRender(const VRORenderContext &context);
+    void onFrameDidRender(const VRORenderContext &context);
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    std::shared_ptr<VRODriver> _driver;
+    
+    /*
+     The loaded FBX model, and the node that renders the crowd built from it.
+     The crowd is built on the first frame after the model loads, since baking
+     poses the skeleton on the rendering thread.
+     */
+    std::shared_ptr<VRONode> _model;
+    std::shared_ptr<VRONode> _crowdNode;
+    std::shared_ptr<VROCrowdUBO> _crowd;
+    bool _loaded;
+    int _numFrames;
+    
+    void buildCrowd();
+    
+    /*
+     Find the first node in the given subtree whose geometry is skinned.
+     */
+    static std::shared_ptr<VRONode> findSkinnedNode(std::shared_ptr<VRONode> node);
+    
+};
+
+#endif /* VROCrowdTest_h */
@@ -0,0 +1,244 @@
+//
+//  VROCrowdUBO.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/1/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROCrowdUBO.h"
+#include "VROBakedSkeletalAnimation.h"
+#include "VROSkinner.h"
+#include "VROGeometry.h"
+#include "VROMaterial.h"
+#include "VROShaderProgram.h"
+#include "VROShaderModifier.h"
+#include "VRODriverOpenGL.h"
+#include "VROTime.h"
+#include "VROThreadRestricted.h"
+#include "VROLog.h"
+#include <string.h>
+#include <algorithm>
+
+VROCrowdUBO::VROCrowdUBO(std::shared_ptr<VRODriver> driver, std::shared_ptr<VROBakedSkeletalAnimation> animation) :
+    _driver(driver),
+    _animation(animation),
+    _animatedBounds(0, 0, 0, 0, 0, 0),
+    _instancedBoundsLoose(false),
+    _startTime(VROTimeCurrentSeconds()) {
+    
+    _instancedBounds = VROBoundingBox(0, 0, 0, 0, 0, 0);
+    memset(&_vertexData, 0x0, sizeof(VROCrowdUBOVertexData));
+}
+
+VROCrowdUBO::~VROCrowdUBO() {
+    std::shared_ptr<VRODriverOpenGL> driver = std::dynamic_pointer_cast<VRODriverOpenGL>(_driver.lock());
+    if (driver) {
+        for (GLuint buffer : _buffers) {
+            driver->deleteBuffer(buffer);
+        }
+    }
+}
+
+std::shared_ptr<VROGeometry> VROCrowdUBO::createGeometry(std::shared_ptr<VROGeometry> skinnedGeometry) {
+    std::shared_ptr<VRODriver> driver = _driver.lock();
+    if (!driver || !driver->isInstancedRenderingSupported()) {
+        pwarn("Instanced rendering not supported, crowd falls back to regular skinning");
+        return skinnedGeometry;
+    }
+    
+    /*
+     The bone indices and weights are geometry sources for glTF, but are held by the
+     skinner for FBX; either way the crowd geometry needs them as vertex attributes.
+     */
+    std::vector<std::shared_ptr<VROGeometrySource>> sources = skinnedGeometry->getGeometrySources();
+    std::shared_ptr<VROSkinner> skinner = skinnedGeometry->getSkinner();
+    if (skinner && skinner->getBoneIndices() != nullptr) {
+        sources.push_back(skinner->getBoneIndices());
+        sources.push_back(skinner->getBoneWeights());
+    }
+    
+    std::shared_ptr<VROGeometry> geometry = std::make_shared<VROGeometry>(sources, skinnedGeometry->getGeometryElements());
+    geometry->setName(skinnedGeometry->getName());
+    
+    /*
+     The silhouettes rendered into shadow maps do not apply the crowd modifier, so
+     crowd materials do not cast shadows.
+     */
+    std::shared_ptr<VROShaderModifier> crowdModifier = _animation->getCrowdModifier();
+    std::vector<std::shared_ptr<VROMaterial>> materials;
+    for (const std::shared_ptr<VROMaterial> &skinnedMaterial : skinnedGeometry->getMaterials()) {
+        std::shared_ptr<VROMaterial> material = std::make_shared<VROMaterial>(skinnedMaterial);
+        std::vector<std::shared_ptr<VROShaderModifier>> modifiers = material->getShaderModifiers();
+        for (const std::shared_ptr<VROShaderModifier> &modifier : modifiers) {
+            if (modifier->getAttributes() & (int) VROShaderMask::BoneIndex) {
+                material->removeShaderModifier(modifier);
+            }
+        }
+        material->addShaderModifier(crowdModifier);
+        material->setCastsShadows(false);
+        materials.push_back(material);
+    }
+    geometry->setMaterials(materials);
+    geometry->setInstancedUBO(shared_from_this());
+    
+    _animatedBounds = _animation->getAnimatedBounds(skinnedGeometry->getBoundingBox());
+    updateBounds();
+    return geometry;
+}
+
+#pragma mark - Instances
+
+int VROCrowdUBO::addInstance(VROMatrix4f transform, float timeOffset, float speed) {
+    _transforms.push_back(transform);
+    _animations.push_back({ timeOffset, speed });
+    
+    int index = (int) _transforms.size() - 1;
+    markDirty(index);
+    
+    growBounds(transform, index == 0);
+    return index;
+}
+
+void VROCrowdUBO::setInstanceTransform(int index, VROMatrix4f transform) {
+    passert (index >= 0 && index < (int) _transforms.size());
+    _transforms[index] = transform;
+    markDirty(index);
+    
+    // The instance's previous bounds may still be included, so the bounds are
+    // only recomputed once they are next requested
+    growBounds(transform, false);
+    _instancedBoundsLoose = true;
+}
+
+void VROCrowdUBO::setInstanceAnimation(int index, float timeOffset, float speed) {
+    passert (index >= 0 && index < (int) _animations.size());
+    _animations[index] = { timeOffset, speed };
+    markDirty(index);
+}
+
+void VROCrowdUBO::removeAllInstances() {
+    _transforms.clear();
+    _animations.clear();
+    _instancedBounds = VROBoundingBox(0, 0, 0, 0, 0, 0);
+    _instancedBoundsLoose = false;
+}
+
+void VROCrowdUBO::markDirty(int index) {
+    int window = index / kMaxCrowdInstancesPerUBO;
+    if (window >= (int) _buffersDirty.size()) {
+        _buffersDirty.resize(window + 1, true);
+    }
+    _buffersDirty[window] = true;
+}
+
+void VROCrowdUBO::growBounds(VROMatrix4f transform, bool first) {
+    VROBoundingBox bounds = _instancedBounds;
+    if (first) {
+        bounds = _animatedBounds.transform(transform);
+    }
+    else {
+        bounds.unionDestructive(_animatedBounds.transform(transform));
+    }
+    _instancedBounds = bounds;
+}
+
+void VROCrowdUBO::updateBounds() {
+    _instancedBoundsLoose = false;
+    if (_transforms.empty()) {
+        _instancedBounds = VROBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    
+    VROBoundingBox bounds = _animatedBounds.transform(_transforms.front());
+    for (size_t i = 1; i < _transforms.size(); i++) {
+        bounds.unionDestructive(_animatedBounds.transform(_transforms[i]));
+    }
+    _instancedBounds = bounds;
+}
+
+float VROCrowdUBO::getTime() const {
+    return (float) (VROTimeCurrentSeconds() - _startTime);
+}
+
+#pragma mark - Instanced UBO
+
+std::vector<std::shared_ptr<VROShaderModifier>> VROCrowdUBO::createInstanceShaderModifier() {
+    return { _animation->getCrowdModifier() };
+}
+
+int VROCrowdUBO::getNumberOfDrawCalls() {
+    return (getNumInstances() + kMaxCrowdInstancesPerUBO - 1) / kMaxCrowdInstancesPerUBO;
+}
+
+int VROCrowdUBO::bindDrawData(int currentDrawCallIndex) {
+    int start = currentDrawCallIndex * kMaxCrowdInstancesPerUBO;
+    int end = std::min(start + kMaxCrowdInstancesPerUBO, getNumInstances());
+    if (start >= end) {
+        return 0;
+    }
+    
+    if (currentDrawCallIndex >= (int) _buffers.size()) {
+        GLuint buffer;
+        GL( glGenBuffers(1, &buffer) );
+        GL( glBindBuffer(GL_UNIFORM_BUFFER, buffer) );
+        GL( glBufferData(GL_UNIFORM_BUFFER, sizeof(VROCrowdUBOVertexData), nullptr, GL_DYNAMIC_DRAW) );
+        _buffers.push_back(buffer);
+        
+        markDirty(start);
+    }
+    
+    GLuint buffer = _buffers[currentDrawCallIndex];
+    GL( glBindBufferBase(GL_UNIFORM_BUFFER, VROShaderProgram::sCrowdVertexUBOBindingPoint, buffer) );
+    
+    // Instance data only changes when the crowd is edited, so most frames draw
+    // straight from the existing buffers
+    if (_buffersDirty[currentDrawCallIndex]) {
+        for (int i = start; i < end; i++) {
+            memcpy(&_vertexData.crowd_transforms[(i - start) * 16], _transforms[i].getArray(), 16 * sizeof(float));
+            
+            float *animation = &_vertexData.crowd_animation[(i - start) * 4];
+            animation[0] = _animations[i].first;
+            animation[1] = _animations[i].second;
+            animation[2] = 0;
+            animation[3] = 0;
+        }
+        
+        pglpush("Crowd");
+#if VRO_AVOID_BUFFER_SUB_DATA
+        GL( glBufferData(GL_UNIFORM_BUFFER, sizeof(VROCrowdUBOVertexData), &_vertexData, GL_DYNAMIC_DRAW) );
+#else
+        GL( glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(VROCrowdUBOVertexData), &_vertexData) );
+#endif
+        pglpop();
+        _buffersDirty[currentDrawCallIndex] = false;
+    }
+    return end - start;
+}
+
+VROBoundingBox VROCrowdUBO::getInstancedBoundingBox() {
+    // The instances are only edited on the rendering thread, which requests the
+    // bounds once per frame when updating the node's transforms
+    if (_instancedBoundsLoose && VROThreadRestricted::isThread(VROThreadName::Renderer)) {
+        updateBounds();
+    }
+    return _instancedBounds;
+}
@@ -0,0 +1,177 @@
+//
+//  VROCrowdUBO.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/1/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROCrowdUBO_h
+#define VROCrowdUBO_h
+
+#include "VROInstancedUBO.h"
+#include "VROAtomic.h"
+
+/*
+ Maximum number of crowd instances drawn per glDrawElementsInstanced call. Each
+ instance occupies a mat4 transform and a vec4 of animation parameters, which
+ keeps the block within the minimum uniform block size of 16KB.
+ */
+static const int kMaxCrowdInstancesPerUBO = 200;
+
+/*
+ Uniform buffer object structure format through which crowd instances are batched
+ into the vertex shader. Matches the layout of crowd_vertex_data in
+ VROBakedSkeletalAnimation::getCrowdModifier().
+ */
+typedef struct {
+    float crowd_transforms[kMaxCrowdInstancesPerUBO * 16];
+    float crowd_animation[kMaxCrowdInstancesPerUBO * 4];
+} VROCrowdUBOVertexData;
+
+class VROGeometry;
+class VROBakedSkeletalAnimation;
+
+/*
+ VROCrowdUBO renders many instances of a skinned model playing a baked skeletal
+ animation, each with its own transform, time offset, and playback speed. All
+ instances are drawn with instanced draw calls, and skinned entirely in the vertex
+ shader from the animation's bone texture: there is no per-instance CPU work each
+ frame, and instance data is only uploaded when it changes.
+ 
+ Usage: bake the model's animation with VROBakedSkeletalAnimation::bake(), create
+ a crowd from it, and set the geometry returned by createGeometry() on a node.
+ Instance transforms are in world space, as with particles, so the node's own
+ transform is ignored.
+ */
+class VROCrowdUBO : public VROInstancedUBO, public std::enable_shared_from_this<VROCrowdUBO> {
+public:
+    
+    VROCrowdUBO(std::shared_ptr<VRODriver> driver, std::shared_ptr<VROBakedSkeletalAnimation> animation);
+    virtual ~VROCrowdUBO();
+    
+    /*
+     Create a geometry that renders this crowd, sharing the vertex data of the given
+     skinned geometry (which should be bound to the skeleton of the baked animation).
+     Its materials are copies of the skinned geometry's materials, with the skinning
+     modifier replaced by the crowd modifier. The returned geometry has no skinner,
+     so it is never skinned on the CPU. Crowds do not cast shadows.
+     
+     If the driver does not support instanced rendering (e.g. Adreno 330 and older),
+     the skinned geometry itself is returned: it is skinned and animated regularly,
+     as a single model at its node's transform.
+     */
+    std::shared_ptr<VROGeometry> createGeometry(std::shared_ptr<VROGeometry> skinnedGeometry);
+    
+    /*
+     Add an instance with the given world transform, which must have uniform scale.
+     The instance plays the animation from the given time offset, in seconds, at the
+     given speed. Returns the index of the instance.
+     */
+    int addInstance(VROMatrix4f transform, float timeOffset, float speed = 1.0);
+    void setInstanceTransform(int index, VROMatrix4f transform);
+    void setInstanceAnimation(int index, float timeOffset, float speed);
+    void removeAllInstances();
+    
+    int getNumInstances() const {
+        return (int) _transforms.size();
+    }
+    
+    /*
+     The time in seconds since the crowd was created, which drives the animations
+     of all instances.
+     */
+    float getTime() const;
+    
+    std::vector<std::shared_ptr<VROShaderModifier>> createInstanceShaderModifier();
+    
+    /*
+     Returns the number of glDraw(s) required to draw all instances.
+     */
+    int getNumberOfDrawCalls();
+    
+    /*
+     Bind the uniform buffer holding the window of instances corresponding to the
+     given draw call index, uploading it first if any of its instances changed.
+     Returns the number of instances in the window.
+     */
+    int bindDrawData(int currentDrawCallIndex);
+    
+    /*
+     Returns the world bounds of all instances, throughout the animation. Moving
+     instances only grows the bounds; they are tightened here, at most once per
+     frame, when invoked on the rendering thread.
+     */
+    VROBoundingBox getInstancedBoundingBox();
+    
+private:
+    
+    /*
+     The driver that created this UBO.
+     */
+    std::weak_ptr<VRODriver> _driver;
+    
+    /*
+     The animation played by the instances.
+     */
+    std::shared_ptr<VROBakedSkeletalAnimation> _animation;
+    
+    /*
+     Per-instance transforms and animation parameters (time offset, speed).
+     */
+    std::vector<VROMatrix4f> _transforms;
+    std::vector<std::pair<float, float>> _animations;
+    
+    /*
+     One uniform buffer per draw call, each holding a window of kMaxCrowdInstancesPerUBO
+     instances, and whether each must be uploaded before it is next drawn.
+     */
+    std::vector<GLuint> _buffers;
+    std::vector<bool> _buffersDirty;
+    
+    /*
+     Bounds of the geometry over the animation, in model space, and the world bounds
+     of all instances. The latter is atomic because it may be accessed from the
+     application thread (see VRONode's application properties). When an instance
+     moves the world bounds are grown to include it and flagged as loose, to be
+     recomputed from all instances on the next getInstancedBoundingBox().
+     */
+    VROBoundingBox _animatedBounds;
+    VROAtomic<VROBoundingBox> _instancedBounds;
+    bool _instancedBoundsLoose;
+    
+    /*
+     Time at which the crowd was created, in seconds.
+     */
+    double _startTime;
+    
+    /*
+     Staging data for the uniform buffers.
+     */
+    VROCrowdUBOVertexData _vertexData;
+    
+    void markDirty(int index);
+    void growBounds(VROMatrix4f transform, bool first);
+    void updateBounds();
+    
+};
+
+#endif /* VROCrowdUBO_h */
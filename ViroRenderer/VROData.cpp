@@ -25,8 +25,9 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "VROData.h"
+#include "VROLog.h"
 
-VROData::VROData(void *data, int dataLength, VRODataOwnership ownership) :
+VROData::VROData(void *data, size_t dataLength, VRODataOwnership ownership) :
     _ownership(ownership) {
         
     if (ownership == VRODataOwnership::Copy) {
@@ -40,7 +41,7 @@ VROData::VROData(void *data, int dataLength, VRODataOwnership ownership) :
     }
 }
 
-VROData::VROData(const void *data, int dataLength, int byteOffset) :
+VROData::VROData(const void *data, size_t dataLength, size_t byteOffset) :
     _ownership(VRODataOwnership::Copy) {
     _data = malloc(dataLength);
     _dataLength = dataLength;
@@ -49,6 +50,31 @@ VROData::VROData(const void *data, int dataLength, int byteOffset) :
     memcpy(_data, startingDataPoint, dataLength);
 }
 
+VROData::VROData(void *data, size_t dataLength, std::shared_ptr<void> owner) :
+    _data(data),
+    _dataLength(dataLength),
+    _ownership(VRODataOwnership::Wrap),
+    _owner(owner) {
+    
+}
+
+VROData::VROData(void *data, size_t dataLength, std::function<void(void *data)> release) :
+    _data(data),
+    _dataLength(dataLength),
+    _ownership(VRODataOwnership::Wrap),
+    _owner(data, release) {
+    
+}
+
+std::shared_ptr<VROData> VROData::slice(std::shared_ptr<VROData> data, size_t byteOffset, size_t dataLength) {
+    passert (byteOffset + dataLength <= data->getDataLength());
+    
+    // Share the parent's owner directly when it has one, so that slices of
+    // slices do not form chains
+    std::shared_ptr<void> owner = data->_owner ? data->_owner : std::shared_ptr<void>(data);
+    return std::make_shared<VROData>((char *) data->_data + byteOffset, dataLength, owner);
+}
+
 VROData::~VROData() {
     if (_ownership == VRODataOwnership::Copy || _ownership == VRODataOwnership::Move) {
         free (_data);
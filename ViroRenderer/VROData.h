@@ -30,6 +30,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <memory>
+#include <functional>
 
 /*
  Defines how the VROData holds onto its underlying data.
@@ -46,6 +48,12 @@ enum class VRODataOwnership {
 
 /*
  Holds onto an arbitrary block of bytes.
+ 
+ Lengths are size_t so that 64-bit platforms can hold buffers larger than 2GB.
+ Any number of VROData may share one underlying allocation: use slice() to
+ reference a sub-range of an existing VROData without copying it. The slice
+ retains its parent, so the allocation (whether heap, memory-mapped, or owned
+ by a loader) is released only when the last slice is destroyed.
  */
 class VROData {
     
@@ -55,30 +63,56 @@ public:
      Construct a new VROData. Default ownership semanatics are
      Copy.
      */
-    VROData(void *data, int dataLength, VRODataOwnership ownership = VRODataOwnership::Copy);
+    VROData(void *data, size_t dataLength, VRODataOwnership ownership = VRODataOwnership::Copy);
 
     /*
      Construct a new VROData, copying a dataLength's worth of bytes, starting
      at a byteOffset into the given data (allows for const data input).
      */
-    VROData(const void *data, int dataLength, int byteOffset = 0);
+    VROData(const void *data, size_t dataLength, size_t byteOffset = 0);
+    
+    /*
+     Construct a new VROData that wraps the given data without copying it. The
+     given owner (e.g. the VROMappedFile containing the data) is retained for as
+     long as this VROData exists.
+     */
+    VROData(void *data, size_t dataLength, std::shared_ptr<void> owner);
+    
+    /*
+     Construct a new VROData that wraps the given data without copying it. The
+     release function is invoked with the data once this VROData and all of
+     its slices have been destroyed.
+     */
+    VROData(void *data, size_t dataLength, std::function<void(void *data)> release);
 
     ~VROData();
     
+    /*
+     Return a VROData referencing dataLength bytes of the given data, starting
+     at byteOffset. No bytes are copied; the slice retains the given data.
+     */
+    static std::shared_ptr<VROData> slice(std::shared_ptr<VROData> data, size_t byteOffset, size_t dataLength);
+    
     void *const getData() {
         return _data;
     }
-    int getDataLength() const {
+    size_t getDataLength() const {
         return _dataLength;
     }
     
 private:
     
     void *_data;
-    int _dataLength;
+    size_t _dataLength;
     
     VRODataOwnership _ownership;
     
+    /*
+     Keeps wrapped data alive, if this VROData was constructed with an owner,
+     a release function, or is a slice.
+     */
+    std::shared_ptr<void> _owner;
+    
 };
 
 #endif /* VROData_h */
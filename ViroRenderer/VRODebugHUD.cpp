@@ -40,7 +40,7 @@ static const int kFPSRefreshRate = 60;
 
 VRODebugHUD::VRODebugHUD() :
     _enabled(false) {
-    
+    _renderMetadata = std::make_shared<VRORenderMetadata>();
 }
 
 VRODebugHUD::~VRODebugHUD() {
@@ -59,7 +59,7 @@ void VRODebugHUD::initRenderer(std::shared_ptr<VRODriver> driver) {
                                           "Helvetica", 26, VROFontStyle::Normal, VROFontWeight::Regular,
                                           { 0.6, 1.0, 0.6, 1.0 }, 0, driver);
     for (const std::shared_ptr<VROTypeface> &typeface : _text->getTypefaceCollection()->getTypefaces()) {
-        typeface->preloadGlyphs("0123456789.");
+        typeface->preloadGlyphs("0123456789. ");
     }
     _node->setPosition({-.5, .5, -2.5});
 }
@@ -68,12 +68,13 @@ void VRODebugHUD::setEnabled(bool enabled) {
     _enabled = enabled;
 }
 
-void VRODebugHUD::prepare(const VRORenderContext &context) {
+void VRODebugHUD::prepare(const VRORenderContext &context, const std::shared_ptr<VRORenderMetadata> &metadata) {
     if (!_enabled) {
         return;
     }
     if (context.getFrame() % kFPSRefreshRate == 0) {
-        _text->setText(VROStringUtil::toWString(context.getFPS(), 2));
+        _text->setText(VROStringUtil::toWString(context.getFPS(), 2) + L" " +
+                       VROStringUtil::toWString(metadata->getUmbrellaBoundsUpdated()));
         _node->setGeometry(_text);
     }
 }
@@ -88,10 +89,10 @@ void VRODebugHUD::renderEye(VROEyeType eye, const VRORenderContext &context, std
     
     VROMatrix4f identity;
     VRORenderParameters renderParams;
-    std::shared_ptr<VRORenderMetadata> metadata = std::make_shared<VRORenderMetadata>();
+    _renderMetadata->reset();
     _node->computeTransforms(identity, {});
     _node->applyConstraints(context, identity, false);
-    _node->updateSortKeys(0, renderParams, metadata, context, driver);
+    _node->updateSortKeys(0, renderParams, _renderMetadata, context, driver);
     _node->syncAppThreadProperties();
 
     for (int i = 0; i < _node->getGeometry()->getGeometryElements().size(); i++) {
@@ -34,6 +34,7 @@ class VRORenderContext;
 class VRODriver;
 class VROText;
 class VROTypefaceCollection;
+class VRORenderMetadata;
 enum class VROEyeType;
 
 class VRODebugHUD {
@@ -54,9 +55,10 @@ public:
     void setEnabled(bool enabled);
   
     /*
-     Render-loop functions.
+     Render-loop functions. The HUD displays the FPS followed by the number
+     of umbrella bounding boxes recomputed in the frame.
      */
-    void prepare(const VRORenderContext &context);
+    void prepare(const VRORenderContext &context, const std::shared_ptr<VRORenderMetadata> &metadata);
     void renderEye(VROEyeType eye, const VRORenderContext &context, std::shared_ptr<VRODriver> &driver);
     
 private:
@@ -65,6 +67,12 @@ private:
     std::shared_ptr<VROText> _text;
     std::shared_ptr<VRONode> _node;
     
+    /*
+     Metadata passed to updateSortKeys() when rendering the HUD, reused each
+     frame.
+     */
+    std::shared_ptr<VRORenderMetadata> _renderMetadata;
+    
 };
 
 #endif /* VRODebugHUD_h */
@@ -28,6 +28,8 @@
 #define VRODriver_h
 
 #include <vector>
+#include <memory>
+#include <functional>
 #include "VRODefines.h"
 #include "VROSoundData.h"
 
@@ -49,6 +51,7 @@ class VRORenderContext;
 class VROShaderProgram;
 class VROImagePostProcess;
 class VROFrameScheduler;
+class VROAssetCache;
 
 enum class VROSoundType;
 enum class VROTextureType;
@@ -190,6 +193,13 @@ public:
      by a subset of GPUs.
      */
     virtual void readGPUType() = 0;
+    
+    /*
+     Read the compressed texture formats the GPU can sample, and report them to
+     VROTextureTranscoder, which decides whether compressed texture data is used
+     as is, decoded, or produced by transcoding.
+     */
+    virtual void readTextureFormats() = 0;
 
     /*
      Get the GPU type, after it has been read by the system.
@@ -264,6 +274,12 @@ public:
      bloom threshold will glow.
      */
     virtual bool isBloomSupported() = 0;
+
+    /*
+     Return true if nodes that share the same geometry and material may be
+     batched together and rendered with instanced draw calls.
+     */
+    virtual bool isInstancedRenderingSupported() = 0;
     
     virtual VROGeometrySubstrate *newGeometrySubstrate(const VROGeometry &geometry) = 0;
     virtual VROMaterialSubstrate *newMaterialSubstrate(VROMaterial &material) = 0;
@@ -275,6 +291,28 @@ public:
                                                      int width, int height, std::vector<uint32_t> mipSizes,
                                                      VROWrapMode wrapS, VROWrapMode wrapT,
                                                      VROFilterMode minFilter, VROFilterMode magFilter, VROFilterMode mipFilter) = 0;
+
+    /*
+     Create a texture substrate without stalling the rendering thread: the data is
+     staged and transferred over subsequent frames, and the callback is invoked on
+     the rendering thread once the substrate is ready. The given images back the
+     data, and are retained until it has been read. Returns false if the driver
+     does not support asynchronous uploads, in which case newTextureSubstrate()
+     should be used instead.
+     */
+    virtual bool newTextureSubstrateAsync(VROTextureType type,
+                                          VROTextureFormat format,
+                                          VROTextureInternalFormat internalFormat, bool sRGB,
+                                          VROMipmapMode mipmapMode,
+                                          std::vector<std::shared_ptr<VROData>> &data,
+                                          std::vector<std::shared_ptr<VROImage>> &images,
+                                          int width, int height, std::vector<uint32_t> mipSizes,
+                                          VROWrapMode wrapS, VROWrapMode wrapT,
+                                          VROFilterMode minFilter, VROFilterMode magFilter, VROFilterMode mipFilter,
+                                          std::function<void(std::unique_ptr<VROTextureSubstrate>)> onCreated) {
+        return false;
+    }
+    
     virtual std::shared_ptr<VRORenderTarget> newRenderTarget(VRORenderTargetType type, int numAttachments, int numImages,
                                                              bool enableMipmaps, bool needsDepthStencil) = 0;
     virtual std::shared_ptr<VROVertexBuffer> newVertexBuffer(std::shared_ptr<VROData> data) = 0;
@@ -292,6 +330,11 @@ public:
     
     virtual std::shared_ptr<VROFrameScheduler> getFrameScheduler() = 0;
     virtual void *getGraphicsContext() = 0;
+    
+    /*
+     Cache of the textures, vertex buffers and materials loaded for this driver.
+     */
+    virtual std::shared_ptr<VROAssetCache> getAssetCache() = 0;
 };
 
 #endif /* VRODriver_hpp */
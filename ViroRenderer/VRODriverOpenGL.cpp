@@ -24,6 +24,7 @@
 //  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "VRODriverOpenGL.h"
+#include "VROAssetCache.h"
 
 // Note this class has limited functionality (most is in the header) but we still require a
 // cpp file in order to have a 'key function' which guarantees we get a strong global symbol
@@ -45,8 +46,14 @@ VRODriverOpenGL::VRODriverOpenGL() :
 
     _shaderFactory = std::unique_ptr<VROShaderFactory>(new VROShaderFactory());
     _scheduler = std::make_shared<VROFrameScheduler>();
+    _assetCache = std::make_shared<VROAssetCache>();
+    if (VROUploadQueueOpenGL::isSupported()) {
+        _uploadQueue = std::unique_ptr<VROUploadQueueOpenGL>(new VROUploadQueueOpenGL());
+    }
 }
 
 VRODriverOpenGL::~VRODriverOpenGL() {
-
+    // Loaders in flight may still reference the cache; release its assets now
+    // rather than when the last of them finishes
+    _assetCache->clear();
 }
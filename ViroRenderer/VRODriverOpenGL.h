@@ -38,13 +38,17 @@
 #include "VRODisplayOpenGL.h"
 #include "VROShaderProgram.h"
 #include "VROLightingUBO.h"
+#include "VROInstanceBatchUBO.h"
 #include "VROShaderModifier.h"
 #include "VRORenderContext.h"
 #include "VROGeometrySource.h"
 #include "VROImagePostProcessOpenGL.h"
 #include "VROLight.h"
 #include "VROShaderFactory.h"
+#include "VROUploadQueueOpenGL.h"
+#include "VROTextureTranscoder.h"
 #include <list>
+#include <algorithm>
 
 static const bool kEnableStencilCopy = true;
 static const int kResourcePurgeFrameInterval = 120;
@@ -59,6 +63,12 @@ public:
     virtual ~VRODriverOpenGL();
 
     void willRenderFrame(const VRORenderContext &context) {
+        // Advance asynchronous uploads before resetting state, since creating
+        // textures disturbs the texture bindings
+        if (_uploadQueue) {
+            _uploadQueue->update(shared_from_this());
+        }
+        
         // Initialize OpenGL state for this frame, matching GL state with CPU state
         // We need to reset state each frame to sync our CPU state with our GPU
         // state, in case a part of the renderer outside our control (e.g. Cardboard,
@@ -404,6 +414,10 @@ public:
         return true;
     }
 
+    virtual bool isInstancedRenderingSupported() {
+        return _gpuType != VROGPUType::Adreno330OrOlder;
+    }
+
     VROGeometrySubstrate *newGeometrySubstrate(const VROGeometry &geometry) {
         std::shared_ptr<VRODriverOpenGL> driver = shared_from_this();
         return new VROGeometrySubstrateOpenGL(geometry, driver);
@@ -429,6 +443,25 @@ public:
                                              driver);
     }
     
+    bool newTextureSubstrateAsync(VROTextureType type,
+                                  VROTextureFormat format,
+                                  VROTextureInternalFormat internalFormat, bool sRGB,
+                                  VROMipmapMode mipmapMode,
+                                  std::vector<std::shared_ptr<VROData>> &data,
+                                  std::vector<std::shared_ptr<VROImage>> &images,
+                                  int width, int height, std::vector<uint32_t> mipSizes,
+                                  VROWrapMode wrapS, VROWrapMode wrapT,
+                                  VROFilterMode minFilter, VROFilterMode magFilter, VROFilterMode mipFilter,
+                                  std::function<void(std::unique_ptr<VROTextureSubstrate>)> onCreated) {
+        if (!_uploadQueue) {
+            return false;
+        }
+        VROTextureUploadParams params = { type, format, internalFormat, sRGB, mipmapMode, data, width, height, mipSizes,
+                                          wrapS, wrapT, minFilter, magFilter, mipFilter, images };
+        _uploadQueue->uploadTexture(params, onCreated);
+        return true;
+    }
+    
     std::shared_ptr<VRORenderTarget> newRenderTarget(VRORenderTargetType type, int numAttachments, int numImages, bool enableMipmaps,
                                                      bool needsDepthStencil) {
         std::shared_ptr<VRODriverOpenGL> driver = shared_from_this();
@@ -473,6 +506,39 @@ public:
         }
     }
 
+    void readTextureFormats() {
+        GLint numFormats = 0;
+        GL( glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numFormats) );
+        std::vector<GLint> formats(numFormats);
+        if (numFormats > 0) {
+            GL( glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data()) );
+        }
+        bool etc2 = std::find(formats.begin(), formats.end(), GL_COMPRESSED_RGBA8_ETC2_EAC) != formats.end();
+        bool astc = std::find(formats.begin(), formats.end(), GL_COMPRESSED_RGBA_ASTC_4x4_KHR) != formats.end();
+
+        // Not every driver lists the formats of its compression extensions above
+        GLint numExtensions = 0;
+        GL( glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions) );
+        for (int i = 0; i < numExtensions; i++) {
+            const char *extension = (const char *) glGetStringi(GL_EXTENSIONS, i);
+            if (!extension) {
+                continue;
+            }
+            std::string name(extension);
+            if (VROStringUtil::endsWith(name, "compressed_texture_etc")) {
+                etc2 = true;
+            }
+            else if (VROStringUtil::endsWith(name, "texture_compression_astc_ldr") ||
+                     VROStringUtil::endsWith(name, "compressed_texture_astc")) {
+                astc = true;
+            }
+        }
+        pinfo("   Compressed texture support: ETC2 [%d], ASTC [%d]", etc2, astc);
+
+        VROTextureTranscoder::setFormatSupported(VROTextureFormat::ETC2_RGBA8_EAC, etc2);
+        VROTextureTranscoder::setFormatSupported(VROTextureFormat::ASTC_4x4_LDR, astc);
+    }
+
     void setHasSoftwareGammaPass(bool gammaPass) {
         _softwareGammaPass = gammaPass;
     }
@@ -518,6 +584,17 @@ public:
         return lightingUBO;
     }
     
+    /*
+     Get the UBO used to batch per-instance transforms when rendering nodes that
+     share the same geometry and material. Created on first use.
+     */
+    std::shared_ptr<VROInstanceBatchUBO> getInstanceBatchUBO() {
+        if (!_instanceBatchUBO) {
+            _instanceBatchUBO = std::make_shared<VROInstanceBatchUBO>(shared_from_this());
+        }
+        return _instanceBatchUBO;
+    }
+    
     std::unique_ptr<VROShaderFactory> &getShaderFactory() {
         return _shaderFactory;
     }
@@ -549,6 +626,10 @@ public:
     std::shared_ptr<VROFrameScheduler> getFrameScheduler() {
         return _scheduler;
     }
+    
+    std::shared_ptr<VROAssetCache> getAssetCache() {
+        return _assetCache;
+    }
 
     /*
      Queue various GL objects for deletion in a thread-safe manner. This ensures that we only
@@ -612,6 +693,11 @@ private:
      */
     std::map<int, std::weak_ptr<VROLightingUBO>> _lightingUBOs;
     
+    /*
+     UBO shared by all instanced batches; see getInstanceBatchUBO().
+     */
+    std::shared_ptr<VROInstanceBatchUBO> _instanceBatchUBO;
+    
     /*
      Creates and caches shaders.
      */
@@ -665,6 +751,17 @@ private:
      Responsible for scheduling async tasks on the rendering thread.
      */
     std::shared_ptr<VROFrameScheduler> _scheduler;
+    
+    /*
+     Assets loaded for this driver. They reference this driver's GL objects,
+     so they are never shared with other drivers.
+     */
+    std::shared_ptr<VROAssetCache> _assetCache;
+    
+    /*
+     Uploads textures to the GPU over multiple frames.
+     */
+    std::unique_ptr<VROUploadQueueOpenGL> _uploadQueue;
 
     /*
      ID of the backbuffer.
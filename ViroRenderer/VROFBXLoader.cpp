@@ -31,6 +31,7 @@
 #include "VROData.h"
 #include "VROStringUtil.h"
 #include "VROModelIOUtil.h"
+#include "VROTextureDecodePool.h"
 #include "VROSkinner.h"
 #include "VROSkeleton.h"
 #include "VROBone.h"
@@ -38,9 +39,13 @@
 #include "VROBoneUBO.h"
 #include "VROKeyframeAnimation.h"
 #include "VROTaskQueue.h"
+#include "VROMappedFile.h"
+#include "VROGeometryPack.h"
+#include "VROAssetCache.h"
 #include "Nodes.pb.h"
 #include <google/protobuf/io/gzip_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <sys/stat.h>
 
 #include "VRODefines.h"
 #if VRO_PLATFORM_IOS || VRO_PLATFORM_MACOS
@@ -231,15 +236,48 @@ void VROFBXLoader::readFBXProtobufAsync(std::string resource, VROResourceType ty
     VROPlatformDispatchAsyncBackground([resource, type, node, path, resourceMap, driver, onFinish, isTemp, loadingTexturesFromResourceMap] {
         pinfo("Loading FBX from file %s", path.c_str());
 
-        std::string data_pb_gzip = VROPlatformLoadFileAsString(path);
-        if (!data_pb_gzip.empty()) {
-            google::protobuf::io::ArrayInputStream input(data_pb_gzip.data(), (int) data_pb_gzip.size());
+        /*
+         The file is mapped rather than read into memory. Legacy files are a gzipped
+         protobuf; geometry packs contain the (optionally gzipped) protobuf with
+         geometry data stripped, followed by the geometry data itself, which is then
+         referenced in place.
+         */
+        std::shared_ptr<VROMappedFile> file = VROMappedFile::map(path);
+        std::shared_ptr<VROGeometryPack> pack = VROGeometryPack::open(file);
+        
+        /*
+         Legacy files are converted into a geometry pack in the cache directory the
+         first time they are loaded. Later loads of the same file open that pack, so
+         their geometry data is mapped rather than inflated and copied.
+         */
+        std::string cachedPackPath;
+        if (file && !pack && !VROGeometryPack::isGeometryPack(file)) {
+            std::string cacheDirectory;
+#if VRO_PLATFORM_ANDROID
+            cacheDirectory = VROPlatformGetCacheDirectory();
+#endif
+            if (!cacheDirectory.empty()) {
+                cachedPackPath = cacheDirectory + "/" + getFBXGeometryPackCacheFileName(file);
+                pack = openCachedFBXGeometryPack(cachedPackPath);
+            }
+        }
+        
+        if (file && (pack || !VROGeometryPack::isGeometryPack(file))) {
+            const uint8_t *payload = pack ? pack->getMetadata() : file->getData();
+            size_t payloadLength = pack ? pack->getMetadataLength() : file->getLength();
+            bool gzipped = pack ? pack->isMetadataCompressed() : true;
+            
+            google::protobuf::io::ArrayInputStream input(payload, (int) payloadLength);
             google::protobuf::io::GzipInputStream gzipIn(&input);
+            google::protobuf::io::ZeroCopyInputStream *stream = gzipped ? (google::protobuf::io::ZeroCopyInputStream *) &gzipIn : &input;
             
             std::shared_ptr<viro::Node> node_pb = std::make_shared<viro::Node>();
-            if (node_pb->ParseFromZeroCopyStream(&gzipIn)) {
+            if (node_pb->ParseFromZeroCopyStream(stream)) {
                 if (kDebugFBXLoading) {
-                    pinfo("Read FBX protobuf");
+                    pinfo("Read FBX protobuf%s", pack ? " from geometry pack" : "");
+                }
+                if (!pack && !cachedPackPath.empty()) {
+                    pack = cacheFBXGeometryPack(node_pb.get(), cachedPackPath);
                 }
 
                 /*
@@ -251,9 +289,13 @@ void VROFBXLoader::readFBXProtobufAsync(std::string resource, VROResourceType ty
                 if (loadingTexturesFromResourceMap) {
                     fileMap = VROModelIOUtil::createResourceMap(resourceMap, type);
                 }
+                
+                // Key the geometry data for the asset cache here, off the rendering thread
+                std::shared_ptr<std::vector<uint64_t>> blobKeys = std::make_shared<std::vector<uint64_t>>();
+                computeFBXGeometryDataKeys(*node_pb, pack.get(), blobKeys.get());
 
                 VROPlatformDispatchAsyncRenderer(
-                        [node, node_pb, resource, type, loadingTexturesFromResourceMap, fileMap, driver, onFinish] {
+                        [node, node_pb, pack, blobKeys, resource, type, loadingTexturesFromResourceMap, fileMap, driver, onFinish] {
                             std::string base = resource.substr(0, resource.find_last_of('/'));
 
                             // Load the FBX from the protobuf on the rendering thread, accumulating additional
@@ -267,13 +309,13 @@ void VROFBXLoader::readFBXProtobufAsync(std::string resource, VROResourceType ty
 
 
                             std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache = std::make_shared<std::map<std::string, std::shared_ptr<VROTexture>>>();
-                            std::shared_ptr<VRONode> fbxNode = loadFBX(*node_pb, node, base,
+                            std::shared_ptr<VRONode> fbxNode = loadFBX(node_pb, node, base,
                                                                        loadingTexturesFromResourceMap
                                                                        ? VROResourceType::LocalFile
                                                                        : type,
                                                                        loadingTexturesFromResourceMap
                                                                        ? fileMap : nullptr,
-                                                                       textureCache, taskQueue, driver);
+                                                                       textureCache, taskQueue, pack, *blobKeys, driver);
 
                             // Run all the async tasks. When they're complete, inject the finished FBX into the
                             // node
@@ -307,12 +349,15 @@ void VROFBXLoader::readFBXProtobufAsync(std::string resource, VROResourceType ty
     });
 }
 
-std::shared_ptr<VRONode> VROFBXLoader::loadFBX(viro::Node &node_pb, std::shared_ptr<VRONode> finalRootNode,
+std::shared_ptr<VRONode> VROFBXLoader::loadFBX(std::shared_ptr<viro::Node> root_pb, std::shared_ptr<VRONode> finalRootNode,
                                                std::string base, VROResourceType type,
                                                std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                                std::shared_ptr<VROTaskQueue> taskQueue,
+                                               std::shared_ptr<VROGeometryPack> pack,
+                                               const std::vector<uint64_t> &blobKeys,
                                                std::shared_ptr<VRODriver> driver) {
+    const viro::Node &node_pb = *root_pb;
     
     // The root node contains the skeleton, if any
     std::shared_ptr<VROSkeleton> skeleton;
@@ -325,9 +370,11 @@ std::shared_ptr<VRONode> VROFBXLoader::loadFBX(viro::Node &node_pb, std::shared_
     // FBX mesh. We use our outer VRONode for the same purpose, to
     // contain the root nodes of the FBX file
     std::shared_ptr<VRONode> tempRootNode = std::make_shared<VRONode>();
+    int blobIndex = 0;
     for (int i = 0; i < node_pb.subnode_size(); i++) {
         std::shared_ptr<VRONode> node = loadFBXNode(node_pb.subnode(i), skeleton, base, type,
-                                                    resourceMap, textureCache, taskQueue, driver);
+                                                    resourceMap, textureCache, taskQueue,
+                                                    root_pb, pack.get(), blobKeys, &blobIndex, driver);
         tempRootNode->addChildNode(node);
     }
     trimEmptyNodes(tempRootNode);
@@ -341,6 +388,9 @@ std::shared_ptr<VRONode> VROFBXLoader::loadFBXNode(const viro::Node &node_pb,
                                                    std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                    std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                                    std::shared_ptr<VROTaskQueue> taskQueue,
+                                                   const std::shared_ptr<viro::Node> &root_pb,
+                                                   const VROGeometryPack *pack,
+                                                   const std::vector<uint64_t> &blobKeys, int *blobIndex,
                                                    std::shared_ptr<VRODriver> driver) {
     
     if (kDebugFBXLoading) {
@@ -359,7 +409,8 @@ std::shared_ptr<VRONode> VROFBXLoader::loadFBXNode(const viro::Node &node_pb,
     
     if (node_pb.has_geometry()) {
         const viro::Node_Geometry &geo_pb = node_pb.geometry();
-        std::shared_ptr<VROGeometry> geo = loadFBXGeometry(geo_pb, base, type, resourceMap, textureCache, taskQueue, driver);
+        std::shared_ptr<VROGeometry> geo = loadFBXGeometry(geo_pb, base, type, resourceMap, textureCache, taskQueue,
+                                                           root_pb, pack, blobKeys, blobIndex, driver);
         geo->setName(node_pb.name());
         
         if (geo_pb.has_skin() && skeleton) {
@@ -427,7 +478,8 @@ std::shared_ptr<VRONode> VROFBXLoader::loadFBXNode(const viro::Node &node_pb,
     
     for (int i = 0; i < node_pb.subnode_size(); i++) {
         std::shared_ptr<VRONode> subnode = loadFBXNode(node_pb.subnode(i), skeleton, base, type,
-                                                       resourceMap, textureCache, taskQueue, driver);
+                                                       resourceMap, textureCache, taskQueue,
+                                                       root_pb, pack, blobKeys, blobIndex, driver);
         node->addChildNode(subnode);
     }
     
@@ -439,9 +491,21 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
                                                            std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                            std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                                            std::shared_ptr<VROTaskQueue> taskQueue,
+                                                           const std::shared_ptr<viro::Node> &root_pb,
+                                                           const VROGeometryPack *pack,
+                                                           const std::vector<uint64_t> &blobKeys, int *blobIndex,
                                                            std::shared_ptr<VRODriver> driver) {
-    std::shared_ptr<VROData> varData = std::make_shared<VROData>(geo_pb.data().c_str(), geo_pb.data().length());
-    std::shared_ptr<VROVertexBuffer> vertexBuffer = driver->newVertexBuffer(varData);
+    passert (*blobIndex < (int) blobKeys.size());
+    uint64_t vertexKey = blobKeys[*blobIndex];
+    std::shared_ptr<VROData> varData = loadFBXGeometryData(geo_pb.data(), root_pb, pack, blobIndex);
+    
+    // Share the vertex buffer with any earlier load of the same geometry
+    std::shared_ptr<VROAssetCache> cache = driver->getAssetCache();
+    std::shared_ptr<VROVertexBuffer> vertexBuffer = cache->getVertexBuffer(vertexKey);
+    if (!vertexBuffer) {
+        vertexBuffer = driver->newVertexBuffer(varData);
+        cache->putVertexBuffer(vertexKey, vertexBuffer, varData->getDataLength());
+    }
     
     std::vector<std::shared_ptr<VROGeometrySource>> sources;
     for (int i = 0; i < geo_pb.source_size(); i++) {
@@ -461,11 +525,15 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
     for (int i = 0; i < geo_pb.element_size(); i++) {
         const viro::Node::Geometry::Element &element_pb = geo_pb.element(i);
         
-        std::shared_ptr<VROData> data = std::make_shared<VROData>(element_pb.data().c_str(), element_pb.data().length());
+        passert (*blobIndex < (int) blobKeys.size());
+        uint64_t elementKey = blobKeys[*blobIndex];
+        
+        std::shared_ptr<VROData> data = loadFBXGeometryData(element_pb.data(), root_pb, pack, blobIndex);
         std::shared_ptr<VROGeometryElement> element = std::make_shared<VROGeometryElement>(data,
                                                                                            convert(element_pb.primitive()),
                                                                                            element_pb.primitive_count(),
                                                                                            element_pb.bytes_per_index());
+        element->setContentKey(elementKey);
         elements.push_back(element);
     }
     
@@ -500,8 +568,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
             
             if (!diffuse_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &diffuse_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(diffuse_pb.texture(), base, type, true, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &diffuse_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(diffuse_pb.texture(), base, type, true, VROTextureDecodePriority::High, resourceMap, textureCache, driver,
                        [material_w, &diffuse_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {
                            std::shared_ptr<VROMaterial> material_s = material_w.lock();
                            if (material_s) {
@@ -528,8 +596,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
             if (!specular_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &specular_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(specular_pb.texture(), base, type, false, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &specular_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(specular_pb.texture(), base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                         [material_w, &specular_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {
                             std::shared_ptr<VROMaterial> material_s = material_w.lock();
                             if (material_s) {
@@ -556,8 +624,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
             if (!normal_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &normal_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(normal_pb.texture(), base, type, false, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &normal_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(normal_pb.texture(), base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                          [material_w, &normal_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {
                              std::shared_ptr<VROMaterial> material_s = material_w.lock();
                              if (material_s) {
@@ -584,8 +652,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
             if (!roughness_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &roughness_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(roughness_pb.texture(), base, type, false, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &roughness_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(roughness_pb.texture(), base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                         [material_w, &roughness_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {
                             std::shared_ptr<VROMaterial> material_s = material_w.lock();
                             if (material_s) {
@@ -616,8 +684,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
             
             if (!metalness_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &metalness_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(metalness_pb.texture(), base, type, false, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &metalness_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(metalness_pb.texture(), base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                          [material_w, &metalness_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {
                              std::shared_ptr<VROMaterial> material_s = material_w.lock();
                              if (material_s) {
@@ -647,8 +715,8 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
             
             if (!ao_pb.texture().empty()) {
-                taskQueue->addTask([material_w, &ao_pb, lightingModel, base, type, resourceMap, textureCache, taskQueue_w] {
-                    VROModelIOUtil::loadTextureAsync(ao_pb.texture(), base, type, true, resourceMap, textureCache,
+                taskQueue->addTask([material_w, &ao_pb, lightingModel, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                    VROModelIOUtil::loadTextureAsync(ao_pb.texture(), base, type, true, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                          [material_w, &ao_pb, lightingModel, taskQueue_w](std::shared_ptr<VROTexture> texture) {;
                              std::shared_ptr<VROMaterial> material_s = material_w.lock();
                              if (material_s) {
@@ -680,6 +748,171 @@ std::shared_ptr<VROGeometry> VROFBXLoader::loadFBXGeometry(const viro::Node_Geom
     return geo;
 }
 
+std::shared_ptr<VROData> VROFBXLoader::loadFBXGeometryData(const std::string &data_pb,
+                                                            const std::shared_ptr<viro::Node> &root_pb,
+                                                            const VROGeometryPack *pack, int *blobIndex) {
+    int index = (*blobIndex)++;
+    if (!pack) {
+        // The field is referenced in place; the data holds the protobuf that owns it
+        return std::make_shared<VROData>((void *) data_pb.data(), data_pb.length(), std::shared_ptr<void>(root_pb));
+    }
+    
+    std::shared_ptr<VROData> data = pack->getBlob(index);
+    if (!data) {
+        pwarn("FBX geometry pack is missing geometry data; geometry will be empty");
+        return std::make_shared<VROData>(data_pb.c_str(), 0);
+    }
+    return data;
+}
+
+void VROFBXLoader::computeFBXGeometryDataKeys(const viro::Node &node_pb, const VROGeometryPack *pack,
+                                              std::vector<uint64_t> *keys) {
+    if (pack) {
+        for (int i = 0; i < pack->getNumBlobs(); i++) {
+            keys->push_back(pack->getBlobKey(i));
+        }
+        return;
+    }
+    
+    // The outer node's own geometry (if any) is never loaded; see loadFBX()
+    for (int i = 0; i < node_pb.subnode_size(); i++) {
+        hashFBXGeometryData(node_pb.subnode(i), keys);
+    }
+}
+
+void VROFBXLoader::hashFBXGeometryData(const viro::Node &node_pb, std::vector<uint64_t> *keys) {
+    if (node_pb.has_geometry()) {
+        const viro::Node_Geometry &geo_pb = node_pb.geometry();
+        keys->push_back(VROAssetCache::hash(geo_pb.data().data(), geo_pb.data().length()));
+        
+        for (int i = 0; i < geo_pb.element_size(); i++) {
+            const std::string &data_pb = geo_pb.element(i).data();
+            keys->push_back(VROAssetCache::hash(data_pb.data(), data_pb.length()));
+        }
+    }
+    for (int i = 0; i < node_pb.subnode_size(); i++) {
+        hashFBXGeometryData(node_pb.subnode(i), keys);
+    }
+}
+
+void VROFBXLoader::stripFBXGeometryData(viro::Node *node_pb, std::vector<std::string> *blobs) {
+    if (node_pb->has_geometry()) {
+        viro::Node_Geometry *geo_pb = node_pb->mutable_geometry();
+        blobs->push_back(std::move(*geo_pb->mutable_data()));
+        geo_pb->clear_data();
+        
+        for (int i = 0; i < geo_pb->element_size(); i++) {
+            viro::Node_Geometry_Element *element_pb = geo_pb->mutable_element(i);
+            blobs->push_back(std::move(*element_pb->mutable_data()));
+            element_pb->clear_data();
+        }
+    }
+    for (int i = 0; i < node_pb->subnode_size(); i++) {
+        stripFBXGeometryData(node_pb->mutable_subnode(i), blobs);
+    }
+}
+
+bool VROFBXLoader::writeFBXGeometryPack(viro::Node node_pb, std::string path, bool compress) {
+    // The outer node's own geometry (if any) is never loaded; see loadFBX()
+    std::vector<std::string> blobs;
+    for (int i = 0; i < node_pb.subnode_size(); i++) {
+        stripFBXGeometryData(node_pb.mutable_subnode(i), &blobs);
+    }
+    
+    std::string metadata;
+    if (!node_pb.SerializeToString(&metadata)) {
+        pwarn("Failed to serialize FBX protobuf for geometry pack");
+        return false;
+    }
+    if (!VROGeometryPack::write(path, metadata, compress, blobs, compress)) {
+        return false;
+    }
+    if (!verifyFBXGeometryPack(path, metadata, blobs)) {
+        pwarn("Geometry pack %s failed verification, removing", path.c_str());
+        remove(path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string VROFBXLoader::getFBXGeometryPackCacheFileName(const std::shared_ptr<VROMappedFile> &file) {
+    uint64_t hash = VROAssetCache::hash(file->getData(), file->getLength());
+    return "fbx_" + VROStringUtil::toString64(hash) + ".vgpk";
+}
+
+std::shared_ptr<VROGeometryPack> VROFBXLoader::openCachedFBXGeometryPack(std::string path) {
+    // Check for the file first, since mapping a missing file warns
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return nullptr;
+    }
+    std::shared_ptr<VROGeometryPack> pack = VROGeometryPack::open(VROMappedFile::map(path));
+    if (pack && kDebugFBXLoading) {
+        pinfo("Opened cached FBX geometry pack [%s]", path.c_str());
+    }
+    return pack;
+}
+
+std::shared_ptr<VROGeometryPack> VROFBXLoader::cacheFBXGeometryPack(viro::Node *node_pb, std::string path) {
+    // Write to a temporary file and move it into place, so that concurrent loads
+    // never open a partially written pack
+    std::string tempPath = path + ".tmp";
+    if (!writeFBXGeometryPack(*node_pb, tempPath, false)) {
+        pwarn("Failed to write FBX geometry pack to cache [%s]", path.c_str());
+        return nullptr;
+    }
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        pwarn("Failed to move FBX geometry pack into cache [%s]", path.c_str());
+        remove(tempPath.c_str());
+        return nullptr;
+    }
+    
+    std::shared_ptr<VROGeometryPack> pack = VROGeometryPack::open(VROMappedFile::map(path));
+    if (!pack) {
+        return nullptr;
+    }
+    
+    // The geometry data is now read from the pack, so release it from the protobuf
+    std::vector<std::string> blobs;
+    for (int i = 0; i < node_pb->subnode_size(); i++) {
+        stripFBXGeometryData(node_pb->mutable_subnode(i), &blobs);
+    }
+    pinfo("Cached FBX geometry pack [%s]", path.c_str());
+    return pack;
+}
+
+bool VROFBXLoader::verifyFBXGeometryPack(std::string path, const std::string &metadata,
+                                         const std::vector<std::string> &blobs) {
+    std::shared_ptr<VROGeometryPack> pack = VROGeometryPack::open(VROMappedFile::map(path));
+    if (!pack || pack->getNumBlobs() != (int) blobs.size()) {
+        return false;
+    }
+    
+    // Read the metadata through the same streams loadFBX() parses it from
+    google::protobuf::io::ArrayInputStream input(pack->getMetadata(), (int) pack->getMetadataLength());
+    google::protobuf::io::GzipInputStream gzipIn(&input);
+    google::protobuf::io::ZeroCopyInputStream *stream = pack->isMetadataCompressed() ? (google::protobuf::io::ZeroCopyInputStream *) &gzipIn : &input;
+    
+    std::string metadataIn;
+    const void *chunk;
+    int chunkLength;
+    while (stream->Next(&chunk, &chunkLength)) {
+        metadataIn.append((const char *) chunk, chunkLength);
+    }
+    if (metadataIn != metadata) {
+        return false;
+    }
+    
+    for (int i = 0; i < (int) blobs.size(); i++) {
+        std::shared_ptr<VROData> blob = pack->getBlob(i);
+        if (!blob || blob->getDataLength() != blobs[i].size() ||
+            memcmp(blob->getData(), blobs[i].data(), blobs[i].size()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 std::shared_ptr<VROSkeleton> VROFBXLoader::loadFBXSkeleton(const viro::Node_Skeleton &skeleton_pb) {
     std::vector<std::shared_ptr<VROBone>> bones;
     for (int i = 0; i < skeleton_pb.bone_size(); i++) {
@@ -45,6 +45,9 @@ class VROSkeleton;
 class VROTaskQueue;
 class VROSkeletalAnimation;
 class VROKeyframeAnimation;
+class VROGeometryPack;
+class VROMappedFile;
+class VROData;
 
 namespace viro {
     class Node;
@@ -77,6 +80,17 @@ public:
                                      std::map<std::string, std::string> resourceMap,
                                      std::shared_ptr<VRODriver> driver,
                                      std::function<void(std::shared_ptr<VRONode> node, bool success)> onFinish = nullptr);
+    
+    /*
+     Convert the given FBX protobuf into a geometry pack (see VROGeometryPack) at
+     the given path. The vertex and index data of every geometry is moved out of
+     the protobuf into separately aligned (and optionally compressed) blobs, so
+     that loading the pack maps geometry data directly instead of copying it.
+     Packs are loaded through the same loadFBXFromResource() entry points. The
+     written pack is read back and verified; returns false (and removes the file)
+     if it does not round-trip.
+     */
+    static bool writeFBXGeometryPack(viro::Node node_pb, std::string path, bool compress);
 
 private:
     
@@ -95,10 +109,12 @@ private:
      Load the FBX subgraph for the given file. The top-level node returned here is a dummy; all the
      data is stored in its children.
      */
-    static std::shared_ptr<VRONode> loadFBX(viro::Node &node_pb, std::shared_ptr<VRONode> node, std::string base, VROResourceType type,
+    static std::shared_ptr<VRONode> loadFBX(std::shared_ptr<viro::Node> root_pb, std::shared_ptr<VRONode> node, std::string base, VROResourceType type,
                                             std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                             std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                             std::shared_ptr<VROTaskQueue> taskQueue,
+                                            std::shared_ptr<VROGeometryPack> pack,
+                                            const std::vector<uint64_t> &blobKeys,
                                             std::shared_ptr<VRODriver> driver);
     
     static std::shared_ptr<VRONode> loadFBXNode(const viro::Node &node_pb,
@@ -107,6 +123,9 @@ private:
                                                 std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                 std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                                 std::shared_ptr<VROTaskQueue> taskQueue,
+                                                const std::shared_ptr<viro::Node> &root_pb,
+                                                const VROGeometryPack *pack,
+                                                const std::vector<uint64_t> &blobKeys, int *blobIndex,
                                                 std::shared_ptr<VRODriver> driver);
     
     static std::shared_ptr<VROGeometry> loadFBXGeometry(const viro::Node_Geometry &geo_pb,
@@ -114,8 +133,57 @@ private:
                                                         std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                         std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
                                                         std::shared_ptr<VROTaskQueue> taskQueue,
+                                                        const std::shared_ptr<viro::Node> &root_pb,
+                                                        const VROGeometryPack *pack,
+                                                        const std::vector<uint64_t> &blobKeys, int *blobIndex,
                                                         std::shared_ptr<VRODriver> driver);
     
+    /*
+     Get the data for a geometry source or element, and advance the blob index.
+     When loading from a geometry pack, the data is the blob at that index (the
+     protobuf field is empty); otherwise it references the protobuf field in place,
+     and keeps the given root protobuf alive for as long as the data is held.
+     */
+    static std::shared_ptr<VROData> loadFBXGeometryData(const std::string &data_pb,
+                                                        const std::shared_ptr<viro::Node> &root_pb,
+                                                        const VROGeometryPack *pack, int *blobIndex);
+    
+    /*
+     Compute the VROAssetCache key of each geometry data field, in the order
+     loadFBXNode() consumes them. Blobs in a geometry pack are keyed by the
+     pack file and their location within it, so they are not read. Data
+     embedded in the protobuf is hashed. Invoked on the loading thread, so
+     that geometry data is never scanned on the rendering thread.
+     */
+    static void computeFBXGeometryDataKeys(const viro::Node &node_pb, const VROGeometryPack *pack,
+                                           std::vector<uint64_t> *keys);
+    static void hashFBXGeometryData(const viro::Node &node_pb, std::vector<uint64_t> *keys);
+    
+    /*
+     Move the geometry data out of the given node and its descendants into the
+     given blob list, in the order loadFBXNode() consumes them.
+     */
+    static void stripFBXGeometryData(viro::Node *node_pb, std::vector<std::string> *blobs);
+    
+    /*
+     Legacy files are converted into a geometry pack in the cache directory on
+     their first load. Cached packs are named by a hash of the legacy file's
+     contents, so a changed file is converted again. openCachedFBXGeometryPack()
+     returns nullptr if the pack has not been written. cacheFBXGeometryPack()
+     writes the pack for the given protobuf and, if the pack opens, strips the
+     protobuf's geometry data so it can be loaded alongside the returned pack.
+     */
+    static std::string getFBXGeometryPackCacheFileName(const std::shared_ptr<VROMappedFile> &file);
+    static std::shared_ptr<VROGeometryPack> openCachedFBXGeometryPack(std::string path);
+    static std::shared_ptr<VROGeometryPack> cacheFBXGeometryPack(viro::Node *node_pb, std::string path);
+    
+    /*
+     Map the geometry pack at the given path and confirm that it reads back the
+     given metadata payload and blobs exactly, as loadFBX() would read them.
+     */
+    static bool verifyFBXGeometryPack(std::string path, const std::string &metadata,
+                                      const std::vector<std::string> &blobs);
+    
     static std::shared_ptr<VROSkeleton> loadFBXSkeleton(const viro::Node_Skeleton &skeleton_pb);
     static std::shared_ptr<VROSkinner> loadFBXSkinner(const viro::Node_Geometry_Skin &skin_pb,
                                                       std::shared_ptr<VROSkeleton> skeleton,
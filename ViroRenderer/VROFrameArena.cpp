@@ -0,0 +1,90 @@
+//
+//  VROFrameArena.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/22/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROFrameArena.h"
+#include "VROAllocationTracker.h"
+#include "VROLog.h"
+#include <algorithm>
+
+VROFrameArena::VROFrameArena(size_t initialCapacity) :
+    _block(nullptr),
+    _blockCapacity(0),
+    _cursor(0),
+    _end(0),
+    _bytesInRetiredBlocks(0),
+    _numHeapAllocations(0) {
+    setBlock(initialCapacity);
+}
+
+VROFrameArena::~VROFrameArena() {
+    for (char *block : _retiredBlocks) {
+        free(block);
+    }
+    free(_block);
+}
+
+void VROFrameArena::setBlock(size_t capacity) {
+    _block = (char *) malloc(capacity);
+    passert (_block != nullptr);
+    _blockCapacity = capacity;
+    _cursor = (uintptr_t) _block;
+    _end = _cursor + capacity;
+    ALLOCATION_TRACKER_ADD(FrameArenaAllocations, 1);
+}
+
+void VROFrameArena::reset() {
+    /*
+     If the last frame overflowed into additional blocks, replace them all with
+     a single block that can hold everything the frame allocated.
+     */
+    if (!_retiredBlocks.empty()) {
+        size_t capacity = _blockCapacity;
+        for (char *block : _retiredBlocks) {
+            free(block);
+        }
+        _retiredBlocks.clear();
+        free(_block);
+        
+        setBlock(capacity + _bytesInRetiredBlocks);
+    }
+    
+    _cursor = (uintptr_t) _block;
+    _bytesInRetiredBlocks = 0;
+    _numHeapAllocations = 0;
+}
+
+void *VROFrameArena::allocateSlow(size_t bytes, size_t alignment) {
+    _retiredBlocks.push_back(_block);
+    _bytesInRetiredBlocks += _blockCapacity;
+    
+    setBlock(std::max(_blockCapacity * 2, bytes + alignment));
+    ++_numHeapAllocations;
+    
+    void *p = allocate(bytes, alignment);
+    passert (p != nullptr);
+    return p;
+}
@@ -0,0 +1,184 @@
+//
+//  VROFrameArena.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/22/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROFrameArena_h
+#define VROFrameArena_h
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include <new>
+#include <type_traits>
+
+/*
+ Linear (bump) allocator for transient data that lives for a single frame.
+ Allocation is a pointer increment, and all allocations are released at once
+ when the arena is reset at the start of the next frame.
+ 
+ Memory is retained across frames: if a frame overflows the arena's current
+ block, additional blocks are allocated, and on the next reset they are
+ coalesced into a single block large enough for the whole frame. After the
+ first few frames the arena therefore stops touching the heap; the number of
+ heap allocations it makes is counted so this can be verified.
+ 
+ Destructors of objects in the arena are not run on reset. Use create() only
+ for trivially destructible types, or use VROFrameAllocator with containers
+ that destroy their own elements.
+ 
+ Arenas are not thread-safe; they should be used only by the rendering thread.
+ */
+class VROFrameArena {
+    
+public:
+    
+    VROFrameArena(size_t initialCapacity = 64 * 1024);
+    virtual ~VROFrameArena();
+    
+    /*
+     Release all allocations made since the last reset.
+     */
+    void reset();
+    
+    /*
+     Allocate the given number of bytes with the given alignment, which must be
+     a power of two.
+     */
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        uintptr_t aligned = (_cursor + (alignment - 1)) & ~(uintptr_t) (alignment - 1);
+        if (aligned + bytes > _end) {
+            return allocateSlow(bytes, alignment);
+        }
+        _cursor = aligned + bytes;
+        return (void *) aligned;
+    }
+    
+    /*
+     Construct an object in the arena.
+     */
+    template <typename T, typename... Args>
+    T *create(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+    
+    /*
+     Number of bytes allocated since the last reset, including any unused space
+     at the end of blocks that overflowed.
+     */
+    size_t getBytesAllocated() const {
+        return _bytesInRetiredBlocks + (_cursor - (uintptr_t) _block);
+    }
+    
+    /*
+     Number of heap allocations the arena made since the last reset. This is zero
+     for any frame that allocates no more than the largest frame before it, since
+     reset() coalesces overflow blocks.
+     */
+    int getNumHeapAllocations() const {
+        return _numHeapAllocations;
+    }
+    
+private:
+    
+    /*
+     The current block, and the cursor and end of its free space.
+     */
+    char *_block;
+    size_t _blockCapacity;
+    uintptr_t _cursor;
+    uintptr_t _end;
+    
+    /*
+     Blocks that overflowed during this frame. They are freed on reset.
+     */
+    std::vector<char *> _retiredBlocks;
+    size_t _bytesInRetiredBlocks;
+    
+    int _numHeapAllocations;
+    
+    void *allocateSlow(size_t bytes, size_t alignment);
+    void setBlock(size_t capacity);
+    
+};
+
+/*
+ STL allocator that allocates from a VROFrameArena, for containers that only
+ live within a frame. Deallocation is a no-op. If the arena is null, the
+ allocator falls back to the heap.
+ */
+template <typename T>
+class VROFrameAllocator {
+    
+public:
+    
+    typedef T value_type;
+    
+    /*
+     Containers adopt the allocator of the container they are moved or swapped
+     from, so a member container can be re-seated onto this frame's arena by
+     assigning it a new, empty container.
+     */
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    
+    VROFrameAllocator(VROFrameArena *arena = nullptr) : _arena(arena) {}
+    template <typename U>
+    VROFrameAllocator(const VROFrameAllocator<U> &other) : _arena(other.getArena()) {}
+    
+    T *allocate(size_t n) {
+        if (_arena) {
+            return (T *) _arena->allocate(n * sizeof(T), alignof(T));
+        }
+        return (T *) ::operator new(n * sizeof(T));
+    }
+    void deallocate(T *p, size_t n) {
+        if (!_arena) {
+            ::operator delete(p);
+        }
+    }
+    
+    VROFrameArena *getArena() const {
+        return _arena;
+    }
+    
+    template <typename U>
+    bool operator==(const VROFrameAllocator<U> &other) const {
+        return _arena == other.getArena();
+    }
+    template <typename U>
+    bool operator!=(const VROFrameAllocator<U> &other) const {
+        return _arena != other.getArena();
+    }
+    
+private:
+    
+    VROFrameArena *_arena;
+    
+};
+
+#endif /* VROFrameArena_h */
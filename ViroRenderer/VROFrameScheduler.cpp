@@ -25,14 +25,30 @@
 //  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "VROFrameScheduler.h"
+#include "VROTime.h"
 #include "VROLog.h"
+#include <algorithm>
 
-// Block and process all tasks when we reach this number
-// of starvation frames
-static const int kStarvationPurgeFrameCount = 60;
+// After this many consecutive starved frames, begin granting a
+// catch-up budget each frame
+static const int kStarvationFrameCount = 10;
+
+// The catch-up budget grows by this many ms for each additional
+// starved frame, up to the maximum
+static const double kCatchUpStepMs = 1.0;
+static const double kMaxCatchUpMs = 8.0;
+
+// Weight given to the most recent duration when updating a task type's
+// cost estimate
+static const double kCostSmoothing = 0.25;
 
 VROFrameScheduler::VROFrameScheduler() :
-    _starvationFrameCount(0) {
+    _starvationFrameCount(0),
+    _nextSequence(0),
+    _lastFrameTimeSpent(0),
+    _lastFrameTimeDeferred(0),
+    _lastFrameTasksProcessed(0),
+    _lastFrameTasksDeferred(0) {
     
 }
 
@@ -40,71 +56,168 @@ VROFrameScheduler::~VROFrameScheduler() {
     
 }
 
-bool VROFrameScheduler::isTaskQueued(std::string key) {
+bool VROFrameScheduler::isTaskQueued(uint64_t key, VROFrameTaskPriority priority) {
     std::lock_guard<std::recursive_mutex> lock(_taskQueueMutex);
-    return _queuedTasks.find(key) != _queuedTasks.end();
+    auto it = _queuedTasks.find(key);
+    return it != _queuedTasks.end() && it->second.first <= priority;
 }
 
-void VROFrameScheduler::scheduleTask(std::string key, std::function<void()> task) {
+void VROFrameScheduler::scheduleTask(uint64_t key, std::function<void()> task,
+                                     VROFrameTaskPriority priority, double workUnits) {
     std::lock_guard<std::recursive_mutex> lock(_taskQueueMutex);
     
-    if (_queuedTasks.find(key) != _queuedTasks.end()) {
-        // Task is already queued
-        return;
+    auto it = _queuedTasks.find(key);
+    if (it != _queuedTasks.end()) {
+        // Task is already queued; promote it if necessary. The entry in
+        // the old queue becomes stale and is skipped
+        if (priority >= it->second.first) {
+            return;
+        }
     }
     
-    _taskQueue.push({ key, task });
-    _queuedTasks.insert(key);
+    uint64_t sequence = _nextSequence++;
+    _queuedTasks[key] = { priority, sequence };
+    _taskQueues[(int) priority].push_back({ key, sequence, priority, workUnits, task });
+}
+
+bool VROFrameScheduler::isLive(const VROFrameTask &task) const {
+    auto it = _queuedTasks.find(task.key);
+    return it != _queuedTasks.end() && it->second.second == task.sequence;
+}
+
+bool VROFrameScheduler::peekTask(VROFrameTask **task) {
+    for (std::deque<VROFrameTask> &queue : _taskQueues) {
+        while (!queue.empty()) {
+            VROFrameTask &front = queue.front();
+            if (isLive(front)) {
+                *task = &front;
+                return true;
+            }
+            queue.pop_front();
+        }
+    }
+    return false;
+}
+
+double VROFrameScheduler::estimateCost(const VROFrameTask &task) const {
+    auto it = _costPerUnit.find((uint32_t) (task.key >> 32));
+    if (it == _costPerUnit.end()) {
+        // Nothing learned yet: optimistically assume the task is free,
+        // so that it runs and provides a measurement
+        return 0;
+    }
+    return it->second * task.workUnits;
+}
+
+void VROFrameScheduler::recordCost(const VROFrameTask &task, double ms) {
+    double costPerUnit = ms / std::max(task.workUnits, 1.0);
+    
+    uint32_t type = (uint32_t) (task.key >> 32);
+    auto it = _costPerUnit.find(type);
+    if (it == _costPerUnit.end()) {
+        _costPerUnit[type] = costPerUnit;
+    }
+    else {
+        it->second += (costPerUnit - it->second) * kCostSmoothing;
+    }
 }
 
 void VROFrameScheduler::processTasks(const VROFrameTimer &timer) {
-    bool processedAnyTask = false;
+    /*
+     If we've been unable to process tasks for several frames, grant a
+     catch-up budget that grows the longer starvation continues. The
+     first task in a catch-up frame always runs, regardless of its
+     estimated cost, so that no task can be deferred indefinitely.
+     */
+    double catchUpBudget = 0;
+    if (_starvationFrameCount >= kStarvationFrameCount) {
+        catchUpBudget = std::min((_starvationFrameCount - kStarvationFrameCount + 1) * kCatchUpStepMs, kMaxCatchUpMs);
+    }
+    double catchUpSpent = 0;
+    bool processedInBudget = false;
     
-    while (!_taskQueue.empty()) {
-        // The iOS simulator is so slow (due to GPU emulation) we don't bother with waiting
-#if !TARGET_OS_SIMULATOR
-        if (!timer.isTimeRemainingInFrame()) {
-            break;
-        }
-#endif
+    _lastFrameTimeSpent = 0;
+    _lastFrameTasksProcessed = 0;
+    
+    while (true) {
         VROFrameTask task;
+        bool catchUp = false;
+        double estimate = 0;
         
         // Lock the mutex while retrieving the task from the queue
         {
             std::lock_guard<std::recursive_mutex> lock(_taskQueueMutex);
-            if (!_taskQueue.empty()) {
-                task = _taskQueue.front();
-                _taskQueue.pop();
+            
+            VROFrameTask *next;
+            if (!peekTask(&next)) {
+                break;
             }
+            estimate = estimateCost(*next);
+            
+            // The iOS simulator is so slow (due to GPU emulation) we don't bother with waiting
+#if !TARGET_OS_SIMULATOR
+            bool fits = timer.isUnlimited() ||
+                        (timer.isTimeRemainingInFrame() && estimate <= timer.getTimeRemainingInFrame());
+#else
+            bool fits = true;
+#endif
+            if (!fits) {
+                if (catchUpBudget > 0 && (catchUpSpent == 0 || catchUpSpent + estimate <= catchUpBudget)) {
+                    catchUp = true;
+                }
+                else {
+                    break;
+                }
+            }
+            
+            task = std::move(*next);
+            _taskQueues[(int) task.priority].pop_front();
+            _queuedTasks.erase(task.key);
         }
         
         // Process the task outside of the lock
+        double start = VROTimeCurrentMillis();
         if (task.functor) {
             task.functor();
-            processedAnyTask = true;
+        }
+        double duration = VROTimeCurrentMillis() - start;
+        recordCost(task, duration);
+        
+        _lastFrameTimeSpent += duration;
+        _lastFrameTasksProcessed++;
+        if (catchUp) {
+            // Charge at least the estimate, so that a string of tasks that
+            // run faster than the clock resolution still exhausts the budget
+            catchUpSpent += std::max(duration, std::max(estimate, 0.01));
+        }
+        else {
+            processedInBudget = true;
         }
     }
     
-    if (!_taskQueue.empty() && !processedAnyTask) {
+    computeDeferredStats();
+    if (_lastFrameTasksDeferred > 0 && !processedInBudget) {
         _starvationFrameCount++;
+        if (_starvationFrameCount == kStarvationFrameCount) {
+            pinfo("Tasks starved for %d frames: catching up gradually", _starvationFrameCount);
+        }
+    }
+    else {
+        _starvationFrameCount = 0;
     }
+}
+
+void VROFrameScheduler::computeDeferredStats() {
+    std::lock_guard<std::recursive_mutex> lock(_taskQueueMutex);
     
-    /*
-     If we've been unable to process tasks for this number of frames, 
-     block and process them all.
-     */
-    if (_starvationFrameCount >= kStarvationPurgeFrameCount) {
-        pinfo("Tasks starved for %d frames: processing all", _starvationFrameCount);
-        
-        std::lock_guard<std::recursive_mutex> lock(_taskQueueMutex);
-        while (!_taskQueue.empty()) {
-            VROFrameTask task = _taskQueue.front();
-            _taskQueue.pop();
-            
-            if (task.functor) {
-                task.functor();
+    _lastFrameTimeDeferred = 0;
+    _lastFrameTasksDeferred = 0;
+    for (std::deque<VROFrameTask> &queue : _taskQueues) {
+        for (VROFrameTask &task : queue) {
+            if (isLive(task)) {
+                _lastFrameTimeDeferred += estimateCost(task);
+                _lastFrameTasksDeferred++;
             }
         }
-        _starvationFrameCount = 0;
     }
 }
@@ -29,13 +29,42 @@
 
 #include "VROFrameTimer.h"
 #include <functional>
-#include <queue>
+#include <deque>
 #include <mutex>
-#include <string>
-#include <set>
+#include <map>
+#include <unordered_map>
+#include <stdint.h>
+
+/*
+ Priority classes for scheduled tasks. All VisibleNow tasks run before any
+ NearCamera task, and all NearCamera tasks before any Background task.
+ Within a class, tasks run in the order they were scheduled.
+ */
+enum class VROFrameTaskPriority {
+    VisibleNow = 0,  // Needed by content being drawn this frame
+    NearCamera = 1,  // Needed by content that is about to be displayed
+    Background = 2,  // Everything else
+};
+
+/*
+ Task types. A task's key combines its type with an identifier that is
+ unique within that type (see VROFrameTaskKey). The scheduler also learns
+ per-type cost estimates from the durations of past tasks of each type.
+ */
+enum class VROFrameTaskType : uint32_t {
+    Generic = 0,
+    TextureHydration = 1,
+};
+
+static inline uint64_t VROFrameTaskKey(VROFrameTaskType type, uint32_t id) {
+    return ((uint64_t) type << 32) | id;
+}
 
 struct VROFrameTask {
-    std::string key;
+    uint64_t key;
+    uint64_t sequence;
+    VROFrameTaskPriority priority;
+    double workUnits;
     std::function<void()> functor;
 };
 
@@ -45,6 +74,14 @@ struct VROFrameTask {
  queue; they are scheduled to run only when time is available in
  the current frame. Time remaining in a frame is determined by a
  set milliseconds-per-frame (mpf) target.
+
+ Before running a task, the scheduler estimates its cost from the
+ durations of previous tasks of the same type, and defers the task to a
+ later frame if the estimate exceeds the time remaining. If tasks are
+ starved of time for several consecutive frames, the scheduler begins
+ granting a small catch-up budget each frame, which grows (up to a limit)
+ for as long as starvation continues. This guarantees progress without
+ ever draining the entire queue in a single frame.
  */
 class VROFrameScheduler {
     
@@ -54,16 +91,26 @@ public:
     virtual ~VROFrameScheduler();
     
     /*
-     Return true if the given task is already queued.
+     Return true if the given task is already queued at the given
+     priority or higher.
      */
-    bool isTaskQueued(std::string key);
+    bool isTaskQueued(uint64_t key, VROFrameTaskPriority priority = VROFrameTaskPriority::Background);
     
     /*
      Schedule a new task to be completed in the time-limited 
      queue. The key should uniquely identify the task, and is used
-     to de-dupe tasks that are scheduled multiple times.
+     to de-dupe tasks that are scheduled multiple times. If the task
+     is already queued at a lower priority, it is promoted to the
+     given priority.
+     
+     The work units are a relative measure of the task's size (e.g.
+     the number of pixels in a texture upload). The cost estimate for
+     the task is the learned cost per unit for its type, multiplied by
+     its work units.
      */
-    void scheduleTask(std::string key, std::function<void()> task);
+    void scheduleTask(uint64_t key, std::function<void()> task,
+                      VROFrameTaskPriority priority = VROFrameTaskPriority::Background,
+                      double workUnits = 1);
     
     /*
      Process as many tasks as allowed given the remaining frame
@@ -71,29 +118,86 @@ public:
      */
     void processTasks(const VROFrameTimer &timer);
     
+    /*
+     Statistics for the last call to processTasks(): the time spent
+     running tasks, the estimated time of the tasks that were deferred
+     to later frames, and the corresponding task counts.
+     */
+    double getLastFrameTimeSpent() const {
+        return _lastFrameTimeSpent;
+    }
+    double getLastFrameTimeDeferred() const {
+        return _lastFrameTimeDeferred;
+    }
+    int getLastFrameTasksProcessed() const {
+        return _lastFrameTasksProcessed;
+    }
+    int getLastFrameTasksDeferred() const {
+        return _lastFrameTasksDeferred;
+    }
+    
 private:
     
     /*
-     The number of frames that have passed, during which we had at
-     lease one task to process but no time to process any.
+     The number of consecutive frames during which we had at least
+     one task to process but no time to process any within the
+     normal frame budget.
      */
     int _starvationFrameCount;
     
     /*
-     Guards the _taskQueue and _queuedTasks set.
+     Guards the task queues and the _queuedTasks map.
      */
     std::recursive_mutex _taskQueueMutex;
     
     /*
-     The actual queue we use to process tasks in FIFO order.
+     One FIFO queue per priority class, indexed by VROFrameTaskPriority.
+     Promoted tasks leave stale entries behind in their old queue; these
+     are skipped when dequeued.
+     */
+    std::deque<VROFrameTask> _taskQueues[3];
+    
+    /*
+     Map of queued task keys to the priority and sequence number of
+     their live queue entry. Used to prevent the same task from being
+     queued multiple times, and to identify stale queue entries.
+     */
+    std::unordered_map<uint64_t, std::pair<VROFrameTaskPriority, uint64_t>> _queuedTasks;
+    uint64_t _nextSequence;
+    
+    /*
+     Learned cost, in ms per work unit, for each task type. Only
+     accessed on the rendering thread.
+     */
+    std::map<uint32_t, double> _costPerUnit;
+    
+    double _lastFrameTimeSpent;
+    double _lastFrameTimeDeferred;
+    int _lastFrameTasksProcessed;
+    int _lastFrameTasksDeferred;
+    
+    /*
+     Return the next live task without removing it, discarding stale
+     entries along the way. Returns false if all queues are empty. Must
+     be invoked with the mutex held.
+     */
+    bool peekTask(VROFrameTask **task);
+    bool isLive(const VROFrameTask &task) const;
+    
+    /*
+     Estimated cost of the given task in ms.
+     */
+    double estimateCost(const VROFrameTask &task) const;
+    
+    /*
+     Fold the measured duration of a task into its type's cost estimate.
      */
-    std::queue<VROFrameTask> _taskQueue;
+    void recordCost(const VROFrameTask &task, double ms);
     
     /*
-     Set used to prevent the same task from being queued
-     multiple times, based on its ID.
+     Compute the estimated cost of all queued tasks for the statistics.
      */
-    std::set<std::string> _queuedTasks;
+    void computeDeferredStats();
     
 };
 
@@ -61,6 +61,13 @@ public:
         return _frameType == VROFrameType::Startup || getTimeRemainingInFrame() > 0;
     }
     
+    /*
+     Returns true if processing time is unlimited this frame.
+     */
+    bool isUnlimited() const {
+        return _frameType == VROFrameType::Startup;
+    }
+    
     double getTimeRemainingInFrame() const {
         return _timeForProcessing - (VROTimeCurrentMillis() - _lastFrameEndTime);
     }
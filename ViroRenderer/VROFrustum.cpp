@@ -27,7 +27,75 @@
 #include "VROFrustum.h"
 #include "VROFrustumPlane.h"
 #include "VROMath.h"
+#include "VROLog.h"
 #include <limits>
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VRO_FRUSTUM_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VRO_FRUSTUM_SSE 1
+#endif
+
+/*
+ Minimal four-wide float vector used to test four boxes against a plane at once.
+ */
+#if VRO_FRUSTUM_NEON
+typedef float32x4_t VROFloat4;
+
+static inline VROFloat4 VROFloat4Load(const float *f) { return vld1q_f32(f); }
+static inline VROFloat4 VROFloat4Splat(float f)       { return vdupq_n_f32(f); }
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) { return vaddq_f32(a, b); }
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) { return vmulq_f32(a, b); }
+static inline VROFloat4 VROFloat4Min(VROFloat4 a, VROFloat4 b) { return vminq_f32(a, b); }
+static inline VROFloat4 VROFloat4Max(VROFloat4 a, VROFloat4 b) { return vmaxq_f32(a, b); }
+static inline int VROFloat4NegativeMask(VROFloat4 a) {
+    static const uint32_t kLaneBits[4] = { 1, 2, 4, 8 };
+    uint32x4_t mask = vandq_u32(vcltq_f32(a, vdupq_n_f32(0)), vld1q_u32(kLaneBits));
+    uint32x2_t pair = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+    return (int) (vget_lane_u32(pair, 0) | vget_lane_u32(pair, 1));
+}
+#elif VRO_FRUSTUM_SSE
+typedef __m128 VROFloat4;
+
+static inline VROFloat4 VROFloat4Load(const float *f) { return _mm_loadu_ps(f); }
+static inline VROFloat4 VROFloat4Splat(float f)       { return _mm_set1_ps(f); }
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) { return _mm_add_ps(a, b); }
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) { return _mm_mul_ps(a, b); }
+static inline VROFloat4 VROFloat4Min(VROFloat4 a, VROFloat4 b) { return _mm_min_ps(a, b); }
+static inline VROFloat4 VROFloat4Max(VROFloat4 a, VROFloat4 b) { return _mm_max_ps(a, b); }
+static inline int VROFloat4NegativeMask(VROFloat4 a) {
+    return _mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps()));
+}
+#else
+struct VROFloat4 {
+    float v[4];
+};
+
+static inline VROFloat4 VROFloat4Load(const float *f) {
+    return {{ f[0], f[1], f[2], f[3] }};
+}
+static inline VROFloat4 VROFloat4Splat(float f) {
+    return {{ f, f, f, f }};
+}
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) {
+    return {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+}
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) {
+    return {{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+}
+static inline VROFloat4 VROFloat4Min(VROFloat4 a, VROFloat4 b) {
+    return {{ std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) }};
+}
+static inline VROFloat4 VROFloat4Max(VROFloat4 a, VROFloat4 b) {
+    return {{ std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]) }};
+}
+static inline int VROFloat4NegativeMask(VROFloat4 a) {
+    return (a.v[0] < 0 ? 1 : 0) | (a.v[1] < 0 ? 2 : 0) | (a.v[2] < 0 ? 4 : 0) | (a.v[3] < 0 ? 8 : 0);
+}
+#endif
 
 /////////////////////////////////////////////////////////////////////////////////
 //
@@ -220,6 +288,112 @@ VROFrustumResult VROFrustum::intersectAllOpt(const VROBoundingBox &box, VROFrust
     }
 }
 
+void VROFrustum::intersectAllOpt(const VROBoundingBox *const *boxes, VROFrustumBoxIntersectionMetadata *const *metadata,
+                                 int count, VROFrustumResult *outResults) const {
+    passert (count <= 4);
+    
+    /*
+     First check each box against the plane it was last outside of. Boxes that
+     remain outside of that plane are done; the rest are gathered into
+     structure-of-arrays form for the full test.
+     */
+    float planes[6][4];
+    int lanes[4];
+    int numLanes = 0;
+    
+    for (int b = 0; b < count; b++) {
+        const float *boxPlanes = boxes[b]->getPlanes();
+        const VROFrustumPlane &plane = _planes[metadata[b]->getPlaneLastOutside()];
+        const VROBoxPlane *farPoints = plane.farPoints;
+        
+        float distanceToInnerPoint = plane.normal.x * boxPlanes[farPoints[VROFarPointPosX]]
+                                   + plane.normal.y * boxPlanes[farPoints[VROFarPointPosY]]
+                                   + plane.normal.z * boxPlanes[farPoints[VROFarPointPosZ]]
+                                   + plane.d;
+        if (distanceToInnerPoint < 0) {
+            outResults[b] = VROFrustumResult::Outside;
+            continue;
+        }
+        for (int p = 0; p < 6; p++) {
+            planes[p][numLanes] = boxPlanes[p];
+        }
+        lanes[numLanes++] = b;
+    }
+    if (numLanes == 0) {
+        return;
+    }
+    
+    // Fill unused lanes with a copy of the first box; their results are ignored
+    for (int l = numLanes; l < 4; l++) {
+        for (int p = 0; p < 6; p++) {
+            planes[p][l] = planes[p][0];
+        }
+    }
+    VROFloat4 minX = VROFloat4Load(planes[VROBoxPlaneMinX]);
+    VROFloat4 maxX = VROFloat4Load(planes[VROBoxPlaneMaxX]);
+    VROFloat4 minY = VROFloat4Load(planes[VROBoxPlaneMinY]);
+    VROFloat4 maxY = VROFloat4Load(planes[VROBoxPlaneMaxY]);
+    VROFloat4 minZ = VROFloat4Load(planes[VROBoxPlaneMinZ]);
+    VROFloat4 maxZ = VROFloat4Load(planes[VROBoxPlaneMaxZ]);
+    
+    /*
+     Test all boxes against each plane. Rather than selecting the far points with
+     the plane's farPoints table, which cannot be vectorized across boxes, we take
+     the max (positive far point) and min (negative far point) of each axis'
+     contribution to the plane distance.
+     */
+    int lanesMask = (1 << numLanes) - 1;
+    int outside = 0;
+    int intersect = 0;
+    int planeOutside[4];
+    
+    for (int i = 0; i < 6; i++) {
+        const VROFrustumPlane &plane = _planes[i];
+        VROFloat4 nx = VROFloat4Splat(plane.normal.x);
+        VROFloat4 ny = VROFloat4Splat(plane.normal.y);
+        VROFloat4 nz = VROFloat4Splat(plane.normal.z);
+        VROFloat4 d  = VROFloat4Splat(plane.d);
+        
+        VROFloat4 x0 = VROFloat4Mul(nx, minX), x1 = VROFloat4Mul(nx, maxX);
+        VROFloat4 y0 = VROFloat4Mul(ny, minY), y1 = VROFloat4Mul(ny, maxY);
+        VROFloat4 z0 = VROFloat4Mul(nz, minZ), z1 = VROFloat4Mul(nz, maxZ);
+        
+        VROFloat4 distanceToInnerPoint = VROFloat4Add(VROFloat4Add(VROFloat4Add(VROFloat4Max(x0, x1), VROFloat4Max(y0, y1)),
+                                                                   VROFloat4Max(z0, z1)), d);
+        VROFloat4 distanceToOuterPoint = VROFloat4Add(VROFloat4Add(VROFloat4Add(VROFloat4Min(x0, x1), VROFloat4Min(y0, y1)),
+                                                                   VROFloat4Min(z0, z1)), d);
+        
+        // Record the first plane each box is outside of, for temporal coherency
+        int newlyOutside = VROFloat4NegativeMask(distanceToInnerPoint) & ~outside & lanesMask;
+        if (newlyOutside) {
+            for (int l = 0; l < numLanes; l++) {
+                if (newlyOutside & (1 << l)) {
+                    planeOutside[l] = i;
+                }
+            }
+            outside |= newlyOutside;
+            if (outside == lanesMask) {
+                break;
+            }
+        }
+        intersect |= VROFloat4NegativeMask(distanceToOuterPoint);
+    }
+    
+    for (int l = 0; l < numLanes; l++) {
+        int b = lanes[l];
+        if (outside & (1 << l)) {
+            metadata[b]->setPlaneLastOutside(planeOutside[l]);
+            outResults[b] = VROFrustumResult::Outside;
+        }
+        else if (intersect & (1 << l)) {
+            outResults[b] = VROFrustumResult::Intersects;
+        }
+        else {
+            outResults[b] = VROFrustumResult::Inside;
+        }
+    }
+}
+
 VROFrustumResult VROFrustum::intersectWithFarPointsOpt(const VROBoundingBox &box) const {
     const float *boxPlanes = box.getPlanes();
 
@@ -84,6 +84,14 @@ public:
      */
     VROFrustumResult intersectAllOpt(const VROBoundingBox &box, VROFrustumBoxIntersectionMetadata *metadata) const;
 
+    /*
+     Intersect up to four bounding boxes with this frustum at once, using SIMD where
+     available. The results, and the updates to each box's temporal coherency metadata,
+     are the same as those of intersectAllOpt for each box.
+     */
+    void intersectAllOpt(const VROBoundingBox *const *boxes, VROFrustumBoxIntersectionMetadata *const *metadata,
+                         int count, VROFrustumResult *outResults) const;
+
     /*
      Frustum intersection using the "far point" optimization. The far point optimization enables us
      to determine if there's an intersection between a frustum and an AABB using only two plane->point
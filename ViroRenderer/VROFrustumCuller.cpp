@@ -0,0 +1,192 @@
+//
+//  VROFrustumCuller.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROFrustumCuller.h"
+#include "VROTransformHierarchy.h"
+#include "VRONode.h"
+#include "VRORenderContext.h"
+#include "VROCamera.h"
+#include "VROFrustum.h"
+#include "VROLog.h"
+
+VROFrustumCuller::VROFrustumCuller() :
+    _lastGraphVersion(0),
+    _lastNumNodes(-1),
+    _numNodesTested(0),
+    _numNodesChanged(0) {
+    
+}
+
+VROFrustumCuller::~VROFrustumCuller() {
+    
+}
+
+void VROFrustumCuller::cull(const VROTransformHierarchy &hierarchy, const VRORenderContext &context) {
+    const std::vector<VRONode *> &nodes = hierarchy.getNodes();
+    const std::vector<int> &subtreeEnds = hierarchy.getSubtreeEnds();
+    passert (hierarchy.isCurrent());
+    
+    int count = (int) nodes.size();
+    _visible.assign((count + 63) / 64, 0);
+    _numNodesTested = 0;
+    if (count == 0) {
+        writeVisibility(nodes);
+        return;
+    }
+    
+    // With the frustum test disabled, every node is visible (as in VRONode::updateVisibility)
+    if (!kEnableVisibilityFrustumTest) {
+        setVisible(0, count);
+        writeVisibility(nodes);
+        return;
+    }
+    
+    int root = 0;
+    testBatch(nodes, subtreeEnds, &root, 1, context);
+    
+    /*
+     Test the children of each intersecting node in batches. Children are found
+     by hopping from subtree to subtree: the first child immediately follows its
+     parent, and each sibling begins where the previous sibling's subtree ends.
+     */
+    int batch[4];
+    while (!_stack.empty()) {
+        int parent = _stack.back();
+        _stack.pop_back();
+        
+        int batchSize = 0;
+        for (int child = parent + 1; child < subtreeEnds[parent]; child = subtreeEnds[child]) {
+            batch[batchSize++] = child;
+            if (batchSize == 4) {
+                testBatch(nodes, subtreeEnds, batch, batchSize, context);
+                batchSize = 0;
+            }
+        }
+        if (batchSize > 0) {
+            testBatch(nodes, subtreeEnds, batch, batchSize, context);
+        }
+    }
+    writeVisibility(nodes);
+}
+
+void VROFrustumCuller::testBatch(const std::vector<VRONode *> &nodes, const std::vector<int> &subtreeEnds,
+                                 const int *batch, int count, const VRORenderContext &context) {
+    const VROFrustum &frustum = context.getCamera().getFrustum();
+    VROVector3f cameraPosition = context.getCamera().getPosition();
+    
+    const VROBoundingBox *boxes[4];
+    VROFrustumBoxIntersectionMetadata *metadata[4];
+    VROFrustumResult results[4];
+    int indices[4];
+    int numTested = 0;
+    
+    for (int i = 0; i < count; i++) {
+        VRONode *node = nodes[batch[i]];
+        
+        // Bounds that enclose the camera are treated as intersecting, as in
+        // VRONode::updateVisibility, since the frustum test handles them poorly
+        if (node->_worldUmbrellaBoundingBox.containsPoint(cameraPosition)) {
+            results[i] = VROFrustumResult::Intersects;
+            continue;
+        }
+        boxes[numTested] = &node->_worldUmbrellaBoundingBox;
+        metadata[numTested] = &node->_umbrellaBoxMetadata;
+        indices[numTested] = i;
+        ++numTested;
+    }
+    
+    if (numTested > 0) {
+        VROFrustumResult tested[4];
+        frustum.intersectAllOpt(boxes, metadata, numTested, tested);
+        for (int t = 0; t < numTested; t++) {
+            results[indices[t]] = tested[t];
+        }
+    }
+    _numNodesTested += count;
+    
+    for (int i = 0; i < count; i++) {
+        int index = batch[i];
+        int end = subtreeEnds[index];
+        
+        if (results[i] == VROFrustumResult::Inside) {
+            setVisible(index, end);
+        }
+        else if (results[i] == VROFrustumResult::Intersects) {
+            setVisible(index, index + 1);
+            if (end > index + 1) {
+                _stack.push_back(index);
+            }
+        }
+        // Outside nodes and their subtrees keep their cleared bits
+    }
+}
+
+void VROFrustumCuller::setVisible(int start, int end) {
+    // Fill the partial leading word, whole words, and then the partial trailing word
+    while (start < end && (start & 63) != 0) {
+        _visible[start >> 6] |= 1ULL << (start & 63);
+        ++start;
+    }
+    while (end - start >= 64) {
+        _visible[start >> 6] = ~0ULL;
+        start += 64;
+    }
+    while (start < end) {
+        _visible[start >> 6] |= 1ULL << (start & 63);
+        ++start;
+    }
+}
+
+void VROFrustumCuller::writeVisibility(const std::vector<VRONode *> &nodes) {
+    int count = (int) nodes.size();
+    
+    /*
+     If the hierarchy was rebuilt since the last cull, the bit positions no longer
+     correspond to the same nodes, so write every node. Otherwise only write the
+     nodes whose bits flipped.
+     */
+    bool writeAll = _lastGraphVersion != VRONode::getGraphVersion() || _lastNumNodes != count;
+    _numNodesChanged = 0;
+    
+    for (size_t w = 0; w < _visible.size(); w++) {
+        uint64_t changed = writeAll ? ~0ULL : (_visible[w] ^ _lastVisible[w]);
+        while (changed) {
+            int bit = __builtin_ctzll(changed);
+            int index = (int) (w * 64) + bit;
+            if (index >= count) {
+                break;
+            }
+            nodes[index]->_visible = (_visible[w] >> bit) & 1;
+            changed &= changed - 1;
+            ++_numNodesChanged;
+        }
+    }
+    
+    _lastGraphVersion = VRONode::getGraphVersion();
+    _lastNumNodes = count;
+    _visible.swap(_lastVisible);
+}
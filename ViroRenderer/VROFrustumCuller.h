@@ -0,0 +1,116 @@
+//
+//  VROFrustumCuller.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROFrustumCuller_h
+#define VROFrustumCuller_h
+
+#include <vector>
+#include <stdint.h>
+
+class VRONode;
+class VROTransformHierarchy;
+class VRORenderContext;
+
+/*
+ Hierarchical frustum culler that operates on the flattened scene graph of a
+ VROTransformHierarchy.
+ 
+ Nodes are tested against the camera frustum using their world umbrella
+ bounding boxes, top-down. The children of each node that intersects the
+ frustum are tested four at a time with SIMD. When a node is entirely inside
+ or outside the frustum, its whole subtree is resolved at once: since the
+ subtree is a contiguous range in the flattened ordering, this is a range fill
+ in a visibility bitset rather than a recursive walk.
+ 
+ The bitset is then compared with that of the previous frame, and only nodes
+ whose visibility changed are written to.
+ */
+class VROFrustumCuller {
+    
+public:
+    
+    VROFrustumCuller();
+    virtual ~VROFrustumCuller();
+    
+    /*
+     Update the visibility of every node in the given hierarchy, which must be
+     current (see VROTransformHierarchy::isCurrent()), against the frustum of
+     the context's camera.
+     */
+    void cull(const VROTransformHierarchy &hierarchy, const VRORenderContext &context);
+    
+    /*
+     Number of umbrella boxes tested against the frustum, and the number of nodes
+     whose visibility changed, during the last cull.
+     */
+    int getNumNodesTested() const {
+        return _numNodesTested;
+    }
+    int getNumNodesChanged() const {
+        return _numNodesChanged;
+    }
+    
+    /*
+     Visibility of the node at the given index of the hierarchy, as computed by
+     the last cull.
+     */
+    bool isVisible(int index) const {
+        return (_lastVisible[index >> 6] >> (index & 63)) & 1;
+    }
+    
+private:
+    
+    /*
+     Visibility of each node in the hierarchy, one bit per node, in the
+     hierarchy's depth-first order, for this frame and the last.
+     */
+    std::vector<uint64_t> _visible;
+    std::vector<uint64_t> _lastVisible;
+    
+    /*
+     The node graph version and node count at which _lastVisible was computed.
+     If either changed, the ordering changed, and all nodes are written.
+     */
+    uint32_t _lastGraphVersion;
+    int _lastNumNodes;
+    
+    /*
+     Nodes that intersect the frustum, whose children remain to be tested.
+     */
+    std::vector<int> _stack;
+    
+    int _numNodesTested;
+    int _numNodesChanged;
+    
+    void testBatch(const std::vector<VRONode *> &nodes, const std::vector<int> &subtreeEnds,
+                   const int *batch, int count, const VRORenderContext &context);
+    void setVisible(int start, int end);
+    void writeVisibility(const std::vector<VRONode *> &nodes);
+    
+};
+
+#endif /* VROFrustumCuller_h */
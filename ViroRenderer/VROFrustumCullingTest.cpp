@@ -0,0 +1,170 @@
+//
+//  VROFrustumCullingTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROFrustumCullingTest.h"
+#include "VROTestUtil.h"
+#include "VROTime.h"
+
+static const int kNumClusters = 10;
+static const int kNumGroupsPerCluster = 10;
+static const int kGroupGridSize = 10;
+
+// Number of frames between each benchmark report
+static const int kReportFrames = 120;
+
+VROFrustumCullingTest::VROFrustumCullingTest() :
+    VRORendererTest(VRORendererTestType::FrustumCulling),
+    _angle(0),
+    _numNodes(0),
+    _numFrames(0),
+    _flattenedMillis(0),
+    _recursiveMillis(0) {
+        
+}
+
+VROFrustumCullingTest::~VROFrustumCullingTest() {
+    
+}
+
+void VROFrustumCullingTest::build(std::shared_ptr<VRORenderer> renderer,
+                                  std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                                  std::shared_ptr<VRODriver> driver) {
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    _numNodes = 1;
+    
+    std::shared_ptr<VROBox> box = VROBox::createBox(0.2, 0.2, 0.2);
+    std::shared_ptr<VROMaterial> material = box->getMaterials()[0];
+    material->setLightingModel(VROLightingModel::Constant);
+    material->getDiffuse().setColor({ 0.4, 0.7, 1.0, 1.0 });
+    
+    /*
+     Clusters are arranged in a ring around the camera, each containing a
+     row of groups, each of which is a grid of boxes. As the camera turns,
+     clusters move from fully outside, to intersecting, to fully inside the
+     frustum, exercising every path of the culler.
+     */
+    for (int c = 0; c < kNumClusters; c++) {
+        float angle = (2 * M_PI * c) / kNumClusters;
+        
+        std::shared_ptr<VRONode> clusterNode = std::make_shared<VRONode>();
+        clusterNode->setPosition({ 20 * sinf(angle), 0, -20 * cosf(angle) });
+        clusterNode->setRotation({ 0, -angle, 0 });
+        rootNode->addChildNode(clusterNode);
+        ++_numNodes;
+        
+        for (int g = 0; g < kNumGroupsPerCluster; g++) {
+            std::shared_ptr<VRONode> groupNode = std::make_shared<VRONode>();
+            groupNode->setPosition({ (g - kNumGroupsPerCluster / 2.0f) * 3.0f, 0, 0 });
+            clusterNode->addChildNode(groupNode);
+            ++_numNodes;
+            
+            for (int x = 0; x < kGroupGridSize; x++) {
+                for (int y = 0; y < kGroupGridSize; y++) {
+                    std::shared_ptr<VRONode> boxNode = std::make_shared<VRONode>();
+                    boxNode->setGeometry(box);
+                    boxNode->setPosition({ (x - kGroupGridSize / 2.0f) * 0.25f, (y - kGroupGridSize / 2.0f) * 0.25f, 0 });
+                    groupNode->addChildNode(boxNode);
+                    ++_numNodes;
+                }
+            }
+        }
+    }
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    cameraNode->setPosition({ 0, 0, 0 });
+    rootNode->addChildNode(cameraNode);
+    ++_numNodes;
+    
+    std::shared_ptr<VROAction> action = VROAction::perpetualPerFrameAction([this](VRONode *const node, float seconds) {
+        _angle += .005;
+        node->setRotation({ 0, _angle, 0 });
+        return true;
+    });
+    cameraNode->runAction(action);
+    
+    _pointOfView = cameraNode;
+    frameSynchronizer->addFrameListener(shared_from_this());
+}
+
+void VROFrustumCullingTest::onFrameWillRender(const VRORenderContext &context) {
+    
+}
+
+void VROFrustumCullingTest::onFrameDidRender(const VRORenderContext &context) {
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    /*
+     Re-cull the scene with this frame's camera. The flattened culler runs last,
+     so that its record of each node's visibility matches the nodes. The recursive
+     result is captured in between, and compared against the flattened culler's.
+     */
+    const VROTransformHierarchy &hierarchy = scene->getTransformHierarchy();
+    const std::vector<VRONode *> &nodes = hierarchy.getNodes();
+    
+    double start = VROTimeCurrentMillis();
+    scene->getRootNode()->updateVisibility(context);
+    double recursiveEnd = VROTimeCurrentMillis();
+    
+    _recursiveVisible.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        _recursiveVisible[i] = nodes[i]->isVisible();
+    }
+    
+    double flattenedStart = VROTimeCurrentMillis();
+    scene->updateVisibility(context);
+    double flattenedEnd = VROTimeCurrentMillis();
+    
+    if (hierarchy.isCurrent()) {
+        int mismatches = 0;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (scene->getFrustumCuller().isVisible(i) != _recursiveVisible[i]) {
+                ++mismatches;
+            }
+        }
+        passert_msg(mismatches == 0, "Flattened culler disagrees with recursive culler on %d of %d nodes",
+                    mismatches, (int) nodes.size());
+    }
+    
+    _recursiveMillis += recursiveEnd - start;
+    _flattenedMillis += flattenedEnd - flattenedStart;
+    ++_numFrames;
+    
+    if (_numFrames == kReportFrames) {
+        double scale = 10000.0 / (_numNodes * _numFrames);
+        pinfo("Frustum culling per 10k nodes: flattened %.3f ms, recursive %.3f ms",
+              _flattenedMillis * scale, _recursiveMillis * scale);
+        
+        _numFrames = 0;
+        _flattenedMillis = 0;
+        _recursiveMillis = 0;
+    }
+}
@@ -0,0 +1,80 @@
+//
+//  VROFrustumCullingTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROFrustumCullingTest_h
+#define VROFrustumCullingTest_h
+
+#include "VRORendererTest.h"
+
+/*
+ Benchmark for frustum culling. Builds a hierarchy of 10k boxes surrounding a
+ rotating camera, so that visibility changes every frame, and periodically logs
+ the time taken to cull the scene graph, per 10k nodes, using the flattened
+ hierarchical culler and the recursive VRONode culler. Each frame asserts that
+ both cullers produce the same visibility for every node.
+ */
+class VROFrustumCullingTest : public VROFrameListener, public VRORendererTest, public std::enable_shared_from_this<VROFrameListener> {
+public:
+    
+    VROFrustumCullingTest();
+    virtual ~VROFrustumCullingTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+    void onFrameWillRender(const VRORenderContext &context);
+    void onFrameDidRender(const VRORenderContext &context);
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    float _angle;
+    
+    /*
+     Total number of nodes in the scene, and the cull times accumulated since the
+     last report.
+     */
+    int _numNodes;
+    int _numFrames;
+    double _flattenedMillis;
+    double _recursiveMillis;
+    
+    /*
+     Visibility of each node, in hierarchy order, as computed by the recursive culler.
+     */
+    std::vector<bool> _recursiveVisible;
+    
+};
+
+#endif /* VROFrustumCullingTest_h */
@@ -51,25 +51,12 @@
 #include "VROShaderModifier.h"
 #include "VROShaderProgram.h"
 #include "VROMorpher.h"
+#include "VROTextureDecodePool.h"
+#include "VROTextureTranscoder.h"
+#include "VROJenkinsHash.h"
+#include "VROAssetCache.h"
 
 static std::string kVROGLTFInputSamplerKey = "timeInput";
-std::map<std::string, std::shared_ptr<VROVertexBuffer>> VROGLTFLoader::_dataCache;
-std::map<std::string, std::shared_ptr<VROTexture>> VROGLTFLoader::_textureCache;
-std::map<int, std::shared_ptr<VROSkeleton>> VROGLTFLoader::_skinIndexToSkeleton;
-std::map<int, std::map<int, std::vector<std::shared_ptr<VROKeyframeAnimation>>>> VROGLTFLoader::_nodeKeyFrameAnims;
-std::map<int, std::vector<std::shared_ptr<VROSkeletalAnimation>>> VROGLTFLoader::_skinSkeletalAnims;
-std::map<int, std::shared_ptr<VROSkinner>> VROGLTFLoader::_skinMap;
-
-// An map of all skinner joint index to its corresponding node index (provided by tinygLTF).
-std::map<int, std::map<int,int>> VROGLTFLoader::_skinIndexToJointNodeIndex;
-
-// An map of all skinner joint index to its skinner child joint indexes (Not Nodes).
-// Note: the first joint index at 0 is not necessairly the root joint. This is only the
-// order of which the inverse bind data is provided in the gLTF JSON structure.
-std::map<int, std::map<int,std::vector<int>>> VROGLTFLoader::_skinIndexToJointChildJoints;
-
-// An map of all root skeleton joint indexes.
-std::map<int, int> VROGLTFLoader::_skinIndexToSkeletonRootJoint;
 
 static int getTypeSize(GLTFType type) {
     switch (type) {
@@ -254,16 +241,16 @@ void VROGLTFLoader::loadGLTFFromResource(std::string gltfManifestFilePath, const
                                             (std::string cachedFilePath, bool isTemp) {
                 // Then use TinyGltf to parse the GTLF structure, and corresponding auxiliary resource files.
                 VROPlatformDispatchAsyncBackground([gltfManifestFilePath, overwriteResourceMap, isGLTFBinary, cachedFilePath, rootNode, driver, onFinish] {
-                    tinygltf::Model gModel;
+                    std::shared_ptr<tinygltf::Model> gModel = std::make_shared<tinygltf::Model>();
                     tinygltf::TinyGLTF gLoader;
                     std::string err;
 
                     // If we've successfully retrieved the GLTF Manifest, start parsing the file with tinyGLTF.
                     bool ret = false;
                     if (isGLTFBinary) {
-                        ret = gLoader.LoadBinaryFromFile(&gModel, &err, cachedFilePath, overwriteResourceMap);
+                        ret = gLoader.LoadBinaryFromFile(gModel.get(), &err, cachedFilePath, overwriteResourceMap);
                     } else {
-                        ret = gLoader.LoadASCIIFromFile(&gModel, &err, cachedFilePath, gltfManifestFilePath, overwriteResourceMap);
+                        ret = gLoader.LoadASCIIFromFile(gModel.get(), &err, cachedFilePath, gltfManifestFilePath, overwriteResourceMap);
                     }
 
                     // Fail fast if any errors were encountered.
@@ -280,56 +267,21 @@ void VROGLTFLoader::loadGLTFFromResource(std::string gltfManifestFilePath, const
                     }
 
                     // Ensure that we are only processing GLTF 2.0 models.
-                    std::string version = gModel.asset.version;
+                    std::string version = gModel->asset.version;
                     if (VROStringUtil::toFloat(version) < 2) {
                         pwarn("Error parsing GLTF model: Only GLTF 2.0 models are supported!");
                         onFinish(nullptr, false);
                         return;
                     }
 
-                    // Once the manifest has been parsed, start constructing our Viro 3D Model.
-                    const tinygltf::Model &model = gModel;
-                    VROPlatformDispatchAsyncRenderer([rootNode, model, driver, onFinish] {
-                        clearCachedData();
-
-                        // Process and cache skinner and skeletal data needed for skeletal animation
-                        // and skinner geometry to be set later on our nodes.
-                        if (!processSkinner(model)) {
-                            perr("Error when processing the skinner of GLTF model!");
-                            onFinish(nullptr, false);
-                            return;
-                        }
-
-                        // Now generate our KeyFrame and skeletal animations and cache them to be
-                        // set later on our nodes (when we iterate through the scene hierarchy).
-                        if (!processAnimations(model)) {
-                            pwarn("Error when processing animation data of the GLTF model!");
-                            onFinish(nullptr, false);
-                            return;
-                        }
-
-                        // Finally, iterate through gLTF model data and build out our VRONodes that
-                        // represent our 3D Model scene, setting cached animations / skinners on
-                        // those nodes along the way.
-                        bool success = true;
-                        std::shared_ptr<VRONode> gltfRootNode = std::make_shared<VRONode>();
-                        for (const tinygltf::Scene &gScene : model.scenes) {
-                            if (!processScene(model, gltfRootNode, gScene, driver)) {
-                                success = false;
-                                break;
-                            }
-                        }
-
-                        for (auto &skeletonPair : _skinIndexToSkeleton) {
-                            std::shared_ptr<VROSkinner> skin = _skinMap[skeletonPair.first];
-                            skeletonPair.second->setSkinnerRootNode(skin->getSkinnerNode());
-                        }
-
-                        // Once we have processed the model, injected it into the scene.
-                        injectGLTF(success ? gltfRootNode : nullptr, rootNode, driver, onFinish);
-
-                        // Clean up our cached resources.
-                        clearCachedData();
+                    // Once the manifest has been parsed, build our Viro 3D Model on a background
+                    // thread as well. The model is shared (not copied) between the stages, and only
+                    // the finished node tree is handed to the rendering thread.
+                    VROPlatformDispatchAsyncBackground([rootNode, gModel, driver, onFinish] {
+                        std::shared_ptr<VRONode> gltfRootNode = buildGLTF(gModel, driver);
+                        VROPlatformDispatchAsyncRenderer([rootNode, gltfRootNode, driver, onFinish] {
+                            injectGLTF(gltfRootNode, rootNode, driver, onFinish);
+                        });
                     });
                 });
             },
@@ -340,19 +292,202 @@ void VROGLTFLoader::loadGLTFFromResource(std::string gltfManifestFilePath, const
             });
 }
 
-void VROGLTFLoader::clearCachedData() {
-    _dataCache.clear();
-    _textureCache.clear();
-    _skinIndexToSkeleton.clear();
-    _skinIndexToJointNodeIndex.clear();
-    _skinIndexToJointChildJoints.clear();
-    _skinMap.clear();
-    _nodeKeyFrameAnims.clear();
-    _skinSkeletalAnims.clear();
-    _skinIndexToSkeletonRootJoint.clear();
+std::shared_ptr<VRONode> VROGLTFLoader::buildGLTF(std::shared_ptr<tinygltf::Model> gModel, std::shared_ptr<VRODriver> driver) {
+    VROGLTFLoadContext context;
+    takeBuffers(context, *gModel);
+    context.assetCache = driver->getAssetCache();
+    
+    const tinygltf::Model &model = *gModel;
+    decodeImages(context, model);
+
+    /*
+     The nodes and materials built here are restricted to the rendering thread, but are
+     detached from any scene and visible only to this thread until they are injected. Their
+     thread restriction is therefore disabled while they are built, and re-enabled by
+     injectGLTF() on the rendering thread.
+     */
+    bool success = true;
+    std::shared_ptr<VRONode> gltfRootNode = std::make_shared<VRONode>();
+    gltfRootNode->setThreadRestrictionEnabled(false);
+
+    if (!processSkinner(context, model)) {
+        // Process and cache skinner and skeletal data needed for skeletal animation
+        // and skinner geometry to be set later on our nodes.
+        perr("Error when processing the skinner of GLTF model!");
+        success = false;
+    }
+    else if (!processAnimations(context, model)) {
+        // Now generate our KeyFrame and skeletal animations and cache them to be
+        // set later on our nodes (when we iterate through the scene hierarchy).
+        pwarn("Error when processing animation data of the GLTF model!");
+        success = false;
+    }
+    else {
+        // Finally, iterate through gLTF model data and build out our VRONodes that
+        // represent our 3D Model scene, setting cached animations / skinners on
+        // those nodes along the way.
+        for (const tinygltf::Scene &gScene : model.scenes) {
+            if (!processScene(context, model, gltfRootNode, gScene, driver)) {
+                success = false;
+                break;
+            }
+        }
+
+        for (auto &skeletonPair : context.skinIndexToSkeleton) {
+            std::shared_ptr<VROSkinner> skin = context.skinMap[skeletonPair.first];
+            skeletonPair.second->setSkinnerRootNode(skin->getSkinnerNode());
+        }
+    }
+
+    // Decodes we did not use still reference the model's image data, so they must
+    // finish before the model is released.
+    waitForImageDecodes(context);
+    return success ? gltfRootNode : nullptr;
+}
+
+void VROGLTFLoader::setThreadRestrictionEnabled(std::shared_ptr<VRONode> node, bool enabled) {
+    node->setThreadRestrictionEnabled(enabled);
+    
+    std::shared_ptr<VROGeometry> geometry = node->getGeometry();
+    if (geometry) {
+        for (const std::shared_ptr<VROMaterial> &material : geometry->getMaterials()) {
+            material->setThreadRestrictionEnabled(enabled);
+        }
+    }
+    for (std::shared_ptr<VRONode> child : node->getChildNodes()) {
+        setThreadRestrictionEnabled(child, enabled);
+    }
+}
+
+void VROGLTFLoader::takeBuffers(VROGLTFLoadContext &context, tinygltf::Model &gModel) {
+    context.bufferData.clear();
+    for (tinygltf::Buffer &gBuffer : gModel.buffers) {
+        std::shared_ptr<std::vector<unsigned char>> storage = std::make_shared<std::vector<unsigned char>>();
+        storage->swap(gBuffer.data);
+        context.bufferData.push_back(std::make_shared<VROData>(storage->data(), storage->size(), storage));
+    }
+    
+    context.bufferNumViews.assign(gModel.buffers.size(), 0);
+    for (const tinygltf::BufferView &gBufferView : gModel.bufferViews) {
+        if (gBufferView.buffer >= 0 && gBufferView.buffer < (int) context.bufferNumViews.size()) {
+            ++context.bufferNumViews[gBufferView.buffer];
+        }
+    }
+}
+
+std::shared_ptr<VROData> VROGLTFLoader::getBufferSlice(VROGLTFLoadContext &context, int bufferIndex, size_t byteOffset, size_t byteLength) {
+    return VROData::slice(context.bufferData[bufferIndex], byteOffset, byteLength);
+}
+
+const char *VROGLTFLoader::getBufferData(VROGLTFLoadContext &context, int bufferIndex) {
+    return (const char *) context.bufferData[bufferIndex]->getData();
+}
+
+void VROGLTFLoader::decodeImages(VROGLTFLoadContext &context, const tinygltf::Model &model) {
+    // Base color maps are decoded first, since they matter most to how the model
+    // looks once it is displayed
+    std::set<int> colorImages;
+    for (const tinygltf::Material &gMaterial : model.materials) {
+        auto it = gMaterial.pbrValues.find("baseColorTexture");
+        if (it == gMaterial.pbrValues.end()) {
+            continue;
+        }
+        int textureIndex = it->second.TextureIndex();
+        if (textureIndex >= 0 && textureIndex < (int) model.textures.size()) {
+            colorImages.insert(model.textures[textureIndex].source);
+        }
+    }
+
+    // Images that are also used as data (normal, occlusion, metal-roughness) maps
+    // are never transcoded, since block compression artifacts are most visible there
+    std::set<int> dataImages;
+    for (const tinygltf::Material &gMaterial : model.materials) {
+        for (const tinygltf::ParameterMap *map : { &gMaterial.pbrValues, &gMaterial.additionalValues }) {
+            for (auto &kv : *map) {
+                if (kv.first == "baseColorTexture") {
+                    continue;
+                }
+                int textureIndex = kv.second.TextureIndex();
+                if (textureIndex >= 0 && textureIndex < (int) model.textures.size()) {
+                    dataImages.insert(model.textures[textureIndex].source);
+                }
+            }
+        }
+    }
+
+    // Lossy transcoding is opt-in. The setting is read once, so that the keys and
+    // decodes of this load agree even if it changes mid-load
+    bool transcodingEnabled = VROTextureTranscoder::isTranscodingEnabled();
+    
+    // Key each image by content, so that models sharing an image (or several loads of
+    // the same model) share a single decode and texture
+    std::map<int, std::string> decodeKeys;
+    for (int i = 0; i < (int) model.images.size(); i++) {
+        const std::vector<unsigned char> &data = model.images[i].rawByteVec;
+        if (data.empty()) {
+            continue;
+        }
+        uint64_t hash = android::VROJenkinsHash64((const uint8_t *) data.data(), data.size());
+        std::string key = "gltf_" + VROStringUtil::toString64(hash) + "_" + VROStringUtil::toString((int) data.size());
+
+        bool transcode = transcodingEnabled && colorImages.count(i) > 0 && dataImages.count(i) == 0;
+        if (transcode) {
+            key += "_transcoded";
+        }
+        decodeKeys[i] = key;
+        context.imageKeys[i] = VROAssetCache::combine(VROAssetCache::combine(hash, data.size()), transcode);
+    }
+
+    // Textures created by a previous load, of this or any other model, are taken from the
+    // asset cache. Only the images of the remaining textures need to be decoded
+    std::shared_ptr<VROAssetCache> cache = context.assetCache;
+    std::set<int> neededImages;
+    for (const tinygltf::Material &gMaterial : model.materials) {
+        for (const tinygltf::ParameterMap *map : { &gMaterial.pbrValues, &gMaterial.additionalValues }) {
+            for (auto &kv : *map) {
+                int textureIndex = kv.second.TextureIndex();
+                if (textureIndex < 0 || textureIndex >= (int) model.textures.size()) {
+                    continue;
+                }
+                const tinygltf::Texture &gTexture = model.textures[textureIndex];
+                uint64_t key = getTextureKey(context, model, gTexture, kv.first == "baseColorTexture");
+                if (key == 0 || context.textureCache.find(key) != context.textureCache.end()) {
+                    continue;
+                }
+                std::shared_ptr<VROTexture> texture = cache->getTexture(key);
+                if (texture) {
+                    context.textureCache[key] = texture;
+                } else {
+                    neededImages.insert(gTexture.source);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<VROTextureDecodePool> pool = VROTextureDecodePool::getSharedPool();
+    for (int i : neededImages) {
+        auto key = decodeKeys.find(i);
+        if (key == decodeKeys.end()) {
+            continue;
+        }
+        const std::vector<unsigned char> *data = &model.images[i].rawByteVec;
+        VROTextureDecodePriority priority = colorImages.count(i) > 0 ? VROTextureDecodePriority::High :
+                                                                      VROTextureDecodePriority::Normal;
+        bool transcode = transcodingEnabled && colorImages.count(i) > 0 && dataImages.count(i) == 0;
+        context.imageDecodes[i] = pool->decodeImage(key->second, priority, [data, transcode]() {
+            std::shared_ptr<VROImage> image = VROPlatformLoadImageWithBufferedData(*data, VROTextureInternalFormat::RGBA8);
+            return transcode ? VROTextureTranscoder::transcode(image) : image;
+        });
+    }
+}
+
+void VROGLTFLoader::waitForImageDecodes(VROGLTFLoadContext &context) {
+    for (auto &decode : context.imageDecodes) {
+        decode.second.wait();
+    }
 }
 
-bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
+bool VROGLTFLoader::processSkinner(VROGLTFLoadContext &context, const tinygltf::Model &model) {
     if (model.skins.size() == 0) {
         return true;
     }
@@ -366,11 +501,11 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
         for (int jointIndex = 0; jointIndex < skin.joints.size(); jointIndex++) {
             int nodeIndexOfJoint = skin.joints[jointIndex];
             skinIndexToNodeJointIndexes[skinIndex][nodeIndexOfJoint] = jointIndex;
-            _skinIndexToJointNodeIndex[skinIndex][jointIndex] = nodeIndexOfJoint;
+            context.skinIndexToJointNodeIndex[skinIndex][jointIndex] = nodeIndexOfJoint;
         }
     }
 
-    // Construct _skinIndexToJointChildJoints and skinIndexToJointParentJoint mappings
+    // Construct context.skinIndexToJointChildJoints and skinIndexToJointParentJoint mappings
     // respectively - these effectively maps out the joints within the skeletal tree
     // by keeping track of a joint's pointer to both child and parent joints.
     std::map<int, std::map<int, int>> skinIndexToJointParentJoint;
@@ -379,7 +514,7 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
         for (int jointIndex = 0; jointIndex < skin.joints.size(); jointIndex++) {
 
             // Grab the node index corresponding to this joint.
-            int nodeIndex = _skinIndexToJointNodeIndex[skinIndex][jointIndex];
+            int nodeIndex = context.skinIndexToJointNodeIndex[skinIndex][jointIndex];
 
             // Then look up the node with the nodeIndex and grab it's child nodes.
             std::vector<int> childrenNodeIndex = model.nodes[nodeIndex].children;
@@ -394,7 +529,7 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
 
                 // Parent the all childed joint with it's parent. Also create a reverse map
                 // in skinIndexToJointParentJoint.
-                _skinIndexToJointChildJoints[skinIndex][jointIndex].push_back(subJointIndex);
+                context.skinIndexToJointChildJoints[skinIndex][jointIndex].push_back(subJointIndex);
                 skinIndexToJointParentJoint[skinIndex][subJointIndex] = jointIndex;
             }
         }
@@ -402,10 +537,10 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
         // Save a reference to the root
         int nodeIndexOfSkeleton = skin.skeleton;
         if (nodeIndexOfSkeleton >= 0) {
-            _skinIndexToSkeletonRootJoint[skinIndex] = skinIndexToNodeJointIndexes[skinIndex][nodeIndexOfSkeleton];
+            context.skinIndexToSkeletonRootJoint[skinIndex] = skinIndexToNodeJointIndexes[skinIndex][nodeIndexOfSkeleton];
         } else {
             // Else grab the first item in the joint list and treat it as the root node.
-            _skinIndexToSkeletonRootJoint[skinIndex] = 0;
+            context.skinIndexToSkeletonRootJoint[skinIndex] = 0;
         }
     }
 
@@ -415,13 +550,13 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
 
         // Process the vec of inverse bind transforms (in the order of specific joints in the gLTF file).
         std::vector<VROMatrix4f> invBindTransformsOut;
-        if (!processSkinnerInverseBindData(model, model.skins[skinIndex], invBindTransformsOut)) {
+        if (!processSkinnerInverseBindData(context, model, model.skins[skinIndex], invBindTransformsOut)) {
             pwarn("Failed to process Skinner");
             return false;
         }
 
         std::vector<std::shared_ptr<VROBone>> bones;
-        int rootJoint = _skinIndexToSkeletonRootJoint[skinIndex];
+        int rootJoint = context.skinIndexToSkeletonRootJoint[skinIndex];
         
         // Create a vec hiearachy of bones, starting at the root bone.
         for (int jointIndex = 0; jointIndex < skin.joints.size(); jointIndex++) {
@@ -442,8 +577,8 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
             bones.push_back(bone);
         }
         std::shared_ptr<VROSkeleton> skeleton = std::make_shared<VROSkeleton>(bones);
-        _skinIndexToSkeleton[skinIndex] = skeleton;
-        _skinMap[skinIndex] = std::shared_ptr<VROSkinner>(new VROSkinner(skeleton,
+        context.skinIndexToSkeleton[skinIndex] = skeleton;
+        context.skinMap[skinIndex] = std::shared_ptr<VROSkinner>(new VROSkinner(skeleton,
                                                    VROMatrix4f(),
                                                    invBindTransformsOut,
                                                    nullptr,
@@ -452,7 +587,7 @@ bool VROGLTFLoader::processSkinner(const tinygltf::Model &model) {
     return true;
 }
 
-bool VROGLTFLoader::processAnimations(const tinygltf::Model &model) {
+bool VROGLTFLoader::processAnimations(VROGLTFLoadContext &context, const tinygltf::Model &model) {
     if (model.animations.size() == 0) {
         return true;
     }
@@ -519,18 +654,18 @@ bool VROGLTFLoader::processAnimations(const tinygltf::Model &model) {
     }
 
     // For each animation channel in the gltf model, convert them into VROKeyframeAnimations
-    // and cache them in _nodeKeyFrameAnims to be later set on a VRONode.
-    if (!processKeyFrameAnimations(model, nodeToAnimDataMap)) {
+    // and cache them in context.nodeKeyFrameAnims to be later set on a VRONode.
+    if (!processKeyFrameAnimations(context, model, nodeToAnimDataMap)) {
         perr("Error when parsing key frame animations");
         return false;
     }
 
     // Finally also process skeletal animations, if any.
-    processSkeletalAnimation(model, skeletalAnimToSkinToNodeMap);
+    processSkeletalAnimation(context, model, skeletalAnimToSkinToNodeMap);
     return true;
 }
 
-bool VROGLTFLoader::processKeyFrameAnimations(const tinygltf::Model &model,
+bool VROGLTFLoader::processKeyFrameAnimations(VROGLTFLoadContext &context, const tinygltf::Model &model,
                                              std::map<int, std::map<int, std::vector<int>>> &animatedNodes) {
     // First, iterate through all the affected animated nodes.
     for (auto const& animNode : animatedNodes) {
@@ -548,7 +683,7 @@ bool VROGLTFLoader::processKeyFrameAnimations(const tinygltf::Model &model,
             // they may have different sampler time durations.
             for (int channelIndex : channelsData) {
                 std::shared_ptr<VROKeyframeAnimation> animation
-                                    = convertChannelToKeyFrameAnimation(model,
+                                    = convertChannelToKeyFrameAnimation(context, model,
                                                                         model.animations[animationIndex],
                                                                         channelIndex);
                 if (animation == nullptr) {
@@ -561,7 +696,7 @@ bool VROGLTFLoader::processKeyFrameAnimations(const tinygltf::Model &model,
                     name = "animation_" + VROStringUtil::toString(animationIndex);
                 }
                 animation->setName(name);
-                _nodeKeyFrameAnims[nodeIndex][anim.first].push_back(animation);
+                context.nodeKeyFrameAnims[nodeIndex][anim.first].push_back(animation);
             }
         }
     }
@@ -569,7 +704,7 @@ bool VROGLTFLoader::processKeyFrameAnimations(const tinygltf::Model &model,
     return true;
 }
 
-std::shared_ptr<VROKeyframeAnimation> VROGLTFLoader::convertChannelToKeyFrameAnimation(
+std::shared_ptr<VROKeyframeAnimation> VROGLTFLoader::convertChannelToKeyFrameAnimation(VROGLTFLoadContext &context,
         const tinygltf::Model &gModel,
         const tinygltf::Animation &anim,
         int targetedChannel) {
@@ -578,7 +713,7 @@ std::shared_ptr<VROKeyframeAnimation> VROGLTFLoader::convertChannelToKeyFrameAni
     std::vector<std::unique_ptr<VROKeyframeAnimationFrame>> frames;
     tinygltf::AnimationChannel inputChannel = anim.channels[targetedChannel];
     tinygltf::AnimationSampler inputSampler = anim.samplers[inputChannel.sampler];
-    if (!processRawChannelData(gModel, kVROGLTFInputSamplerKey, inputChannel.target_node, inputSampler, frames)) {
+    if (!processRawChannelData(context, gModel, kVROGLTFInputSamplerKey, inputChannel.target_node, inputSampler, frames)) {
         return nullptr;
     }
 
@@ -603,7 +738,7 @@ std::shared_ptr<VROKeyframeAnimation> VROGLTFLoader::convertChannelToKeyFrameAni
     bool hasMorphWeights = false;
     tinygltf::AnimationChannel channel = anim.channels[targetedChannel];
     tinygltf::AnimationSampler gSampler = anim.samplers[channel.sampler];
-    if (!processRawChannelData(gModel, channel.target_path, channel.target_node, gSampler, frames)) {
+    if (!processRawChannelData(context, gModel, channel.target_path, channel.target_node, gSampler, frames)) {
         perr("Failed to process channel index %s for gltf model!", channel.target_path.c_str());
         return nullptr;
     }
@@ -621,7 +756,7 @@ std::shared_ptr<VROKeyframeAnimation> VROGLTFLoader::convertChannelToKeyFrameAni
     return std::make_shared<VROKeyframeAnimation>(frames, duration, hasTranslation, hasRotation, hasScale, hasMorphWeights);
 }
 
-bool VROGLTFLoader::processRawChannelData(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processRawChannelData(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                           std::string channelProperty,
                                           int channelTarget,
                                           const tinygltf::AnimationSampler &channelSampler,
@@ -695,10 +830,9 @@ bool VROGLTFLoader::processRawChannelData(const tinygltf::Model &gModel,
     }
 
     // Now process that buffer to produce the right output data.
-    const tinygltf::Buffer &gBuffer = gModel.buffers[gIndiceBufferView.buffer];
     std::vector<float> tempVec;
     int morphIndex = 0;
-    VROByteBuffer buffer((char *)gBuffer.data.data() + dataOffset, dataLength, false);
+    VROByteBuffer buffer(getBufferData(context, gIndiceBufferView.buffer) + dataOffset, dataLength, false);
     for (int elementIndex = 0; elementIndex < elementCount; elementIndex++) {
 
         // Set the buffer position to begin at each element index - Ex: Each Vec4.
@@ -766,13 +900,13 @@ bool VROGLTFLoader::processRawChannelData(const tinygltf::Model &gModel,
     return true;
 }
 
-bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
+bool VROGLTFLoader::processSkeletalAnimation(VROGLTFLoadContext &context, const tinygltf::Model &model,
                                      std::map<int, std::pair<int, std::vector<int>>> &skeletalAnimToSkinToNodeMap) {
     if (skeletalAnimToSkinToNodeMap.size() == 0) {
         return true;
     }
 
-    flattenSkeletalKeyframeAnimations(skeletalAnimToSkinToNodeMap);
+    flattenSkeletalKeyframeAnimations(context, skeletalAnimToSkinToNodeMap);
 
     // First, iterate through each skeletal animation that is associated with each
     // skinner in the scene. Also assume that an animation can only move a single
@@ -781,14 +915,14 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
         int skinIndex = animToSkinToNodePair.second.first;
         int skeletalAnimationIndex = animToSkinToNodePair.first;
         
-        int rootJointIndexForSkin = _skinIndexToSkeletonRootJoint[skinIndex];
-        int animatedNodeIndexFirst = _skinIndexToJointNodeIndex[skinIndex][rootJointIndexForSkin];
+        int rootJointIndexForSkin = context.skinIndexToSkeletonRootJoint[skinIndex];
+        int animatedNodeIndexFirst = context.skinIndexToJointNodeIndex[skinIndex][rootJointIndexForSkin];
 
         // For the current skeletal animation, grab first joint/Node, and then grab
         // it's vec of VROKeyframeAnimations. (This is because at this point, a given
         // joint can have different animated properties with different input time samples).
         std::vector<std::shared_ptr<VROKeyframeAnimation>> animatedChannels;
-        animatedChannels = _nodeKeyFrameAnims[animatedNodeIndexFirst][skeletalAnimationIndex];
+        animatedChannels = context.nodeKeyFrameAnims[animatedNodeIndexFirst][skeletalAnimationIndex];
 
         // If there are no animations for the root node, keep iterating until we find one.
         // We are assuming here that the animation for this skinner has the same
@@ -796,7 +930,7 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
         if (animatedChannels.size() == 0) {
             std::vector<int> intersectingAnimatedJoints = animToSkinToNodePair.second.second;
             for (auto jointIndex : intersectingAnimatedJoints) {
-                animatedChannels = _nodeKeyFrameAnims[jointIndex][skeletalAnimationIndex];
+                animatedChannels = context.nodeKeyFrameAnims[jointIndex][skeletalAnimationIndex];
                 if (animatedChannels.size() != 0) {
                     break;
                 }
@@ -833,11 +967,11 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
         }
 
         // Then iterate through each frame and populate them with the computed transform for each joint/bone.
-        std::shared_ptr<VROSkeleton> currentSkeleton = _skinIndexToSkeleton[skinIndex];
-        std::shared_ptr<VROSkinner> currentSkinner = _skinMap[skinIndex];
+        std::shared_ptr<VROSkeleton> currentSkeleton = context.skinIndexToSkeleton[skinIndex];
+        std::shared_ptr<VROSkinner> currentSkinner = context.skinMap[skinIndex];
         for (int i = 0; i < frames.size(); i++) {
             std::map<int, VROMatrix4f> computedAnimatedJointTrans;
-            if (!processSkeletalTransformsForFrame(model, skinIndex, skeletalAnimationIndex, channelIndex, i, 0,
+            if (!processSkeletalTransformsForFrame(context, model, skinIndex, skeletalAnimationIndex, channelIndex, i, 0,
                                                        computedAnimatedJointTrans)) {
                 return false;
             }
@@ -845,7 +979,7 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
             // Then, for each joint, move the transform the computed joint back into bone space
             // and save that into the skeletalFrames for the animation.
             for (int jointI = 0; jointI < computedAnimatedJointTrans.size(); jointI++) {
-                VROMatrix4f invBind = _skinMap[skinIndex]->getSkeleton()->getBone(jointI)->getBindTransform();
+                VROMatrix4f invBind = context.skinMap[skinIndex]->getSkeleton()->getBone(jointI)->getBindTransform();
                 VROMatrix4f computedAnimatedBoneTrans = invBind.multiply(computedAnimatedJointTrans[jointI]);
                 skeletalFrames[i]->boneIndices.push_back(jointI);
                 skeletalFrames[i]->boneTransforms.push_back(computedAnimatedBoneTrans);
@@ -856,13 +990,13 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
         std::shared_ptr<VROSkeletalAnimation> skeletalAnimation
                 = std::make_shared<VROSkeletalAnimation>(currentSkinner, skeletalFrames, totalDuration);
         skeletalAnimation->setName(keyFrameAnim->getName());
-        _skinSkeletalAnims[skinIndex].push_back(skeletalAnimation);
+        context.skinSkeletalAnims[skinIndex].push_back(skeletalAnimation);
 
         // Remove any KeyFrameAnimations that were "turned into" and used for skeletal animations.
         // If an animation is on a skinner node, it is always treated as a skeletal animation.
-        for (auto &jointNode : _skinIndexToJointNodeIndex[skinIndex]) {
+        for (auto &jointNode : context.skinIndexToJointNodeIndex[skinIndex]) {
             int nodeIndex = jointNode.second;
-            _nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex].clear();
+            context.nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex].clear();
         }
     }
     return true;
@@ -889,7 +1023,8 @@ bool VROGLTFLoader::processSkeletalAnimation(const tinygltf::Model &model,
    one is used.
 
  */
-void VROGLTFLoader::flattenSkeletalKeyframeAnimations(std::map<int, std::pair<int, std::vector<int>>> &skeletalAnimToNodeSkinPair) {
+void VROGLTFLoader::flattenSkeletalKeyframeAnimations(VROGLTFLoadContext &context,
+                                                      std::map<int, std::pair<int, std::vector<int>>> &skeletalAnimToNodeSkinPair) {
     // Iterate through each skeletal animation and flattern them if possible.
     for (auto &animToSkinToNodePair : skeletalAnimToNodeSkinPair) {
         int skeletalAnimationIndex = animToSkinToNodePair.first;
@@ -903,12 +1038,12 @@ void VROGLTFLoader::flattenSkeletalKeyframeAnimations(std::map<int, std::pair<in
         for (auto &nodeIndex : animToSkinToNodePair.second.second) {
 
             // Skip if there's no animation for this node in the skeleton.
-            if (_nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex].size() == 0) {
+            if (context.nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex].size() == 0) {
                 continue;
             }
 
             // Set the duration and keyframes for this skeletal animation if we haven't yet done so.
-            std::vector<std::shared_ptr<VROKeyframeAnimation>> &keyframeAnimations = _nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex];
+            std::vector<std::shared_ptr<VROKeyframeAnimation>> &keyframeAnimations = context.nodeKeyFrameAnims[nodeIndex][skeletalAnimationIndex];
             if (chosenDuration == -1) {
                 chosenDuration = keyframeAnimations.front()->getDuration();
             }
@@ -986,7 +1121,7 @@ void VROGLTFLoader::flattenSkeletalKeyframeAnimations(std::map<int, std::pair<in
     }
 }
 
-bool VROGLTFLoader::processSkeletalTransformsForFrame(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processSkeletalTransformsForFrame(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                                       int skin,
                                                       int animationIndex,
                                                       int subAnimPropertyIndex,
@@ -994,16 +1129,16 @@ bool VROGLTFLoader::processSkeletalTransformsForFrame(const tinygltf::Model &gMo
                                                       int currentJointIndex,
                                                       std::map<int, VROMatrix4f> &transformsOut) {
     // If we are at the root, process its transform to be cascaded down the model's scene tree.
-    int childNodeIndex = _skinIndexToJointNodeIndex[skin][0];
+    int childNodeIndex = context.skinIndexToJointNodeIndex[skin][0];
 
     if (currentJointIndex == 0) {
-        if (_nodeKeyFrameAnims[childNodeIndex][animationIndex].size() == 0) {
+        if (context.nodeKeyFrameAnims[childNodeIndex][animationIndex].size() == 0) {
 
             // If the there are no animations configured for this bone, simply get the model's
             // original local transform.
             transformsOut[0] = getTransformOfNode(gModel, childNodeIndex);
         } else {
-            std::shared_ptr<VROKeyframeAnimation> animation = _nodeKeyFrameAnims[childNodeIndex][animationIndex].at(subAnimPropertyIndex);
+            std::shared_ptr<VROKeyframeAnimation> animation = context.nodeKeyFrameAnims[childNodeIndex][animationIndex].at(subAnimPropertyIndex);
             const std::vector<std::unique_ptr<VROKeyframeAnimationFrame>> &frames = animation->getFrames();
             VROMatrix4f localTransform;
             localTransform.toIdentity();
@@ -1028,17 +1163,17 @@ bool VROGLTFLoader::processSkeletalTransformsForFrame(const tinygltf::Model &gMo
     VROMatrix4f currentMatrix = transformsOut[currentJointIndex];
 
     // Grab all the child joints for this current joint.
-    std::vector<int> childJoints = _skinIndexToJointChildJoints[skin][currentJointIndex];
+    std::vector<int> childJoints = context.skinIndexToJointChildJoints[skin][currentJointIndex];
     for (int childJointIndex : childJoints) {
         // Get the actual node index for the child joint Index and it's animation to set.
-        int childNodeIndex = _skinIndexToJointNodeIndex[skin][childJointIndex];
+        int childNodeIndex = context.skinIndexToJointNodeIndex[skin][childJointIndex];
 
         VROMatrix4f localTransform = VROMatrix4f::identity();
-        if (_nodeKeyFrameAnims[childNodeIndex][animationIndex].size() == 0) {
+        if (context.nodeKeyFrameAnims[childNodeIndex][animationIndex].size() == 0) {
             localTransform = getTransformOfNode(gModel, childNodeIndex);
         } else {
             // Grab the animation transform of the current keyFrame
-            std::shared_ptr<VROKeyframeAnimation> animation = _nodeKeyFrameAnims[childNodeIndex][animationIndex].at(subAnimPropertyIndex);
+            std::shared_ptr<VROKeyframeAnimation> animation = context.nodeKeyFrameAnims[childNodeIndex][animationIndex].at(subAnimPropertyIndex);
             const std::vector<std::unique_ptr<VROKeyframeAnimationFrame>> &frames = animation->getFrames();
             if (animation->_hasScale) {
                 localTransform.scale(frames[keyFrameTime]->scale.x,
@@ -1059,7 +1194,7 @@ bool VROGLTFLoader::processSkeletalTransformsForFrame(const tinygltf::Model &gMo
         transformsOut[childJointIndex] = computedJointTransformInMeshCoords;
 
         // Continue going down the skeletal tree
-        if (!processSkeletalTransformsForFrame(gModel, skin, animationIndex, subAnimPropertyIndex,
+        if (!processSkeletalTransformsForFrame(context, gModel, skin, animationIndex, subAnimPropertyIndex,
                                                keyFrameTime, childJointIndex, transformsOut)) {
             return false;
         }
@@ -1074,6 +1209,10 @@ void VROGLTFLoader::injectGLTF(std::shared_ptr<VRONode> gltfNode,
                              std::shared_ptr<VRODriver> driver,
                              std::function<void(std::shared_ptr<VRONode> node, bool success)> onFinish) {
     if (gltfNode) {
+        // The tree was built off the rendering thread; restrict it to the rendering thread
+        // again now that it is joining the scene
+        setThreadRestrictionEnabled(gltfNode, true);
+
         // The top-level glTF Node is a dummy; all of the data is stored in the children, so we
         // simply transfer those children over to the destination node
         for (std::shared_ptr<VRONode> child : gltfNode->getChildNodes()) {
@@ -1110,15 +1249,16 @@ void VROGLTFLoader::injectGLTF(std::shared_ptr<VRONode> gltfNode,
     }
 }
 
-bool VROGLTFLoader::processScene(const tinygltf::Model &gModel, std::shared_ptr<VRONode> rootNode, const tinygltf::Scene &gScene,
+bool VROGLTFLoader::processScene(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> rootNode, const tinygltf::Scene &gScene,
                                  std::shared_ptr<VRODriver> driver) {
     std::shared_ptr<VRONode> sceneNode = std::make_shared<VRONode>();
+    sceneNode->setThreadRestrictionEnabled(false);
     sceneNode->setName(gScene.name);
 
     std::vector<int> gNodeIndexes = gScene.nodes;
     for (int gNodeIndex : gNodeIndexes) {
         // Fail fast if we have failed to process a node in the scene.
-        if (!processNode(gModel, sceneNode, gNodeIndex, driver)) {
+        if (!processNode(context, gModel, sceneNode, gNodeIndex, driver)) {
             return false;
         }
     }
@@ -1127,7 +1267,7 @@ bool VROGLTFLoader::processScene(const tinygltf::Model &gModel, std::shared_ptr<
     return true;
 }
 
-bool VROGLTFLoader::processNode(const tinygltf::Model &gModel, std::shared_ptr<VRONode> &parentNode, int gNodeIndex,
+bool VROGLTFLoader::processNode(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> &parentNode, int gNodeIndex,
                                 std::shared_ptr<VRODriver> driver) {
     tinygltf::Node gNode = gModel.nodes[gNodeIndex];
 
@@ -1154,6 +1294,7 @@ bool VROGLTFLoader::processNode(const tinygltf::Model &gModel, std::shared_ptr<V
 
     // Finally set the parsed transforms on VRONode.
     std::shared_ptr<VRONode> node = std::make_shared<VRONode>();
+    node->setThreadRestrictionEnabled(false);
     node->setPosition(pos);
     node->setScale(scale);
     node->setRotation(rot);
@@ -1162,33 +1303,33 @@ bool VROGLTFLoader::processNode(const tinygltf::Model &gModel, std::shared_ptr<V
     // Process the Geometry for this node, if any.
     // Fail fast if we have failed to process the node's mesh.
     int meshIndex = gNode.mesh;
-    if (meshIndex >= 0 && !processMesh(gModel, node, gModel.meshes[meshIndex], driver)) {
+    if (meshIndex >= 0 && !processMesh(context, gModel, node, gModel.meshes[meshIndex], driver)) {
         return false;
     }
 
     // After processing the nodes of this model, process skins if any.
     std::shared_ptr<VROGeometry> geom = node->getGeometry();
     if (geom != nullptr && gNode.skin >=0) {
-        _skinMap[gNode.skin]->setSkinnerNode(node);
-        geom->setSkinner(_skinMap[gNode.skin]);
+        context.skinMap[gNode.skin]->setSkinnerNode(node);
+        geom->setSkinner(context.skinMap[gNode.skin]);
         for (const std::shared_ptr<VROMaterial> &material : geom->getMaterials()) {
             material->addShaderModifier(VROBoneUBO::createSkinningShaderModifier(false));
         }
     }
 
     // Set the animations on this node, if any.
-    if (_nodeKeyFrameAnims.find(gNodeIndex) != _nodeKeyFrameAnims.end()) {
-        for (int i = 0; i < _nodeKeyFrameAnims[gNodeIndex].size(); i ++) {
+    if (context.nodeKeyFrameAnims.find(gNodeIndex) != context.nodeKeyFrameAnims.end()) {
+        for (int i = 0; i < context.nodeKeyFrameAnims[gNodeIndex].size(); i ++) {
             // Add in parallel all animated keyframe properties within this
             // animation, within this node.
-            for (auto anim : _nodeKeyFrameAnims[gNodeIndex][i]) {
+            for (auto anim : context.nodeKeyFrameAnims[gNodeIndex][i]) {
                 node->addAnimation(anim->getName(), anim);
             }
         }
     }
 
-    if (_skinSkeletalAnims.find(gNode.skin) != _skinSkeletalAnims.end()) {
-        for (std::shared_ptr<VROSkeletalAnimation> anim : _skinSkeletalAnims[gNode.skin]){
+    if (context.skinSkeletalAnims.find(gNode.skin) != context.skinSkeletalAnims.end()) {
+        for (std::shared_ptr<VROSkeletalAnimation> anim : context.skinSkeletalAnims[gNode.skin]){
             node->addAnimation(anim->getName(), anim);
         }
     }
@@ -1199,14 +1340,14 @@ bool VROGLTFLoader::processNode(const tinygltf::Model &gModel, std::shared_ptr<V
     std::vector<int> gNodeChildrenIndexes = gNode.children;
     for (int gNodeIndex : gNodeChildrenIndexes) {
         // Fail fast if we have failed to process a node in the scene.
-        if (!processNode(gModel, node, gNodeIndex, driver)) {
+        if (!processNode(context, gModel, node, gNodeIndex, driver)) {
             return false;
         }
     }
     return true;
 }
 
-bool VROGLTFLoader::processSkinnerInverseBindData(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processSkinnerInverseBindData(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                                   const tinygltf::Skin &skin,
                                                   std::vector<VROMatrix4f> &invBindTransformsOut) {
     // Process inverseBind Matrices from the gLTF Accessor
@@ -1232,9 +1373,8 @@ bool VROGLTFLoader::processSkinnerInverseBindData(const tinygltf::Model &gModel,
     size_t dataLength = elementCount * bufferViewStride;
 
     // Now process that buffer to produce the right output data.
-    const tinygltf::Buffer &gBuffer = gModel.buffers[gIndiceBufferView.buffer];
     std::vector<VROMatrix4f> invBindTransforms;
-    VROByteBuffer buffer((char *)gBuffer.data.data() + dataOffset, dataLength, false);
+    VROByteBuffer buffer(getBufferData(context, gIndiceBufferView.buffer) + dataOffset, dataLength, false);
     for (int elementIndex = 0; elementIndex < elementCount; elementIndex++) {
 
         // Set the buffer position to begin at each element index - Ex: Each Mat4.
@@ -1259,7 +1399,7 @@ bool VROGLTFLoader::processSkinnerInverseBindData(const tinygltf::Model &gModel,
     return true;
 }
 
-bool VROGLTFLoader::processMesh(const tinygltf::Model &gModel, std::shared_ptr<VRONode> &rootNode, const tinygltf::Mesh &gMesh,
+bool VROGLTFLoader::processMesh(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> &rootNode, const tinygltf::Mesh &gMesh,
                                 std::shared_ptr<VRODriver> driver) {
     if (gMesh.primitives.size() <=0) {
         perr("GTLF requires mesh data to contain at least one primitive!");
@@ -1277,8 +1417,8 @@ bool VROGLTFLoader::processMesh(const tinygltf::Model &gModel, std::shared_ptr<V
     for (tinygltf::Primitive gPrimitive : gPrimitives) {
 
         // Grab vertex indexing information needed for creating meshes.
-        bool successVertex = processVertexElement(gModel, gPrimitive, elements);
-        bool successAttributes = processVertexAttributes(gModel, gPrimitive.attributes, sources, elements.size() - 1, driver);
+        bool successVertex = processVertexElement(context, gModel, gPrimitive, elements);
+        bool successAttributes = processVertexAttributes(context, gModel, gPrimitive.attributes, sources, elements.size() - 1, driver);
         processTangent(elements, sources, elements.size() - 1);
         
         if (!successVertex || !successAttributes) {
@@ -1291,11 +1431,11 @@ bool VROGLTFLoader::processMesh(const tinygltf::Model &gModel, std::shared_ptr<V
         std::shared_ptr<VROMaterial> material = nullptr;
         if (gMatIndex >= 0) {
             const tinygltf::Material &gMat = gModel.materials[gMatIndex];
-            material = getMaterial(gModel, gMat);
+            material = getMaterial(context, gModel, gMat);
         }
 
         // Process Morph targets for each primitive.
-        if (!processMorphTargets(gModel, gMesh, gPrimitive, material, sources, elements, morphers, driver)) {
+        if (!processMorphTargets(context, gModel, gMesh, gPrimitive, material, sources, elements, morphers, driver)) {
             pwarn("Failed to process morph target for mesh %s.", gMesh.name.c_str());
             return false;
         }
@@ -1307,7 +1447,9 @@ bool VROGLTFLoader::processMesh(const tinygltf::Model &gModel, std::shared_ptr<V
 
     // Apply a default material if none has been specified.
     if (materials.size() == 0) {
-        materials.push_back(std::make_shared<VROMaterial>());
+        std::shared_ptr<VROMaterial> material = std::make_shared<VROMaterial>();
+        material->setThreadRestrictionEnabled(false);
+        materials.push_back(material);
     }
 
     // Finally construct our geometry with the processed vertex and attribute data.
@@ -1515,7 +1657,7 @@ void VROGLTFLoader::regenerateTangent(std::vector<VROVector3f> &posArray,
     delete[] tan1;
 }
 
-bool VROGLTFLoader::processVertexElement(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processVertexElement(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                          const tinygltf::Primitive &gPrimitive,
                                          std::vector<std::shared_ptr<VROGeometryElement>> &elements) {
     // Grab primitive type to be drawn for this geometry.
@@ -1567,10 +1709,7 @@ bool VROGLTFLoader::processVertexElement(const tinygltf::Model &gModel,
     size_t dataLength = elementCount *  bufferViewStride;
 
     // Finally, grab the raw indexed vertex data from the buffer to be created with VROGeometryElement
-    const tinygltf::Buffer &gBuffer = gModel.buffers[gIndiceBufferView.buffer];
-    std::shared_ptr<VROData> data = std::make_shared<VROData>((void *)gBuffer.data.data(),
-                                                              dataLength,
-                                                              dataOffset);
+    std::shared_ptr<VROData> data = getBufferSlice(context, gIndiceBufferView.buffer, dataOffset, dataLength);
     std::shared_ptr<VROGeometryElement> element
             = std::make_shared<VROGeometryElement>(data,
                                                    primitiveType,
@@ -1578,11 +1717,12 @@ bool VROGLTFLoader::processVertexElement(const tinygltf::Model &gModel,
                                                    getComponentTypeSize(gTypeComponent),
                                                    gTypeComponent != GLTFTypeComponent::UnsignedByte &&
                                                    gTypeComponent != GLTFTypeComponent::UnsignedShort);
+    element->setContentKey(VROAssetCache::hash(data->getData(), data->getDataLength()));
     elements.push_back(element);
     return true;
 }
 
-bool VROGLTFLoader::processVertexAttributes(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processVertexAttributes(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                             std::map<std::string, int> &gAttributes,
                                             std::vector<std::shared_ptr<VROGeometrySource>> &sources,
                                             size_t geoElementIndex,
@@ -1625,19 +1765,32 @@ bool VROGLTFLoader::processVertexAttributes(const tinygltf::Model &gModel,
             std::string key = VROStringUtil::toString(gAttributeAccesor.bufferView);
             std::shared_ptr<VROVertexBuffer> vbo;
             
-            auto it = VROGLTFLoader::_dataCache.find(key);
-            if (it == VROGLTFLoader::_dataCache.end()) {
-                const tinygltf::Buffer &gbuffer = gModel.buffers[gIndiceBufferView.buffer];
-                vbo = driver->newVertexBuffer(std::make_shared<VROData>((void *) gbuffer.data.data(), bufferViewTotalSize, bufferViewOffset));
-                VROGLTFLoader::_dataCache[key] = vbo;
+            auto it = context.dataCache.find(key);
+            if (it == context.dataCache.end()) {
+                // Share the vertex buffer with any earlier load of the same data
+                std::shared_ptr<VROData> data = getBufferSlice(context, gIndiceBufferView.buffer, bufferViewOffset, bufferViewTotalSize);
+                uint64_t contentKey = VROAssetCache::hash(data->getData(), data->getDataLength());
+                std::shared_ptr<VROAssetCache> cache = context.assetCache;
+                
+                vbo = cache->getVertexBuffer(contentKey);
+                if (!vbo) {
+                    vbo = driver->newVertexBuffer(data);
+                    
+                    // The slice retains the entire buffer it was cut from, so charge the
+                    // vertex buffer its share of that buffer as well as its own data
+                    int numViews = std::max(1, context.bufferNumViews[gIndiceBufferView.buffer]);
+                    size_t retainedBytes = context.bufferData[gIndiceBufferView.buffer]->getDataLength() / numViews;
+                    cache->putVertexBuffer(contentKey, vbo, data->getDataLength() + retainedBytes);
+                }
+                context.dataCache[key] = vbo;
             } else {
                 vbo = it->second;
             }
             source = buildGeometrySource(attributeType, gType, gTypeComponent, gAttributeAccesor, gIndiceBufferView, vbo);
             
         } else {
-            const tinygltf::Buffer &gBuffer = gModel.buffers[gIndiceBufferView.buffer];
-            source = buildBoneWeightSource(gType, gTypeComponent, gAttributeAccesor, gIndiceBufferView, gBuffer);
+            source = buildBoneWeightSource(gType, gTypeComponent, gAttributeAccesor, gIndiceBufferView,
+                                           getBufferData(context, gIndiceBufferView.buffer));
         }
 
         // Because GLTF can have VROGeometryElements that corresponds to different sets of VROGeometrySources,
@@ -1651,7 +1804,7 @@ bool VROGLTFLoader::processVertexAttributes(const tinygltf::Model &gModel,
     return true;
 }
 
-bool VROGLTFLoader::processMorphTargets(const tinygltf::Model &gModel,
+bool VROGLTFLoader::processMorphTargets(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                         const tinygltf::Mesh &gMesh,
                                         const tinygltf::Primitive &gPrimitive,
                                         std::shared_ptr<VROMaterial> &mat,
@@ -1688,7 +1841,7 @@ bool VROGLTFLoader::processMorphTargets(const tinygltf::Model &gModel,
     for (int targetIndex = 0; targetIndex < gPrimitive.targets.size(); targetIndex ++) {
         std::vector<std::shared_ptr<VROGeometrySource>> morphTargetSources;
         std::map<std::string, int> gAttributes = gPrimitive.targets[targetIndex];
-        if (!processVertexAttributes(gModel, gAttributes, morphTargetSources, elements.size() -1, driver)) {
+        if (!processVertexAttributes(context, gModel, gAttributes, morphTargetSources, elements.size() -1, driver)) {
             pwarn("Invalid Attribute found for morph target!");
             return false;
         }
@@ -1774,7 +1927,7 @@ std::shared_ptr<VROGeometrySource> VROGLTFLoader::buildBoneWeightSource(GLTFType
                                                                         GLTFTypeComponent gTypeComponent,
                                                                         const tinygltf::Accessor &gAttributeAccesor,
                                                                         const tinygltf::BufferView &gIndiceBufferView,
-                                                                        const tinygltf::Buffer &gbuffer) {
+                                                                        const char *bufferData) {
     bool isFloat = gTypeComponent == GLTFTypeComponent::Float;
     size_t bufferViewOffset = gIndiceBufferView.byteOffset;
     size_t bufferViewTotalSize = gIndiceBufferView.byteLength;
@@ -1788,7 +1941,7 @@ std::shared_ptr<VROGeometrySource> VROGLTFLoader::buildBoneWeightSource(GLTFType
     
     // gLTF requires the manual normalization of weighted bone attributes. As such,
     // we process them here before constructing our VROGeometrySource.
-    VROByteBuffer buffer((char *) gbuffer.data.data() + bufferViewOffset, bufferViewTotalSize, false);
+    VROByteBuffer buffer(bufferData + bufferViewOffset, bufferViewTotalSize, false);
     
     // Parse the gLTF buffers for the weight of each bone and normalize them.
     // The normalized data is stored in dataOut.
@@ -1841,21 +1994,30 @@ std::shared_ptr<VROGeometrySource> VROGLTFLoader::buildBoneWeightSource(GLTFType
                                                sizeOfSingleBoneWeight);
 }
 
-std::shared_ptr<VROMaterial> VROGLTFLoader::getMaterial(const tinygltf::Model &gModel, const tinygltf::Material &gMat) {
+std::shared_ptr<VROMaterial> VROGLTFLoader::getMaterial(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Material &gMat) {
+    std::shared_ptr<VROAssetCache> cache = context.assetCache;
+    uint64_t materialKey = getMaterialKey(context, gModel, gMat);
+    std::shared_ptr<VROMaterial> cached = cache->getMaterial(materialKey);
+    if (cached) {
+        cached->setThreadRestrictionEnabled(false);
+        return cached;
+    }
+    
     std::shared_ptr<VROMaterial> vroMat = std::make_shared<VROMaterial>();
+    vroMat->setThreadRestrictionEnabled(false);
     tinygltf::ParameterMap gAdditionalMap = gMat.additionalValues;
 
     // Process PBR values from the given tinyGLTF material into our VROMaterial, if any.
-    processPBR(gModel, vroMat, gMat);
+    processPBR(context, gModel, vroMat, gMat);
 
     // Process Normal textures
-    std::shared_ptr<VROTexture> normalTexture = getTexture(gModel, gAdditionalMap, "normalTexture", false);
+    std::shared_ptr<VROTexture> normalTexture = getTexture(context, gModel, gAdditionalMap, "normalTexture", false);
     if (normalTexture != nullptr) {
         vroMat->getNormal().setTexture(normalTexture);
     }
 
     // Process Occlusion Textures
-    std::shared_ptr<VROTexture> occlusionTexture = getTexture(gModel, gAdditionalMap, "occlusionTexture", false);
+    std::shared_ptr<VROTexture> occlusionTexture = getTexture(context, gModel, gAdditionalMap, "occlusionTexture", false);
     if (occlusionTexture != nullptr) {
         vroMat->getAmbientOcclusion().setTexture(occlusionTexture);
     }
@@ -1877,10 +2039,11 @@ std::shared_ptr<VROMaterial> VROGLTFLoader::getMaterial(const tinygltf::Model &g
 
     // TODO VIRO-3683: Implement GLTF Emissive Maps
     vroMat->setName(gMat.name);
+    cache->putMaterial(materialKey, vroMat);
     return vroMat;
 }
 
-void VROGLTFLoader::processPBR(const tinygltf::Model &gModel, std::shared_ptr<VROMaterial> &vroMat, const tinygltf::Material &gMat) {
+void VROGLTFLoader::processPBR(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VROMaterial> &vroMat, const tinygltf::Material &gMat) {
     std::map<std::string, tinygltf::Parameter> gPbrMap = gMat.pbrValues;
     if (gPbrMap.size() <= 0) {
         vroMat->setLightingModel(VROLightingModel::Lambert);
@@ -1911,7 +2074,7 @@ void VROGLTFLoader::processPBR(const tinygltf::Model &gModel, std::shared_ptr<VR
 
     // Process a metallic / roughness texture if any, where metalness values are sampled from the
     // B channel and roughness values are sampled from the G channel.
-    std::shared_ptr<VROTexture> metallicRoughnessTexture = getTexture(gModel, gPbrMap, "metallicRoughnessTexture", false);
+    std::shared_ptr<VROTexture> metallicRoughnessTexture = getTexture(context, gModel, gPbrMap, "metallicRoughnessTexture", false);
     if (metallicRoughnessTexture != nullptr) {
         vroMat->getMetalness().setTexture(metallicRoughnessTexture);
         vroMat->getRoughness().setTexture(metallicRoughnessTexture);
@@ -1922,14 +2085,14 @@ void VROGLTFLoader::processPBR(const tinygltf::Model &gModel, std::shared_ptr<VR
     }
 
     // Grab the base color texture in sRGB space.
-    std::shared_ptr<VROTexture> baseColorTexture = getTexture(gModel, gPbrMap, "baseColorTexture", true);
+    std::shared_ptr<VROTexture> baseColorTexture = getTexture(context, gModel, gPbrMap, "baseColorTexture", true);
     if (baseColorTexture != nullptr) {
         vroMat->getDiffuse().setTexture(baseColorTexture);
     }
     vroMat->setLightingModel(VROLightingModel::PhysicallyBased);
 }
 
-std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(const tinygltf::Model &gModel, std::map<std::string, tinygltf::Parameter> gPropMap,
+std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::map<std::string, tinygltf::Parameter> gPropMap,
                                                       std::string targetedTextureName, bool srgb) {
     if (gPropMap.find(targetedTextureName) == gPropMap.end()) {
         return nullptr;
@@ -1941,10 +2104,10 @@ std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(const tinygltf::Model &gMo
     }
 
     tinygltf::Texture gTexture = gModel.textures[index];
-    return getTexture(gModel, gTexture, srgb);
+    return getTexture(context, gModel, gTexture, srgb);
 }
 
-std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(const tinygltf::Model &gModel, const tinygltf::Texture &gTexture, bool srgb){
+std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Texture &gTexture, bool srgb){
     std::shared_ptr<VROTexture> texture = nullptr;
     int imageIndex = gTexture.source;
     if (imageIndex < 0){
@@ -1952,19 +2115,24 @@ std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(const tinygltf::Model &gMo
         return nullptr;
     }
 
-    // Return the texture if we had already previously processed and cached this image.
-    if (VROGLTFLoader::_textureCache.find(VROStringUtil::toString(imageIndex)) != VROGLTFLoader::_textureCache.end()){
-        std::string key = VROStringUtil::toString(imageIndex);
-        return VROGLTFLoader::_textureCache[key];
+    // Return the texture if we had already previously processed and cached this image
+    // with the same sampler and color space, in this load or an earlier one.
+    uint64_t textureKey = getTextureKey(context, gModel, gTexture, srgb);
+    auto cached = context.textureCache.find(textureKey);
+    if (textureKey != 0 && cached != context.textureCache.end()) {
+        return cached->second;
     }
 
     // Grab the GLTF image data of for this texture.
     tinygltf::Image gImg = gModel.images[imageIndex];
     std::string imgName = gImg.name;
 
-    // Decode the GLTF image data / raw bytes into a VROImage data.
-    std::vector<unsigned char> data = gImg.rawByteVec;
-    std::shared_ptr<VROImage> image = VROPlatformLoadImageWithBufferedData(data, VROTextureInternalFormat::RGBA8);
+    // Wait for the GLTF image data / raw bytes to be decoded into a VROImage.
+    std::shared_ptr<VROImage> image;
+    auto decode = context.imageDecodes.find(imageIndex);
+    if (decode != context.imageDecodes.end()) {
+        image = decode->second.get();
+    }
     if (image == nullptr){
         perr("Error when parsing texture for image %s.", imgName.c_str());
         return nullptr;
@@ -1986,12 +2154,61 @@ std::shared_ptr<VROTexture> VROGLTFLoader::getTexture(const tinygltf::Model &gMo
         texture->setMinificationFilter(VROFilterMode::Linear);
     }
 
-    // Cache a copy of the created texture as other elements may also refer to it.
-    std::string key = VROStringUtil::toString(imageIndex);
-    VROGLTFLoader::_textureCache[key] = texture;
+    // Cache a copy of the created texture as other elements, and other models, may also refer to it.
+    if (textureKey != 0) {
+        context.textureCache[textureKey] = texture;
+        context.assetCache->putTexture(textureKey, texture,
+                                VROAssetCache::estimateTextureBytes(image->getWidth(), image->getHeight(),
+                                                                    image->getMipSizes()));
+    }
     return texture;
 }
 
+uint64_t VROGLTFLoader::getTextureKey(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Texture &gTexture, bool srgb) {
+    auto it = context.imageKeys.find(gTexture.source);
+    if (it == context.imageKeys.end()) {
+        return 0;
+    }
+    uint64_t key = VROAssetCache::combine(it->second, srgb);
+    if (gTexture.sampler >= 0) {
+        const tinygltf::Sampler &sampler = gModel.samplers[gTexture.sampler];
+        key = VROAssetCache::combine(key, sampler.wrapS);
+        key = VROAssetCache::combine(key, sampler.wrapT);
+        key = VROAssetCache::combine(key, sampler.magFilter);
+        key = VROAssetCache::combine(key, sampler.minFilter);
+    }
+    return key;
+}
+
+uint64_t VROGLTFLoader::getMaterialKey(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Material &gMat) {
+    // Hash every parameter of the material, with textures identified by content instead
+    // of by their index in this model
+    uint64_t key = VROAssetCache::hash(gMat.name.data(), gMat.name.size());
+    for (const tinygltf::ParameterMap *map : { &gMat.pbrValues, &gMat.additionalValues }) {
+        key = VROAssetCache::combine(key, map->size());
+        for (auto &kv : *map) {
+            const tinygltf::Parameter &parameter = kv.second;
+            key = VROAssetCache::combine(key, VROAssetCache::hash(kv.first.data(), kv.first.size()));
+            key = VROAssetCache::combine(key, VROAssetCache::hash(parameter.string_value.data(), parameter.string_value.size()));
+            key = VROAssetCache::combine(key, VROAssetCache::hash(parameter.number_array.data(),
+                                                                  parameter.number_array.size() * sizeof(double)));
+            for (auto &value : parameter.json_double_value) {
+                key = VROAssetCache::combine(key, VROAssetCache::hash(value.first.data(), value.first.size()));
+                if (value.first == "index") {
+                    int textureIndex = (int) value.second;
+                    if (textureIndex >= 0 && textureIndex < (int) gModel.textures.size()) {
+                        key = VROAssetCache::combine(key, getTextureKey(context, gModel, gModel.textures[textureIndex],
+                                                                        kv.first == "baseColorTexture"));
+                    }
+                } else {
+                    key = VROAssetCache::combine(key, VROAssetCache::hash(&value.second, sizeof(double)));
+                }
+            }
+        }
+    }
+    return key;
+}
+
 VROMatrix4f VROGLTFLoader::getTransformOfNode(const tinygltf::Model &gModel, int nodeIndex) {
     tinygltf::Node gNode = gModel.nodes[nodeIndex];
 
@@ -32,6 +32,7 @@
 #include <map>
 #include <functional>
 #include <set>
+#include <future>
 #include "VROGeometrySource.h"
 #include "VROGeometryElement.h"
 #include "VROMaterial.h"
@@ -42,10 +43,12 @@ class VROMorpher;
 class VRONode;
 class VROVertexBuffer;
 class VROTexture;
+class VROImage;
 class VROGeometry;
 class VROSkinner;
 class VROSkeleton;
 class VROTaskQueue;
+class VROAssetCache;
 class VROSkeletalAnimation;
 class VROKeyframeAnimation;
 class VROKeyframeAnimationFrame;
@@ -94,6 +97,79 @@ enum class GLTFTypeComponent {
     Float
 };
 
+/*
+ The state of a single glTF load, created by VROGLTFLoader::buildGLTF() and passed through
+ each of its processing functions. Nothing here outlives the load, and each load has its
+ own context, so models may be built concurrently on different background threads.
+ */
+struct VROGLTFLoadContext {
+    
+    /*
+     As multiple mesh attributes may point to the same texture or data arrays when loading a
+     GTLF model, we cache them here.
+     */
+    std::map<std::string, std::shared_ptr<VROVertexBuffer>> dataCache;
+    
+    /*
+     Textures of this model, keyed by content (see VROGLTFLoader::getTextureKey()). Populated
+     up front from the VROAssetCache with the textures a previous load already created, and
+     as the rest are created. The content keys of the model's images are stored in imageKeys.
+     */
+    std::map<uint64_t, std::shared_ptr<VROTexture>> textureCache;
+    std::map<int, uint64_t> imageKeys;
+    
+    /*
+     Decodes of the model's images, keyed by image index. All images are submitted to the
+     VROTextureDecodePool at the start of the load so that they decode in parallel while
+     the scene is built; getTexture() then waits on the decode it needs.
+     */
+    std::map<int, std::shared_future<std::shared_ptr<VROImage>>> imageDecodes;
+    
+    /*
+     The model's buffers, indexed as in the model. takeBuffers() moves the storage of each
+     buffer out of the model into its own VROData, so the model itself is released once
+     built. Vertex and index data are slices of these, so geometry references the parsed
+     buffers instead of copying them, and retains only the buffers it uses.
+     */
+    std::vector<std::shared_ptr<VROData>> bufferData;
+    
+    /*
+     The number of buffer views into each buffer. A vertex buffer built from one view keeps
+     the whole buffer alive, so each is charged an equal share of that buffer in the asset
+     cache's budget.
+     */
+    std::vector<int> bufferNumViews;
+    
+    /*
+     The asset cache of the driver the model is being built for.
+     */
+    std::shared_ptr<VROAssetCache> assetCache;
+    
+    /*
+     Maps of skinner indexes to skeletal data, including both joints and affected node
+     indexes. Note that in gLTF, a node can only have one skeletal root joint.
+     
+     skinIndexToJointNodeIndex maps each skinner joint index to its node index (provided
+     by tinygLTF), and skinIndexToJointChildJoints maps each joint index to its child
+     joint indexes (not nodes). Note the first joint index at 0 is not necessarily the
+     root joint; this is only the order in which the inverse bind data is provided in the
+     gLTF JSON structure.
+     */
+    std::map<int, std::shared_ptr<VROSkeleton>> skinIndexToSkeleton;
+    std::map<int, std::map<int,int>> skinIndexToJointNodeIndex;
+    std::map<int, std::map<int,std::vector<int>>> skinIndexToJointChildJoints;
+    std::map<int, std::shared_ptr<VROSkinner>> skinMap;
+    std::map<int, int> skinIndexToSkeletonRootJoint;
+    
+    /*
+     Maps of nodeIndexes to its corresponding animations. Note that nodeKeyFrameAnims is
+     of the form: <nodeIndex , <animationIndex, VROKeyframeAnimation>>>.
+     */
+    std::map<int, std::map<int, std::vector<std::shared_ptr<VROKeyframeAnimation>>>> nodeKeyFrameAnims;
+    std::map<int, std::vector<std::shared_ptr<VROSkeletalAnimation>>> skinSkeletalAnims;
+    
+};
+
 /*
  Handles the loading of a GLTF model that is represented by a given .gltf or .glb file.
  TinyGltf is used to parse raw GTLF data into a tinygltf::Model format, after which we then
@@ -110,17 +186,26 @@ public:
                                      std::function<void(std::shared_ptr<VRONode> node, bool success)> onFinish = nullptr);
 
 private:
+    /*
+     Build the VRONode tree representing the given parsed model, including its
+     skinners and animations. Runs on a background thread: the returned tree is
+     not attached to any scene, and is handed to the rendering thread only once
+     complete. The model's buffers are moved out of it (see takeBuffers()). Returns
+     nullptr on failure.
+     */
+    static std::shared_ptr<VRONode> buildGLTF(std::shared_ptr<tinygltf::Model> gModel, std::shared_ptr<VRODriver> driver);
+
     // Functions for processing basic components required for constructing a 3D Model in Viro.
-    static bool processScene(const tinygltf::Model &gModel, std::shared_ptr<VRONode> rootNode, const tinygltf::Scene &gScene,
+    static bool processScene(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> rootNode, const tinygltf::Scene &gScene,
                              std::shared_ptr<VRODriver> driver);
-    static bool processNode(const tinygltf::Model &gModel, std::shared_ptr<VRONode> &sceneNode, int gNodeIndex,
+    static bool processNode(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> &sceneNode, int gNodeIndex,
                             std::shared_ptr<VRODriver> driver);
-    static bool processMesh(const tinygltf::Model &gModel, std::shared_ptr<VRONode> &node, const tinygltf::Mesh &gMesh,
+    static bool processMesh(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VRONode> &node, const tinygltf::Mesh &gMesh,
                             std::shared_ptr<VRODriver> driver);
     static bool processSkin(const tinygltf::Model &gModel, std::shared_ptr<VRONode> &node, int skinIndex);
-    static bool processVertexElement(const tinygltf::Model &gModel, const tinygltf::Primitive &gPrimitive,
+    static bool processVertexElement(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Primitive &gPrimitive,
                                      std::vector<std::shared_ptr<VROGeometryElement>> &element);
-    static bool processVertexAttributes(const tinygltf::Model &gModel, std::map<std::string, int> &gAttributes,
+    static bool processVertexAttributes(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::map<std::string, int> &gAttributes,
                                         std::vector<std::shared_ptr<VROGeometrySource>> &sources,
                                         size_t geoElementIndex,
                                         std::shared_ptr<VRODriver> driver);
@@ -131,7 +216,7 @@ private:
                                   std::vector<VROVector3f> &texCoordArray,
                                   std::vector<int> &elementIndicesArray,
                                   std::vector<VROVector4f> &generatedTangents);
-    static bool processMorphTargets(const tinygltf::Model &gModel,
+    static bool processMorphTargets(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                     const tinygltf::Mesh &gMesh,
                                     const tinygltf::Primitive &gPrimitive,
                                     std::shared_ptr<VROMaterial> &material,
@@ -155,14 +240,16 @@ private:
                                                                     GLTFTypeComponent gTypeComponent,
                                                                     const tinygltf::Accessor &gAttributeAccesor,
                                                                     const tinygltf::BufferView &gIndiceBufferView,
-                                                                    const tinygltf::Buffer &gbuffer);
+                                                                    const char *bufferData);
 
     // Processing of GTLF Materials and Textures into VROMaterials and VROTextures
-    static std::shared_ptr<VROMaterial> getMaterial(const tinygltf::Model &gModel, const tinygltf::Material &gMat);
-    static std::shared_ptr<VROTexture> getTexture(const  tinygltf::Model &gModel, std::map<std::string, tinygltf::Parameter> gPropMap,
+    static std::shared_ptr<VROMaterial> getMaterial(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Material &gMat);
+    static std::shared_ptr<VROTexture> getTexture(VROGLTFLoadContext &context, const  tinygltf::Model &gModel, std::map<std::string, tinygltf::Parameter> gPropMap,
                                                   std::string targetedTextureName, bool srgb);
-    static std::shared_ptr<VROTexture> getTexture(const tinygltf::Model &gModel, const tinygltf::Texture &texture, bool srgb);
-    static void processPBR(const tinygltf::Model &gModel, std::shared_ptr<VROMaterial> &texture, const tinygltf::Material &gMat);
+    static std::shared_ptr<VROTexture> getTexture(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Texture &texture, bool srgb);
+    static uint64_t getTextureKey(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Texture &texture, bool srgb);
+    static uint64_t getMaterialKey(VROGLTFLoadContext &context, const tinygltf::Model &gModel, const tinygltf::Material &gMat);
+    static void processPBR(VROGLTFLoadContext &context, const tinygltf::Model &gModel, std::shared_ptr<VROMaterial> &texture, const tinygltf::Material &gMat);
 
     // Conversion of GLTF Semantics to VRO Semantics
     static bool getPrimitiveType(int mode, VROGeometryPrimitiveType &type);
@@ -173,60 +260,41 @@ private:
     static VROWrapMode getWrappingMode(int mode);
 
     // Processing of Animation Data
-    static bool processAnimations(const tinygltf::Model &gModel);
-    static bool processKeyFrameAnimations(const tinygltf::Model &gModel,
+    static bool processAnimations(VROGLTFLoadContext &context, const tinygltf::Model &gModel);
+    static bool processKeyFrameAnimations(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                          std::map<int, std::map<int, std::vector<int>>> &gltfAnimatedNodes);
-    static void flattenSkeletalKeyframeAnimations(
+    static void flattenSkeletalKeyframeAnimations(VROGLTFLoadContext &context,
             std::map<int, std::pair<int, std::vector<int>>> &skeletalAnimToNodeSkinPair);
-    static std::shared_ptr<VROKeyframeAnimation> convertChannelToKeyFrameAnimation(
+    static std::shared_ptr<VROKeyframeAnimation> convertChannelToKeyFrameAnimation(VROGLTFLoadContext &context,
                                                   const tinygltf::Model &gModel,
                                                   const tinygltf::Animation &anim,
                                                   int targetedChannel);
-    static bool processRawChannelData(const tinygltf::Model &gModel,
+    static bool processRawChannelData(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                       std::string channelProperty,
                                       int channelTarget,
                                       const tinygltf::AnimationSampler &gChannelSampler,
                                       std::vector<std::unique_ptr<VROKeyframeAnimationFrame>> &framesOut);
-    static bool processSkeletalAnimation(const tinygltf::Model &gModel,
+    static bool processSkeletalAnimation(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                          std::map<int, std::pair<int, std::vector<int>>> &skeletalAnimToSkinToNodeMap);
-    static bool processSkeletalTransformsForFrame(const tinygltf::Model &gModel,
+    static bool processSkeletalTransformsForFrame(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                                   int skin,
                                                   int animation,
                                                   int subAnimPropertyIndex,
                                                   int keyFrameIndex,
                                                   int currentJointIndex,
                                                   std::map<int, VROMatrix4f> &transforms);
-    static bool processSkinner(const tinygltf::Model &gModel);
-    static bool processSkinnerInverseBindData(const tinygltf::Model &gModel,
+    static bool processSkinner(VROGLTFLoadContext &context, const tinygltf::Model &gModel);
+    static bool processSkinnerInverseBindData(VROGLTFLoadContext &context, const tinygltf::Model &gModel,
                                               const tinygltf::Skin &skin,
                                               std::vector<VROMatrix4f> &invBindTransformsOut);
-    static void clearCachedData();
-
-    /*
-     As multiple mesh attributes may point to the same texture or data arrays when loading a
-     GTLF model, we cache them here during loadGLTFFromResource(), and clear them out after.
-     */
-    static std::map<std::string, std::shared_ptr<VROVertexBuffer>> _dataCache;
-    static std::map<std::string, std::shared_ptr<VROTexture>> _textureCache;
 
-    /*
-     Cached maps of skinner indexes to skeletal data, including both joints and affected node
-     indexes. Note that in gLTF, a node can only have one skeletal root joint. These caches
-     are cleared out after the parsing of a single gLTF model.
-     */
-    static std::map<int, std::shared_ptr<VROSkeleton>> _skinIndexToSkeleton;
-    static std::map<int, std::map<int,int>> _skinIndexToJointNodeIndex;
-    static std::map<int, std::map<int,std::vector<int>>> _skinIndexToJointChildJoints;
-    static std::map<int, std::shared_ptr<VROSkinner>> _skinMap;
-    static std::map<int, int> _skinIndexToSkeletonRootJoint;
-
-    /*
-     Cached maps of nodeIndexes to it's corresponding animations. These caches are cleared
-     out after the parsing of a single gLTF model. Note that _nodeKeyFrameAnims is of the form:
-     <nodeIndex , <animationIndex, VROKeyframeAnimation>>> _nodeKeyframeAnims.
-     */
-    static std::map<int, std::map<int, std::vector<std::shared_ptr<VROKeyframeAnimation>>>> _nodeKeyFrameAnims;
-    static std::map<int, std::vector<std::shared_ptr<VROSkeletalAnimation>>> _skinSkeletalAnims;
+    // Ownership of the model's buffers and images, and thread restriction of the built nodes
+    static void takeBuffers(VROGLTFLoadContext &context, tinygltf::Model &gModel);
+    static std::shared_ptr<VROData> getBufferSlice(VROGLTFLoadContext &context, int bufferIndex, size_t byteOffset, size_t byteLength);
+    static const char *getBufferData(VROGLTFLoadContext &context, int bufferIndex);
+    static void decodeImages(VROGLTFLoadContext &context, const tinygltf::Model &gModel);
+    static void waitForImageDecodes(VROGLTFLoadContext &context);
+    static void setThreadRestrictionEnabled(std::shared_ptr<VRONode> node, bool enabled);
 
     /*
      Returns the local transform of the node index retried from the gltf model.
@@ -35,6 +35,8 @@
 #include "VROMaterial.h"
 #include "VRORenderMetadata.h"
 #include "VROMorpher.h"
+#include "VROTriangleBVH.h"
+#include "VROAssetCache.h"
 
 VROGeometry::~VROGeometry() {
     delete (_substrate);
@@ -67,6 +69,21 @@ void VROGeometry::render(int elementIndex,
     }
 }
 
+void VROGeometry::renderInstanced(int elementIndex,
+                                  const std::shared_ptr<VROMaterial> &material,
+                                  const VROMatrix4f *transforms,
+                                  const VROMatrix4f *normalMatrices,
+                                  int count,
+                                  float opacity,
+                                  const VRORenderContext &context,
+                                  std::shared_ptr<VRODriver> &driver) {
+    prewarm(driver);
+    if (_substrate) {
+        _substrate->renderInstanced(*this, elementIndex, transforms, normalMatrices, count,
+                                    opacity, material, context, driver);
+    }
+}
+
 void VROGeometry::renderSilhouette(VROMatrix4f transform,
                                    std::shared_ptr<VROMaterial> &material,
                                    const VRORenderContext &context,
@@ -88,14 +105,23 @@ void VROGeometry::renderSilhouetteTextured(int element,
     }
 }
 
-void VROGeometry::updateSortKeys(VRONode *node, uint32_t hierarchyId, uint32_t hierarchyDepth,
+void VROGeometry::updateSortKeys(VRONode *node, VROSortKeyCache *sortKeys,
+                                 uint32_t hierarchyId, uint32_t hierarchyDepth,
                                  uint32_t lightsHash, const std::vector<std::shared_ptr<VROLight>> &lights,
                                  float opacity, float distanceFromCamera, float zFar,
                                  std::shared_ptr<VRORenderMetadata> &metadata,
                                  const VRORenderContext &context,
                                  std::shared_ptr<VRODriver> &driver) {
-    _sortKeys.clear();
-
+    /*
+     The shader chosen for each material depends only on the material and these
+     lighting capabilities, so if neither has changed since the last frame the
+     material's portion of each key can be reused.
+     */
+    VROLightingShaderCapabilities capabilities = VROShaderCapabilities::deriveLightingCapabilitiesKey(lights, context);
+    bool capabilitiesChanged = capabilities != sortKeys->capabilities;
+    sortKeys->capabilities = capabilities;
+    
+    size_t numKeys = 0;
     size_t numElements = _geometryElements.size();
     for (size_t i = 0; i < numElements; i++) {
         int materialIndex = i % (int) _materials.size();
@@ -110,21 +136,21 @@ void VROGeometry::updateSortKeys(VRONode *node, uint32_t hierarchyId, uint32_t h
         key.distanceFromCamera = zFar - distanceFromCamera;
         
         std::shared_ptr<VROMaterial> &material = _materials[materialIndex];
-        material->updateSortKey(key, lights, context, driver);
+        updateMaterialSortKey(key, numKeys, material, *sortKeys, capabilitiesChanged, lights, context, driver);
 
-        key.transparent = (node->getOpacity() < (1 - kEpsilon) ||
+        key.transparent = (opacity < (1 - kEpsilon) ||
                            material->getTransparency() < (1 - kEpsilon) ||
                            material->hasDiffuseAlpha());
         key.incoming = true;
         
-        _sortKeys.push_back(key);
+        storeSortKey(key, numKeys++, material, sortKeys);
         
         const std::shared_ptr<VROMaterial> &outgoing = material->getOutgoing();
         if (outgoing) {
-            outgoing->updateSortKey(key, lights, context, driver);
+            updateMaterialSortKey(key, numKeys, outgoing, *sortKeys, capabilitiesChanged, lights, context, driver);
             key.incoming = false;
             
-            _sortKeys.push_back(key);
+            storeSortKey(key, numKeys++, outgoing, sortKeys);
         }
         
         if (material->isBloomSupported()) {
@@ -135,6 +161,8 @@ void VROGeometry::updateSortKeys(VRONode *node, uint32_t hierarchyId, uint32_t h
             metadata->setRequiresPostProcessMaskPass(true);
         }
     }
+    sortKeys->keys.resize(numKeys);
+    sortKeys->versions.resize(numKeys);
     
     if (_substrate) {
         bool updatedMorphSources = false;
@@ -154,8 +182,107 @@ void VROGeometry::updateSortKeys(VRONode *node, uint32_t hierarchyId, uint32_t h
     }
 }
 
-void VROGeometry::getSortKeys(std::vector<VROSortKey> *outKeys) {
-    outKeys->insert(outKeys->end(), _sortKeys.begin(), _sortKeys.end());
+void VROGeometry::updateMaterialSortKey(VROSortKey &key, size_t index, const std::shared_ptr<VROMaterial> &material,
+                                        const VROSortKeyCache &sortKeys, bool capabilitiesChanged,
+                                        const std::vector<std::shared_ptr<VROLight>> &lights,
+                                        const VRORenderContext &context,
+                                        std::shared_ptr<VRODriver> &driver) {
+    /*
+     Sort key versions are unique across materials, so a matching version means
+     the cached key at this index was produced by this same material, in its
+     current state. A material without a substrate has changed but has not yet
+     been rebuilt, so it must be queried.
+     */
+    if (!capabilitiesChanged && index < sortKeys.versions.size() &&
+        sortKeys.versions[index] == material->getSortKeyVersion() && !material->isUpdated()) {
+        
+        const VROSortKey &cached = sortKeys.keys[index];
+        key.material = cached.material;
+        key.materialRenderingOrder = cached.materialRenderingOrder;
+        key.shader = cached.shader;
+        key.textures = cached.textures;
+    }
+    else {
+        material->updateSortKey(key, lights, context, driver);
+    }
+}
+
+void VROGeometry::storeSortKey(const VROSortKey &key, size_t index, const std::shared_ptr<VROMaterial> &material,
+                               VROSortKeyCache *sortKeys) {
+    if (index < sortKeys->keys.size()) {
+        sortKeys->keys[index] = key;
+        sortKeys->versions[index] = material->getSortKeyVersion();
+    }
+    else {
+        sortKeys->keys.push_back(key);
+        sortKeys->versions.push_back(material->getSortKeyVersion());
+    }
+}
+
+bool VROGeometry::isBatchableWith(const VROGeometry &geometry, int elementIndex) const {
+    if (this == &geometry) {
+        return true;
+    }
+    if (_skinner || geometry._skinner || !_elementsToMorphers.empty() || !geometry._elementsToMorphers.empty() ||
+        _geometrySources.size() != geometry._geometrySources.size() ||
+        elementIndex >= (int) _geometryElements.size() || elementIndex >= (int) geometry._geometryElements.size()) {
+        return false;
+    }
+    
+    // Each source must read the same vertex buffer in the same way
+    for (size_t i = 0; i < _geometrySources.size(); i++) {
+        const VROGeometrySource &source = *_geometrySources[i];
+        const VROGeometrySource &other = *geometry._geometrySources[i];
+        
+        bool sameBuffer = source.getVertexBuffer() ? source.getVertexBuffer() == other.getVertexBuffer() :
+                                                     (source.getData() && source.getData() == other.getData());
+        if (!sameBuffer ||
+            source.getSemantic() != other.getSemantic() ||
+            source.getVertexCount() != other.getVertexCount() ||
+            source.getComponentsPerVertex() != other.getComponentsPerVertex() ||
+            source.getBytesPerComponent() != other.getBytesPerComponent() ||
+            source.isFloatComponents() != other.isFloatComponents() ||
+            source.getDataOffset() != other.getDataOffset() ||
+            source.getDataStride() != other.getDataStride() ||
+            source.getGeometryElementIndex() != other.getGeometryElementIndex()) {
+            return false;
+        }
+    }
+    
+    const VROGeometryElement &element = *_geometryElements[elementIndex];
+    const VROGeometryElement &otherElement = *geometry._geometryElements[elementIndex];
+    if (&element == &otherElement) {
+        return true;
+    }
+    
+    bool sameIndices = (element.getData() && element.getData() == otherElement.getData()) ||
+                       (element.getContentKey() != 0 && element.getContentKey() == otherElement.getContentKey());
+    return sameIndices &&
+           element.getPrimitiveType() == otherElement.getPrimitiveType() &&
+           element.getPrimitiveCount() == otherElement.getPrimitiveCount() &&
+           element.getBytesPerIndex() == otherElement.getBytesPerIndex();
+}
+
+uint64_t VROGeometry::getBatchKey(int elementIndex) const {
+    uint64_t key = 0;
+    if (!_geometrySources.empty()) {
+        const std::shared_ptr<VROGeometrySource> &source = _geometrySources.front();
+        if (source->getVertexBuffer()) {
+            key = (uint64_t) (uintptr_t) source->getVertexBuffer().get();
+        }
+        else {
+            key = (uint64_t) (uintptr_t) source->getData().get();
+        }
+    }
+    if (elementIndex < (int) _geometryElements.size()) {
+        const std::shared_ptr<VROGeometryElement> &element = _geometryElements[elementIndex];
+        uint64_t elementKey = element->getContentKey();
+        if (elementKey == 0) {
+            elementKey = (uint64_t) (uintptr_t) element->getData().get();
+        }
+        key = VROAssetCache::combine(key, elementKey);
+    }
+    return key;
 }
 
 const VROBoundingBox &VROGeometry::getBoundingBox() {
@@ -230,4 +357,16 @@ void VROGeometry::updateSubstrate() {
 
 void VROGeometry::updateBoundingBox(){
     _boundingBoxComputed = false;
+    invalidateTriangleBVH();
+}
+
+std::shared_ptr<VROTriangleBVH> VROGeometry::getTriangleBVH() {
+    if (!_elementsToMorphers.empty()) {
+        return nullptr;
+    }
+    if (!_triangleBVHComputed) {
+        _triangleBVH = VROTriangleBVH::build(*this);
+        _triangleBVHComputed = true;
+    }
+    return _triangleBVH;
 }
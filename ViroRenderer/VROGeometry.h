@@ -36,6 +36,7 @@
 #include "VRORenderContext.h"
 #include "VRODriver.h"
 #include "VROSortKey.h"
+#include "VROShaderCapabilities.h"
 #include "VROBoundingBox.h"
 #include "VROAnimatable.h"
 #include "VROSkinner.h"
@@ -53,6 +54,7 @@ class VROGeometrySubstrate;
 class VROMatrix4f;
 class VROInstancedUBO;
 class VRORenderMetadata;
+class VROTriangleBVH;
 enum class VROGeometrySourceSemantic;
 
 /*
@@ -75,6 +77,7 @@ public:
         _cameraEnclosure(false),
         _screenSpace(false),
         _boundingBoxComputed(false),
+        _triangleBVHComputed(false),
         _substrate(nullptr),
         _instancedUBO(nullptr) {
 
@@ -90,6 +93,7 @@ public:
         _cameraEnclosure(false),
         _screenSpace(false),
         _boundingBoxComputed(false),
+        _triangleBVHComputed(false),
         _substrate(nullptr) {
 
         _bounds = VROBoundingBox();
@@ -102,7 +106,9 @@ public:
      */
     VROGeometry(std::shared_ptr<VROGeometry> geometry) :
         _geometrySources(geometry->_geometrySources),
-        _geometryElements(geometry->_geometryElements) {
+        _geometryElements(geometry->_geometryElements),
+        _triangleBVH(geometry->_triangleBVH),
+        _triangleBVHComputed(geometry->_triangleBVHComputed) {
         
          ALLOCATION_TRACKER_ADD(Geometry, 1);
     }
@@ -134,6 +140,20 @@ public:
                 const VRORenderContext &context,
                 std::shared_ptr<VRODriver> &driver);
     
+    /*
+     Render the given element once for each of the given transforms, using
+     instanced draw calls. Assumes the material's instanced shader and
+     geometry-independent properties have already been bound.
+     */
+    void renderInstanced(int elementIndex,
+                         const std::shared_ptr<VROMaterial> &material,
+                         const VROMatrix4f *transforms,
+                         const VROMatrix4f *normalMatrices,
+                         int count,
+                         float opacity,
+                         const VRORenderContext &context,
+                         std::shared_ptr<VRODriver> &driver);
+    
     /*
      Render the silhouette of the entire geometry (all elements). Renders
      using the given material, which is assumed to already be bound, ignoring
@@ -156,13 +176,32 @@ public:
                                   const VRORenderContext &context,
                                   std::shared_ptr<VRODriver> &driver);
     
-    void updateSortKeys(VRONode *node, uint32_t hierarchyId, uint32_t hierarchyDepth,
+    /*
+     Compute the sort keys for each element of this geometry as rendered by the
+     given node, storing them in the given cache (owned by the node).
+     */
+    void updateSortKeys(VRONode *node, VROSortKeyCache *sortKeys,
+                        uint32_t hierarchyId, uint32_t hierarchyDepth,
                         uint32_t lightsHash, const std::vector<std::shared_ptr<VROLight>> &lights,
                         float opacity, float distanceFromCamera, float zFar,
                         std::shared_ptr<VRORenderMetadata> &metadata,
                         const VRORenderContext &context,
                         std::shared_ptr<VRODriver> &driver);
-    void getSortKeys(std::vector<VROSortKey> *outKeys);
+    
+    /*
+     Returns true if the given element of this geometry and the same element of
+     the given geometry draw identical vertex and index data, so that either may
+     be rendered in place of the other. This holds when the geometries share
+     their vertex buffers, and their index data is shared or has the same
+     content key (see VROGeometryElement::getContentKey()).
+     */
+    bool isBatchableWith(const VROGeometry &geometry, int elementIndex) const;
+    
+    /*
+     Returns a key that is equal for all elements that may be batchable with
+     one another (see isBatchableWith()). Unequal keys are never batchable.
+     */
+    uint64_t getBatchKey(int elementIndex) const;
     
     std::shared_ptr<VROMaterial> &getMaterialForElement(int elementIndex) {
         return _materials[elementIndex % _materials.size()];
@@ -196,6 +235,14 @@ public:
 
     VROVector3f getCenter();
     
+    /*
+     Get the triangle BVH of this geometry, in local space, building it if it has
+     not yet been accessed since the geometry's sources or elements last changed.
+     Returns nullptr for geometries with morph targets (whose vertices change
+     continually) or without triangles.
+     */
+    std::shared_ptr<VROTriangleBVH> getTriangleBVH();
+    
     bool isCameraEnclosure() const {
         return _cameraEnclosure;
     }
@@ -261,10 +308,12 @@ public:
      */
     void setSources(std::vector<std::shared_ptr<VROGeometrySource>> sources) {
         _geometrySources = sources;
+        invalidateTriangleBVH();
         updateSubstrate();
     }
     void setElements(std::vector<std::shared_ptr<VROGeometryElement>> elements) {
         _geometryElements = elements;
+        invalidateTriangleBVH();
         updateSubstrate();
     }
     
@@ -288,11 +337,6 @@ private:
     std::vector<std::shared_ptr<VROGeometrySource>> _geometrySources;
     std::vector<std::shared_ptr<VROGeometryElement>> _geometryElements;
     
-    /*
-     Used for sorting the elements prior to rendering.
-     */
-    std::vector<VROSortKey> _sortKeys;
-    
     /*
      True if this geometry is a camera enclosure, e.g. a skybox. Camera enclosures follow
      the camera and ignore interlens distance (since they generally simulate far away objects).
@@ -317,6 +361,13 @@ private:
      */
     bool _boundingBoxComputed;
     
+    /*
+     Triangle BVH used for hit testing, built lazily. The BVH may be null even
+     when computed, if the geometry has no triangles.
+     */
+    std::shared_ptr<VROTriangleBVH> _triangleBVH;
+    bool _triangleBVHComputed;
+    
     /*
      Representation of this geometry in the underlying graphics library.
      */
@@ -338,6 +389,24 @@ private:
      geometry sources or elements change).
      */
     void updateSubstrate();
+    
+    void invalidateTriangleBVH() {
+        _triangleBVH.reset();
+        _triangleBVHComputed = false;
+    }
+    
+    /*
+     Fill in the material-derived fields of the given key, reusing those of the
+     cached key at the given index when the material is unchanged, and store the
+     finished key at that index.
+     */
+    void updateMaterialSortKey(VROSortKey &key, size_t index, const std::shared_ptr<VROMaterial> &material,
+                               const VROSortKeyCache &sortKeys, bool capabilitiesChanged,
+                               const std::vector<std::shared_ptr<VROLight>> &lights,
+                               const VRORenderContext &context,
+                               std::shared_ptr<VRODriver> &driver);
+    void storeSortKey(const VROSortKey &key, size_t index, const std::shared_ptr<VROMaterial> &material,
+                      VROSortKeyCache *sortKeys);
 
     /*
      If set, this geometry is instanced rendered with the configurations set by this
@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <memory>
 #include <functional>
@@ -61,7 +62,8 @@ public:
         _primitiveCount(primitiveCount),
         _data(data),
         _bytesPerIndex(bytesPerIndex),
-        _signed(isSigned)
+        _signed(isSigned),
+        _contentKey(0)
     {}
 
     // The data, primitive type, primitive count, and bytes per index
@@ -69,7 +71,8 @@ public:
     VROGeometryElement() : _primitiveType(VROGeometryPrimitiveType::Triangle),
                            _primitiveCount(0),
                            _data(nullptr),
-                           _bytesPerIndex(sizeof(int))
+                           _bytesPerIndex(sizeof(int)),
+                           _contentKey(0)
     {}
 
     void setData(std::shared_ptr<VROData> data) {
@@ -100,6 +103,18 @@ public:
         return _bytesPerIndex;
     }
     
+    /*
+     Key identifying the contents of the index data, set by loaders that
+     already key the data for the asset cache. Elements with equal non-zero
+     keys hold identical indices. Zero means the contents are unknown.
+     */
+    void setContentKey(uint64_t key) {
+        _contentKey = key;
+    }
+    uint64_t getContentKey() const {
+        return _contentKey;
+    }
+    
     /*
      Read through the indices in this element, read the corresponding vertices
      from the given geometry source, and invoke the provided function once per
@@ -133,6 +148,11 @@ private:
     int _bytesPerIndex;
     bool _signed;
     
+    /*
+     Key identifying the contents of _data, or zero if unknown.
+     */
+    uint64_t _contentKey;
+    
 };
 
 #endif /* VROGeometryElement_h */
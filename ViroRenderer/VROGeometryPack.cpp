@@ -0,0 +1,218 @@
+//
+//  VROGeometryPack.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/24/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROGeometryPack.h"
+#include "VROMappedFile.h"
+#include "VROData.h"
+#include "VROLog.h"
+#include "VROAssetCache.h"
+#include <zlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+// Deflate the given data, in gzip format if requested (otherwise zlib format)
+static bool deflateData(const std::string &data, bool gzip, std::string *out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    
+    out->resize(deflateBound(&zs, (uLong) data.size()) + (gzip ? 18 : 0));
+    zs.next_in = (Bytef *) data.data();
+    zs.avail_in = (uInt) data.size();
+    zs.next_out = (Bytef *) &(*out)[0];
+    zs.avail_out = (uInt) out->size();
+    
+    int ret = deflate(&zs, Z_FINISH);
+    out->resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+static uint64_t align(uint64_t offset) {
+    return (offset + kGeometryPackAlignment - 1) & ~((uint64_t) kGeometryPackAlignment - 1);
+}
+
+bool VROGeometryPack::isGeometryPack(const std::shared_ptr<VROMappedFile> &file) {
+    return file && file->getLength() >= sizeof(VROGeometryPackHeader) &&
+           memcmp(file->getData(), kGeometryPackMagic, sizeof(kGeometryPackMagic)) == 0;
+}
+
+std::shared_ptr<VROGeometryPack> VROGeometryPack::open(std::shared_ptr<VROMappedFile> file) {
+    if (!isGeometryPack(file)) {
+        return nullptr;
+    }
+    
+    VROGeometryPackHeader header;
+    memcpy(&header, file->getData(), sizeof(header));
+    if (header.version != kGeometryPackVersion) {
+        pwarn("Unsupported geometry pack version %d", header.version);
+        return nullptr;
+    }
+    
+    uint64_t length = file->getLength();
+    uint64_t tableLength = (uint64_t) header.numBlobs * sizeof(VROGeometryPackBlob);
+    if (header.metadataOffset > length || header.metadataLength > length - header.metadataOffset ||
+        header.blobTableOffset > length || tableLength > length - header.blobTableOffset ||
+        header.blobTableOffset % alignof(VROGeometryPackBlob) != 0) {
+        pwarn("Malformed geometry pack: sections out of range");
+        return nullptr;
+    }
+    
+    // Validate every blob up front, so that getBlob() need only check the index
+    const VROGeometryPackBlob *blobs = (const VROGeometryPackBlob *) (file->getData() + header.blobTableOffset);
+    for (uint32_t i = 0; i < header.numBlobs; i++) {
+        const VROGeometryPackBlob &blob = blobs[i];
+        if (blob.offset > length || blob.length > length - blob.offset ||
+            blob.uncompressedLength > INT32_MAX) {
+            pwarn("Malformed geometry pack: blob %d out of range", i);
+            return nullptr;
+        }
+    }
+    return std::make_shared<VROGeometryPack>(file, header);
+}
+
+VROGeometryPack::VROGeometryPack(std::shared_ptr<VROMappedFile> file, const VROGeometryPackHeader &header) :
+    _file(file),
+    _header(header) {
+    _blobs = (const VROGeometryPackBlob *) (file->getData() + header.blobTableOffset);
+}
+
+VROGeometryPack::~VROGeometryPack() {
+    
+}
+
+const uint8_t *VROGeometryPack::getMetadata() const {
+    return _file->getData() + _header.metadataOffset;
+}
+
+std::shared_ptr<VROData> VROGeometryPack::getBlob(int index) const {
+    if (index < 0 || index >= (int) _header.numBlobs) {
+        pwarn("Geometry pack blob %d out of range", index);
+        return nullptr;
+    }
+    
+    const VROGeometryPackBlob &blob = _blobs[index];
+    uint8_t *data = _file->getData() + blob.offset;
+    if (blob.compression == (uint32_t) VROGeometryPackCompression::None) {
+        return std::make_shared<VROData>(data, (size_t) blob.length, _file);
+    }
+    
+    uLongf length = (uLongf) blob.uncompressedLength;
+    void *inflated = malloc(length > 0 ? length : 1);
+    if (uncompress((Bytef *) inflated, &length, data, (uLong) blob.length) != Z_OK ||
+        length != blob.uncompressedLength) {
+        pwarn("Failed to inflate geometry pack blob %d", index);
+        free(inflated);
+        return nullptr;
+    }
+    return std::make_shared<VROData>(inflated, (size_t) length, VRODataOwnership::Move);
+}
+
+uint64_t VROGeometryPack::getBlobKey(int index) const {
+    if (index < 0 || index >= (int) _header.numBlobs) {
+        return 0;
+    }
+    const VROGeometryPackBlob &blob = _blobs[index];
+    uint64_t key = VROAssetCache::combine(_file->getIdentity(), blob.offset);
+    key = VROAssetCache::combine(key, blob.length);
+    return VROAssetCache::combine(key, blob.compression);
+}
+
+bool VROGeometryPack::write(std::string path, const std::string &metadata, bool compressMetadata,
+                            const std::vector<std::string> &blobs, bool compressBlobs) {
+    std::string metadataOut;
+    if (!compressMetadata || !deflateData(metadata, true, &metadataOut)) {
+        metadataOut = metadata;
+        compressMetadata = false;
+    }
+    
+    VROGeometryPackHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kGeometryPackMagic, sizeof(kGeometryPackMagic));
+    header.version = kGeometryPackVersion;
+    header.metadataCompression = (uint32_t) (compressMetadata ? VROGeometryPackCompression::Zlib : VROGeometryPackCompression::None);
+    header.metadataOffset = sizeof(header);
+    header.metadataLength = metadataOut.size();
+    header.blobTableOffset = align(header.metadataOffset + header.metadataLength);
+    header.numBlobs = (uint32_t) blobs.size();
+    
+    // Compress each blob independently, keeping it raw if compression does not help
+    std::vector<std::string> blobsOut(blobs.size());
+    std::vector<VROGeometryPackBlob> table(blobs.size());
+    uint64_t offset = align(header.blobTableOffset + blobs.size() * sizeof(VROGeometryPackBlob));
+    for (size_t i = 0; i < blobs.size(); i++) {
+        VROGeometryPackBlob &entry = table[i];
+        memset(&entry, 0, sizeof(entry));
+        entry.uncompressedLength = blobs[i].size();
+        entry.compression = (uint32_t) VROGeometryPackCompression::None;
+        
+        if (compressBlobs && deflateData(blobs[i], false, &blobsOut[i]) && blobsOut[i].size() < blobs[i].size()) {
+            entry.compression = (uint32_t) VROGeometryPackCompression::Zlib;
+        }
+        entry.offset = offset;
+        entry.length = entry.compression == (uint32_t) VROGeometryPackCompression::None ? blobs[i].size() : blobsOut[i].size();
+        offset = align(offset + entry.length);
+    }
+    
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        pwarn("Failed to open %s to write geometry pack", path.c_str());
+        return false;
+    }
+    
+    static const char padding[kGeometryPackAlignment] = { 0 };
+    auto writeAt = [file] (uint64_t offset, const void *data, size_t length) {
+        long position = ftell(file);
+        if (position < 0 || (uint64_t) position > offset) {
+            return false;
+        }
+        while ((uint64_t) position < offset) {
+            size_t pad = std::min((size_t) (offset - position), sizeof(padding));
+            if (fwrite(padding, 1, pad, file) != pad) {
+                return false;
+            }
+            position += pad;
+        }
+        return length == 0 || fwrite(data, 1, length, file) == length;
+    };
+    
+    bool success = writeAt(0, &header, sizeof(header)) &&
+                   writeAt(header.metadataOffset, metadataOut.data(), metadataOut.size()) &&
+                   writeAt(header.blobTableOffset, table.data(), table.size() * sizeof(VROGeometryPackBlob));
+    for (size_t i = 0; success && i < blobs.size(); i++) {
+        const std::string &data = table[i].compression == (uint32_t) VROGeometryPackCompression::None ? blobs[i] : blobsOut[i];
+        success = writeAt(table[i].offset, data.data(), data.size());
+    }
+    
+    if (fclose(file) != 0 || !success) {
+        pwarn("Failed to write geometry pack to %s", path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,150 @@
+//
+//  VROGeometryPack.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/24/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROGeometryPack_h
+#define VROGeometryPack_h
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class VROData;
+class VROMappedFile;
+
+/*
+ A memory-mappable container for model files, designed so that geometry data can
+ be handed to the renderer without intermediate heap copies. The file consists of:
+ 
+ 1. A header (VROGeometryPackHeader) identifying the file and locating the other
+    sections.
+ 2. A metadata payload: for FBX models, a serialized viro::Node whose geometry
+    data fields have been stripped out. The payload may be gzipped.
+ 3. A table of blobs (VROGeometryPackBlob), one per stripped data field, in the
+    order the loader consumes them.
+ 4. The blobs themselves, each aligned to kGeometryPackAlignment bytes.
+ 
+ Uncompressed blobs are returned as VROData that point directly into the mapped
+ file. Compressed blobs are zlib-compressed individually, so that only one blob
+ at a time needs to be inflated into the heap. All integers are little-endian.
+ */
+static const char kGeometryPackMagic[8] = { 'V', 'R', 'O', 'G', 'P', 'A', 'K', '1' };
+static const uint32_t kGeometryPackVersion = 1;
+static const uint32_t kGeometryPackAlignment = 16;
+
+/*
+ Compression applied to a section of the pack. Compressed metadata uses the gzip
+ wrapper (so it can be read with a gzip stream); compressed blobs use the zlib
+ wrapper.
+ */
+enum class VROGeometryPackCompression : uint32_t {
+    None = 0,
+    Zlib = 1,
+};
+
+struct VROGeometryPackHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t metadataCompression;
+    uint64_t metadataOffset;
+    uint64_t metadataLength;
+    uint64_t blobTableOffset;
+    uint32_t numBlobs;
+    uint32_t reserved;
+};
+
+struct VROGeometryPackBlob {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t uncompressedLength;
+    uint32_t compression;
+    uint32_t reserved;
+};
+
+class VROGeometryPack {
+    
+public:
+    
+    /*
+     Returns true if the given mapped file begins with a geometry pack header.
+     */
+    static bool isGeometryPack(const std::shared_ptr<VROMappedFile> &file);
+    
+    /*
+     Open the geometry pack contained in the given mapped file. Returns nullptr
+     if the pack is malformed.
+     */
+    static std::shared_ptr<VROGeometryPack> open(std::shared_ptr<VROMappedFile> file);
+    
+    /*
+     Write a geometry pack containing the given metadata payload and blobs to the
+     given path. Returns false on failure.
+     */
+    static bool write(std::string path, const std::string &metadata, bool compressMetadata,
+                      const std::vector<std::string> &blobs, bool compressBlobs);
+    
+    VROGeometryPack(std::shared_ptr<VROMappedFile> file, const VROGeometryPackHeader &header);
+    virtual ~VROGeometryPack();
+    
+    /*
+     The metadata payload, pointing into the mapped file. If compressed, the
+     payload is in gzip format.
+     */
+    const uint8_t *getMetadata() const;
+    size_t getMetadataLength() const {
+        return (size_t) _header.metadataLength;
+    }
+    bool isMetadataCompressed() const {
+        return _header.metadataCompression != (uint32_t) VROGeometryPackCompression::None;
+    }
+    
+    int getNumBlobs() const {
+        return (int) _header.numBlobs;
+    }
+    
+    /*
+     Get the blob at the given index. Uncompressed blobs reference the mapped file
+     directly; compressed blobs are inflated into a new allocation. Returns nullptr
+     if the index is out of range or the blob is corrupt.
+     */
+    std::shared_ptr<VROData> getBlob(int index) const;
+    
+    /*
+     Get a key identifying the contents of the blob at the given index, without
+     reading the blob: the identity of the mapped file combined with the blob's
+     location within it. Used to key the blob in VROAssetCache.
+     */
+    uint64_t getBlobKey(int index) const;
+    
+private:
+    
+    std::shared_ptr<VROMappedFile> _file;
+    VROGeometryPackHeader _header;
+    const VROGeometryPackBlob *_blobs;
+    
+};
+
+#endif /* VROGeometryPack_h */
@@ -0,0 +1,179 @@
+//
+//  VROGeometryPackTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/6/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROGeometryPackTest.h"
+#include "VROTestUtil.h"
+#include "VROPortal.h"
+#include "VROFBXLoader.h"
+#include "VROGeometryPack.h"
+#include "VROMappedFile.h"
+#include "VROPlatformUtil.h"
+#include "VROData.h"
+#include "Nodes.pb.h"
+#include <stdlib.h>
+
+VROGeometryPackTest::VROGeometryPackTest() :
+    VRORendererTest(VRORendererTestType::GeometryPack) {
+        
+}
+
+VROGeometryPackTest::~VROGeometryPackTest() {
+    
+}
+
+void VROGeometryPackTest::build(std::shared_ptr<VRORenderer> renderer,
+                                std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                                std::shared_ptr<VRODriver> driver) {
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    std::shared_ptr<VROLight> ambient = std::make_shared<VROLight>(VROLightType::Ambient);
+    ambient->setColor({ 1.0, 1.0, 1.0 });
+    ambient->setIntensity(600);
+    rootNode->addLight(ambient);
+    
+    float vertices[] = { -1, -1, 0,
+                          1, -1, 0,
+                          1,  1, 0,
+                         -1,  1, 0 };
+    uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
+    
+    std::vector<std::string> blobs;
+    blobs.push_back(std::string((const char *) vertices, sizeof(vertices)));
+    blobs.push_back(std::string((const char *) indices, sizeof(indices)));
+    
+    std::string path = getTestDirectory() + "/geometry_pack_test.vgpk";
+    passert_msg(VROFBXLoader::writeFBXGeometryPack(createQuad(blobs[0], blobs[1]), path, false),
+                "Failed to write geometry pack to %s", path.c_str());
+    verifyMappedPack(path, blobs);
+    
+    std::shared_ptr<VRONode> node = std::make_shared<VRONode>();
+    node->setPosition({ 0, 0, -3 });
+    rootNode->addChildNode(node);
+    
+    VROFBXLoader::loadFBXFromResource(path, VROResourceType::LocalFile, node, driver,
+                                      [blobs](std::shared_ptr<VRONode> node, bool success) {
+                                          passert_msg(success, "Failed to load geometry pack");
+                                          passert_msg(node->getChildNodes().size() == 1, "Expected one node loaded from geometry pack");
+                                          
+                                          std::shared_ptr<VROGeometry> geometry = node->getChildNodes().front()->getGeometry();
+                                          passert_msg(geometry != nullptr, "Node loaded from geometry pack has no geometry");
+                                          
+                                          std::shared_ptr<VROData> vertexData = geometry->getGeometrySources().front()->getData();
+                                          std::shared_ptr<VROData> indexData = geometry->getGeometryElements().front()->getData();
+                                          passert_msg(vertexData->getDataLength() == blobs[0].size() &&
+                                                      memcmp(vertexData->getData(), blobs[0].data(), blobs[0].size()) == 0,
+                                                      "Vertex data loaded from geometry pack does not match");
+                                          passert_msg(indexData->getDataLength() == blobs[1].size() &&
+                                                      memcmp(indexData->getData(), blobs[1].data(), blobs[1].size()) == 0,
+                                                      "Index data loaded from geometry pack does not match");
+                                          pinfo("Loaded quad from geometry pack");
+                                      });
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+}
+
+viro::Node VROGeometryPackTest::createQuad(const std::string &vertices, const std::string &indices) {
+    viro::Node root_pb;
+    viro::Node *node_pb = root_pb.add_subnode();
+    node_pb->set_name("Quad");
+    for (int i = 0; i < 3; i++) {
+        node_pb->add_position(0);
+        node_pb->add_scale(1);
+        node_pb->add_rotation(0);
+    }
+    node_pb->set_opacity(1);
+    
+    viro::Node_Geometry *geo_pb = node_pb->mutable_geometry();
+    geo_pb->set_data(vertices);
+    
+    viro::Node_Geometry_Source *source_pb = geo_pb->add_source();
+    source_pb->set_semantic(viro::Node_Geometry_Source_Semantic_Vertex);
+    source_pb->set_vertex_count(4);
+    source_pb->set_float_components(true);
+    source_pb->set_components_per_vertex(3);
+    source_pb->set_bytes_per_component(sizeof(float));
+    source_pb->set_data_offset(0);
+    source_pb->set_data_stride(3 * sizeof(float));
+    
+    viro::Node_Geometry_Element *element_pb = geo_pb->add_element();
+    element_pb->set_data(indices);
+    element_pb->set_primitive(viro::Node_Geometry_Element_Primitive_Triangle);
+    element_pb->set_primitive_count(2);
+    element_pb->set_bytes_per_index(sizeof(uint16_t));
+    
+    viro::Node_Geometry_Material *material_pb = geo_pb->add_material();
+    material_pb->set_lighting_model(viro::Node_Geometry_Material_LightingModel_Constant);
+    material_pb->set_transparency(1);
+    viro::Node_Geometry_Material_Visual *diffuse_pb = material_pb->mutable_diffuse();
+    diffuse_pb->add_color(1);
+    diffuse_pb->add_color(0);
+    diffuse_pb->add_color(0);
+    diffuse_pb->set_intensity(1);
+    
+    return root_pb;
+}
+
+std::string VROGeometryPackTest::getTestDirectory() {
+#if VRO_PLATFORM_ANDROID
+    return VROPlatformGetCacheDirectory();
+#else
+    const char *directory = getenv("TMPDIR");
+    return directory ? std::string(directory) : "/tmp";
+#endif
+}
+
+void VROGeometryPackTest::verifyMappedPack(std::string path, const std::vector<std::string> &blobs) {
+    std::shared_ptr<VROMappedFile> file = VROMappedFile::map(path);
+    passert_msg(file != nullptr, "Failed to map geometry pack %s", path.c_str());
+    
+    std::shared_ptr<VROGeometryPack> pack = VROGeometryPack::open(file);
+    passert_msg(pack != nullptr, "Failed to open geometry pack %s", path.c_str());
+    passert_msg(pack->getNumBlobs() == (int) blobs.size(), "Expected %d blobs in geometry pack, found %d",
+                (int) blobs.size(), pack->getNumBlobs());
+    
+    for (int i = 0; i < (int) blobs.size(); i++) {
+        std::shared_ptr<VROData> blob = pack->getBlob(i);
+        passert_msg(blob->getDataLength() == blobs[i].size() &&
+                    memcmp(blob->getData(), blobs[i].data(), blobs[i].size()) == 0,
+                    "Blob %d of geometry pack does not match the data written", i);
+        
+        // Uncompressed blobs are read in place from the mapping, not copied
+        const uint8_t *data = (const uint8_t *) blob->getData();
+        passert_msg(data >= file->getData() && data + blob->getDataLength() <= file->getData() + file->getLength(),
+                    "Blob %d of geometry pack was copied out of the mapped file", i);
+    }
+    pinfo("Verified %d blobs of mapped geometry pack", pack->getNumBlobs());
+}
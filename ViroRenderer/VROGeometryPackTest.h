@@ -0,0 +1,82 @@
+//
+//  VROGeometryPackTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/6/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROGeometryPackTest_h
+#define VROGeometryPackTest_h
+
+#include "VRORendererTest.h"
+
+namespace viro {
+    class Node;
+}
+
+/*
+ Verifies the write -> mmap -> read round trip of FBX geometry packs. Builds a small
+ FBX protobuf (a quad), writes it as a geometry pack, and checks that the mapped pack
+ returns each geometry blob in place, byte for byte. The pack is then loaded through
+ VROFBXLoader, and the loaded geometry is checked against the original data and
+ rendered.
+ */
+class VROGeometryPackTest : public VRORendererTest {
+public:
+    
+    VROGeometryPackTest();
+    virtual ~VROGeometryPackTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    
+    /*
+     Build the FBX protobuf for a quad with the given vertex and index data.
+     */
+    static viro::Node createQuad(const std::string &vertices, const std::string &indices);
+    
+    /*
+     Directory in which the test writes its pack.
+     */
+    static std::string getTestDirectory();
+    
+    /*
+     Map the pack at the given path and verify its blobs against the given data.
+     */
+    static void verifyMappedPack(std::string path, const std::vector<std::string> &blobs);
+    
+};
+
+#endif /* VROGeometryPackTest_h */
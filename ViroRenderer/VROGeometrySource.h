@@ -162,7 +162,7 @@ public:
     void setGeometryElementIndex(int i) {
         _geoElementIndex = i;
     }
-    int getGeometryElementIndex() {
+    int getGeometryElementIndex() const {
         return _geoElementIndex;
     }
     
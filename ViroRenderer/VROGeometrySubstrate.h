@@ -70,6 +70,21 @@ public:
                         const VRORenderContext &context,
                         std::shared_ptr<VRODriver> &driver) = 0;
     
+    /*
+     Render the given element of the geometry once for each of the given
+     transforms, using instanced draw calls. Assumes the material's instanced
+     shader and geometry-independent properties have already been bound.
+     */
+    virtual void renderInstanced(const VROGeometry &geometry,
+                                 int elementIndex,
+                                 const VROMatrix4f *transforms,
+                                 const VROMatrix4f *normalMatrices,
+                                 int count,
+                                 float opacity,
+                                 const std::shared_ptr<VROMaterial> &material,
+                                 const VRORenderContext &context,
+                                 std::shared_ptr<VRODriver> &driver) = 0;
+    
     /*
      Render the silhouette of the entire geometry (all elements). Renders
      using the given material, which is assumed to already be bound, ignoring
@@ -326,17 +326,67 @@ void VROGeometrySubstrateOpenGL::render(const VROGeometry &geometry,
     
     passert (elementIndex < _vaos.size() && elementIndex >= 0);
     GL (glBindVertexArray(_vaos[elementIndex]) );
-    renderMaterial(geometry, material, substrate, element, opacity, context, driver);
+    renderMaterial(geometry, material, substrate, element, opacity, geometry.getInstancedUBO().get(),
+                   context, driver);
     GL (glBindVertexArray(0) );
     
     pglpop();
 }
 
+void VROGeometrySubstrateOpenGL::renderInstanced(const VROGeometry &geometry,
+                                                 int elementIndex,
+                                                 const VROMatrix4f *transforms,
+                                                 const VROMatrix4f *normalMatrices,
+                                                 int count,
+                                                 float opacity,
+                                                 const std::shared_ptr<VROMaterial> &material,
+                                                 const VRORenderContext &context,
+                                                 std::shared_ptr<VRODriver> &driver) {
+    std::shared_ptr<VRODriverOpenGL> driverGL = _driver.lock();
+    if (!driverGL || count <= 0) {
+        return;
+    }
+    
+    VROMatrix4f viewMatrix = context.getViewMatrix();
+    VROMatrix4f projectionMatrix = context.getProjectionMatrix();
+    
+    if (geometry.isCameraEnclosure()) {
+        viewMatrix = context.getEnclosureViewMatrix();
+    }
+    if (geometry.isScreenSpace()) {
+        viewMatrix = VROMatrix4f();
+        projectionMatrix = context.getOrthographicMatrix();
+    }
+    
+    pglpush("Geometry [%s] x %d", geometry.getName().c_str(), count);
+    
+    std::shared_ptr<VROInstanceBatchUBO> instances = driverGL->getInstanceBatchUBO();
+    instances->setInstances(transforms, normalMatrices, count);
+    
+    /*
+     The model and normal matrices are read from the instance UBO by the
+     instancing shader modifier, so the uniforms are bound to identity.
+     */
+    VROGeometryElementOpenGL element = _elements[elementIndex];
+    VROMaterialSubstrateOpenGL *substrate = static_cast<VROMaterialSubstrateOpenGL *>(material->getSubstrate(driver));
+    substrate->bindView(VROMatrix4f::identity(), viewMatrix, projectionMatrix, VROMatrix4f::identity(),
+                        context.getCamera().getPosition(), context.getEyeType());
+    
+    passert (elementIndex < (int) _vaos.size() && elementIndex >= 0);
+    GL (glBindVertexArray(_vaos[elementIndex]) );
+    renderMaterial(geometry, material, substrate, element, opacity, instances.get(), context, driver);
+    GL (glBindVertexArray(0) );
+    
+    instances->setInstances(nullptr, nullptr, 0);
+    pglpop();
+}
+
 void VROGeometrySubstrateOpenGL::renderMaterial(const VROGeometry &geometry,
                                                 const std::shared_ptr<VROMaterial> &material,
                                                 VROMaterialSubstrateOpenGL *substrate,
                                                 VROGeometryElementOpenGL &element,
                                                 float opacity,
+                                                VROInstancedUBO *instancedUBO,
                                                 const VRORenderContext &context,
                                                 std::shared_ptr<VRODriver> &driver) {
     substrate->bindGeometry(opacity, geometry);
@@ -371,7 +421,6 @@ void VROGeometrySubstrateOpenGL::renderMaterial(const VROGeometry &geometry,
         }
     }
 
-    const std::shared_ptr<VROInstancedUBO> &instancedUBO = geometry.getInstancedUBO();
     if (instancedUBO != nullptr) {
         int numberOfDraws = instancedUBO->getNumberOfDrawCalls();
         for (int i = 0; i < numberOfDraws; i++) {
@@ -452,7 +501,8 @@ void VROGeometrySubstrateOpenGL::renderSilhouetteTextured(const VROGeometry &geo
                         context.getCamera().getPosition(), context.getEyeType());
     
     GL( glBindVertexArray(_vaos[elementIndex]) );
-    renderMaterial(geometry, material, substrate, element, 1.0, context, driver);
+    renderMaterial(geometry, material, substrate, element, 1.0, geometry.getInstancedUBO().get(),
+                   context, driver);
     GL( glBindVertexArray(0) );
     
     pglpop();
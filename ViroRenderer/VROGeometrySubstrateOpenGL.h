@@ -38,6 +38,7 @@ class VROGeometrySource;
 class VROGeometryElement;
 class VROMaterialSubstrateOpenGL;
 class VROBoneUBO;
+class VROInstancedUBO;
 enum class VROGeometryPrimitiveType;
 
 struct VROGeometryElementOpenGL {
@@ -82,6 +83,16 @@ public:
                 const VRORenderContext &context,
                 std::shared_ptr<VRODriver> &driver);
     
+    void renderInstanced(const VROGeometry &geometry,
+                         int elementIndex,
+                         const VROMatrix4f *transforms,
+                         const VROMatrix4f *normalMatrices,
+                         int count,
+                         float opacity,
+                         const std::shared_ptr<VROMaterial> &material,
+                         const VRORenderContext &context,
+                         std::shared_ptr<VRODriver> &driver);
+    
     void renderSilhouette(const VROGeometry &geometry,
                           VROMatrix4f transform,
                           std::shared_ptr<VROMaterial> &material,
@@ -155,6 +166,7 @@ private:
                         VROMaterialSubstrateOpenGL *substrate,
                         VROGeometryElementOpenGL &element,
                         float opacity,
+                        VROInstancedUBO *instancedUBO,
                         const VRORenderContext &renderContext,
                         std::shared_ptr<VRODriver> &driver);
     
@@ -28,6 +28,7 @@
 #include "VROLog.h"
 #include "VROTexture.h"
 #include "VROData.h"
+#include "VROJobSystem.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "glm/gtc/packing.hpp"
@@ -37,15 +38,208 @@
 #include <stdint.h>
 #include <iostream>
 #include <array>
+#include <cstring>
+#include <cmath>
+#include <functional>
 
 // Set to true to compress HDR textures into RGB9_E5 format; false to
 // store HDR textures in memory in fully expanded RGB16F.
 static bool kCompressHDR = true;
 
-std::shared_ptr<VROTexture> VROHDRLoader::loadRadianceHDRTexture(std::string hdrPath) {
-    int width, height, n;
+// Number of scanlines decoded per band. Only one band of compressed data is
+// held in memory at a time
+static const int kHDRBandRows = 64;
+
+// Images with fewer pixels than this are decoded on the calling thread alone
+static const int kHDRMinParallelPixels = 1024 * 1024;
+
+// Largest image the streaming decoder will accept (a 16K x 16K equirect)
+static const int64_t kHDRMaxPixels = 16384LL * 16384LL;
+
+// Size of each read from the file
+static const size_t kHDRReadSize = 256 * 1024;
+
+#pragma mark - Radiance Parsing
+
+/*
+ Reads a single header line (without the terminating newline). Returns false
+ at end of file.
+ */
+static bool readHeaderLine(FILE *file, std::string *line) {
+    line->clear();
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (c == '\n') {
+            return true;
+        }
+        line->push_back((char) c);
+    }
+    return !line->empty();
+}
+
+/*
+ Parses the Radiance header, leaving the file positioned at the first
+ scanline. Only the standard top-to-bottom, left-to-right orientation
+ (-Y height +X width) is recognized; anything else is left to stb_image.
+ */
+static bool readHeader(FILE *file, int *width, int *height) {
+    std::string line;
+    if (!readHeaderLine(file, &line) || (line != "#?RADIANCE" && line != "#?RGBE")) {
+        return false;
+    }
+    
+    bool validFormat = false;
+    while (readHeaderLine(file, &line)) {
+        if (line.empty()) {
+            break;
+        }
+        if (line == "FORMAT=32-bit_rle_rgbe") {
+            validFormat = true;
+        }
+    }
+    if (!validFormat || !readHeaderLine(file, &line)) {
+        return false;
+    }
+    
+    char trailing;
+    if (sscanf(line.c_str(), "-Y %d +X %d %c", height, width, &trailing) != 2) {
+        return false;
+    }
+    return *width > 0 && *height > 0 && (int64_t) *width * *height <= kHDRMaxPixels;
+}
+
+/*
+ Returns the number of bytes the scanline starting at the given data occupies,
+ without decoding it; 0 if more data is needed to tell, or -1 if the scanline
+ is corrupt. Scanning is far cheaper than decoding, which lets us find the
+ boundaries of each band's scanlines serially and then decode them in parallel.
+ */
+static int64_t scanScanline(const uint8_t *data, size_t available, int width, bool rle) {
+    if (!rle) {
+        size_t length = (size_t) width * 4;
+        return available >= length ? (int64_t) length : 0;
+    }
+    
+    size_t offset = 4;
+    if (available < offset) {
+        return 0;
+    }
+    if (data[0] != 2 || data[1] != 2 || ((data[2] << 8) | data[3]) != width) {
+        return -1;
+    }
+    for (int k = 0; k < 4; k++) {
+        int filled = 0;
+        while (filled < width) {
+            if (offset >= available) {
+                return 0;
+            }
+            int count = data[offset++];
+            if (count > 128) {
+                count -= 128;
+                offset += 1;
+            }
+            else {
+                offset += count;
+            }
+            if (count == 0 || filled + count > width) {
+                return -1;
+            }
+            filled += count;
+        }
+    }
+    return offset <= available ? (int64_t) offset : 0;
+}
+
+/*
+ Decodes a scanline into interleaved RGBE. The scanline must have been
+ validated by scanScanline().
+ */
+static void decodeScanline(const uint8_t *data, int width, bool rle, uint8_t *rgbe) {
+    if (!rle) {
+        memcpy(rgbe, data, (size_t) width * 4);
+        return;
+    }
+    
+    data += 4;
+    for (int k = 0; k < 4; k++) {
+        uint8_t *out = rgbe + k;
+        uint8_t *end = rgbe + (size_t) width * 4;
+        while (out < end) {
+            int count = *data++;
+            if (count > 128) {
+                uint8_t value = *data++;
+                for (count -= 128; count > 0; count--, out += 4) {
+                    *out = value;
+                }
+            }
+            else {
+                for (; count > 0; count--, out += 4) {
+                    *out = *data++;
+                }
+            }
+        }
+    }
+}
+
+#pragma mark - Packing
+
+/*
+ Converts RGBE pixels directly into RGB9_E5. Both formats use a shared exponent,
+ so this is exact integer manipulation: the 8-bit mantissas widen to 9 bits and
+ the exponent is rebiased. RGBE value = m * 2^(e - 136), and RGB9_E5 value =
+ m * 2^(e - 24), so with 9-bit mantissas m9 = 2m, e5 = e - 113. Exponents outside
+ the RGB9_E5 range flush to zero or saturate.
+ */
+static void packRGB9E5(const uint8_t *rgbe, int numPixels, uint32_t *out) {
+    for (int i = 0; i < numPixels; i++) {
+        uint32_t r = (uint32_t) rgbe[i * 4 + 0] << 1;
+        uint32_t g = (uint32_t) rgbe[i * 4 + 1] << 1;
+        uint32_t b = (uint32_t) rgbe[i * 4 + 2] << 1;
+        int e = (int) rgbe[i * 4 + 3] - 113;
+        
+        if (rgbe[i * 4 + 3] == 0) {
+            r = g = b = 0;
+            e = 0;
+        }
+        else if (e < 0) {
+            int shift = std::min(-e, 10);
+            r >>= shift;
+            g >>= shift;
+            b >>= shift;
+            e = 0;
+        }
+        else if (e > 31) {
+            r = g = b = 511;
+            e = 31;
+        }
+        out[i] = r | (g << 9) | (b << 18) | ((uint32_t) e << 27);
+    }
+}
 
+/*
+ Converts RGBE pixels into RGB floats, matching stb_image's conversion.
+ */
+static void packFloat(const uint8_t *rgbe, int numPixels, const float *exponents, float *out) {
+    for (int i = 0; i < numPixels; i++) {
+        float scale = exponents[rgbe[i * 4 + 3]];
+        out[i * 3 + 0] = rgbe[i * 4 + 0] * scale;
+        out[i * 3 + 1] = rgbe[i * 4 + 1] * scale;
+        out[i * 3 + 2] = rgbe[i * 4 + 2] * scale;
+    }
+}
+
+#pragma mark - Loading
+
+std::shared_ptr<VROTexture> VROHDRLoader::loadRadianceHDRTexture(std::string hdrPath) {
     pinfo("Loading Radiance HDR file [%s]...", hdrPath.c_str());
+    
+    std::shared_ptr<VROTexture> texture = loadRadianceHDRTextureStreaming(hdrPath);
+    if (texture) {
+        return texture;
+    }
+    
+    // Fall back to stb_image for layouts the streaming decoder does not handle
+    int width, height, n;
     float *data = stbi_loadf(hdrPath.c_str(), &width, &height, &n, 0);
     if (data == nullptr) {
         pinfo("Error loading Radiance HDR file");
@@ -55,7 +249,132 @@ std::shared_ptr<VROTexture> VROHDRLoader::loadRadianceHDRTexture(std::string hdr
     pinfo("Load successful [width: %d, height %d, components per pixel %d]", width, height, n);
     
     // Note the data float* will be freed by loadTexture, if necessary
-    std::shared_ptr<VROTexture> texture = loadTexture(data, width, height, n);
+    return loadTexture(data, width, height, n);
+}
+
+std::shared_ptr<VROTexture> VROHDRLoader::loadRadianceHDRTextureStreaming(std::string hdrPath) {
+    FILE *file = fopen(hdrPath.c_str(), "rb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+    
+    int width, height;
+    if (!readHeader(file, &width, &height)) {
+        fclose(file);
+        return nullptr;
+    }
+    
+    /*
+     Scanlines are either all new-style RLE or all flat, as determined by the
+     first scanline (this matches stb_image).
+     */
+    int firstBytes[4];
+    for (int i = 0; i < 4; i++) {
+        firstBytes[i] = fgetc(file);
+    }
+    bool rle = width >= 8 && width < 32768 && firstBytes[0] == 2 && firstBytes[1] == 2 && (firstBytes[2] & 0x80) == 0;
+    if (firstBytes[3] == EOF) {
+        fclose(file);
+        return nullptr;
+    }
+    
+    size_t numPixels = (size_t) width * height;
+    size_t outputStride = kCompressHDR ? sizeof(uint32_t) : 3 * sizeof(float);
+    uint8_t *output = (uint8_t *) malloc(numPixels * outputStride);
+    if (output == nullptr) {
+        fclose(file);
+        return nullptr;
+    }
+    
+    float exponents[256];
+    exponents[0] = 0;
+    for (int e = 1; e < 256; e++) {
+        exponents[e] = ldexpf(1.0f, e - (128 + 8));
+    }
+    
+    std::shared_ptr<VROJobSystem> jobs;
+    if (numPixels >= kHDRMinParallelPixels) {
+        jobs = VROJobSystem::getBackgroundJobSystem();
+    }
+    
+    /*
+     Stream the file a band at a time. For each band we find the extent of each
+     scanline serially, then decode and pack the scanlines in parallel straight
+     into the output. Only the output and one band of compressed data (plus one
+     decoded scanline per thread) are ever resident.
+     */
+    std::vector<uint8_t> buffer(firstBytes, firstBytes + 4);
+    bool eof = false;
+    bool failed = false;
+    std::vector<size_t> offsets;
+    
+    for (int bandStart = 0; bandStart < height && !failed; bandStart += kHDRBandRows) {
+        int bandRows = std::min(kHDRBandRows, height - bandStart);
+        offsets.clear();
+        
+        size_t offset = 0;
+        while ((int) offsets.size() < bandRows) {
+            int64_t length = scanScanline(buffer.data() + offset, buffer.size() - offset, width, rle);
+            if (length > 0) {
+                offsets.push_back(offset);
+                offset += length;
+            }
+            else if (length < 0 || eof) {
+                failed = true;
+                break;
+            }
+            else {
+                size_t size = buffer.size();
+                buffer.resize(size + kHDRReadSize);
+                size_t read = fread(buffer.data() + size, 1, kHDRReadSize, file);
+                buffer.resize(size + read);
+                eof = read < kHDRReadSize;
+            }
+        }
+        if (failed) {
+            break;
+        }
+        
+        std::function<void(int, int)> decodeRows = [&] (int start, int end) {
+            std::vector<uint8_t> rgbe((size_t) width * 4);
+            for (int r = start; r < end; r++) {
+                decodeScanline(buffer.data() + offsets[r], width, rle, rgbe.data());
+                
+                size_t row = (size_t) (bandStart + r) * width;
+                if (kCompressHDR) {
+                    packRGB9E5(rgbe.data(), width, (uint32_t *) output + row);
+                }
+                else {
+                    packFloat(rgbe.data(), width, exponents, (float *) output + row * 3);
+                }
+            }
+        };
+        if (jobs) {
+            jobs->parallelFor(bandRows, 4, decodeRows);
+        }
+        else {
+            decodeRows(0, bandRows);
+        }
+        
+        // Discard the decoded band, keeping any bytes read past its end
+        buffer.erase(buffer.begin(), buffer.begin() + offset);
+    }
+    fclose(file);
+    
+    if (failed) {
+        free (output);
+        return nullptr;
+    }
+    pinfo("Load successful [width: %d, height %d, streamed]", width, height);
+    
+    std::vector<uint32_t> mipSizes;
+    std::shared_ptr<VROData> texData = std::make_shared<VROData>(output, numPixels * outputStride, VRODataOwnership::Move);
+    std::vector<std::shared_ptr<VROData>> dataVec = { texData };
+    
+    VROTextureFormat format = kCompressHDR ? VROTextureFormat::RGB9_E5 : VROTextureFormat::RGB16F;
+    VROTextureInternalFormat internalFormat = kCompressHDR ? VROTextureInternalFormat::RGB9_E5 : VROTextureInternalFormat::RGB16F;
+    std::shared_ptr<VROTexture> texture = std::make_shared<VROTexture>(VROTextureType::Texture2D, format, internalFormat, true,
+                                                                       VROMipmapMode::None, dataVec, width, height, mipSizes);
     return texture;
 }
 
@@ -43,11 +43,22 @@ public:
     /*
      Loads the Radiance HDR texture (.hdr) at the given path. The data will
      be internally stored in RGB9_E5 format.
+     
+     The file is streamed in bands of scanlines, each of which is decoded and
+     packed in parallel directly into the final texture data, so no full-size
+     float intermediate is ever allocated. Files the streaming decoder does
+     not recognize are loaded through stb_image.
      */
     static std::shared_ptr<VROTexture> loadRadianceHDRTexture(std::string hdrPath);
     
 private:
     
+    /*
+     Streaming decoder for standard (-Y +X) Radiance files. Returns nullptr if
+     the file is not in a layout it handles.
+     */
+    static std::shared_ptr<VROTexture> loadRadianceHDRTextureStreaming(std::string hdrPath);
+    
     static std::shared_ptr<VROTexture> loadTexture(float *data, int width, int height,
                                                    int componentsPerPixel);
     
@@ -0,0 +1,706 @@
+//
+//  VROIBLBaker.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/26/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROIBLBaker.h"
+#include "VROTexture.h"
+#include "VROData.h"
+#include "VROVector3f.h"
+#include "VROJobSystem.h"
+#include "VROJenkinsHash.h"
+#include "VROStringUtil.h"
+#include "VROTime.h"
+#include "VROLog.h"
+#include "glm/gtc/packing.hpp"
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <algorithm>
+
+static const uint32_t kIBLCacheVersion = 1;
+
+// Output sizes, matching the render targets of the GPU passes. The prefilter
+// roughness for each mip level matches MAX_REFLECTION_LOD in the PBR shader
+static const int kIrradianceSize = 32;
+static const int kPrefilterSize = 128;
+static const float kMaxReflectionLOD = 4.0;
+static const int kBRDFSize = 128;
+
+// Importance samples per prefiltered and BRDF texel, as in the GPU passes
+static const int kNumSamples = 256;
+
+// The source environment is box filtered down to at most this width before
+// convolution; this is ample resolution for 128x128 prefiltered faces
+static const int kMaxSourceWidth = 1024;
+
+// Rows of cube faces or of the source processed per job
+static const int kRowGrain = 8;
+
+static const float kPI = M_PI;
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t irradianceSize;
+    uint32_t prefilterSize;
+    uint32_t prefilterMips;
+    uint32_t brdfSize;
+    float sh[27];
+} VROIBLCacheHeader;
+
+#pragma mark - Environment Sampling
+
+/*
+ One level of the box filtered pyramid of the equirectangular source, as
+ linear RGB floats. Rows are in texture order (row 0 at v = 0).
+ */
+struct VROIBLEnvironmentLevel {
+    int width;
+    int height;
+    std::vector<float> rgb;
+};
+
+class VROIBLEnvironment {
+public:
+    
+    std::vector<VROIBLEnvironmentLevel> levels;
+    
+    /*
+     Average solid angle of a texel in the first level.
+     */
+    float texelSolidAngle;
+    
+    /*
+     Trilinear sample of the environment in the given direction, using the
+     same equirectangular mapping as the equirect_to_cube shader.
+     */
+    VROVector3f sample(const VROVector3f &dir, float lod) const {
+        float u = atan2f(dir.z, dir.x) * (0.5 / kPI) + 0.5;
+        float v = asinf(std::max(-1.0f, std::min(1.0f, dir.y))) * (1.0 / kPI) + 0.5;
+        
+        lod = std::max(0.0f, std::min(lod, (float) (levels.size() - 1)));
+        int l0 = (int) lod;
+        int l1 = std::min(l0 + 1, (int) levels.size() - 1);
+        float t = lod - l0;
+        
+        VROVector3f color = sampleLevel(levels[l0], u, v);
+        if (t > 0 && l1 != l0) {
+            color = color * (1 - t) + sampleLevel(levels[l1], u, v) * t;
+        }
+        return color;
+    }
+    
+private:
+    
+    static VROVector3f sampleLevel(const VROIBLEnvironmentLevel &level, float u, float v) {
+        float x = u * level.width - 0.5f;
+        float y = v * level.height - 0.5f;
+        int x0 = (int) floorf(x);
+        int y0 = (int) floorf(y);
+        float fx = x - x0;
+        float fy = y - y0;
+        
+        // Wrap horizontally, clamp vertically
+        int x1 = x0 + 1;
+        x0 = (x0 % level.width + level.width) % level.width;
+        x1 = (x1 % level.width + level.width) % level.width;
+        int y1 = std::min(y0 + 1, level.height - 1);
+        y0 = std::max(0, std::min(y0, level.height - 1));
+        y1 = std::max(0, y1);
+        
+        const float *r0 = &level.rgb[y0 * level.width * 3];
+        const float *r1 = &level.rgb[y1 * level.width * 3];
+        float w00 = (1 - fx) * (1 - fy), w10 = fx * (1 - fy);
+        float w01 = (1 - fx) * fy,       w11 = fx * fy;
+        
+        return { r0[x0 * 3 + 0] * w00 + r0[x1 * 3 + 0] * w10 + r1[x0 * 3 + 0] * w01 + r1[x1 * 3 + 0] * w11,
+                 r0[x0 * 3 + 1] * w00 + r0[x1 * 3 + 1] * w10 + r1[x0 * 3 + 1] * w01 + r1[x1 * 3 + 1] * w11,
+                 r0[x0 * 3 + 2] * w00 + r0[x1 * 3 + 2] * w10 + r1[x0 * 3 + 2] * w01 + r1[x1 * 3 + 2] * w11 };
+    }
+    
+};
+
+/*
+ Decode the source into the first level of the environment (box filtering it
+ down to at most kMaxSourceWidth), then build the remaining levels. Returns
+ false if the source data does not match its dimensions.
+ */
+static bool loadEnvironment(std::shared_ptr<VROData> source, VROTextureFormat format, int width, int height,
+                            VROJobSystem &jobs, VROIBLEnvironment *env) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    
+    int bytesPerTexel;
+    if (format == VROTextureFormat::RGB9_E5) {
+        bytesPerTexel = 4;
+    }
+    else if (format == VROTextureFormat::RGB16F) {
+        // VROHDRLoader stores uncompressed HDR data as 32-bit floats, RGB or RGBA
+        bytesPerTexel = (int) (source->getDataLength() / ((size_t) width * height));
+        if (bytesPerTexel != 12 && bytesPerTexel != 16) {
+            return false;
+        }
+    }
+    else {
+        return false;
+    }
+    if (source->getDataLength() < (size_t) width * height * bytesPerTexel) {
+        return false;
+    }
+    
+    int factor = 1;
+    while (width / factor > kMaxSourceWidth && height / factor > 1) {
+        factor *= 2;
+    }
+    
+    VROIBLEnvironmentLevel level;
+    level.width = width / factor;
+    level.height = height / factor;
+    level.rgb.resize(level.width * level.height * 3);
+    
+    const uint8_t *bytes = (const uint8_t *) source->getData();
+    float scale = 1.0f / (factor * factor);
+    jobs.parallelFor(level.height, kRowGrain, [&](int start, int end) {
+        for (int y = start; y < end; y++) {
+            float *out = &level.rgb[y * level.width * 3];
+            for (int x = 0; x < level.width; x++) {
+                float r = 0, g = 0, b = 0;
+                for (int sy = y * factor; sy < (y + 1) * factor; sy++) {
+                    for (int sx = x * factor; sx < (x + 1) * factor; sx++) {
+                        const uint8_t *texel = bytes + ((size_t) sy * width + sx) * bytesPerTexel;
+                        if (bytesPerTexel == 4) {
+                            uint32_t packed;
+                            memcpy(&packed, texel, sizeof(uint32_t));
+                            glm::vec3 rgb = glm::unpackF3x9_E1x5(packed);
+                            r += rgb.x; g += rgb.y; b += rgb.z;
+                        }
+                        else {
+                            const float *rgb = (const float *) texel;
+                            r += rgb[0]; g += rgb[1]; b += rgb[2];
+                        }
+                    }
+                }
+                out[x * 3 + 0] = r * scale;
+                out[x * 3 + 1] = g * scale;
+                out[x * 3 + 2] = b * scale;
+            }
+        }
+    });
+    env->levels.push_back(std::move(level));
+    env->texelSolidAngle = 4 * kPI / (env->levels[0].width * env->levels[0].height);
+    
+    while (env->levels.back().width >= 8 && env->levels.back().height >= 4) {
+        const VROIBLEnvironmentLevel &prev = env->levels.back();
+        VROIBLEnvironmentLevel next;
+        next.width = prev.width / 2;
+        next.height = prev.height / 2;
+        next.rgb.resize(next.width * next.height * 3);
+        
+        for (int y = 0; y < next.height; y++) {
+            const float *r0 = &prev.rgb[(y * 2) * prev.width * 3];
+            const float *r1 = &prev.rgb[(y * 2 + 1) * prev.width * 3];
+            float *out = &next.rgb[y * next.width * 3];
+            for (int i = 0; i < next.width * 3; i++) {
+                int c = i % 3;
+                int x = (i / 3) * 2;
+                out[i] = (r0[x * 3 + c] + r0[(x + 1) * 3 + c] + r1[x * 3 + c] + r1[(x + 1) * 3 + c]) * 0.25f;
+            }
+        }
+        env->levels.push_back(std::move(next));
+    }
+    return true;
+}
+
+#pragma mark - Sampling Utilities
+
+/*
+ Direction through the center of texel (x, y) of the given cube face, in
+ OpenGL face order and orientation.
+ */
+static VROVector3f getCubeDirection(int face, int x, int y, int size) {
+    float sc = 2.0f * (x + 0.5f) / size - 1.0f;
+    float tc = 2.0f * (y + 0.5f) / size - 1.0f;
+    
+    VROVector3f dir;
+    switch (face) {
+        case 0:  dir = {  1,  -tc, -sc }; break;
+        case 1:  dir = { -1,  -tc,  sc }; break;
+        case 2:  dir = { sc,    1,  tc }; break;
+        case 3:  dir = { sc,   -1, -tc }; break;
+        case 4:  dir = { sc,  -tc,   1 }; break;
+        default: dir = { -sc, -tc,  -1 }; break;
+    }
+    return dir.normalize();
+}
+
+static float radicalInverse(uint32_t bits) {
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return float(bits) * 2.3283064365386963e-10f;
+}
+
+/*
+ GGX importance sampled half vector about +Z, for the i-th Hammersley point.
+ */
+static VROVector3f importanceSampleGGX(int i, float roughness) {
+    float a = roughness * roughness;
+    float phi = 2.0f * kPI * ((float) i / kNumSamples);
+    float xi = radicalInverse(i);
+    float cosTheta = sqrtf((1.0f - xi) / (1.0f + (a * a - 1.0f) * xi));
+    float sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+    return { cosf(phi) * sinTheta, sinf(phi) * sinTheta, cosTheta };
+}
+
+static uint32_t packRGB9E5(const VROVector3f &color) {
+    return glm::packF3x9_E1x5(glm::vec3(std::max(color.x, 0.0f), std::max(color.y, 0.0f), std::max(color.z, 0.0f)));
+}
+
+#pragma mark - Irradiance
+
+/*
+ Project the environment's radiance onto the first nine real spherical
+ harmonics. Each row's contribution is computed in parallel, then summed.
+ */
+static void computeSH(const VROIBLEnvironment &env, VROJobSystem &jobs, float sh[9][3]) {
+    const VROIBLEnvironmentLevel &level = env.levels[0];
+    std::vector<float> rowSums(level.height * 27, 0.0f);
+    
+    jobs.parallelFor(level.height, kRowGrain, [&](int start, int end) {
+        for (int y = start; y < end; y++) {
+            float latitude = ((y + 0.5f) / level.height - 0.5f) * kPI;
+            float cosLat = cosf(latitude);
+            float sinLat = sinf(latitude);
+            float solidAngle = (2 * kPI / level.width) * (kPI / level.height) * cosLat;
+            
+            float *sums = &rowSums[y * 27];
+            const float *row = &level.rgb[y * level.width * 3];
+            for (int x = 0; x < level.width; x++) {
+                float phi = ((x + 0.5f) / level.width - 0.5f) * 2 * kPI;
+                float dx = cosLat * cosf(phi);
+                float dy = sinLat;
+                float dz = cosLat * sinf(phi);
+                
+                float basis[9] = {
+                    0.282095f,
+                    0.488603f * dy,
+                    0.488603f * dz,
+                    0.488603f * dx,
+                    1.092548f * dx * dy,
+                    1.092548f * dy * dz,
+                    0.315392f * (3 * dz * dz - 1),
+                    1.092548f * dx * dz,
+                    0.546274f * (dx * dx - dy * dy),
+                };
+                for (int k = 0; k < 9; k++) {
+                    float w = basis[k] * solidAngle;
+                    sums[k * 3 + 0] += row[x * 3 + 0] * w;
+                    sums[k * 3 + 1] += row[x * 3 + 1] * w;
+                    sums[k * 3 + 2] += row[x * 3 + 2] * w;
+                }
+            }
+        }
+    });
+    
+    for (int k = 0; k < 9; k++) {
+        for (int c = 0; c < 3; c++) {
+            double sum = 0;
+            for (int y = 0; y < level.height; y++) {
+                sum += rowSums[y * 27 + k * 3 + c];
+            }
+            sh[k][c] = (float) sum;
+        }
+    }
+}
+
+/*
+ Evaluate the irradiance in the given direction from the radiance SH,
+ divided by PI to match the output of the irradiance convolution shader.
+ */
+static VROVector3f evaluateIrradiance(const float sh[9][3], const VROVector3f &n) {
+    // Convolution with the clamped cosine lobe (Ramamoorthi and Hanrahan),
+    // pre-divided by PI: A0 = PI, A1 = 2PI/3, A2 = PI/4
+    const float a0 = 1.0f, a1 = 2.0f / 3.0f, a2 = 0.25f;
+    float basis[9] = {
+        a0 * 0.282095f,
+        a1 * 0.488603f * n.y,
+        a1 * 0.488603f * n.z,
+        a1 * 0.488603f * n.x,
+        a2 * 1.092548f * n.x * n.y,
+        a2 * 1.092548f * n.y * n.z,
+        a2 * 0.315392f * (3 * n.z * n.z - 1),
+        a2 * 1.092548f * n.x * n.z,
+        a2 * 0.546274f * (n.x * n.x - n.y * n.y),
+    };
+    VROVector3f irradiance;
+    for (int k = 0; k < 9; k++) {
+        irradiance += VROVector3f(sh[k][0], sh[k][1], sh[k][2]) * basis[k];
+    }
+    return irradiance;
+}
+
+#pragma mark - Prefilter
+
+struct VROIBLPrefilterSample {
+    VROVector3f direction; // Light direction in tangent space (N = +Z)
+    float weight;          // NdotL
+    float lod;             // Environment level to sample
+};
+
+/*
+ The light directions and environment levels used for every texel of a
+ given roughness. Since the convolution assumes V = R = N, these depend only
+ on the roughness and are computed once, in tangent space.
+ */
+static std::vector<VROIBLPrefilterSample> createPrefilterSamples(float roughness, const VROIBLEnvironment &env) {
+    std::vector<VROIBLPrefilterSample> samples;
+    float a = roughness * roughness;
+    float a2 = a * a;
+    
+    for (int i = 0; i < kNumSamples; i++) {
+        VROVector3f H = importanceSampleGGX(i, roughness);
+        VROVector3f L = { 2 * H.z * H.x, 2 * H.z * H.y, 2 * H.z * H.z - 1 };
+        if (L.z <= 0) {
+            continue;
+        }
+        
+        // Sample the environment at the level whose texels match the solid
+        // angle covered by this sample (filtered importance sampling)
+        float denom = H.z * H.z * (a2 - 1.0f) + 1.0f;
+        float D = a2 / (kPI * denom * denom);
+        float pdf = D / 4.0f + 0.0001f;
+        float saSample = 1.0f / (kNumSamples * pdf + 0.0001f);
+        float lod = 0.5f * log2f(saSample / env.texelSolidAngle);
+        
+        samples.push_back({ L, L.z, lod });
+    }
+    return samples;
+}
+
+static void computePrefilter(const VROIBLEnvironment &env, VROJobSystem &jobs, VROIBLBakeData *data) {
+    int size = kPrefilterSize;
+    int mips = 0;
+    size_t faceLength = 0;
+    for (int s = size; s >= 1; s /= 2) {
+        faceLength += s * s;
+        mips++;
+    }
+    data->prefilterSize = size;
+    data->prefilterMips = mips;
+    data->prefilter.resize(faceLength * 6);
+    
+    size_t mipOffset = 0;
+    for (int mip = 0; mip < mips; mip++) {
+        int mipSize = size >> mip;
+        float roughness = std::min(mip / kMaxReflectionLOD, 1.0f);
+        std::vector<VROIBLPrefilterSample> samples;
+        
+        // A perfect mirror samples the environment directly, filtered to the
+        // footprint of the output texel
+        float mirrorLod = 0.5f * log2f((4 * kPI / (6.0f * mipSize * mipSize)) / env.texelSolidAngle);
+        if (roughness > 0) {
+            samples = createPrefilterSamples(roughness, env);
+        }
+        
+        jobs.parallelFor(6 * mipSize, kRowGrain, [&](int start, int end) {
+            for (int row = start; row < end; row++) {
+                int face = row / mipSize;
+                int y = row % mipSize;
+                uint32_t *out = &data->prefilter[face * faceLength + mipOffset + y * mipSize];
+                
+                for (int x = 0; x < mipSize; x++) {
+                    VROVector3f N = getCubeDirection(face, x, y, mipSize);
+                    if (samples.empty()) {
+                        out[x] = packRGB9E5(env.sample(N, mirrorLod));
+                        continue;
+                    }
+                    
+                    VROVector3f up = fabs(N.z) < 0.999f ? VROVector3f(0, 0, 1) : VROVector3f(1, 0, 0);
+                    VROVector3f tangent = up.cross(N).normalize();
+                    VROVector3f bitangent = N.cross(tangent);
+                    
+                    VROVector3f color;
+                    float totalWeight = 0;
+                    for (const VROIBLPrefilterSample &sample : samples) {
+                        VROVector3f L = tangent * sample.direction.x + bitangent * sample.direction.y + N * sample.direction.z;
+                        color += env.sample(L, sample.lod) * sample.weight;
+                        totalWeight += sample.weight;
+                    }
+                    out[x] = packRGB9E5(color / totalWeight);
+                }
+            }
+        });
+        mipOffset += mipSize * mipSize;
+    }
+}
+
+#pragma mark - BRDF
+
+static void computeBRDF(VROJobSystem &jobs, std::vector<float> *brdf) {
+    brdf->resize(kBRDFSize * kBRDFSize * 2);
+    
+    jobs.parallelFor(kBRDFSize, kRowGrain, [&](int start, int end) {
+        for (int y = start; y < end; y++) {
+            float roughness = (y + 0.5f) / kBRDFSize;
+            float k = (roughness * roughness) / 2.0f;
+            
+            for (int x = 0; x < kBRDFSize; x++) {
+                float nDotV = (x + 0.5f) / kBRDFSize;
+                VROVector3f V = { sqrtf(1.0f - nDotV * nDotV), 0, nDotV };
+                
+                float A = 0, B = 0;
+                for (int i = 0; i < kNumSamples; i++) {
+                    VROVector3f H = importanceSampleGGX(i, roughness);
+                    float vDotH = V.dot(H);
+                    VROVector3f L = H * (2.0f * vDotH) - V;
+                    
+                    float nDotL = std::max(L.z, 0.0f);
+                    float nDotH = std::max(H.z, 0.0f);
+                    vDotH = std::max(vDotH, 0.0f);
+                    if (nDotL > 0) {
+                        float G = (nDotV / (nDotV * (1 - k) + k)) * (nDotL / (nDotL * (1 - k) + k));
+                        float G_Vis = (G * vDotH) / (nDotH * nDotV);
+                        float Fc = powf(1.0f - vDotH, 5.0f);
+                        A += (1.0f - Fc) * G_Vis;
+                        B += Fc * G_Vis;
+                    }
+                }
+                (*brdf)[(y * kBRDFSize + x) * 2 + 0] = A / kNumSamples;
+                (*brdf)[(y * kBRDFSize + x) * 2 + 1] = B / kNumSamples;
+            }
+        }
+    });
+}
+
+#pragma mark - Baking
+
+std::shared_ptr<VROIBLBakeData> VROIBLBaker::bake(std::shared_ptr<VROData> source, VROTextureFormat format,
+                                                  int width, int height) {
+    double start = VROTimeCurrentMillis();
+    VROJobSystem &jobs = *VROJobSystem::getBackgroundJobSystem();
+    
+    VROIBLEnvironment env;
+    if (!source || !loadEnvironment(source, format, width, height, jobs, &env)) {
+        pwarn("Unable to bake IBL maps: unsupported lighting environment data");
+        return nullptr;
+    }
+    
+    std::shared_ptr<VROIBLBakeData> data = std::make_shared<VROIBLBakeData>();
+    data->sourceHash = hashSource(source, width, height);
+    
+    computeSH(env, jobs, data->sh);
+    data->irradianceSize = kIrradianceSize;
+    data->irradiance.resize(kIrradianceSize * kIrradianceSize * 6);
+    for (int face = 0; face < 6; face++) {
+        for (int y = 0; y < kIrradianceSize; y++) {
+            for (int x = 0; x < kIrradianceSize; x++) {
+                VROVector3f N = getCubeDirection(face, x, y, kIrradianceSize);
+                data->irradiance[(face * kIrradianceSize + y) * kIrradianceSize + x] = packRGB9E5(evaluateIrradiance(data->sh, N));
+            }
+        }
+    }
+    
+    computePrefilter(env, jobs, data.get());
+    
+    // The BRDF LUT does not depend on the environment, so compute it only once
+    static std::mutex sBRDFMutex;
+    static std::vector<float> sBRDF;
+    {
+        std::lock_guard<std::mutex> lock(sBRDFMutex);
+        if (sBRDF.empty()) {
+            computeBRDF(jobs, &sBRDF);
+        }
+        data->brdfSize = kBRDFSize;
+        data->brdf = sBRDF;
+    }
+    
+    pinfo("Baked IBL maps on the CPU in %.1f ms (%d worker threads)", VROTimeCurrentMillis() - start, jobs.getNumWorkers());
+    return data;
+}
+
+std::shared_ptr<VROIBLBakeData> VROIBLBaker::bakeOrLoad(std::shared_ptr<VROData> source, VROTextureFormat format,
+                                                        int width, int height, std::string cacheDirectory) {
+    if (cacheDirectory.empty() || !source) {
+        return bake(source, format, width, height);
+    }
+    
+    uint64_t hash = hashSource(source, width, height);
+    std::string path = cacheDirectory + "/" + getCacheFileName(hash);
+    std::shared_ptr<VROIBLBakeData> data = read(path, hash);
+    if (data) {
+        pinfo("Loaded IBL maps from cache [%s]", path.c_str());
+        return data;
+    }
+    
+    data = bake(source, format, width, height);
+    if (data && !write(*data, path)) {
+        pwarn("Failed to write IBL cache file [%s]", path.c_str());
+    }
+    return data;
+}
+
+uint64_t VROIBLBaker::hashSource(std::shared_ptr<VROData> source, int width, int height) {
+    uint64_t hash = android::VROJenkinsHash64((const uint8_t *) source->getData(), source->getDataLength());
+    return hash ^ (((uint64_t) width << 32) | (uint32_t) height);
+}
+
+std::string VROIBLBaker::getCacheFileName(uint64_t sourceHash) {
+    return "ibl_" + VROStringUtil::toString64(sourceHash) + ".vibl";
+}
+
+#pragma mark - Cache Files
+
+static size_t getPrefilterFaceLength(int size, int mips) {
+    size_t length = 0;
+    for (int mip = 0; mip < mips; mip++) {
+        length += (size >> mip) * (size >> mip);
+    }
+    return length;
+}
+
+std::shared_ptr<VROIBLBakeData> VROIBLBaker::read(std::string path, uint64_t sourceHash) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return nullptr;
+    }
+    
+    VROIBLCacheHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, "VIBL", 4) != 0 ||
+        header.version != kIBLCacheVersion ||
+        header.sourceHash != sourceHash ||
+        header.irradianceSize != kIrradianceSize ||
+        header.prefilterSize != kPrefilterSize ||
+        header.prefilterMips == 0 || header.prefilterMips > 16 ||
+        header.brdfSize != kBRDFSize) {
+        fclose(file);
+        return nullptr;
+    }
+    
+    std::shared_ptr<VROIBLBakeData> data = std::make_shared<VROIBLBakeData>();
+    data->sourceHash = header.sourceHash;
+    memcpy(data->sh, header.sh, sizeof(data->sh));
+    data->irradianceSize = header.irradianceSize;
+    data->prefilterSize = header.prefilterSize;
+    data->prefilterMips = header.prefilterMips;
+    data->brdfSize = header.brdfSize;
+    
+    data->irradiance.resize(data->irradianceSize * data->irradianceSize * 6);
+    data->prefilter.resize(getPrefilterFaceLength(data->prefilterSize, data->prefilterMips) * 6);
+    data->brdf.resize(data->brdfSize * data->brdfSize * 2);
+    
+    bool success = fread(data->irradiance.data(), sizeof(uint32_t), data->irradiance.size(), file) == data->irradiance.size() &&
+                   fread(data->prefilter.data(), sizeof(uint32_t), data->prefilter.size(), file) == data->prefilter.size() &&
+                   fread(data->brdf.data(), sizeof(float), data->brdf.size(), file) == data->brdf.size();
+    fclose(file);
+    return success ? data : nullptr;
+}
+
+bool VROIBLBaker::write(const VROIBLBakeData &data, std::string path) {
+    VROIBLCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "VIBL", 4);
+    header.version = kIBLCacheVersion;
+    header.sourceHash = data.sourceHash;
+    header.irradianceSize = data.irradianceSize;
+    header.prefilterSize = data.prefilterSize;
+    header.prefilterMips = data.prefilterMips;
+    header.brdfSize = data.brdfSize;
+    memcpy(header.sh, data.sh, sizeof(header.sh));
+    
+    // Write to a temporary file and move it into place, so that readers never
+    // see a partially written cache file
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(data.irradiance.data(), sizeof(uint32_t), data.irradiance.size(), file) == data.irradiance.size() &&
+                   fwrite(data.prefilter.data(), sizeof(uint32_t), data.prefilter.size(), file) == data.prefilter.size() &&
+                   fwrite(data.brdf.data(), sizeof(float), data.brdf.size(), file) == data.brdf.size();
+    success = (fclose(file) == 0) && success;
+    
+    if (!success || rename(tempPath.c_str(), path.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+#pragma mark - Textures
+
+std::shared_ptr<VROTexture> VROIBLBakeData::createIrradianceTexture() const {
+    int faceLength = irradianceSize * irradianceSize;
+    std::vector<std::shared_ptr<VROData>> faces;
+    for (int face = 0; face < 6; face++) {
+        faces.push_back(std::make_shared<VROData>(&irradiance[face * faceLength], faceLength * sizeof(uint32_t)));
+    }
+    
+    std::vector<uint32_t> mipSizes;
+    return std::make_shared<VROTexture>(VROTextureType::TextureCube, VROTextureFormat::RGB9_E5,
+                                        VROTextureInternalFormat::RGB9_E5, false, VROMipmapMode::None,
+                                        faces, irradianceSize, irradianceSize, mipSizes);
+}
+
+std::shared_ptr<VROTexture> VROIBLBakeData::createPrefilterTexture() const {
+    size_t faceLength = getPrefilterFaceLength(prefilterSize, prefilterMips);
+    std::vector<std::shared_ptr<VROData>> faces;
+    for (int face = 0; face < 6; face++) {
+        faces.push_back(std::make_shared<VROData>(&prefilter[face * faceLength], faceLength * sizeof(uint32_t)));
+    }
+    
+    std::vector<uint32_t> mipSizes;
+    for (int mip = 0; mip < prefilterMips; mip++) {
+        mipSizes.push_back((prefilterSize >> mip) * (prefilterSize >> mip) * sizeof(uint32_t));
+    }
+    return std::make_shared<VROTexture>(VROTextureType::TextureCube, VROTextureFormat::RGB9_E5,
+                                        VROTextureInternalFormat::RGB9_E5, false, VROMipmapMode::Pregenerated,
+                                        faces, prefilterSize, prefilterSize, mipSizes);
+}
+
+std::shared_ptr<VROTexture> VROIBLBakeData::createBRDFTexture() const {
+    // RGB16F textures are uploaded from 32-bit float RGB data
+    int numTexels = brdfSize * brdfSize;
+    std::vector<float> rgb(numTexels * 3);
+    for (int i = 0; i < numTexels; i++) {
+        rgb[i * 3 + 0] = brdf[i * 2 + 0];
+        rgb[i * 3 + 1] = brdf[i * 2 + 1];
+        rgb[i * 3 + 2] = 0;
+    }
+    
+    std::vector<std::shared_ptr<VROData>> data = { std::make_shared<VROData>(rgb.data(), rgb.size() * sizeof(float)) };
+    std::vector<uint32_t> mipSizes;
+    std::shared_ptr<VROTexture> texture = std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::RGB16F,
+                                                                       VROTextureInternalFormat::RGB16F, false, VROMipmapMode::None,
+                                                                       data, brdfSize, brdfSize, mipSizes);
+    texture->setWrapS(VROWrapMode::Clamp);
+    texture->setWrapT(VROWrapMode::Clamp);
+    return texture;
+}
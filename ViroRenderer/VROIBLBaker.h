@@ -0,0 +1,140 @@
+//
+//  VROIBLBaker.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/26/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROIBLBaker_h
+#define VROIBLBaker_h
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class VROData;
+class VROTexture;
+enum class VROTextureFormat;
+
+/*
+ The image based lighting maps for a lighting environment, computed on the
+ CPU by VROIBLBaker. Cube map faces are stored in RGB9_E5, in OpenGL face
+ order (+X, -X, +Y, -Y, +Z, -Z), and match the output of the GPU passes
+ in VROIBLPreprocess.
+ */
+class VROIBLBakeData {
+public:
+    
+    /*
+     Hash of the source environment these maps were computed from.
+     */
+    uint64_t sourceHash;
+    
+    /*
+     Order 2 spherical harmonic coefficients (9 RGB triplets) of the
+     environment's radiance. The irradiance map is reconstructed from these.
+     */
+    float sh[9][3];
+    
+    /*
+     Diffuse irradiance cube map, one face after another.
+     */
+    int irradianceSize;
+    std::vector<uint32_t> irradiance;
+    
+    /*
+     Specular prefiltered cube map. Each face holds its full mip chain, and
+     mip level i holds the convolution for roughness i / 4 (clamped to 1).
+     */
+    int prefilterSize;
+    int prefilterMips;
+    std::vector<uint32_t> prefilter;
+    
+    /*
+     Split-sum BRDF lookup table: RG pairs indexed by (NdotV, roughness).
+     */
+    int brdfSize;
+    std::vector<float> brdf;
+    
+    /*
+     Create the textures for these maps. Must be invoked on the rendering
+     thread, but does not upload the textures.
+     */
+    std::shared_ptr<VROTexture> createIrradianceTexture() const;
+    std::shared_ptr<VROTexture> createPrefilterTexture() const;
+    std::shared_ptr<VROTexture> createBRDFTexture() const;
+    
+};
+
+/*
+ Computes image based lighting maps on the CPU, as an alternative to the GPU
+ passes run by VROIBLPreprocess. Baking runs on background threads (the work
+ is split across rows of each face), and the results are stored in a cache
+ file keyed by the hash of the source environment, so that switching to an
+ environment that was baked before costs only a file read.
+
+ The cache file ("VIBL") is a versioned header followed by the irradiance
+ faces, the prefiltered faces with their mip chains, and the BRDF LUT. Files
+ with a mismatched version, hash, or size are ignored and re-baked.
+ */
+class VROIBLBaker {
+public:
+    
+    /*
+     Compute the maps for the given equirectangular environment. The source
+     data must be in RGB9_E5 or in 32-bit float RGB(A) (the VROTextureFormat
+     RGB16F as produced by VROHDRLoader). Returns nullptr if the source is
+     invalid.
+     */
+    static std::shared_ptr<VROIBLBakeData> bake(std::shared_ptr<VROData> source, VROTextureFormat format,
+                                                int width, int height);
+    
+    /*
+     Load the maps for the given source from the cache directory if present,
+     otherwise bake them and write them to the cache. If the cache directory
+     is empty, the maps are always baked.
+     */
+    static std::shared_ptr<VROIBLBakeData> bakeOrLoad(std::shared_ptr<VROData> source, VROTextureFormat format,
+                                                      int width, int height, std::string cacheDirectory);
+    
+    /*
+     Hash identifying the given source environment.
+     */
+    static uint64_t hashSource(std::shared_ptr<VROData> source, int width, int height);
+    
+    /*
+     Read or write the given maps from or to a cache file. Reading returns
+     nullptr if the file is missing, is of another version, or does not
+     match the given source hash.
+     */
+    static std::shared_ptr<VROIBLBakeData> read(std::string path, uint64_t sourceHash);
+    static bool write(const VROIBLBakeData &data, std::string path);
+    
+    /*
+     Name of the cache file for the given source hash.
+     */
+    static std::string getCacheFileName(uint64_t sourceHash);
+    
+};
+
+#endif /* VROIBLBaker_h */
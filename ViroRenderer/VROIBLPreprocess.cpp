@@ -33,11 +33,21 @@
 #include "VROIrradianceRenderPass.h"
 #include "VROPrefilterRenderPass.h"
 #include "VROBRDFRenderPass.h"
+#include "VROIBLBaker.h"
+#include "VROTexture.h"
+#include "VROPlatformUtil.h"
+#include <atomic>
 
 // Set to true to display the generated irradiance map as the background, and to
 // deactivate specular IBL
 static bool kDebugIrradiance = false;
 
+struct VROIBLBakeTask {
+    std::shared_ptr<VROTexture> environment;
+    std::atomic<bool> finished;
+    std::shared_ptr<VROIBLBakeData> result;
+};
+
 VROIBLPreprocess::VROIBLPreprocess() {
     _phase = VROIBLPhase::Idle;
     _equirectangularToCubePass = std::make_shared<VROEquirectangularToCubeRenderPass>();
@@ -61,7 +71,7 @@ void VROIBLPreprocess::execute(std::shared_ptr<VROScene> scene, VRORenderContext
             pinfo("Lighting environment changed");
 
             _currentLightingEnvironment = portal->getLightingEnvironment();
-            _phase = VROIBLPhase::CubeConvert;
+            _phase = startCPUBake() ? VROIBLPhase::CPUBake : VROIBLPhase::CubeConvert;
         }
         
         // If an environment map has been removed
@@ -75,6 +85,10 @@ void VROIBLPreprocess::execute(std::shared_ptr<VROScene> scene, VRORenderContext
         }
     }
     
+    else if (_phase == VROIBLPhase::CPUBake) {
+        finishCPUBake(scene, context, driver);
+    }
+    
     else if (_phase == VROIBLPhase::CubeConvert) {
         doCubeConversionPhase(scene, context, driver);
         _phase = VROIBLPhase::IrradianceConvolution;
@@ -143,3 +157,70 @@ void VROIBLPreprocess::doBRDFComputationPhase(std::shared_ptr<VROScene> scene, V
     _brdfPass->render(scene, nullptr, inputs, context, driver);
     _brdfMap = inputs.outputTarget->getTexture(0);
 }
+
+bool VROIBLPreprocess::startCPUBake() {
+    std::shared_ptr<VROData> source = _currentLightingEnvironment->getSourceData();
+    if (!source) {
+        return false;
+    }
+    pinfo("   Baking IBL maps on the CPU");
+    
+    // The bake task holds the only remaining reference to the source data, so
+    // it is freed as soon as the bake finishes
+    _currentLightingEnvironment->releaseSourceData();
+    
+    std::shared_ptr<VROIBLBakeTask> task = std::make_shared<VROIBLBakeTask>();
+    task->environment = _currentLightingEnvironment;
+    task->finished = false;
+    _bakeTask = task;
+    
+    VROTextureFormat format = _currentLightingEnvironment->getFormat();
+    int width = _currentLightingEnvironment->getWidth();
+    int height = _currentLightingEnvironment->getHeight();
+    
+    VROPlatformDispatchAsyncBackground([task, source, format, width, height] {
+        std::string cacheDirectory;
+#if VRO_PLATFORM_ANDROID
+        cacheDirectory = VROPlatformGetCacheDirectory();
+#endif
+        task->result = VROIBLBaker::bakeOrLoad(source, format, width, height, cacheDirectory);
+        task->finished = true;
+    });
+    return true;
+}
+
+void VROIBLPreprocess::finishCPUBake(std::shared_ptr<VROScene> scene, VRORenderContext *context,
+                                     std::shared_ptr<VRODriver> driver) {
+    if (!_bakeTask->finished) {
+        return;
+    }
+    std::shared_ptr<VROIBLBakeTask> task = _bakeTask;
+    _bakeTask.reset();
+    
+    // If the lighting environment changed while we were baking, discard the
+    // result; the idle phase will start over with the new environment
+    if (scene->getActivePortal()->getLightingEnvironment() != task->environment) {
+        _phase = VROIBLPhase::Idle;
+        return;
+    }
+    
+    // Fall back to the GPU passes if the environment could not be baked
+    if (!task->result) {
+        _phase = VROIBLPhase::CubeConvert;
+        return;
+    }
+    
+    _irradianceMap = task->result->createIrradianceTexture();
+    _prefilterMap = task->result->createPrefilterTexture();
+    _brdfMap = task->result->createBRDFTexture();
+    _cubeLightingEnvironment.reset();
+    
+    _irradianceMap->prewarm(driver);
+    _prefilterMap->prewarm(driver);
+    _brdfMap->prewarm(driver);
+    
+    context->setIrradianceMap(_irradianceMap);
+    context->setPrefilteredMap(_prefilterMap);
+    context->setBRDFMap(_brdfMap);
+    _phase = VROIBLPhase::Idle;
+}
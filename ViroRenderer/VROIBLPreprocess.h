@@ -34,15 +34,27 @@ class VROEquirectangularToCubeRenderPass;
 class VROIrradianceRenderPass;
 class VROPrefilterRenderPass;
 class VROBRDFRenderPass;
+class VROIBLBakeData;
+struct VROIBLBakeTask;
 
 enum class VROIBLPhase {
     Idle,
+    CPUBake,
     CubeConvert,
     IrradianceConvolution,
     PrefilterConvolution,
     BRDFConvolution
 };
 
+/*
+ Computes the image based lighting maps (irradiance, prefiltered specular, and
+ BRDF) whenever the active portal's lighting environment changes.
+
+ If the environment retains its source data (see VROTexture::retainSourceData),
+ the maps are baked on the CPU in the background by VROIBLBaker, or loaded
+ from its on-disk cache, and the current maps stay in use until the new ones
+ are ready. Otherwise the maps are rendered on the GPU, one pass per frame.
+ */
 class VROIBLPreprocess : public VROPreprocess {
 public:
     VROIBLPreprocess();
@@ -64,6 +76,23 @@ private:
     std::shared_ptr<VROTexture> _irradianceMap;
     std::shared_ptr<VROTexture> _prefilterMap;
     std::shared_ptr<VROTexture> _brdfMap;
+    
+    /*
+     The background bake in progress, when in the CPUBake phase.
+     */
+    std::shared_ptr<VROIBLBakeTask> _bakeTask;
+    
+    /*
+     Begin baking the current lighting environment on the CPU. Returns false
+     if the environment has no source data to bake from.
+     */
+    bool startCPUBake();
+    
+    /*
+     Install the maps produced by the CPU bake, once it has finished.
+     */
+    void finishCPUBake(std::shared_ptr<VROScene> scene, VRORenderContext *context,
+                       std::shared_ptr<VRODriver> driver);
 
     void doCubeConversionPhase(std::shared_ptr<VROScene> scene, VRORenderContext *context,
                                std::shared_ptr<VRODriver> driver);
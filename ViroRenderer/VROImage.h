@@ -28,6 +28,8 @@
 #define VROImage_h
 
 #include <stdio.h>
+#include <vector>
+#include <stdint.h>
 #include "VRODefines.h"
 #include "VROTexture.h"
 
@@ -60,6 +62,14 @@ public:
     virtual void lock() {}
     virtual void unlock() {}
     
+    /*
+     If the data returned by getData() contains a pregenerated mip chain (as
+     transcoded images do), returns the size of each level. Empty otherwise.
+     */
+    virtual std::vector<uint32_t> getMipSizes() const {
+        return {};
+    }
+    
     /*
      Get the format of the source image data.
      */
@@ -0,0 +1,97 @@
+//
+//  VROInstanceBatchUBO.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/23/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROInstanceBatchUBO.h"
+#include "VROShaderProgram.h"
+#include "VROShaderModifier.h"
+#include "VRODriverOpenGL.h"
+#include <string.h>
+#include <algorithm>
+
+VROInstanceBatchUBO::VROInstanceBatchUBO(std::shared_ptr<VRODriver> driver) :
+    _driver(driver),
+    _transforms(nullptr),
+    _normalMatrices(nullptr),
+    _count(0) {
+
+    // Initialize data to something sane
+    memset(_vertexData.instances_transform, 0x0, sizeof(VROInstanceBatchUBOVertexData));
+
+    GL( glGenBuffers(1, &_instanceVertexUBO) );
+    GL( glBindBuffer(GL_UNIFORM_BUFFER, _instanceVertexUBO) );
+    GL( glBufferData(GL_UNIFORM_BUFFER, sizeof(VROInstanceBatchUBOVertexData), &_vertexData, GL_DYNAMIC_DRAW) );
+}
+
+VROInstanceBatchUBO::~VROInstanceBatchUBO() {
+    std::shared_ptr<VRODriverOpenGL> driver = std::dynamic_pointer_cast<VRODriverOpenGL>(_driver.lock());
+    if (driver) {
+        driver->deleteBuffer(_instanceVertexUBO);
+    }
+}
+
+std::vector<std::shared_ptr<VROShaderModifier>> VROInstanceBatchUBO::createInstanceShaderModifier() {
+    return {};
+}
+
+void VROInstanceBatchUBO::setInstances(const VROMatrix4f *transforms, const VROMatrix4f *normalMatrices, int count) {
+    _transforms = transforms;
+    _normalMatrices = normalMatrices;
+    _count = count;
+}
+
+int VROInstanceBatchUBO::getNumberOfDrawCalls() {
+    return (_count + kMaxInstancesPerUBO - 1) / kMaxInstancesPerUBO;
+}
+
+int VROInstanceBatchUBO::bindDrawData(int currentDrawCallIndex) {
+    int start = currentDrawCallIndex * kMaxInstancesPerUBO;
+    int end = std::min(start + kMaxInstancesPerUBO, _count);
+    if (start >= end) {
+        return 0;
+    }
+
+    for (int i = start; i < end; i++) {
+        float *slot = &_vertexData.instances_transform[(i - start) * kFloatsPerInstance];
+        memcpy(slot, _transforms[i].getArray(), 16 * sizeof(float));
+        memcpy(slot + 16, _normalMatrices[i].getArray(), 16 * sizeof(float));
+    }
+
+    pglpush("Instances");
+    GL( glBindBufferBase(GL_UNIFORM_BUFFER, VROShaderProgram::sInstanceVertexUBOBindingPoint, _instanceVertexUBO) );
+#if VRO_AVOID_BUFFER_SUB_DATA
+    GL( glBufferData(GL_UNIFORM_BUFFER, sizeof(VROInstanceBatchUBOVertexData), &_vertexData, GL_DYNAMIC_DRAW) );
+#else
+    // Only upload the instances actually used by this draw
+    GLsizeiptr size = (end - start) * kFloatsPerInstance * sizeof(float);
+    GL( glBufferSubData(GL_UNIFORM_BUFFER, 0, size, &_vertexData) );
+#endif
+    pglpop();
+    return end - start;
+}
+
+VROBoundingBox VROInstanceBatchUBO::getInstancedBoundingBox() {
+    return VROBoundingBox(0, 0, 0, 0, 0, 0);
+}
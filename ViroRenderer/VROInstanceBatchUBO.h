@@ -0,0 +1,118 @@
+//
+//  VROInstanceBatchUBO.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/23/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROInstanceBatchUBO_h
+#define VROInstanceBatchUBO_h
+
+#include "VROInstancedUBO.h"
+
+/*
+ Maximum number of instances drawn per glDrawElementsInstanced call. Each
+ instance occupies two mat4 slots (model matrix and normal matrix), so this
+ matches the size of the particle UBO.
+ */
+static const int kMaxInstancesPerUBO = 90;
+static const int kFloatsPerInstance = 32;
+
+/*
+ Uniform buffer object structure format through which per-instance transforms
+ are batched into the vertex shader. Each instance stores its model matrix
+ followed by its normal matrix, matching the layout of instances_vertex_data in
+ VROShaderFactory::createInstancedTransformModifier().
+ */
+typedef struct {
+    float instances_transform[kMaxInstancesPerUBO * kFloatsPerInstance];
+} VROInstanceBatchUBOVertexData;
+
+/*
+ VROInstanceBatchUBO batches the transforms of many nodes that share the same
+ geometry and material, so that VROPortal can render them with instanced draw
+ calls. Unlike VROParticleUBO, this UBO is not owned by a geometry: a single
+ instance is shared by the driver and refilled for each batch via setInstances().
+ */
+class VROInstanceBatchUBO : public VROInstancedUBO {
+public:
+    VROInstanceBatchUBO(std::shared_ptr<VRODriver> driver);
+    virtual ~VROInstanceBatchUBO();
+
+    /*
+     The instancing modifier is installed by VROShaderFactory whenever the
+     instanced lighting capability is set, so this returns no modifiers.
+     */
+    std::vector<std::shared_ptr<VROShaderModifier>> createInstanceShaderModifier();
+
+    /*
+     Set the instances to render in the next batch. The arrays are not copied,
+     and must remain valid until the batch has been drawn.
+     */
+    void setInstances(const VROMatrix4f *transforms, const VROMatrix4f *normalMatrices, int count);
+
+    /*
+     Returns the number of glDraw(s) required to draw all the instances set in
+     the last call to setInstances().
+     */
+    int getNumberOfDrawCalls();
+
+    /*
+     Upload the window of instances corresponding to the given draw call index
+     and bind it to the instance uniform block. Returns the number of instances
+     uploaded.
+     */
+    int bindDrawData(int currentDrawCallIndex);
+
+    /*
+     Batches are culled per node before they are formed, so this is unused and
+     returns an empty box.
+     */
+    VROBoundingBox getInstancedBoundingBox();
+
+private:
+
+    /*
+     Buffer ID of the uniform buffer object generated for this UBO.
+     */
+    GLuint _instanceVertexUBO;
+
+    /*
+     The driver that created this UBO.
+     */
+    std::weak_ptr<VRODriver> _driver;
+
+    /*
+     The current batch, set via setInstances().
+     */
+    const VROMatrix4f *_transforms;
+    const VROMatrix4f *_normalMatrices;
+    int _count;
+
+    /*
+     Staging data for the uniform buffer, kept as a member to avoid placing it
+     on the stack for every draw call.
+     */
+    VROInstanceBatchUBOVertexData _vertexData;
+};
+
+#endif /* VROInstanceBatchUBO_h */
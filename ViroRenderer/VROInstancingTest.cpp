@@ -0,0 +1,124 @@
+//
+//  VROInstancingTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/4/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROInstancingTest.h"
+#include "VROTestUtil.h"
+#include "VROPortal.h"
+
+static const int kGridSize = 4;
+static const int kNumModels = kGridSize * kGridSize;
+
+// Number of frames to wait after the last model loads before checking draws,
+// so that the textures of every copy have been loaded and set
+static const int kSettleFrames = 60;
+
+VROInstancingTest::VROInstancingTest() :
+    VRORendererTest(VRORendererTestType::Instancing),
+    _numLoaded(0),
+    _numElements(0),
+    _numFrames(0) {
+        
+}
+
+VROInstancingTest::~VROInstancingTest() {
+    
+}
+
+void VROInstancingTest::build(std::shared_ptr<VRORenderer> renderer,
+                              std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                              std::shared_ptr<VRODriver> driver) {
+    _driver = driver;
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    std::shared_ptr<VROLight> ambient = std::make_shared<VROLight>(VROLightType::Ambient);
+    ambient->setColor({ 1.0, 1.0, 1.0 });
+    ambient->setIntensity(600);
+    rootNode->addLight(ambient);
+    
+    /*
+     Each copy is loaded separately, as an app placing the same prop many times
+     would, so the copies share no VROGeometry or VROMaterial: only the vertex
+     buffers and textures shared through the driver's asset cache.
+     */
+    for (int x = 0; x < kGridSize; x++) {
+        for (int y = 0; y < kGridSize; y++) {
+            VROVector3f position = { (x - kGridSize / 2.0f + 0.5f) * 1.5f, (y - kGridSize / 2.0f + 0.5f) * 1.5f, -8 };
+            std::shared_ptr<VRONode> fbxNode = VROTestUtil::loadFBXModel("cylinder_pbr", position, { 0.2, 0.2, 0.2 }, { 0, 0, 0 },
+                                                                         1, "02_spin", driver,
+                                                                         [this](std::shared_ptr<VRONode> node, bool success) {
+                                                                             ++_numLoaded;
+                                                                             _numElements += countElements(node);
+                                                                         });
+            rootNode->addChildNode(fbxNode);
+        }
+    }
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+    frameSynchronizer->addFrameListener(shared_from_this());
+}
+
+int VROInstancingTest::countElements(std::shared_ptr<VRONode> node) {
+    int count = 0;
+    if (node->getGeometry()) {
+        count += (int) node->getGeometry()->getGeometryElements().size();
+    }
+    for (std::shared_ptr<VRONode> child : node->getChildNodes()) {
+        count += countElements(child);
+    }
+    return count;
+}
+
+void VROInstancingTest::onFrameWillRender(const VRORenderContext &context) {
+    
+}
+
+void VROInstancingTest::onFrameDidRender(const VRORenderContext &context) {
+    if (_numLoaded < kNumModels) {
+        return;
+    }
+    if (++_numFrames != kSettleFrames) {
+        return;
+    }
+    
+    int numDraws = _sceneController->getScene()->getRootNode()->getNumDraws();
+    pinfo("Rendered %d copies of a model (%d geometry elements) with %d draws",
+          kNumModels, _numElements, numDraws);
+    
+    if (_driver->isInstancedRenderingSupported()) {
+        passert_msg(numDraws < _numElements, "Expected instancing to reduce draws: %d draws for %d elements",
+                    numDraws, _numElements);
+    }
+}
@@ -0,0 +1,81 @@
+//
+//  VROInstancingTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/4/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROInstancingTest_h
+#define VROInstancingTest_h
+
+#include "VRORendererTest.h"
+
+/*
+ Verifies instanced rendering of repeated props. Loads the same FBX model many
+ times, each as a separate load with its own geometry and materials, and asserts
+ that once every copy is loaded the scene renders with fewer draws than the one
+ per geometry element of each copy that it would take without instancing.
+ */
+class VROInstancingTest : public VROFrameListener, public VRORendererTest, public std::enable_shared_from_this<VROFrameListener> {
+public:
+    
+    VROInstancingTest();
+    virtual ~VROInstancingTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+    void onFrameWillRender(const VRORenderContext &context);
+    void onFrameDidRender(const VRORenderContext &context);
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    std::shared_ptr<VRODriver> _driver;
+    
+    /*
+     Number of copies of the model that have finished loading, the total number
+     of geometry elements across those copies (the number of draws required
+     without instancing), and the number of frames rendered since the last
+     copy loaded.
+     */
+    int _numLoaded;
+    int _numElements;
+    int _numFrames;
+    
+    /*
+     Count the geometry elements of the given node and its descendants.
+     */
+    static int countElements(std::shared_ptr<VRONode> node);
+    
+};
+
+#endif /* VROInstancingTest_h */
@@ -98,5 +98,10 @@ uint32_t VROJenkinsHashMixShorts(uint32_t hash, const uint16_t* shorts, size_t s
     return hash;
 }
 
+uint64_t VROJenkinsHash64(const uint8_t* bytes, size_t size) {
+    uint64_t high = VROJenkinsHashWhiten(VROJenkinsHashMixBytes(0, bytes, size));
+    uint64_t low = VROJenkinsHashWhiten(VROJenkinsHashMixBytes(0x9e3779b9, bytes, size));
+    return (high << 32) | low;
 }
 
+}
@@ -50,6 +50,9 @@
 #ifndef VROJenkinsHash_h
 #define VROJenkinsHash_h
 
+#include <stdint.h>
+#include <stddef.h>
+
 namespace android {
 
 /* The Jenkins hash of a sequence of 32 bit words A, B, C is:
@@ -72,6 +75,10 @@ uint32_t VROJenkinsHashMixBytes(uint32_t hash, const uint8_t* bytes, size_t size
 
 uint32_t VROJenkinsHashMixShorts(uint32_t hash, const uint16_t* shorts, size_t size);
 
+/* 64 bit hash of a sequence of bytes, formed from two differently seeded
+ * 32 bit hashes. Used to key caches by content. */
+uint64_t VROJenkinsHash64(const uint8_t* bytes, size_t size);
+
 }
 
 #endif // VROJenkinsHash_h
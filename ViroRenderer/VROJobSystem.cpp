@@ -0,0 +1,326 @@
+//
+//  VROJobSystem.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/18/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROJobSystem.h"
+#include "VRODefines.h"
+#include "VROLog.h"
+#include <algorithm>
+
+// Frame preparation jobs are short; beyond this many workers the overhead of
+// distributing them outweighs the gain on mobile hardware
+static const int kMaxWorkers = 7;
+
+// The job system and queue index of the current thread, if it is a worker
+static thread_local const VROJobSystem *tJobSystem = nullptr;
+static thread_local int tQueueIndex = -1;
+
+std::shared_ptr<VROJobSystem> VROJobSystem::getBackgroundJobSystem() {
+    static std::shared_ptr<VROJobSystem> sJobSystem = std::make_shared<VROJobSystem>();
+    return sJobSystem;
+}
+
+VROJobSystem::VROJobSystem() :
+    _numPendingJobs(0),
+    _stopped(false) {
+    
+    int numWorkers = 0;
+#if !VRO_PLATFORM_WASM
+    numWorkers = std::min((int) std::thread::hardware_concurrency() - 1, kMaxWorkers);
+    numWorkers = std::max(numWorkers, 0);
+#endif
+    
+    for (int i = 0; i < numWorkers + 1; i++) {
+        _queues.push_back(std::unique_ptr<VROJobQueue>(new VROJobQueue()));
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        _workers.push_back(std::thread(&VROJobSystem::workerLoop, this, i));
+    }
+    pinfo("Job system started with %d workers", numWorkers);
+}
+
+VROJobSystem::~VROJobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopped = true;
+    }
+    _sleepCondition.notify_all();
+    
+    for (std::thread &worker : _workers) {
+        worker.join();
+    }
+}
+
+#pragma mark - Workers
+
+void VROJobSystem::workerLoop(int index) {
+    tJobSystem = this;
+    tQueueIndex = index;
+    VROThreadRestricted::adoptThread(VROThreadName::Worker);
+    
+    while (true) {
+        if (executeNextJob()) {
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepCondition.wait(lock, [this] {
+            return _stopped || _numPendingJobs.load() > 0;
+        });
+        if (_stopped) {
+            return;
+        }
+    }
+}
+
+int VROJobSystem::getQueueIndex() const {
+    if (tJobSystem == this) {
+        return tQueueIndex;
+    }
+    return (int) _queues.size() - 1;
+}
+
+bool VROJobSystem::popJob(int queueIndex, VROJob *outJob) {
+    // First pop the most recently scheduled job from our own queue
+    {
+        VROJobQueue &queue = *_queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.empty()) {
+            *outJob = queue.popBack();
+            return true;
+        }
+    }
+    
+    // Otherwise steal the oldest job from another queue
+    int numQueues = (int) _queues.size();
+    for (int i = 1; i < numQueues; i++) {
+        VROJobQueue &queue = *_queues[(queueIndex + i) % numQueues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.empty()) {
+            *outJob = queue.popFront();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VROJobSystem::executeNextJob() {
+    VROJob job;
+    if (!popJob(getQueueIndex(), &job)) {
+        return false;
+    }
+    _numPendingJobs.fetch_sub(1);
+    
+    job.function();
+    if (job.counter) {
+        job.counter->fetch_sub(1, std::memory_order_acq_rel);
+    }
+    return true;
+}
+
+#pragma mark - Job Queue
+
+void VROJobSystem::VROJobQueue::pushBack(VROJob job) {
+    if (_size == _jobs.size()) {
+        // Grow, unwrapping the ring so that the jobs start at index zero
+        std::vector<VROJob> jobs(std::max(_jobs.size() * 2, (size_t) 16));
+        for (size_t i = 0; i < _size; i++) {
+            jobs[i] = std::move(_jobs[(_head + i) % _jobs.size()]);
+        }
+        _jobs.swap(jobs);
+        _head = 0;
+    }
+    _jobs[(_head + _size) % _jobs.size()] = std::move(job);
+    ++_size;
+}
+
+VROJobSystem::VROJob VROJobSystem::VROJobQueue::popBack() {
+    --_size;
+    VROJob &slot = _jobs[(_head + _size) % _jobs.size()];
+    VROJob job = std::move(slot);
+    slot.function = nullptr;
+    return job;
+}
+
+VROJobSystem::VROJob VROJobSystem::VROJobQueue::popFront() {
+    VROJob &slot = _jobs[_head];
+    VROJob job = std::move(slot);
+    slot.function = nullptr;
+    _head = (_head + 1) % _jobs.size();
+    --_size;
+    return job;
+}
+
+#pragma mark - Scheduling
+
+void VROJobSystem::schedule(std::function<void()> job, std::atomic<int> *counter) {
+    if (_workers.empty()) {
+        job();
+        if (counter) {
+            counter->fetch_sub(1, std::memory_order_acq_rel);
+        }
+        return;
+    }
+    
+    {
+        VROJobQueue &queue = *_queues[getQueueIndex()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pushBack({ std::move(job), counter });
+    }
+    _numPendingJobs.fetch_add(1);
+    
+    // Acquire the sleep mutex so that a worker cannot miss this wakeup between
+    // checking for pending jobs and going to sleep
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+    }
+    _sleepCondition.notify_one();
+}
+
+void VROJobSystem::wait(std::atomic<int> &counter) {
+    while (counter.load(std::memory_order_acquire) > 0) {
+        if (!executeNextJob()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void VROJobSystem::parallelFor(int count, int grain, const std::function<void(int start, int end)> &function) {
+    if (count <= 0) {
+        return;
+    }
+    grain = std::max(grain, 1);
+    
+    int numRanges = (count + grain - 1) / grain;
+    if (numRanges == 1 || _workers.empty()) {
+        function(0, count);
+        return;
+    }
+    
+    // Schedule all but the first range, which we run on this thread
+    std::atomic<int> counter(numRanges - 1);
+    for (int r = 1; r < numRanges; r++) {
+        int start = r * grain;
+        int end = std::min(start + grain, count);
+        schedule([&function, start, end] {
+            function(start, end);
+        }, &counter);
+    }
+    
+    function(0, std::min(grain, count));
+    wait(counter);
+}
+
+#pragma mark - Job Graph
+
+VROJobGraph::VROJobGraph(VROFrameArena *arena) :
+    _arena(arena),
+    _jobs(VROFrameAllocator<std::function<void()>>(arena)),
+    _numDependencies(VROFrameAllocator<int>(arena)),
+    _dependencies(VROFrameAllocator<std::pair<int, int>>(arena)),
+    _jobSystem(nullptr),
+    _remaining(nullptr),
+    _counter(nullptr) {
+    
+}
+
+int VROJobGraph::addJob(std::function<void()> job) {
+    _jobs.push_back(std::move(job));
+    _numDependencies.push_back(0);
+    return (int) _jobs.size() - 1;
+}
+
+void VROJobGraph::addDependency(int job, int dependency) {
+    passert (job < (int) _jobs.size() && dependency < (int) _jobs.size());
+    _dependencies.push_back({ job, dependency });
+    _numDependencies[job]++;
+}
+
+void VROJobGraph::execute(std::shared_ptr<VROJobSystem> jobSystem) {
+    int numJobs = (int) _jobs.size();
+    
+    /*
+     Without a job system, run the jobs serially in dependency (topological)
+     order.
+     */
+    if (!jobSystem) {
+        VROFrameVector<int> remaining(_numDependencies);
+        VROFrameVector<int> ready { VROFrameAllocator<int>(_arena) };
+        ready.reserve(numJobs);
+        for (int i = 0; i < numJobs; i++) {
+            if (remaining[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        while (!ready.empty()) {
+            int job = ready.back();
+            ready.pop_back();
+            _jobs[job]();
+            
+            for (const std::pair<int, int> &edge : _dependencies) {
+                if (edge.second == job && --remaining[edge.first] == 0) {
+                    ready.push_back(edge.first);
+                }
+            }
+        }
+        return;
+    }
+    
+    VROFrameVector<std::atomic<int>> remaining(numJobs, VROFrameAllocator<std::atomic<int>>(_arena));
+    for (int i = 0; i < numJobs; i++) {
+        remaining[i].store(_numDependencies[i]);
+    }
+    
+    std::atomic<int> counter(numJobs);
+    _jobSystem = jobSystem.get();
+    _remaining = remaining.data();
+    _counter = &counter;
+    
+    for (int i = 0; i < numJobs; i++) {
+        if (_numDependencies[i] == 0) {
+            schedule(i);
+        }
+    }
+    jobSystem->wait(counter);
+    
+    _jobSystem = nullptr;
+    _remaining = nullptr;
+    _counter = nullptr;
+}
+
+void VROJobGraph::schedule(int job) {
+    _jobSystem->schedule([this, job] {
+        _jobs[job]();
+        
+        // Successors are scheduled before this job's completion is counted,
+        // so the graph cannot appear complete while work remains
+        for (const std::pair<int, int> &edge : _dependencies) {
+            if (edge.second == job && _remaining[edge.first].fetch_sub(1) == 1) {
+                schedule(edge.first);
+            }
+        }
+    }, _counter);
+}
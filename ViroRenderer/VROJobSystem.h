@@ -0,0 +1,214 @@
+//
+//  VROJobSystem.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/18/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROJobSystem_h
+#define VROJobSystem_h
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "VROThreadRestricted.h"
+#include "VROFrameArena.h"
+
+/*
+ Pool of worker threads that execute short, CPU-bound jobs on behalf of the
+ rendering thread during frame preparation. Each worker owns a double-ended
+ queue: it pushes and pops its own jobs from the back (so recently created,
+ cache-warm jobs run first), and when its queue is empty it steals from the
+ front of the other queues.
+
+ Threads that wait on jobs never block idly: they execute pending jobs until
+ the jobs they are waiting on complete. This makes it safe to issue parallel
+ work from within a job.
+
+ Workers identify themselves as VROThreadName::Worker, so thread-restricted
+ objects touched from a job are flagged, and code that behaves differently
+ on the rendering thread (e.g. animations) takes its off-thread path. Jobs
+ must only touch state that no other job touches concurrently.
+
+ If the platform has a single core (or no thread support), the job system
+ has no workers and all work executes inline on the calling thread.
+ */
+class VROJobSystem {
+
+public:
+
+    /*
+     The job system shared by background tasks that parallelize CPU work off
+     the rendering thread, such as decoding large HDR images and baking IBL
+     maps. It is created on first use and lives for the rest of the process,
+     so these tasks do not each start and join their own workers. It is
+     separate from the renderer's job system, so background work never takes
+     workers away from frame preparation.
+     */
+    static std::shared_ptr<VROJobSystem> getBackgroundJobSystem();
+
+    VROJobSystem();
+    virtual ~VROJobSystem();
+
+    /*
+     Number of worker threads, not including the calling thread.
+     */
+    int getNumWorkers() const {
+        return (int) _workers.size();
+    }
+
+    /*
+     Invoke the given function over [0, count) split into ranges of at most
+     grain elements, in parallel. The function receives the [start, end) of
+     each range. Blocks until every range has completed.
+     */
+    void parallelFor(int count, int grain, const std::function<void(int start, int end)> &function);
+
+    /*
+     Internal: schedule a job on the calling thread's queue. The counter is
+     decremented when the job completes.
+     */
+    void schedule(std::function<void()> job, std::atomic<int> *counter);
+
+    /*
+     Internal: execute pending jobs until the given counter reaches zero.
+     */
+    void wait(std::atomic<int> &counter);
+
+private:
+
+    struct VROJob {
+        std::function<void()> function;
+        std::atomic<int> *counter;
+    };
+
+    /*
+     Double-ended queue of jobs, stored in a ring buffer that grows but never
+     shrinks, so that scheduling does not allocate once the queue has reached
+     its working size.
+     */
+    class VROJobQueue {
+    public:
+        std::mutex mutex;
+
+        VROJobQueue() : _head(0), _size(0) {}
+        bool empty() const {
+            return _size == 0;
+        }
+        void pushBack(VROJob job);
+        VROJob popBack();
+        VROJob popFront();
+
+    private:
+        std::vector<VROJob> _jobs;
+        size_t _head;
+        size_t _size;
+    };
+
+    /*
+     One queue per worker, followed by a final queue shared by all
+     non-worker threads.
+     */
+    std::vector<std::unique_ptr<VROJobQueue>> _queues;
+    std::vector<std::thread> _workers;
+
+    /*
+     Idle workers sleep on this condition until jobs are scheduled.
+     */
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<int> _numPendingJobs;
+    bool _stopped;
+
+    void workerLoop(int index);
+    int getQueueIndex() const;
+    bool popJob(int queueIndex, VROJob *outJob);
+    bool executeNextJob();
+
+};
+
+/*
+ A small task graph of jobs with dependencies between them. A job is started
+ only once all of the jobs it depends on have completed. The graph is
+ executed on a VROJobSystem, and execute() returns when every job has run.
+ */
+class VROJobGraph {
+
+public:
+
+    /*
+     Create a job graph. If an arena is provided, the graph's storage is allocated
+     from it, in which case the graph must not outlive the current frame.
+     */
+    VROJobGraph(VROFrameArena *arena = nullptr);
+    virtual ~VROJobGraph() {}
+
+    /*
+     Add a job to the graph, returning its identifier.
+     */
+    int addJob(std::function<void()> job);
+
+    /*
+     Indicate that the given job may only start after the dependency has
+     completed.
+     */
+    void addDependency(int job, int dependency);
+
+    /*
+     Run all jobs in the graph, blocking until they have all completed. If
+     the job system is null, the jobs run serially in dependency order.
+     */
+    void execute(std::shared_ptr<VROJobSystem> jobSystem);
+
+private:
+
+    template <typename T>
+    using VROFrameVector = std::vector<T, VROFrameAllocator<T>>;
+
+    VROFrameArena *_arena;
+    VROFrameVector<std::function<void()>> _jobs;
+    VROFrameVector<int> _numDependencies;
+
+    /*
+     Dependency edges, as (job, dependency) pairs. Graphs are small, so the
+     successors of a job are found by scanning the edges.
+     */
+    VROFrameVector<std::pair<int, int>> _dependencies;
+
+    /*
+     State used while the graph executes, held here so that the scheduled
+     closures stay small enough to avoid allocation.
+     */
+    VROJobSystem *_jobSystem;
+    std::atomic<int> *_remaining;
+    std::atomic<int> *_counter;
+
+    void schedule(int job);
+
+};
+
+#endif /* VROJobSystem_h */
@@ -0,0 +1,96 @@
+//
+//  VROKeyframeCursor.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/31/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROKeyframeCursor_h
+#define VROKeyframeCursor_h
+
+#include <algorithm>
+
+/*
+ Locates the active segment of a keyframe track: the pair of keys whose
+ times bracket the input time. Each animated track keeps its own cursor,
+ which remembers the segment found last. During normal playback time
+ moves forward by a small amount each frame, so the next segment is
+ either the same one or one of those just after it, and is found in
+ constant time. Any other input (a seek, a loop, or reversed playback)
+ falls back to a binary search.
+
+ A cursor is not tied to a specific track, but should only be used with
+ one: a cursor shared between tracks is correct, but degenerates to a
+ binary search on every lookup.
+ */
+class VROKeyframeCursor {
+    
+public:
+    
+    VROKeyframeCursor() : _segment(0) {}
+    
+    /*
+     Find the segment of the given key times that contains the input, i.e. the
+     index i such that times[i] <= input < times[i + 1]. The input must lie in
+     [times[0], times[count - 1]), and there must be at least two keys.
+     */
+    int find(float input, const float *times, int count) {
+        int i = _segment;
+        if (i < count - 1 && times[i] <= input) {
+            if (input < times[i + 1]) {
+                return i;
+            }
+            if (i + 2 < count && input < times[i + 2]) {
+                _segment = i + 1;
+                return _segment;
+            }
+        }
+        _segment = search(input, times, count);
+        return _segment;
+    }
+    
+    /*
+     Forget the last segment found.
+     */
+    void reset() {
+        _segment = 0;
+    }
+    
+    /*
+     Find the segment containing the input by binary search, without a cursor.
+     The result is clamped to a valid segment, even for inputs outside the keys.
+     */
+    static int search(float input, const float *times, int count) {
+        int i = (int) (std::upper_bound(times, times + count, input) - times) - 1;
+        return std::max(0, std::min(i, count - 2));
+    }
+    
+private:
+    
+    /*
+     Index of the first key of the segment found last.
+     */
+    int _segment;
+    
+};
+
+#endif /* VROKeyframeCursor_h */
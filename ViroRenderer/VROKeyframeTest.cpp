@@ -0,0 +1,182 @@
+//
+//  VROKeyframeTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/31/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROKeyframeTest.h"
+#include "VROTestUtil.h"
+#include "VROMath.h"
+#include "VROTime.h"
+
+static const int kNumKeys = 10000;
+static const int kLookupsPerFrame = 1000;
+
+// Fraction of a key that playback advances between lookups
+static const float kPlaybackStep = 0.25f;
+
+// Number of frames between each benchmark report
+static const int kReportFrames = 120;
+
+/*
+ Keyframe lookup as it was done before VROKeyframeCursor: a scan from the
+ first key until the input is passed.
+ */
+static int VROKeyframeScan(float input, const float *times, int count) {
+    for (int i = 1; i < count - 1; i++) {
+        if (input < times[i]) {
+            return i - 1;
+        }
+    }
+    return count - 2;
+}
+
+VROKeyframeTest::VROKeyframeTest() :
+    VRORendererTest(VRORendererTestType::KeyframeLookup),
+    _time(0),
+    _numFrames(0),
+    _checksum(0) {
+    
+    for (int i = 0; i < 3; i++) {
+        _playbackMillis[i] = 0;
+        _seekMillis[i] = 0;
+    }
+}
+
+VROKeyframeTest::~VROKeyframeTest() {
+    
+}
+
+void VROKeyframeTest::build(std::shared_ptr<VRORenderer> renderer,
+                            std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                            std::shared_ptr<VRODriver> driver) {
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    /*
+     A track of kNumKeys rotations, four full turns about Y, with slightly
+     uneven key spacing as exported animations usually have.
+     */
+    _keyTimes.resize(kNumKeys);
+    _keyValues.resize(kNumKeys);
+    for (int i = 0; i < kNumKeys; i++) {
+        float jitter = (i > 0 && i < kNumKeys - 1) ? 0.3f * sinf(i * 12.9898f) : 0;
+        _keyTimes[i] = (i + jitter) / (kNumKeys - 1);
+        _keyValues[i] = VROQuaternion(0, 8 * M_PI * _keyTimes[i], 0.25f * sinf(i * 0.01f));
+    }
+    
+    std::shared_ptr<VROBox> box = VROBox::createBox(0.5, 0.5, 0.5);
+    std::shared_ptr<VROMaterial> material = box->getMaterials()[0];
+    material->setLightingModel(VROLightingModel::Constant);
+    material->getDiffuse().setColor({ 0.4, 0.7, 1.0, 1.0 });
+    
+    std::shared_ptr<VRONode> boxNode = std::make_shared<VRONode>();
+    boxNode->setGeometry(box);
+    boxNode->setPosition({ 0, 0, -3 });
+    rootNode->addChildNode(boxNode);
+    
+    std::shared_ptr<VROAction> action = VROAction::perpetualPerFrameAction([this](VRONode *const node, float seconds) {
+        node->setRotation(VROMathInterpolateKeyFrameQuaternion(_time, _keyTimes, _keyValues, &_boxCursor));
+        return true;
+    });
+    boxNode->runAction(action);
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    cameraNode->setPosition({ 0, 0, 0 });
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+    frameSynchronizer->addFrameListener(shared_from_this());
+}
+
+void VROKeyframeTest::onFrameWillRender(const VRORenderContext &context) {
+    
+}
+
+void VROKeyframeTest::onFrameDidRender(const VRORenderContext &context) {
+    /*
+     Playback lookups advance monotonically from the box's time, looping at
+     the end of the track; seek lookups are uniformly random.
+     */
+    float step = kPlaybackStep / kNumKeys;
+    std::vector<float> playback(kLookupsPerFrame);
+    std::vector<float> seeks(kLookupsPerFrame);
+    for (int i = 0; i < kLookupsPerFrame; i++) {
+        _time += step;
+        if (_time >= 1.0f) {
+            _time -= 1.0f;
+        }
+        playback[i] = _time;
+        seeks[i] = drand48();
+    }
+    
+    benchmark(playback, _playbackCursor, _playbackMillis);
+    benchmark(seeks, _seekCursor, _seekMillis);
+    ++_numFrames;
+    
+    if (_numFrames == kReportFrames) {
+        double scale = 1000.0 / (kLookupsPerFrame * _numFrames);
+        pinfo("Keyframe lookup per 1k lookups on %d keys: playback [scan %.3f ms, search %.3f ms, cursor %.3f ms], seek [scan %.3f ms, search %.3f ms, cursor %.3f ms] (%d)",
+              kNumKeys,
+              _playbackMillis[0] * scale, _playbackMillis[1] * scale, _playbackMillis[2] * scale,
+              _seekMillis[0] * scale, _seekMillis[1] * scale, _seekMillis[2] * scale, _checksum);
+        
+        _numFrames = 0;
+        for (int i = 0; i < 3; i++) {
+            _playbackMillis[i] = 0;
+            _seekMillis[i] = 0;
+        }
+    }
+}
+
+void VROKeyframeTest::benchmark(const std::vector<float> &inputs, VROKeyframeCursor &cursor, double *outMillis) {
+    const float *times = _keyTimes.data();
+    int count = (int) _keyTimes.size();
+    int scanSum = 0, searchSum = 0, cursorSum = 0;
+    
+    double start = VROTimeCurrentMillis();
+    for (float input : inputs) {
+        scanSum += VROKeyframeScan(input, times, count);
+    }
+    double scanEnd = VROTimeCurrentMillis();
+    for (float input : inputs) {
+        searchSum += VROKeyframeCursor::search(input, times, count);
+    }
+    double searchEnd = VROTimeCurrentMillis();
+    for (float input : inputs) {
+        cursorSum += cursor.find(input, times, count);
+    }
+    double cursorEnd = VROTimeCurrentMillis();
+    
+    passert (scanSum == searchSum && searchSum == cursorSum);
+    _checksum += cursorSum;
+    
+    outMillis[0] += scanEnd - start;
+    outMillis[1] += searchEnd - scanEnd;
+    outMillis[2] += cursorEnd - searchEnd;
+}
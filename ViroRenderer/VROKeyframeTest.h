@@ -0,0 +1,97 @@
+//
+//  VROKeyframeTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/31/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROKeyframeTest_h
+#define VROKeyframeTest_h
+
+#include "VRORendererTest.h"
+#include "VROKeyframeCursor.h"
+
+/*
+ Benchmark for keyframe lookup. Rotates a box using a 10k-key rotation track,
+ and periodically logs the time taken to locate keyframes in that track, per
+ 1k lookups, using a linear scan, a binary search, and a VROKeyframeCursor.
+ Lookups are measured both for monotonic playback and for random seeks.
+ */
+class VROKeyframeTest : public VROFrameListener, public VRORendererTest, public std::enable_shared_from_this<VROFrameListener> {
+public:
+    
+    VROKeyframeTest();
+    virtual ~VROKeyframeTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+    void onFrameWillRender(const VRORenderContext &context);
+    void onFrameDidRender(const VRORenderContext &context);
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    
+    /*
+     The benchmarked track, and the normalized playback time of the box.
+     */
+    std::vector<float> _keyTimes;
+    std::vector<VROQuaternion> _keyValues;
+    float _time;
+    
+    /*
+     Cursors used to rotate the box, and by the playback and seek benchmarks.
+     */
+    VROKeyframeCursor _boxCursor;
+    VROKeyframeCursor _playbackCursor;
+    VROKeyframeCursor _seekCursor;
+    
+    /*
+     Lookup times accumulated since the last report, for playback and seeks.
+     */
+    int _numFrames;
+    double _playbackMillis[3];
+    double _seekMillis[3];
+    
+    /*
+     Running sum of the segments found, so the lookups cannot be optimized away.
+     */
+    int _checksum;
+    
+    /*
+     Locate each input in the track by scan, search, and cursor, adding the
+     time taken by each to the corresponding entry of outMillis.
+     */
+    void benchmark(const std::vector<float> &inputs, VROKeyframeCursor &cursor, double *outMillis);
+    
+};
+
+#endif /* VROKeyframeTest_h */
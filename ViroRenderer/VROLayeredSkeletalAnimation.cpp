@@ -36,27 +36,146 @@
 #include "VROAnimationChain.h"
 #include "VROExecutableNodeAnimation.h"
 #include "VROSkeletalAnimationLayer.h"
+#include "VROMath.h"
+#include "VROQuaternion.h"
 #include <sstream>
 #include <map>
+#include <algorithm>
 
-static const float kBlendEpsilon = 0.02;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VRO_BLEND_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VRO_BLEND_SSE 1
+#endif
+
+/*
+ Minimal four-wide float vector used to accumulate weighted translations,
+ rotations, and scales.
+ */
+#if VRO_BLEND_NEON
+typedef float32x4_t VROFloat4;
+
+static inline VROFloat4 VROFloat4Load(const float *f) { return vld1q_f32(f); }
+static inline void VROFloat4Store(float *f, VROFloat4 a) { vst1q_f32(f, a); }
+static inline VROFloat4 VROFloat4Splat(float f)       { return vdupq_n_f32(f); }
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) { return vaddq_f32(a, b); }
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) { return vmulq_f32(a, b); }
+#elif VRO_BLEND_SSE
+typedef __m128 VROFloat4;
+
+static inline VROFloat4 VROFloat4Load(const float *f) { return _mm_loadu_ps(f); }
+static inline void VROFloat4Store(float *f, VROFloat4 a) { _mm_storeu_ps(f, a); }
+static inline VROFloat4 VROFloat4Splat(float f)       { return _mm_set1_ps(f); }
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) { return _mm_add_ps(a, b); }
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) { return _mm_mul_ps(a, b); }
+#else
+struct VROFloat4 {
+    float v[4];
+};
+
+static inline VROFloat4 VROFloat4Load(const float *f) {
+    return {{ f[0], f[1], f[2], f[3] }};
+}
+static inline void VROFloat4Store(float *f, VROFloat4 a) {
+    f[0] = a.v[0]; f[1] = a.v[1]; f[2] = a.v[2]; f[3] = a.v[3];
+}
+static inline VROFloat4 VROFloat4Splat(float f) {
+    return {{ f, f, f, f }};
+}
+static inline VROFloat4 VROFloat4Add(VROFloat4 a, VROFloat4 b) {
+    return {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] }};
+}
+static inline VROFloat4 VROFloat4Mul(VROFloat4 a, VROFloat4 b) {
+    return {{ a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] }};
+}
+#endif
+
+static VROBoneTRS VRODecomposeBoneTransform(const VROMatrix4f &transform) {
+    VROVector3f translation = transform.extractTranslation();
+    VROVector3f scale = transform.extractScale();
+    
+    // Degenerate (zero-scale) transforms have no meaningful rotation
+    VROQuaternion rotation;
+    if (scale.x > 1e-8 && scale.y > 1e-8 && scale.z > 1e-8) {
+        rotation = transform.extractRotation(scale);
+        rotation.normalize();
+    }
+    
+    VROBoneTRS key = {
+        { translation.x, translation.y, translation.z, 0 },
+        { rotation.X, rotation.Y, rotation.Z, rotation.W },
+        { scale.x, scale.y, scale.z, 0 },
+    };
+    return key;
+}
 
 void VROSkeletalAnimationLayerInternal::buildKeyframes() {
     // If the keyframes are already built, nothing to do here
-    if (boneKeyTimes.size() > 0) {
+    if (trackBones.size() > 0) {
         return;
     }
+    
+    std::map<int, std::vector<float>> boneKeyTimes;
+    std::map<int, std::vector<const VROMatrix4f *>> boneLocalTransforms;
     for (const std::unique_ptr<VROSkeletalAnimationFrame> &frame : animation->getFrames()) {
         passert (frame->boneIndices.size() == frame->boneTransforms.size());
         
-        for (int f = 0; f < frame->boneIndices.size(); f++) {
+        for (size_t f = 0; f < frame->boneIndices.size(); f++) {
             int boneIndex = frame->boneIndices[f];
             boneKeyTimes[boneIndex].push_back(frame->time);
-            boneLocalTransforms[boneIndex].push_back(frame->localBoneTransforms[f]);
+            boneLocalTransforms[boneIndex].push_back(&frame->localBoneTransforms[f]);
+        }
+    }
+    
+    boneTracks.assign(animation->getSkinner()->getSkeleton()->getNumBones(), -1);
+    for (auto &kv : boneKeyTimes) {
+        int boneIndex = kv.first;
+        if (boneIndex >= (int) boneTracks.size()) {
+            boneTracks.resize(boneIndex + 1, -1);
+        }
+        boneTracks[boneIndex] = (int) trackBones.size();
+        trackBones.push_back(boneIndex);
+        trackFirstKey.push_back((int) keys.size());
+        trackNumKeys.push_back((int) kv.second.size());
+        
+        const std::vector<const VROMatrix4f *> &transforms = boneLocalTransforms[boneIndex];
+        for (size_t k = 0; k < kv.second.size(); k++) {
+            keyTimes.push_back(kv.second[k]);
+            keys.push_back(VRODecomposeBoneTransform(*transforms[k]));
+            keyTransforms.push_back(transforms[k]);
+        }
+    }
+    buildBoneMask();
+}
+
+void VROSkeletalAnimationLayerInternal::buildBoneMask() {
+    boneMask.assign(boneTracks.size(), defaultBoneWeight);
+    for (auto &kv : boneWeights) {
+        if (kv.first >= 0 && kv.first < (int) boneMask.size()) {
+            boneMask[kv.first] = kv.second;
         }
     }
 }
 
+void VROSkeletalAnimationLayerInternal::setBoneWeights(float defaultBoneWeight, const std::map<int, float> &boneWeights) {
+    this->defaultBoneWeight = defaultBoneWeight;
+    this->boneWeights = boneWeights;
+    
+    // Only the mask is derived from the weights; the keyframe data is untouched
+    if (!boneMask.empty()) {
+        buildBoneMask();
+    }
+    weightsVersion++;
+}
+
+void VROSkeletalAnimationLayer::updateInternalWeights() {
+    for (auto &kv : _internal) {
+        kv.second->setBoneWeights(defaultBoneWeight, boneWeights);
+    }
+}
+
 void VROLayeredSkeletalAnimation::flattenAnimationChain(std::shared_ptr<VROAnimationChain> chain, std::vector<std::shared_ptr<VROExecutableAnimation>> *animations) {
     
     for (const std::shared_ptr<VROExecutableAnimation> &child : chain->getAnimations()) {
@@ -155,15 +274,9 @@ std::shared_ptr<VROExecutableAnimation> VROLayeredSkeletalAnimation::createLayer
 }
 
 std::shared_ptr<VROExecutableAnimation> VROLayeredSkeletalAnimation::copy() {
-    std::vector<std::shared_ptr<VROSkeletalAnimationLayerInternal>> layers;
-    for (std::shared_ptr<VROSkeletalAnimationLayerInternal> &origLayer : _layers) {
-        std::shared_ptr<VROSkeletalAnimationLayerInternal> layer = std::make_shared<VROSkeletalAnimationLayerInternal>(origLayer->name, origLayer->defaultBoneWeight);
-        layer->animation = origLayer->animation;
-        layer->boneWeights = origLayer->boneWeights;
-        layers.push_back(layer);
-    }
-    
-    std::shared_ptr<VROLayeredSkeletalAnimation> animation = std::make_shared<VROLayeredSkeletalAnimation>(_skinner, layers, _duration);
+    // The layers are shared with the copy, so their keyframe data is not rebuilt, and
+    // re-weighting a layer affects every animation blending it
+    std::shared_ptr<VROLayeredSkeletalAnimation> animation = std::make_shared<VROLayeredSkeletalAnimation>(_skinner, _layers, _duration);
     animation->setName(_name);
     animation->setTimeOffset(_timeOffset);
     animation->setSpeed(_speed);
@@ -171,34 +284,56 @@ std::shared_ptr<VROExecutableAnimation> VROLayeredSkeletalAnimation::copy() {
 }
 
 void VROLayeredSkeletalAnimation::blendFrame(int f) {
-    const std::vector<std::unique_ptr<VROSkeletalAnimationFrame>> &masterFrames = _layers[0]->animation->getFrames();
-    std::vector<std::pair<VROMatrix4f, float>> boneTransformsToBlend;
-
-    for (int b = 0; b < masterFrames[f]->boneIndices.size(); b++) {
-        int boneIndex = masterFrames[f]->boneIndices[b];
+    const std::shared_ptr<VROSkeleton> &skeleton = _skinner->getSkeleton();
+    
+    for (int t = 0; t < (int) _trackBones.size(); t++) {
+        if (f >= _trackNumKeys[t]) {
+            continue;
+        }
+        int boneIndex = _trackBones[t];
         
         // Collect all layers that have a non-zero weight on this bone
-        VROMatrix4f boneIdentityTransform = _skinner->getSkeleton()->getBone(boneIndex)->getLocalTransform();
-        
-        for (int i = 0; i < _layers.size(); i++) {
-            std::shared_ptr<VROSkeletalAnimationLayerInternal> &layer = _layers[i];
+        int count = 0;
+        for (const std::shared_ptr<VROSkeletalAnimationLayerInternal> &layer : _layers) {
             float weight = layer->getBoneWeight(boneIndex);
-            if (weight > 0) {
-                auto boneLocalTransform = layer->boneLocalTransforms.find(boneIndex);
-                if (boneLocalTransform != layer->boneLocalTransforms.end() && f < boneLocalTransform->second.size()) {
-                    boneTransformsToBlend.push_back({ boneLocalTransform->second[f], weight });
-                }
+            if (weight <= 0 || boneIndex >= (int) layer->boneTracks.size()) {
+                continue;
+            }
+            int track = layer->boneTracks[boneIndex];
+            if (track >= 0 && f < layer->trackNumKeys[track]) {
+                _blendKeys[count] = &layer->keys[layer->trackFirstKey[track] + f];
+                _blendTransforms[count] = layer->keyTransforms[layer->trackFirstKey[track] + f];
+                _blendWeights[count] = weight;
+                count++;
             }
         }
         
-        if (boneTransformsToBlend.size() == 0) {
-            _boneTransforms[boneIndex][f] = boneIdentityTransform;
-        } else if (boneTransformsToBlend.size() == 1) {
-            _boneTransforms[boneIndex][f] = boneTransformsToBlend[0].first;
+        VROMatrix4f &transform = _boneTransforms[_trackFirstKey[t] + f];
+        if (count == 0) {
+            transform = skeleton->getBone(boneIndex)->getLocalTransform();
+        } else if (count == 1) {
+            transform = *_blendTransforms[0];
         } else {
-            _boneTransforms[boneIndex][f] = blendBoneTransforms(boneIndex, boneTransformsToBlend);
+            VROBoneTRS blended;
+            blendBoneKeys(_blendKeys.data(), _blendWeights.data(), count, &blended);
+            
+            float m[16];
+            VROMathComposeTRS(blended.translation, blended.rotation, blended.scale, m);
+            transform = VROMatrix4f(m);
+        }
+    }
+}
+
+void VROLayeredSkeletalAnimation::invalidateIfReweighted() {
+    bool reweighted = false;
+    for (int i = 0; i < (int) _layers.size(); i++) {
+        if (_layers[i]->weightsVersion != _cachedWeightsVersions[i]) {
+            _cachedWeightsVersions[i] = _layers[i]->weightsVersion;
+            reweighted = true;
         }
-        boneTransformsToBlend.clear();
+    }
+    if (reweighted) {
+        std::fill(_cached.begin(), _cached.end(), false);
     }
 }
 
@@ -206,20 +341,31 @@ void VROLayeredSkeletalAnimation::preload() {
     /*
      Build the keyframe animation data for each layer.
      */
-    for (int i = 0; i < _layers.size(); i++) {
+    for (int i = 0; i < (int) _layers.size(); i++) {
         _layers[i]->buildKeyframes();
     }
     
-    if (_boneKeyTimes.size() == 0) {
-        const std::vector<std::unique_ptr<VROSkeletalAnimationFrame>> &masterFrames = _layers[0]->animation->getFrames();
-        for (int f = 0; f < masterFrames.size(); f++) {
-            for (int b = 0; b < masterFrames[f]->boneIndices.size(); b++) {
-                int boneIndex = masterFrames[f]->boneIndices[b];
-                _boneKeyTimes[boneIndex].push_back(_layers[0]->boneKeyTimes[boneIndex][f]);
-                _boneTransforms[boneIndex].push_back(VROMatrix4f::identity());
-            }
-            _cached.push_back(false);
+    if (_trackBones.size() == 0) {
+        const std::shared_ptr<VROSkeletalAnimationLayerInternal> &master = _layers[0];
+        _trackBones = master->trackBones;
+        _trackFirstKey = master->trackFirstKey;
+        _trackNumKeys = master->trackNumKeys;
+        _keyTimes = master->keyTimes;
+        _boneTransforms.assign(_keyTimes.size(), VROMatrix4f::identity());
+        
+        int numFrames = 0;
+        for (int numKeys : _trackNumKeys) {
+            numFrames = std::max(numFrames, numKeys);
         }
+        _cached.assign(numFrames, false);
+        
+        _cachedWeightsVersions.clear();
+        for (const std::shared_ptr<VROSkeletalAnimationLayerInternal> &layer : _layers) {
+            _cachedWeightsVersions.push_back(layer->weightsVersion);
+        }
+        _blendKeys.resize(_layers.size());
+        _blendTransforms.resize(_layers.size());
+        _blendWeights.resize(_layers.size());
     }
 }
 
@@ -237,21 +383,22 @@ void VROLayeredSkeletalAnimation::execute(std::shared_ptr<VRONode> node, std::fu
     VROTransaction::setTimingFunction(VROTimingFunctionType::Linear);
     
     std::string name = _name;
-    for (auto kv : _boneKeyTimes) {
-        int boneIndex = kv.first;
-        std::vector<float> &keyTimes = kv.second;
+    for (int t = 0; t < (int) _trackBones.size(); t++) {
+        int firstKey = _trackFirstKey[t];
+        std::vector<float> keyTimes(_keyTimes.begin() + firstKey, _keyTimes.begin() + firstKey + _trackNumKeys[t]);
         
-        std::shared_ptr<VROBone> bone = skeleton->getBone(boneIndex);
+        std::shared_ptr<VROBone> bone = skeleton->getBone(_trackBones[t]);
         
         // TODO Use a a weak pointer for 'this'
-        std::shared_ptr<VROAnimation> animation = std::make_shared<VROAnimationKeyframeIndex>([name, boneIndex, this](VROAnimatable *const animatable, int frame) {
+        std::shared_ptr<VROAnimation> animation = std::make_shared<VROAnimationKeyframeIndex>([name, firstKey, this](VROAnimatable *const animatable, int frame) {
             VROBone *bone = (VROBone *) animatable;
             
+            invalidateIfReweighted();
             if (!_cached[frame]) {
                 blendFrame(frame);
                 _cached[frame] = true;
             }
-            bone->setTransform(_boneTransforms[boneIndex][frame], VROBoneTransformType::Local);
+            bone->setTransform(_boneTransforms[firstKey + frame], VROBoneTransformType::Local);
         }, keyTimes);
         
         bone->animate(animation);
@@ -272,75 +419,55 @@ void VROLayeredSkeletalAnimation::execute(std::shared_ptr<VRONode> node, std::fu
     _transaction = transaction;
 }
 
-VROMatrix4f VROLayeredSkeletalAnimation::blendBoneTransforms(int bone, const std::vector<std::pair<VROMatrix4f, float>> &transformsAndWeights) {
-    passert (transformsAndWeights.size() >= 2);
+void VROLayeredSkeletalAnimation::blendBoneKeys(const VROBoneTRS **keys, const float *weights, int count, VROBoneTRS *result) {
+    passert (count >= 1);
     
     /*
-     Reweight the transforms so they add to one.
+     Reweight the keys so they add to one.
      */
-    std::vector<std::pair<VROMatrix4f, float>> reweighted;
     float totalWeight = 0;
-    for (int i = 0; i < transformsAndWeights.size(); i++) {
-        totalWeight += transformsAndWeights[i].second;
-    }
-    for (int i = 0; i < transformsAndWeights.size(); i++) {
-        reweighted.push_back({ transformsAndWeights[i].first, transformsAndWeights[i].second / totalWeight });
+    for (int i = 0; i < count; i++) {
+        totalWeight += weights[i];
     }
+    float inverseTotalWeight = 1.0f / totalWeight;
     
     /*
-     Compute the blended transform.
+     Accumulate the weighted components. Each rotation is negated if necessary so that it
+     lies in the same hemisphere as the first, since q and -q are the same rotation but
+     would otherwise cancel out.
      */
-    VROMatrix4f blendedTransform = reweighted[0].first;
-    float blendedWeight = reweighted[0].second;
+    const float *reference = keys[0]->rotation;
+    VROFloat4 translation = VROFloat4Splat(0);
+    VROFloat4 rotation = VROFloat4Splat(0);
+    VROFloat4 scale = VROFloat4Splat(0);
     
-    for (int i = 1; i < reweighted.size(); i++) {
-        VROMatrix4f nextTransform = reweighted[i].first;
-        float nextWeight = reweighted[i].second;
-        
-        // Skip tranforms that are below a given weight
-        if (nextWeight < kBlendEpsilon) {
-            continue;
-        }
-        
-        // Reweight from the cumulative weight across all quaternions into a normalized
-        // weight between just the last quaternion and the new one
-        float totalWeight = blendedWeight + nextWeight;
-        float twoValueBlendWeight = (nextWeight / totalWeight);
+    for (int i = 0; i < count; i++) {
+        const VROBoneTRS *key = keys[i];
+        float weight = weights[i] * inverseTotalWeight;
+        float dot = reference[0] * key->rotation[0] + reference[1] * key->rotation[1] +
+                    reference[2] * key->rotation[2] + reference[3] * key->rotation[3];
         
-        // Optimization to avoid blending when values are extremely low or high
-        if (twoValueBlendWeight > (1 - kBlendEpsilon)) {
-            blendedTransform = nextTransform;
-        } else if (twoValueBlendWeight > kBlendEpsilon) {
-            blendedTransform = blendBoneTransform(blendedTransform, nextTransform, twoValueBlendWeight);
-        } // else don't bother blending nextTransform into blendedTransform, its weight is too low to matter
-        
-        // Add the original weight of the latest transform to our total blend weight
-        // (note this is distinct from the weight we just used to perform the blend --
-        // that weight is just between the two quaternions, this weight is the weight
-        // amongst *all* quaternions)
-        blendedWeight += nextWeight;
+        VROFloat4 w = VROFloat4Splat(weight);
+        translation = VROFloat4Add(translation, VROFloat4Mul(w, VROFloat4Load(key->translation)));
+        scale = VROFloat4Add(scale, VROFloat4Mul(w, VROFloat4Load(key->scale)));
+        rotation = VROFloat4Add(rotation, VROFloat4Mul(VROFloat4Splat(dot < 0 ? -weight : weight),
+                                                       VROFloat4Load(key->rotation)));
     }
-    return blendedTransform;
-}
-
-VROMatrix4f VROLayeredSkeletalAnimation::blendBoneTransform(const VROMatrix4f &previous, const VROMatrix4f &next, float weight) {
-    // Merge the current animation with any previously stored animation for this bone
-    VROVector3f   previousScale = previous.extractScale();
-    VROQuaternion previousRotation = previous.extractRotation(previousScale);
-    VROVector3f   previousTranslation = previous.extractTranslation();
-    
-    VROVector3f   currentScale = next.extractScale();
-    VROQuaternion currentRotation = next.extractRotation(currentScale);
-    VROVector3f   currentTranslation = next.extractTranslation();
+    VROFloat4Store(result->translation, translation);
+    VROFloat4Store(result->scale, scale);
+    VROFloat4Store(result->rotation, rotation);
     
-    // Rotations are averaged by slerping
-    VROQuaternion averageRotation = VROQuaternion::slerp(previousRotation, currentRotation, weight);
-    VROMatrix4f averageTransform = averageRotation.getMatrix();
-    
-    // Translation is averaged by interpolation
-    VROVector3f averageTranslation = previousTranslation.interpolate(currentTranslation, weight);
-    averageTransform.translate(averageTranslation);
-    return averageTransform;
+    /*
+     Renormalize the averaged rotation. Its length can only vanish if every rotation is
+     orthogonal to the first, in which case we fall back to the first.
+     */
+    const float *q = result->rotation;
+    float lengthSquared = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+    if (lengthSquared < 1e-12) {
+        VROFloat4Store(result->rotation, VROFloat4Load(reference));
+    } else {
+        VROFloat4Store(result->rotation, VROFloat4Mul(rotation, VROFloat4Splat(1.0f / sqrtf(lengthSquared))));
+    }
 }
 
 void VROLayeredSkeletalAnimation::setSpeed(float speed) {
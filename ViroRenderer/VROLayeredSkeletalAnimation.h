@@ -30,6 +30,8 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <string>
+#include <stdint.h>
 #include "VROMatrix4f.h"
 #include "VROExecutableAnimation.h"
 
@@ -40,6 +42,17 @@ class VROSkeletalAnimation;
 class VROAnimationChain;
 class VROSkeletalAnimationLayer;
 
+/*
+ A single bone key decomposed into translation, rotation (a unit quaternion, x y z w),
+ and scale. Translation and scale are padded to four floats so that each component
+ can be loaded as a four-wide vector when blending.
+ */
+struct VROBoneTRS {
+    float translation[4];
+    float rotation[4];
+    float scale[4];
+};
+
 /*
  A single layer of a VROLayeredSkeletalAnimation. Each layer is comprised of a skeletal
  animation and the properties that define how it blends with the other skeletal animations.
@@ -51,15 +64,24 @@ class VROSkeletalAnimationLayerInternal {
     
 public:
     VROSkeletalAnimationLayerInternal(std::string name, float defaultBoneWeight) :
-        name(name), defaultBoneWeight(defaultBoneWeight) {
+        name(name), defaultBoneWeight(defaultBoneWeight), weightsVersion(0) {
     }
     virtual ~VROSkeletalAnimationLayerInternal() {}
     
-    float getBoneWeight(int boneIndex) {
+    float getBoneWeight(int boneIndex) const {
+        if (boneIndex >= 0 && boneIndex < (int) boneMask.size()) {
+            return boneMask[boneIndex];
+        }
         auto it = boneWeights.find(boneIndex);
         return (it == boneWeights.end()) ? defaultBoneWeight : it->second;
     }
     
+    /*
+     Replace the weights of this layer. Layered animations blending this layer pick up
+     the new weights on their next frame, without rebuilding any keyframe data.
+     */
+    void setBoneWeights(float defaultBoneWeight, const std::map<int, float> &boneWeights);
+    
 private:
     std::string name;
     std::shared_ptr<VROSkeletalAnimation> animation;
@@ -70,12 +92,29 @@ private:
     // Overriden specific weights for bones
     std::map<int, float> boneWeights;
     
-    // Derived keyframe data for the animation
-    std::map<int, std::vector<float>> boneKeyTimes;
-    std::map<int, std::vector<VROMatrix4f>> boneLocalTransforms;
+    // The weight of this layer for each bone in the skeleton (the bone mask), derived
+    // from the weights above once keyframes are built, and a counter incremented
+    // each time the weights change
+    std::vector<float> boneMask;
+    uint32_t weightsVersion;
+    
+    // Derived keyframe data for the animation, decomposed into one track per animated
+    // bone. boneTracks maps each skeleton bone to its track, or -1 if this layer does
+    // not animate the bone; each track's times and keys occupy the range
+    // [trackFirstKey, trackFirstKey + trackNumKeys) in keyTimes and keys. keyTransforms
+    // point to the source matrix of each key in the animation's frames, which are
+    // used as-is when this is the only layer influencing a bone
+    std::vector<int> boneTracks;
+    std::vector<int> trackBones;
+    std::vector<int> trackFirstKey;
+    std::vector<int> trackNumKeys;
+    std::vector<float> keyTimes;
+    std::vector<VROBoneTRS> keys;
+    std::vector<const VROMatrix4f *> keyTransforms;
     
     // Convert animation into keyframe data
     void buildKeyframes();
+    void buildBoneMask();
     
 };
 
@@ -166,11 +205,32 @@ private:
     
     /*
      Cache the blended bone times and values so if we re-run this animation these do not have
-     to be recomputed. The _cached vector indicates which frames are already cached.
+     to be recomputed. The _cached vector indicates which frames are already cached. The bones
+     animated are those of the first (master) layer: each has a track whose key times and
+     blended transforms occupy [_trackFirstKey, _trackFirstKey + _trackNumKeys) in _keyTimes
+     and _boneTransforms.
      */
     std::vector<bool> _cached;
-    std::map<int, std::vector<float>> _boneKeyTimes;
-    std::map<int, std::vector<VROMatrix4f>> _boneTransforms;
+    std::vector<int> _trackBones;
+    std::vector<int> _trackFirstKey;
+    std::vector<int> _trackNumKeys;
+    std::vector<float> _keyTimes;
+    std::vector<VROMatrix4f> _boneTransforms;
+    
+    /*
+     The weightsVersion of each layer when the cached frames were blended. If any layer's
+     weights have since changed, the cache is invalidated and frames are re-blended as
+     they are reached.
+     */
+    std::vector<uint32_t> _cachedWeightsVersions;
+    
+    /*
+     Scratch space for blendFrame, holding the key and weight of each layer contributing
+     to the bone being blended.
+     */
+    std::vector<const VROBoneTRS *> _blendKeys;
+    std::vector<const VROMatrix4f *> _blendTransforms;
+    std::vector<float> _blendWeights;
     
     /*
      If the animation is running, this is its associated transaction.
@@ -181,8 +241,14 @@ private:
      Blending methods to create the unified animation.
      */
     void blendFrame(int f);
-    static VROMatrix4f blendBoneTransform(const VROMatrix4f &previous, const VROMatrix4f &next, float weight);
-    static VROMatrix4f blendBoneTransforms(int bone, const std::vector<std::pair<VROMatrix4f, float>> &transformsAndWeights);
+    void invalidateIfReweighted();
+    
+    /*
+     Blend the given keys by normalized weight: translation and scale are averaged,
+     and rotations are averaged then renormalized (an N-way nlerp), after flipping
+     each into the hemisphere of the first. Weights must be positive.
+     */
+    static void blendBoneKeys(const VROBoneTRS **keys, const float *weights, int count, VROBoneTRS *result);
     
     /*
      Recursively flatten out chains of chains.
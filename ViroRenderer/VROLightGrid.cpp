@@ -0,0 +1,276 @@
+//
+//  VROLightGrid.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROLightGrid.h"
+#include "VROLight.h"
+#include "VROCamera.h"
+#include "VROBoundingBox.h"
+#include "VROVector4f.h"
+#include "VROLog.h"
+#include <algorithm>
+#include <float.h>
+
+// Dimensions of the cluster grid: tiles across the viewport, and depth slices
+static const int kTilesX = 16;
+static const int kTilesY = 8;
+static const int kSlices = 16;
+static const int kNumClusters = kTilesX * kTilesY * kSlices;
+
+// With fewer attenuating lights than this, testing every light per node is
+// cheaper than looking up clusters
+static const int kMinLocalLightsForClustering = 8;
+
+// Interned light sets are discarded when there are more than this many, which
+// can happen when lights move through a large scene
+static const size_t kMaxLightSets = 1024;
+
+// Clip-space w below which a point is considered behind the camera
+static const float kMinClipW = 1e-5;
+
+static inline int clampToIndex(float value, int count) {
+    // Clamp before converting, as projected values can exceed the range of int
+    return (int) std::min(std::max(value, 0.0f), (float) (count - 1));
+}
+
+static bool isAttenuating(const std::shared_ptr<VROLight> &light) {
+    return light->getType() != VROLightType::Ambient &&
+           light->getType() != VROLightType::Directional;
+}
+
+#pragma mark - VROLightSet
+
+std::shared_ptr<VROLightSet> VROLightSet::getEmptySet() {
+    static std::shared_ptr<VROLightSet> sEmptySet = std::make_shared<VROLightSet>(std::vector<std::shared_ptr<VROLight>>());
+    return sEmptySet;
+}
+
+VROLightSet::VROLightSet(std::vector<std::shared_ptr<VROLight>> lights) :
+    _lights(lights),
+    _hash(VROLight::hashLights(lights)) {
+    
+}
+
+#pragma mark - VROLightGrid
+
+VROLightGrid::VROLightGrid() :
+    _numWords(0),
+    _numLocalLights(0),
+    _near(0),
+    _logDepthScale(0) {
+    
+}
+
+VROLightGrid::~VROLightGrid() {
+    
+}
+
+void VROLightGrid::build(const std::vector<std::shared_ptr<VROLight>> &lights, const VROCamera &camera) {
+    bool lightsChanged = lights.size() != _lights.size() || !std::equal(lights.begin(), lights.end(), _lights.begin());
+    if (lightsChanged) {
+        _lights = lights;
+        _lightSets.clear();
+    }
+    else if (_lightSets.size() > kMaxLightSets) {
+        _lightSets.clear();
+    }
+    
+    int numLights = (int) _lights.size();
+    _numWords = (numLights + 63) / 64;
+    _globalMask.assign(_numWords, 0);
+    _numLocalLights = 0;
+    
+    for (int i = 0; i < numLights; i++) {
+        // Lights with unbounded influence are candidates for every node
+        if (!isAttenuating(_lights[i]) || !isfinite(_lights[i]->getAttenuationEndDistance())) {
+            _globalMask[i / 64] |= 1ULL << (i % 64);
+        }
+        else {
+            ++_numLocalLights;
+        }
+    }
+    
+    _clusterMasks.clear();
+    if (_numLocalLights < kMinLocalLightsForClustering) {
+        return;
+    }
+    
+    _view = camera.getLookAtMatrix();
+    _viewProjection = camera.getProjection().multiply(_view);
+    _near = std::max(camera.getNCP(), 0.001f);
+    float far = std::max(camera.getFCP(), _near * 2);
+    _logDepthScale = kSlices / log(far / _near);
+    
+    _clusterMasks.assign(kNumClusters * _numWords, 0);
+    for (int i = 0; i < numLights; i++) {
+        if (_globalMask[i / 64] & (1ULL << (i % 64))) {
+            continue;
+        }
+        const std::shared_ptr<VROLight> &light = _lights[i];
+        VROVector3f position = light->getTransformedPosition();
+        float radius = light->getAttenuationEndDistance();
+        VROBoundingBox influence(position.x - radius, position.x + radius,
+                                 position.y - radius, position.y + radius,
+                                 position.z - radius, position.z + radius);
+        
+        int min[3], max[3];
+        getClusterRange(influence, min, max);
+        for (int z = min[2]; z <= max[2]; z++) {
+            for (int y = min[1]; y <= max[1]; y++) {
+                for (int x = min[0]; x <= max[0]; x++) {
+                    int cluster = (z * kTilesY + y) * kTilesX + x;
+                    _clusterMasks[cluster * _numWords + i / 64] |= 1ULL << (i % 64);
+                }
+            }
+        }
+    }
+}
+
+void VROLightGrid::getClusterRange(const VROBoundingBox &box, int *outMin, int *outMax) const {
+    float minX =  FLT_MAX, minY =  FLT_MAX, minDepth =  FLT_MAX;
+    float maxX = -FLT_MAX, maxY = -FLT_MAX, maxDepth = -FLT_MAX;
+    bool behindCamera = false;
+    
+    for (int i = 0; i < 8; i++) {
+        VROVector3f corner((i & 1) ? box.getMaxX() : box.getMinX(),
+                           (i & 2) ? box.getMaxY() : box.getMinY(),
+                           (i & 4) ? box.getMaxZ() : box.getMinZ());
+        
+        float depth = -_view.multiply(corner).z;
+        minDepth = std::min(minDepth, depth);
+        maxDepth = std::max(maxDepth, depth);
+        
+        VROVector4f clip = _viewProjection.multiply(VROVector4f(corner.x, corner.y, corner.z, 1.0));
+        if (clip.w < kMinClipW) {
+            behindCamera = true;
+        }
+        else {
+            minX = std::min(minX, clip.x / clip.w);
+            maxX = std::max(maxX, clip.x / clip.w);
+            minY = std::min(minY, clip.y / clip.w);
+            maxY = std::max(maxY, clip.y / clip.w);
+        }
+    }
+    
+    // Boxes that cross behind the camera do not have a bounded projection, so they
+    // span every tile. Non-finite bounds span every cluster.
+    if (behindCamera || !isfinite(minX) || !isfinite(maxX) || !isfinite(minY) || !isfinite(maxY)) {
+        outMin[0] = 0;
+        outMin[1] = 0;
+        outMax[0] = kTilesX - 1;
+        outMax[1] = kTilesY - 1;
+    }
+    else {
+        outMin[0] = clampToIndex((minX + 1) * 0.5f * kTilesX, kTilesX);
+        outMax[0] = clampToIndex((maxX + 1) * 0.5f * kTilesX, kTilesX);
+        outMin[1] = clampToIndex((minY + 1) * 0.5f * kTilesY, kTilesY);
+        outMax[1] = clampToIndex((maxY + 1) * 0.5f * kTilesY, kTilesY);
+    }
+    
+    if (!isfinite(minDepth) || !isfinite(maxDepth)) {
+        outMin[2] = 0;
+        outMax[2] = kSlices - 1;
+    }
+    else {
+        // Depths in front of the near plane (or behind the camera) go to the first slice
+        outMin[2] = minDepth <= _near ? 0 : clampToIndex(log(minDepth / _near) * _logDepthScale, kSlices);
+        outMax[2] = maxDepth <= _near ? 0 : clampToIndex(log(maxDepth / _near) * _logDepthScale, kSlices);
+    }
+}
+
+std::shared_ptr<VROLightSet> VROLightGrid::findLights(const VROBoundingBox &bounds, int lightReceivingBitMask) {
+    int numLights = (int) _lights.size();
+    if (numLights == 0) {
+        return VROLightSet::getEmptySet();
+    }
+    
+    /*
+     Gather candidate lights: the global lights, plus the lights of each cluster
+     overlapped by the bounds. If we are not clustering, every light is a
+     candidate.
+     */
+    if (_clusterMasks.empty()) {
+        _candidates.assign(_numWords, ~0ULL);
+        if (numLights % 64 != 0) {
+            _candidates.back() = (1ULL << (numLights % 64)) - 1;
+        }
+    }
+    else {
+        _candidates = _globalMask;
+        
+        int min[3], max[3];
+        getClusterRange(bounds, min, max);
+        for (int z = min[2]; z <= max[2]; z++) {
+            for (int y = min[1]; y <= max[1]; y++) {
+                for (int x = min[0]; x <= max[0]; x++) {
+                    const uint64_t *clusterMask = &_clusterMasks[((z * kTilesY + y) * kTilesX + x) * _numWords];
+                    for (int w = 0; w < _numWords; w++) {
+                        _candidates[w] |= clusterMask[w];
+                    }
+                }
+            }
+        }
+    }
+    
+    /*
+     Test each candidate exactly. Ambient and directional lights do not attenuate,
+     so they are not culled by distance.
+     */
+    _mask.assign(_numWords, 0);
+    for (int w = 0; w < _numWords; w++) {
+        uint64_t candidates = _candidates[w];
+        while (candidates) {
+            int bit = __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            
+            const std::shared_ptr<VROLight> &light = _lights[w * 64 + bit];
+            if ((light->getInfluenceBitMask() & lightReceivingBitMask) == 0) {
+                continue;
+            }
+            if (!isAttenuating(light) ||
+                bounds.getDistanceToPoint(light->getTransformedPosition()) < light->getAttenuationEndDistance()) {
+                _mask[w] |= 1ULL << bit;
+            }
+        }
+    }
+    
+    auto it = _lightSets.find(_mask);
+    if (it != _lightSets.end()) {
+        return it->second;
+    }
+    
+    // Lights are added in scene order, so the set's hash matches that of the
+    // same lights collected by a per-node loop
+    std::vector<std::shared_ptr<VROLight>> lights;
+    for (int i = 0; i < numLights; i++) {
+        if (_mask[i / 64] & (1ULL << (i % 64))) {
+            lights.push_back(_lights[i]);
+        }
+    }
+    std::shared_ptr<VROLightSet> lightSet = std::make_shared<VROLightSet>(lights);
+    _lightSets[_mask] = lightSet;
+    return lightSet;
+}
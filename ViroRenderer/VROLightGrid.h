@@ -0,0 +1,159 @@
+//
+//  VROLightGrid.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/21/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROLightGrid_h
+#define VROLightGrid_h
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include "VROMatrix4f.h"
+
+class VROLight;
+class VROCamera;
+class VROBoundingBox;
+
+/*
+ An immutable set of lights, shared by every node influenced by exactly those
+ lights. Light sets are interned by VROLightGrid, so nodes with the same lights
+ share the same VROLightSet, and the set's hash is computed only once.
+ */
+class VROLightSet {
+    
+public:
+    
+    /*
+     The shared empty light set.
+     */
+    static std::shared_ptr<VROLightSet> getEmptySet();
+    
+    VROLightSet(std::vector<std::shared_ptr<VROLight>> lights);
+    virtual ~VROLightSet() {}
+    
+    const std::vector<std::shared_ptr<VROLight>> &getLights() const {
+        return _lights;
+    }
+    uint32_t getHash() const {
+        return _hash;
+    }
+    
+private:
+    
+    const std::vector<std::shared_ptr<VROLight>> _lights;
+    const uint32_t _hash;
+    
+};
+
+/*
+ Clustered light grid used to find the lights that influence each node.
+ 
+ Once per frame the camera frustum is divided into clusters (froxels): tiles
+ in normalized device X and Y, and exponentially distributed slices in view
+ depth. Each attenuating light is added to the clusters its sphere of influence
+ overlaps. A node then only needs to test the lights found in the clusters its
+ bounding box overlaps, instead of testing every light in the scene.
+ 
+ Boxes that extend outside the frustum are clamped to the outermost clusters,
+ and boxes that reach behind the near plane span every tile. Both lights and
+ nodes are clamped the same way, so the grid never misses a light; it only
+ narrows the candidates that are then tested exactly.
+ 
+ The resulting light sets are interned, and remain stable across frames as long
+ as the scene's lights do not change.
+ */
+class VROLightGrid {
+    
+public:
+    
+    VROLightGrid();
+    virtual ~VROLightGrid();
+    
+    /*
+     Assign the given lights to clusters of the given camera's frustum. The light
+     positions must already be transformed to world space.
+     */
+    void build(const std::vector<std::shared_ptr<VROLight>> &lights, const VROCamera &camera);
+    
+    /*
+     Get the set of lights that influence a node with the given world bounding box
+     and light receiving bit mask.
+     */
+    std::shared_ptr<VROLightSet> findLights(const VROBoundingBox &bounds, int lightReceivingBitMask);
+    
+private:
+    
+    /*
+     The lights in the scene this frame, and the number of 64-bit words used
+     for each light mask.
+     */
+    std::vector<std::shared_ptr<VROLight>> _lights;
+    int _numWords;
+    
+    /*
+     Mask of the lights that do not attenuate (ambient and directional), which
+     influence every node, and the number of lights that do attenuate.
+     */
+    std::vector<uint64_t> _globalMask;
+    int _numLocalLights;
+    
+    /*
+     Light masks for each cluster, _numWords per cluster. Empty if there are too
+     few local lights to make clustering worthwhile, in which case all lights are
+     candidates for every node.
+     */
+    std::vector<uint64_t> _clusterMasks;
+    
+    /*
+     Camera matrices and depth range used to map boxes to clusters.
+     */
+    VROMatrix4f _view;
+    VROMatrix4f _viewProjection;
+    float _near;
+    float _logDepthScale;
+    
+    /*
+     Interned light sets, keyed by light mask. Cleared whenever the scene's
+     lights change, since the masks index into _lights.
+     */
+    std::map<std::vector<uint64_t>, std::shared_ptr<VROLightSet>> _lightSets;
+    
+    /*
+     Scratch masks reused across lookups to avoid allocation.
+     */
+    std::vector<uint64_t> _candidates;
+    std::vector<uint64_t> _mask;
+    
+    /*
+     Compute the (inclusive) range of clusters overlapped by the given world
+     space box.
+     */
+    void getClusterRange(const VROBoundingBox &box, int *outMin, int *outMax) const;
+    
+};
+
+#endif /* VROLightGrid_h */
@@ -0,0 +1,83 @@
+//
+//  VROMappedFile.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/24/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROMappedFile.h"
+#include "VROLog.h"
+#include "VROAssetCache.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+std::shared_ptr<VROMappedFile> VROMappedFile::map(std::string path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        pwarn("Failed to open file %s for mapping", path.c_str());
+        return nullptr;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        pwarn("Failed to map file %s: file is empty or unreadable", path.c_str());
+        close(fd);
+        return nullptr;
+    }
+    
+    size_t length = (size_t) st.st_size;
+    void *data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    
+    // The mapping holds its own reference to the file, so the descriptor
+    // (and the file itself, if temporary) may be released immediately
+    close(fd);
+    
+    if (data == MAP_FAILED) {
+        pwarn("Failed to map file %s", path.c_str());
+        return nullptr;
+    }
+    
+#if defined(__APPLE__)
+    const struct timespec &modified = st.st_mtimespec;
+#else
+    const struct timespec &modified = st.st_mtim;
+#endif
+    uint64_t identity = VROAssetCache::combine((uint64_t) st.st_dev, (uint64_t) st.st_ino);
+    identity = VROAssetCache::combine(identity, (uint64_t) length);
+    identity = VROAssetCache::combine(identity, (uint64_t) modified.tv_sec);
+    identity = VROAssetCache::combine(identity, (uint64_t) modified.tv_nsec);
+    
+    return std::shared_ptr<VROMappedFile>(new VROMappedFile((uint8_t *) data, length, identity));
+}
+
+VROMappedFile::VROMappedFile(uint8_t *data, size_t length, uint64_t identity) :
+    _data(data),
+    _length(length),
+    _identity(identity) {
+    
+}
+
+VROMappedFile::~VROMappedFile() {
+    munmap(_data, _length);
+}
@@ -0,0 +1,81 @@
+//
+//  VROMappedFile.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/24/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROMappedFile_h
+#define VROMappedFile_h
+
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+/*
+ A read-only view of a file mapped into memory. Pages are loaded on demand and
+ are backed by the file itself rather than the heap, so the OS can reclaim them
+ under memory pressure. The mapping is read-only; data that needs to be
+ modified must be copied out first.
+ 
+ The mapping is released when the last reference to this object is dropped.
+ VROData objects wrapping mapped memory hold such a reference.
+ */
+class VROMappedFile {
+    
+public:
+    
+    /*
+     Map the file at the given path. Returns nullptr if the file could not be
+     opened or mapped.
+     */
+    static std::shared_ptr<VROMappedFile> map(std::string path);
+    
+    virtual ~VROMappedFile();
+    
+    uint8_t *getData() const {
+        return _data;
+    }
+    size_t getLength() const {
+        return _length;
+    }
+    
+    /*
+     Identifies the mapped file by its device, inode, size and modification
+     time. Two mappings with the same identity hold the same contents, so data
+     read from the file can be recognized across loads without reading it.
+     */
+    uint64_t getIdentity() const {
+        return _identity;
+    }
+    
+private:
+    
+    VROMappedFile(uint8_t *data, size_t length, uint64_t identity);
+    
+    uint8_t *_data;
+    size_t _length;
+    uint64_t _identity;
+    
+};
+
+#endif /* VROMappedFile_h */
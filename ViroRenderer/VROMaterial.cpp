@@ -37,6 +37,7 @@
 #include <algorithm>
 
 static std::atomic_int sMaterialId;
+static std::atomic_uint sSortKeyVersion;
 
 VROMaterial::VROMaterial() : VROThreadRestricted(VROThreadName::Renderer),
     _materialId(sMaterialId++),
@@ -59,7 +60,8 @@ VROMaterial::VROMaterial() : VROThreadRestricted(VROThreadName::Renderer),
     _chromaKeyFilteringColor({ 0, 1, 0 }),
     _needsToneMapping(true),
     _renderingOrder(0),
-    _substrate(nullptr) {
+    _substrate(nullptr),
+    _sortKeyVersion(sSortKeyVersion++) {
    
     _diffuse          = new VROMaterialVisual(*this, (int)VROTextureType::None |
                                                      (int)VROTextureType::Texture2D |
@@ -107,7 +109,8 @@ VROMaterial::VROMaterial(std::shared_ptr<VROMaterial> material) : VROThreadRestr
  _chromaKeyFilteringColor(material->_chromaKeyFilteringColor),
  _needsToneMapping(material->needsToneMapping()),
  _renderingOrder(material->_renderingOrder),
- _substrate(nullptr) {
+ _substrate(nullptr),
+ _sortKeyVersion(sSortKeyVersion++) {
  
      _diffuse = new VROMaterialVisual(*this, *material->_diffuse);
      _roughness = new VROMaterialVisual(*this, *material->_roughness);
@@ -320,6 +323,11 @@ void VROMaterial::updateSubstrateTextures() {
     if (_substrate) {
         _substrate->updateTextures();
     }
+    invalidateSortKey();
+}
+
+void VROMaterial::invalidateSortKey() {
+    _sortKeyVersion = sSortKeyVersion++;
 }
 
 void VROMaterial::updateSubstrate() {
@@ -333,6 +341,7 @@ void VROMaterial::updateSubstrate() {
 VROMaterialSubstrate *const VROMaterial::getSubstrate(std::shared_ptr<VRODriver> &driver) {
     if (!_substrate) {
         _substrate = driver->newMaterialSubstrate(*this);
+        invalidateSortKey();
     }
     return _substrate;
 }
@@ -356,8 +365,9 @@ void VROMaterial::bindProperties(std::shared_ptr<VRODriver> &driver) {
 bool VROMaterial::bindShader(int lightsHash,
                              const std::vector<std::shared_ptr<VROLight>> &lights,
                              const VRORenderContext &context,
-                             std::shared_ptr<VRODriver> &driver) {
-    return getSubstrate(driver)->bindShader(lightsHash, lights, context, driver);
+                             std::shared_ptr<VRODriver> &driver,
+                             bool instanced) {
+    return getSubstrate(driver)->bindShader(lightsHash, lights, context, driver, instanced);
 }
 
 bool VROMaterial::hasDiffuseAlpha() const {
@@ -370,6 +380,48 @@ bool VROMaterial::hasDiffuseAlpha() const {
     }
 }
 
+bool VROMaterial::isBatchableWith(const VROMaterial &material) const {
+    if (this == &material) {
+        return true;
+    }
+    if (!_shaderModifiers.empty() || !material._shaderModifiers.empty()) {
+        return false;
+    }
+    if (_shininess != material._shininess ||
+        _fresnelExponent != material._fresnelExponent ||
+        _transparency != material._transparency ||
+        _transparencyMode != material._transparencyMode ||
+        _lightingModel != material._lightingModel ||
+        _litPerPixel != material._litPerPixel ||
+        _cullMode != material._cullMode ||
+        _blendMode != material._blendMode ||
+        _writesToDepthBuffer != material._writesToDepthBuffer ||
+        _readsFromDepthBuffer != material._readsFromDepthBuffer ||
+        _colorWriteMask != material._colorWriteMask ||
+        _bloomThreshold != material._bloomThreshold ||
+        _postProcessMask != material._postProcessMask ||
+        _receivesShadows != material._receivesShadows ||
+        _chromaKeyFilteringEnabled != material._chromaKeyFilteringEnabled ||
+        !_chromaKeyFilteringColor.isEqual(material._chromaKeyFilteringColor) ||
+        _needsToneMapping != material._needsToneMapping ||
+        _renderingOrder != material._renderingOrder) {
+        return false;
+    }
+    
+    VROMaterialVisual *visuals[10] = { _diffuse, _roughness, _metalness, _specular, _normal, _reflective,
+                                       _emission, _multiply, _ambientOcclusion, _selfIllumination };
+    VROMaterialVisual *otherVisuals[10] = { material._diffuse, material._roughness, material._metalness,
+                                            material._specular, material._normal, material._reflective,
+                                            material._emission, material._multiply, material._ambientOcclusion,
+                                            material._selfIllumination };
+    for (int i = 0; i < 10; i++) {
+        if (!visuals[i]->isEquivalentTo(*otherVisuals[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void VROMaterial::setChromaKeyFilteringEnabled(bool enabled) {
     _chromaKeyFilteringEnabled = enabled;
     updateSubstrate();
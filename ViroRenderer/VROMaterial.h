@@ -139,6 +139,16 @@ public:
         return _materialId;
     }
     
+    /*
+     Identifies the state of the properties that feed this material's sort key:
+     its substrate (and therefore its shader), its textures, and its rendering
+     order. Changes whenever any of these change, and is never shared between
+     materials, so geometries can use it to tell when a cached sort key is stale.
+     */
+    uint32_t getSortKeyVersion() const {
+        return _sortKeyVersion;
+    }
+    
     /*
      Bind shader and properties. These must be called in order: material properties
      cannot be bound until the shader is bound.
@@ -147,12 +157,16 @@ public:
      is a function both of that material's properties and of the desired lighting
      configuration.
      
+     If instanced is true, the shader variant that reads per-instance transforms
+     is bound, for rendering batches via VROGeometry::renderInstanced().
+     
      Returns false if the shader could not be bound.
      */
     bool bindShader(int lightsHash,
                     const std::vector<std::shared_ptr<VROLight>> &lights,
                     const VRORenderContext &context,
-                    std::shared_ptr<VRODriver> &driver);
+                    std::shared_ptr<VRODriver> &driver,
+                    bool instanced = false);
     void bindProperties(std::shared_ptr<VRODriver> &driver);
 
     VROMaterialVisual &getDiffuse() const {
@@ -354,6 +368,7 @@ public:
     }
     void setRenderingOrder(int renderingOrder) {
         _renderingOrder = renderingOrder;
+        invalidateSortKey();
     }
 
     /*
@@ -417,6 +432,14 @@ public:
      texture.
      */
     bool hasDiffuseAlpha() const;
+    
+    /*
+     Return true if this material binds exactly the same shader state as the
+     given material, so that geometry using either may be rendered in the same
+     instanced batch. Materials with shader modifiers are never batchable,
+     except with themselves.
+     */
+    bool isBatchableWith(const VROMaterial &material) const;
 
     /*
      Returns a VROBlendMode for the given string. If no matching blend modes were found,
@@ -598,6 +621,12 @@ private:
      */
     VROMaterialSubstrate *_substrate;
     
+    /*
+     See getSortKeyVersion().
+     */
+    uint32_t _sortKeyVersion;
+    
+    void invalidateSortKey();
     void removeOutgoingMaterial();
     bool isHydrated();
     
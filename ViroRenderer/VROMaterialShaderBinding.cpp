@@ -35,6 +35,8 @@
 #include "VRODriver.h"
 #include "VROTextureReference.h"
 #include "VROMath.h"
+#include "VROImageUtil.h"
+#include "VROTexture.h"
 
 VROMaterialShaderBinding::VROMaterialShaderBinding(std::shared_ptr<VROShaderProgram> program,
                                                    VROLightingShaderCapabilities capabilities,
@@ -139,7 +141,29 @@ void VROMaterialShaderBinding::loadTextures() {
         else if (sampler == "brdf_map") {
             _textures.emplace_back(VROGlobalTextureType::BrdfMap);
         }
+        else {
+            // Samplers not owned by the material may be declared by its modifiers
+            // (diffuse_texture_cbcr is bound as the second substrate of the Y texture).
+            // A modifier sampler always takes a texture unit, even if its texture is
+            // missing, so that the units of the samplers after it stay aligned
+            std::shared_ptr<VROTexture> texture;
+            if (getModifierTexture(sampler, &texture)) {
+                _textures.emplace_back(texture ? texture : getBlankTexture(VROTextureType::Texture2D));
+            }
+        }
+    }
+}
+
+bool VROMaterialShaderBinding::getModifierTexture(const std::string &sampler, std::shared_ptr<VROTexture> *outTexture) const {
+    for (const std::shared_ptr<VROShaderModifier> &modifier : _program->getModifiers()) {
+        for (auto &modifierSampler : modifier->getSamplers()) {
+            if (modifierSampler.first == sampler) {
+                *outTexture = modifierSampler.second;
+                return true;
+            }
+        }
     }
+    return false;
 }
 
 void VROMaterialShaderBinding::bindViewUniforms(VROMatrix4f &modelMatrix, VROMatrix4f &viewMatrix,
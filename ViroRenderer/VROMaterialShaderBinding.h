@@ -36,6 +36,7 @@ class VROMatrix4f;
 class VROGeometry;
 class VRODriver;
 class VROTextureReference;
+class VROTexture;
 class VROUniform;
 class VROUniformBinder;
 class VROShaderProgram;
@@ -129,6 +130,12 @@ private:
     
     void loadUniforms();
     
+    /*
+     Find the texture attached to the given sampler by one of the program's
+     shader modifiers. Returns false if no modifier declares the sampler.
+     */
+    bool getModifierTexture(const std::string &sampler, std::shared_ptr<VROTexture> *outTexture) const;
+    
 };
 
 #endif /* VROMaterialShaderBinding_h */
@@ -65,12 +65,14 @@ public:
      render loop.
      
      The shader used is a function both of the underlying material properties
-     and of the desired lighting configuration.
+     and of the desired lighting configuration, and of whether the geometry is
+     to be rendered with instancing.
      */
     virtual bool bindShader(int lightsHash,
                             const std::vector<std::shared_ptr<VROLight>> &lights,
                             const VRORenderContext &context,
-                            std::shared_ptr<VRODriver> &driver) = 0;
+                            std::shared_ptr<VRODriver> &driver,
+                            bool instanced) = 0;
     
     /*
      Bind the properties of this material to the active rendering context.
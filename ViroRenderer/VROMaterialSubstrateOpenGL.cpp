@@ -68,9 +68,10 @@ void VROMaterialSubstrateOpenGL::bindGeometry(float opacity, const VROGeometry &
 bool VROMaterialSubstrateOpenGL::bindShader(int lightsHash,
                                             const std::vector<std::shared_ptr<VROLight>> &lights,
                                             const VRORenderContext &context,
-                                            std::shared_ptr<VRODriver> &driver) {
+                                            std::shared_ptr<VRODriver> &driver,
+                                            bool instanced) {
     
-    _activeBinding = getShaderBindingForLights(lights, context, driver);
+    _activeBinding = getShaderBindingForLights(lights, context, driver, instanced);
     
     std::shared_ptr<VROShaderProgram> &shader = _activeBinding->getProgram();
     if (!shader->isHydrated()) {
@@ -130,9 +131,11 @@ void VROMaterialSubstrateOpenGL::updateSortKey(VROSortKey &key, const std::vecto
 
 VROMaterialShaderBinding *VROMaterialSubstrateOpenGL::getShaderBindingForLights(const std::vector<std::shared_ptr<VROLight>> &lights,
                                                                                 const VRORenderContext &context,
-                                                                                std::shared_ptr<VRODriver> driver) {
+                                                                                std::shared_ptr<VRODriver> driver,
+                                                                                bool instanced) {
     std::shared_ptr<VRODriverOpenGL> driverGL = std::dynamic_pointer_cast<VRODriverOpenGL>(driver);
     VROLightingShaderCapabilities capabilities = VROShaderCapabilities::deriveLightingCapabilitiesKey(lights, context);
+    capabilities.instanced = instanced;
     
     // Optimized path: check the active binding
     if (_activeBinding != nullptr && _activeBinding->lightingShaderCapabilities == capabilities) {
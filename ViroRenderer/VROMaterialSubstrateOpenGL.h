@@ -69,7 +69,8 @@ public:
     bool bindShader(int lightsHash,
                     const std::vector<std::shared_ptr<VROLight>> &lights,
                     const VRORenderContext &context,
-                    std::shared_ptr<VRODriver> &driver);
+                    std::shared_ptr<VRODriver> &driver,
+                    bool instanced);
     
     /*
      Bind the properties of this material to the active rendering context.
@@ -135,7 +136,8 @@ private:
      */
     VROMaterialShaderBinding *getShaderBindingForLights(const std::vector<std::shared_ptr<VROLight>> &lights,
                                                         const VRORenderContext &context,
-                                                        std::shared_ptr<VRODriver> driver);
+                                                        std::shared_ptr<VRODriver> driver,
+                                                        bool instanced = false);
 
     uint32_t hashTextures(const std::vector<VROTextureReference> &textures) const;
     
@@ -52,6 +52,13 @@ void VROMaterialVisual::copyFrom(const VROMaterialVisual &visual) {
     _contentsTransform = visual._contentsTransform;
 }
 
+bool VROMaterialVisual::isEquivalentTo(const VROMaterialVisual &visual) const {
+    return _contentsTexture == visual._contentsTexture &&
+           _contentsColor.isEqual(visual._contentsColor) &&
+           _intensity == visual._intensity &&
+           _contentsTransform == visual._contentsTransform;
+}
+
 void VROMaterialVisual::clear() {
     _material.fadeSnapshot();
     
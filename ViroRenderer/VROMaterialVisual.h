@@ -72,6 +72,12 @@ public:
      */
     void copyFrom(const VROMaterialVisual &visual);
     
+    /*
+     Returns true if this visual has the same contents, intensity, and contents
+     transform as the given visual.
+     */
+    bool isEquivalentTo(const VROMaterialVisual &visual) const;
+    
     void clear();
     void setColor(VROVector4f contents);
     void setTexture(std::shared_ptr<VROTexture> texture);
@@ -26,9 +26,12 @@
 
 #include "VROMath.h"
 #include "VROLog.h"
+#include "VROKeyframeCursor.h"
 #include <algorithm>
 #include <limits>
 #include <cstring>
+#include <random>
+#include <atomic>
 #include "glm/glm.hpp"
 #include "glm/gtc/color_space.hpp"
 
@@ -163,7 +166,13 @@ float random(float min, float max) {
         return max;
     }
 
-    float random = ((float) rand()) / (float) RAND_MAX;
+    // Each thread has its own generator, since particle emitters draw random
+    // numbers concurrently from job system workers (and rand() is not reentrant)
+    static std::atomic<uint32_t> sNextSeed(1);
+    static thread_local std::minstd_rand tGenerator(sNextSeed++);
+    
+    float random = (float) (tGenerator() - std::minstd_rand::min()) /
+                   (float) (std::minstd_rand::max() - std::minstd_rand::min());
     float range = max - min;
     return (random * range) + min;
 }
@@ -529,6 +538,26 @@ void VROMathMakeIdentity_d(double *m) {
     memcpy(m, IDENTITY_MATRIX_D, sizeof(double) * 16);
 }
 
+void VROMathComposeTRS(const float *translation, const float *rotation, const float *scale, float *m) {
+    float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+    m[0]  = (1.0f - 2.0f * (y * y + z * z)) * scale[0];
+    m[1]  = (2.0f * (x * y + z * w)) * scale[0];
+    m[2]  = (2.0f * (x * z - y * w)) * scale[0];
+    m[3]  = 0;
+    m[4]  = (2.0f * (x * y - z * w)) * scale[1];
+    m[5]  = (1.0f - 2.0f * (x * x + z * z)) * scale[1];
+    m[6]  = (2.0f * (z * y + x * w)) * scale[1];
+    m[7]  = 0;
+    m[8]  = (2.0f * (x * z + y * w)) * scale[2];
+    m[9]  = (2.0f * (z * y - x * w)) * scale[2];
+    m[10] = (1.0f - 2.0f * (x * x + y * y)) * scale[2];
+    m[11] = 0;
+    m[12] = translation[0];
+    m[13] = translation[1];
+    m[14] = translation[2];
+    m[15] = 1;
+}
+
 void VROMathTransposeMatrix(const float *src, float *transpose) {
     transpose[0] = src[0];
     transpose[1] = src[4];
@@ -854,24 +883,29 @@ double VROMathInterpolate_d(double input, double inMin, double inMax, double out
     return outMin + position;
 }
 
-float VROMathInterpolateKeyFrameIndex(float input, const std::vector<float> &inputs) {
+/*
+ Find the first key of the segment containing the input, which must lie strictly
+ within the key times.
+ */
+static inline int VROMathFindKeyFrame(float input, const std::vector<float> &inputs, VROKeyframeCursor *cursor) {
+    if (cursor) {
+        return cursor->find(input, inputs.data(), (int) inputs.size());
+    }
+    return VROKeyframeCursor::search(input, inputs.data(), (int) inputs.size());
+}
+
+float VROMathInterpolateKeyFrameIndex(float input, const std::vector<float> &inputs, VROKeyframeCursor *cursor) {
     if (input < inputs.front()) {
         return 0;
     }
     if (input >= inputs.back()) {
         return inputs.size() - 1;
     }
-    
-    for (int i = 1; i < inputs.size(); i++) {
-        if (input < inputs[i]) {
-            return i - 1;
-        }
-    }
-    pabort();
-    return 0;
+    return VROMathFindKeyFrame(input, inputs, cursor);
 }
 
-float VROMathInterpolateKeyFrame(float input, const std::vector<float> &inputs, const std::vector<float> &outputs) {
+float VROMathInterpolateKeyFrame(float input, const std::vector<float> &inputs, const std::vector<float> &outputs,
+                                 VROKeyframeCursor *cursor) {
     passert (inputs.size() == outputs.size());
     if (input < inputs.front()) {
         return outputs.front();
@@ -880,17 +914,12 @@ float VROMathInterpolateKeyFrame(float input, const std::vector<float> &inputs,
         return outputs.back();
     }
     
-    for (int i = 1; i < inputs.size(); i++) {
-        if (input < inputs[i]) {
-            return VROMathInterpolate(input, inputs[i - 1], inputs[i], outputs[i - 1], outputs[i]);
-        }
-    }
-    
-    pabort();
-    return 0;
+    int i = VROMathFindKeyFrame(input, inputs, cursor);
+    return VROMathInterpolate(input, inputs[i], inputs[i + 1], outputs[i], outputs[i + 1]);
 }
 
-VROVector3f VROMathInterpolateKeyFrameVector3f(float input, const std::vector<float> &inputs, const std::vector<VROVector3f> &outputs) {
+VROVector3f VROMathInterpolateKeyFrameVector3f(float input, const std::vector<float> &inputs, const std::vector<VROVector3f> &outputs,
+                                               VROKeyframeCursor *cursor) {
     passert (inputs.size() == outputs.size());
     if (input < inputs.front()) {
         return outputs.front();
@@ -899,17 +928,12 @@ VROVector3f VROMathInterpolateKeyFrameVector3f(float input, const std::vector<fl
         return outputs.back();
     }
     
-    for (int i = 1; i < inputs.size(); i++) {
-        if (input < inputs[i]) {
-            return outputs[i - 1].interpolate(outputs[i], (input - inputs[i - 1]) / (inputs[i] - inputs[i - 1]));
-        }
-    }
-    
-    pabort();
-    return {};
+    int i = VROMathFindKeyFrame(input, inputs, cursor);
+    return outputs[i].interpolate(outputs[i + 1], (input - inputs[i]) / (inputs[i + 1] - inputs[i]));
 }
 
-VROQuaternion VROMathInterpolateKeyFrameQuaternion(float input, const std::vector<float> &inputs, const std::vector<VROQuaternion> &outputs) {
+VROQuaternion VROMathInterpolateKeyFrameQuaternion(float input, const std::vector<float> &inputs, const std::vector<VROQuaternion> &outputs,
+                                                   VROKeyframeCursor *cursor) {
     passert (inputs.size() == outputs.size());
     if (input < inputs.front()) {
         return outputs.front();
@@ -918,17 +942,12 @@ VROQuaternion VROMathInterpolateKeyFrameQuaternion(float input, const std::vecto
         return outputs.back();
     }
     
-    for (int i = 1; i < inputs.size(); i++) {
-        if (input < inputs[i]) {
-            return VROQuaternion::slerp(outputs[i - 1], outputs[i], (input - inputs[i - 1]) / (inputs[i] - inputs[i - 1]));
-        }
-    }
-    
-    pabort();
-    return {};
+    int i = VROMathFindKeyFrame(input, inputs, cursor);
+    return VROQuaternion::slerp(outputs[i], outputs[i + 1], (input - inputs[i]) / (inputs[i + 1] - inputs[i]));
 }
 
-VROMatrix4f VROMathInterpolateKeyFrameMatrix4f(float input, const std::vector<float> &inputs, const std::vector<VROMatrix4f> &outputs) {
+VROMatrix4f VROMathInterpolateKeyFrameMatrix4f(float input, const std::vector<float> &inputs, const std::vector<VROMatrix4f> &outputs,
+                                               VROKeyframeCursor *cursor) {
     passert (inputs.size() == outputs.size());
     if (input < inputs.front()) {
         return outputs.front();
@@ -937,18 +956,12 @@ VROMatrix4f VROMathInterpolateKeyFrameMatrix4f(float input, const std::vector<fl
         return outputs.back();
     }
     
-    for (int i = 1; i < inputs.size(); i++) {
-        if (input < inputs[i]) {
-            float interp[16];
-            for (int j = 0; j < 16; j++) {
-                interp[j] = VROMathInterpolate(input, inputs[i - 1], inputs[i], outputs[i - 1][j], outputs[i][j]);
-            }
-            return { interp };
-        }
+    int i = VROMathFindKeyFrame(input, inputs, cursor);
+    float interp[16];
+    for (int j = 0; j < 16; j++) {
+        interp[j] = VROMathInterpolate(input, inputs[i], inputs[i + 1], outputs[i][j], outputs[i + 1][j]);
     }
-    
-    pabort();
-    return {};
+    return { interp };
 }
 
 void VROMathInterpolatePoint(const float *bottom, const float *top, float amount, int size, float *result) {
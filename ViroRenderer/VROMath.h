@@ -37,6 +37,8 @@
 #include "VROBoundingBox.h"
 #include "VRODefines.h"
 
+class VROKeyframeCursor;
+
 static float kRoundingErrorFloat = 0.00001;
 static float kEpsilon = 0.00000001;
 
@@ -92,6 +94,12 @@ void VROMathMakeIdentity_d(double *m);
 
 void VROMathTransposeMatrix(const float *src, float *transpose);
 
+/*
+ Compose a matrix from a translation, a unit quaternion rotation (x, y, z, w),
+ and a scale, applied in scale-rotate-translate order.
+ */
+void VROMathComposeTRS(const float *translation, const float *rotation, const float *scale, float *m);
+
 bool VROMathInvertMatrix(const float *src, float *inverse);
 bool VROMathInvertMatrix_d(const double *src, double *inverse);
 
@@ -104,14 +112,24 @@ void VROMathMultVX(const float *vx, const float *m0, float *d);
 
 /*
  Interpolation functions.
+ 
+ The key frame functions locate the active pair of keys with the given
+ VROKeyframeCursor, which should be owned by the animated track and makes
+ lookups during playback constant time. Without a cursor they use a
+ binary search.
  */
 float  VROMathInterpolate(float input, float inMin, float inMax, float outMin, float outMax);
 double VROMathInterpolate_d(double input, double inMin, double inMax, double outMin, double outMax);
-float  VROMathInterpolateKeyFrame(float input, const std::vector<float> &inputs, const std::vector<float> &outputs);
-float  VROMathInterpolateKeyFrameIndex(float input, const std::vector<float> &inputs);
-VROVector3f   VROMathInterpolateKeyFrameVector3f(float input, const std::vector<float> &inputs, const std::vector<VROVector3f> &outputs);
-VROQuaternion VROMathInterpolateKeyFrameQuaternion(float input, const std::vector<float> &inputs, const std::vector<VROQuaternion> &outputs);
-VROMatrix4f   VROMathInterpolateKeyFrameMatrix4f(float input, const std::vector<float> &inputs, const std::vector<VROMatrix4f> &outputs);
+float  VROMathInterpolateKeyFrame(float input, const std::vector<float> &inputs, const std::vector<float> &outputs,
+                                  VROKeyframeCursor *cursor = nullptr);
+float  VROMathInterpolateKeyFrameIndex(float input, const std::vector<float> &inputs,
+                                       VROKeyframeCursor *cursor = nullptr);
+VROVector3f   VROMathInterpolateKeyFrameVector3f(float input, const std::vector<float> &inputs, const std::vector<VROVector3f> &outputs,
+                                                 VROKeyframeCursor *cursor = nullptr);
+VROQuaternion VROMathInterpolateKeyFrameQuaternion(float input, const std::vector<float> &inputs, const std::vector<VROQuaternion> &outputs,
+                                                   VROKeyframeCursor *cursor = nullptr);
+VROMatrix4f   VROMathInterpolateKeyFrameMatrix4f(float input, const std::vector<float> &inputs, const std::vector<VROMatrix4f> &outputs,
+                                                 VROKeyframeCursor *cursor = nullptr);
 void   VROMathInterpolatePoint(const float *bottom, const float *top, float amount, int size, float *result);
 
 /*
@@ -34,12 +34,18 @@
 #include "VRONode.h"
 #include "VROGeometry.h"
 #include "VROMaterial.h"
+#include "VROTextureDecodePool.h"
+#include "VROTextureTranscoder.h"
+#include "VROAssetCache.h"
+#include "VRODriver.h"
 
 const std::string kAssetURLPrefix = "file:///android_asset";
 
 void VROModelIOUtil::loadTextureAsync(const std::string &name, const std::string &base, VROResourceType type, bool sRGB,
+                                      VROTextureDecodePriority priority,
                                       std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                       std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
+                                      std::shared_ptr<VRODriver> driver,
                                       std::function<void(std::shared_ptr<VROTexture> texture)> onFinished) {
     
     // First check the cache, which can only be accessed on the rendering thread
@@ -56,45 +62,98 @@ void VROModelIOUtil::loadTextureAsync(const std::string &name, const std::string
         textureFile = VROPlatformFindValueInResourceMap(name, *resourceMap);
     }
 
+    // If another model (or another material of this model) is already loading
+    // this texture for the same driver, wait for that load instead of retrieving
+    // and decoding it again
+    std::shared_ptr<VROAssetCache> cache = driver->getAssetCache();
+    std::shared_ptr<VROTextureDecodePool> pool = VROTextureDecodePool::getSharedPool();
+    std::string key = textureFile + (sRGB ? "|srgb|" : "|linear|") + VROStringUtil::toString64((uint64_t) (uintptr_t) cache.get());
+    bool first = pool->requestTexture(key, priority, [name, textureCache, onFinished](std::shared_ptr<VROTexture> texture) {
+        if (texture != nullptr) {
+            textureCache->insert(std::make_pair(name, texture));
+        }
+        onFinished(texture);
+    });
+    if (!first) {
+        return;
+    }
+
     retrieveResourceAsync(textureFile, type,
-          [name, sRGB, onFinished, textureCache](std::string path, bool isTemp) {
+          [pool, cache, key, name, sRGB](std::string path, bool isTemp) {
               // Abort (return empty texture) if the file wasn't found
               if (path.length() == 0) {
-                  onFinished(nullptr);
+                  pool->completeTexture(key, nullptr);
                   return;
               }
               
-              VROPlatformDispatchAsyncBackground([name, path, sRGB, isTemp, textureCache, onFinished]() {
-                  std::shared_ptr<VROTexture> texture = loadLocalTexture(name, path, sRGB, isTemp);
-
-                  VROPlatformDispatchAsyncRenderer([name, texture, textureCache, onFinished]() {
-                      if (texture != nullptr) {
-                          textureCache->insert(std::make_pair(name, texture));
-                      }
-                      onFinished(texture);
-                  });
+              pool->decodeTexture(key, [name, path, sRGB, isTemp, cache]() {
+                  return loadLocalTexture(name, path, sRGB, isTemp, cache);
               });
-              
           },
-          [onFinished]() {
-              onFinished(nullptr);
+          [pool, key]() {
+              pool->completeTexture(key, nullptr);
           }
     );
 }
 
-std::shared_ptr<VROTexture> VROModelIOUtil::loadLocalTexture(std::string name, std::string path, bool sRGB, bool isTemp) {
+std::shared_ptr<VROTexture> VROModelIOUtil::loadLocalTexture(std::string name, std::string path, bool sRGB, bool isTemp,
+                                                             std::shared_ptr<VROAssetCache> cache) {
+    // Key the texture by the contents of its file, so that it is shared with every
+    // earlier load of the same texture for this driver, by any model and from any path.
+    // The file is read once: the bytes that are hashed are the bytes that are decoded
+    int dataLength;
+    void *data = VROPlatformLoadFile(path, &dataLength);
+    if (isTemp) {
+        VROPlatformDeleteFile(path);
+    }
+    if (!data) {
+        pinfo("Failed to load texture [%s] at path [%s]", name.c_str(), path.c_str());
+        return nullptr;
+    }
+    uint64_t key = VROAssetCache::combine(VROAssetCache::hash(data, dataLength), sRGB);
+    key = VROAssetCache::combine(key, sRGB && VROTextureTranscoder::isTranscodingEnabled());
+
+    std::shared_ptr<VROTexture> texture = cache->getTexture(key);
+    if (!texture) {
+        size_t bytes = 0;
+        texture = decodeLocalTexture(name, (const uint8_t *) data, dataLength, sRGB, &bytes);
+        if (texture) {
+            cache->putTexture(key, texture, bytes);
+        }
+    }
+    free(data);
+    return texture;
+}
+
+std::shared_ptr<VROTexture> VROModelIOUtil::decodeLocalTexture(std::string name, const uint8_t *data, int dataLength,
+                                                               bool sRGB, size_t *outBytes) {
     std::shared_ptr<VROTexture> texture;
     if (VROStringUtil::endsWith(name, "ktx")) {
-        int dataLength;
-        void *data = VROPlatformLoadFile(path, &dataLength);
-        
         VROTextureFormat format;
         int texWidth;
         int texHeight;
         std::vector<uint32_t> mipSizes;
         std::shared_ptr<VROData> texData = VROTextureUtil::readKTXHeader((uint8_t *) data, (uint32_t) dataLength,
                                                                          &format, &texWidth, &texHeight, &mipSizes);
+        
+        // Devices that cannot sample the compressed format receive the top level
+        // decoded to RGBA8, with mipmaps generated at runtime
+        if (!VROTextureTranscoder::isFormatSupported(format) && format == VROTextureFormat::ETC2_RGBA8_EAC) {
+            std::shared_ptr<VROData> rgba = VROTextureTranscoder::decodeETC2((const uint8_t *) texData->getData(),
+                                                                             texData->getDataLength(), texWidth, texHeight);
+            if (!rgba) {
+                pinfo("Failed to decode texture [%s]", name.c_str());
+                return nullptr;
+            }
+            std::vector<std::shared_ptr<VROData>> dataVec = { rgba };
+            *outBytes = VROAssetCache::estimateTextureBytes(texWidth, texHeight, {});
+            return std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::RGBA8,
+                                                VROTextureInternalFormat::RGBA8, sRGB,
+                                                VROMipmapMode::Runtime,
+                                                dataVec, texWidth, texHeight, std::vector<uint32_t>());
+        }
         std::vector<std::shared_ptr<VROData>> dataVec = { texData };
+        *outBytes = VROAssetCache::estimateTextureBytes(texWidth, texHeight, mipSizes);
         
         texture = std::make_shared<VROTexture>(VROTextureType::Texture2D, format,
                                                VROTextureInternalFormat::RGBA8, true,
@@ -103,16 +162,19 @@ std::shared_ptr<VROTexture> VROModelIOUtil::loadLocalTexture(std::string name, s
         return texture;
     }
     else {
-        std::shared_ptr<VROImage> image = VROPlatformLoadImageFromFile(path, VROTextureInternalFormat::RGBA8);
-        if (isTemp) {
-            VROPlatformDeleteFile(path);
-        }
-        
+        std::vector<unsigned char> bytes(data, data + dataLength);
+        std::shared_ptr<VROImage> image = VROPlatformLoadImageWithBufferedData(std::move(bytes), VROTextureInternalFormat::RGBA8);
         if (!image) {
-            pinfo("Failed to load texture [%s] at path [%s]", name.c_str(), path.c_str());
+            pinfo("Failed to load texture [%s]", name.c_str());
             return nullptr;
         }
         else {
+            // Color textures are transcoded to a compressed format where supported,
+            // if the app has opted in to lossy transcoding
+            if (sRGB && VROTextureTranscoder::isTranscodingEnabled()) {
+                image = VROTextureTranscoder::transcode(image);
+            }
+            *outBytes = VROAssetCache::estimateTextureBytes(image->getWidth(), image->getHeight(), image->getMipSizes());
             texture = std::make_shared<VROTexture>(sRGB, VROMipmapMode::Runtime, image);
             return texture;
         }
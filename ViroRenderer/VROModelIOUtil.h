@@ -32,8 +32,10 @@
 #include <memory>
 
 class VROTexture;
+enum class VROTextureDecodePriority;
 class VRONode;
 class VRODriver;
+class VROAssetCache;
 
 /*
  The type of file within which the model is stored. On Android, use URL with file:///android-asset/
@@ -60,10 +62,16 @@ public:
      Set sRGB to true to gamma-uncorrect the texture into linear RGB when sampling. This should
      only be used for color (diffuse) textures, and not for textures that are *already* linear
      (e.g. specular, normal, etc.).
+     
+     Retrieval and decoding are shared with any in-flight load of the same texture file for the
+     same driver, and decoding is performed on the shared VROTextureDecodePool at the given
+     priority. Textures already loaded for the driver are taken from its VROAssetCache.
      */
     static void loadTextureAsync(const std::string &name, const std::string &base, VROResourceType type, bool sRGB,
+                                 VROTextureDecodePriority priority,
                                  std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                  std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
+                                 std::shared_ptr<VRODriver> driver,
                                  std::function<void(std::shared_ptr<VROTexture> texture)> onFinished);
 
     /*
@@ -112,10 +120,20 @@ private:
                              std::shared_ptr<VRODriver> &driver);
     
     /*
-     Helper function for loadTextureAsync. Loads the texture at the given local file path.
+     Helper function for loadTextureAsync. Loads the texture at the given local file path,
+     or returns the texture already loaded from a file with the same contents, if it is
+     still in the given VROAssetCache.
      */
     static std::shared_ptr<VROTexture> loadLocalTexture(std::string name, std::string path,
-                                                        bool sRGB, bool isTemp);
+                                                        bool sRGB, bool isTemp,
+                                                        std::shared_ptr<VROAssetCache> cache);
+    
+    /*
+     Decode the texture with the given name from the given file contents, returning its
+     estimated size in bytes.
+     */
+    static std::shared_ptr<VROTexture> decodeLocalTexture(std::string name, const uint8_t *data, int dataLength,
+                                                          bool sRGB, size_t *outBytes);
     
 };
 
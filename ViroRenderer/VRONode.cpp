@@ -57,12 +57,13 @@
 #include "VROInstancedUBO.h"
 #include "VROPlatformUtil.h"
 #include "VROMorpher.h"
+#include "VROTriangleBVH.h"
 
 // Opacity below which a node is considered hidden
 static const float kHiddenOpacityThreshold = 0.02;
 
 // Set to false to disable visibility testing
-static const bool kEnableVisibilityFrustumTest = true;
+bool kEnableVisibilityFrustumTest = true;
 
 // Set to true to output log statements debugging bounding box computation
 static const bool kDebugBoundingBoxComputation = false;
@@ -79,6 +80,10 @@ const std::string kDefaultNodeTag = "undefined";
 // never vend.
 std::atomic<int> sUniqueIDGenerator(0);
 
+// Incremented on every scene graph topology change. Atomic because detached
+// subtrees may be assembled on background threads (e.g. by VROGLTFLoader).
+static std::atomic<uint32_t> sGraphVersion(0);
+
 #pragma mark - Initialization
 
 VRONode::VRONode() : VROThreadRestricted(VROThreadName::Renderer),
@@ -88,7 +93,9 @@ VRONode::VRONode() : VROThreadRestricted(VROThreadName::Renderer),
     _lastVisitedRenderingFrame(-1),
     _scale({1.0, 1.0, 1.0}),
     _euler({0, 0, 0}),
+    _transformDirty(true),
     _renderingOrder(0),
+    _computedLightSet(VROLightSet::getEmptySet()),
     _hidden(false),
     _opacityFromHiddenFlag(1.0),
     _opacity(1.0),
@@ -112,6 +119,9 @@ VRONode::VRONode() : VROThreadRestricted(VROThreadName::Renderer),
     _lastRotation(VROMatrix4f::identity()),
     _lastHasScalePivot(false),
     _lastHasRotationPivot(false),
+    _umbrellaBoundsSet(false),
+    _umbrellaBoundsInexact(true),
+    _worldInverseTransposeDirty(true),
     _holdRendering(false) {
     ALLOCATION_TRACKER_ADD(Nodes, 1);
 }
@@ -128,7 +138,9 @@ VRONode::VRONode(const VRONode &node) : VROThreadRestricted(VROThreadName::Rende
     _position(node._position),
     _rotation(node._rotation),
     _euler(node._euler),
+    _transformDirty(true),
     _renderingOrder(node._renderingOrder),
+    _computedLightSet(VROLightSet::getEmptySet()),
     _hidden(node._hidden),
     _opacityFromHiddenFlag(node._opacityFromHiddenFlag),
     _opacity(node._opacity),
@@ -186,6 +198,9 @@ VRONode::VRONode(const VRONode &node) : VROThreadRestricted(VROThreadName::Rende
     _lastWorldUmbrellaBoundingBox(node._lastWorldUmbrellaBoundingBox),
     _lastUmbrellaBoundsSet(node._lastUmbrellaBoundsSet),
 #endif
+    _umbrellaBoundsSet(false),
+    _umbrellaBoundsInexact(true),
+    _worldInverseTransposeDirty(true),
     _holdRendering(node._holdRendering) {
         
     ALLOCATION_TRACKER_ADD(Nodes, 1);
@@ -230,6 +245,25 @@ void VRONode::render(int elementIndex,
     }
 }
 
+bool VRONode::isInstanceable(const std::shared_ptr<VROMaterial> &material) const {
+    if (_holdRendering || !_geometry || _computedOpacity <= kHiddenOpacityThreshold) {
+        return false;
+    }
+    
+    // Skinned and particle geometries already have their own per-vertex or
+    // per-instance transforms, and shader modifiers may rely on the model matrix
+    // uniform, so these are always rendered individually
+    return !_geometry->getSkinner() && !_geometry->getInstancedUBO() &&
+           !_geometry->isScreenSpace() && !_geometry->isCameraEnclosure() &&
+           material->getShaderModifiers().empty();
+}
+
+void VRONode::appendInstance(std::vector<VROMatrix4f> *transforms,
+                             std::vector<VROMatrix4f> *normalMatrices) const {
+    transforms->push_back(_worldTransform);
+    normalMatrices->push_back(_worldInverseTransposeTransform);
+}
+
 void VRONode::render(const VRORenderContext &context, std::shared_ptr<VRODriver> &driver) {
     if (_holdRendering) {
         return;
@@ -237,7 +271,7 @@ void VRONode::render(const VRORenderContext &context, std::shared_ptr<VRODriver>
     if (_geometry && _computedOpacity > kHiddenOpacityThreshold) {
         for (int i = 0; i < _geometry->getGeometryElements().size(); i++) {
             std::shared_ptr<VROMaterial> &material = _geometry->getMaterialForElement(i);
-            if (!material->bindShader(_computedLightsHash, _computedLights, context, driver)) {
+            if (!material->bindShader(_computedLightSet->getHash(), _computedLightSet->getLights(), context, driver)) {
                 continue;
             }
             material->bindProperties(driver);
@@ -249,7 +283,7 @@ void VRONode::render(const VRORenderContext &context, std::shared_ptr<VRODriver>
             // 2. The material is Constant. Constant materials do not need light to be visible. Or,
             // 3. The material is PBR, and we have an active lighting environment. Lighting environments
             //    provide ambient light for PBR materials
-            if (!_computedLights.empty() ||
+            if (!_computedLightSet->getLights().empty() ||
                  material->getLightingModel() == VROLightingModel::Constant ||
                 (material->getLightingModel() == VROLightingModel::PhysicallyBased && context.getIrradianceMap() != nullptr)) {
 
@@ -316,6 +350,10 @@ void VRONode::resetDebugSortIndex() {
     sDebugSortIndex = 0;
 }
 
+uint32_t VRONode::getGraphVersion() {
+    return sGraphVersion;
+}
+
 void VRONode::collectLights(std::vector<std::shared_ptr<VROLight>> *outLights) {
     for (std::shared_ptr<VROLight> &light : _lights) {
         light->setTransformedPosition(_worldTransform.multiply(light->getPosition()));
@@ -351,39 +389,30 @@ void VRONode::updateSortKeys(uint32_t depth,
         return;
     }
 
-    std::stack<float> &opacities = params.opacities;
-    std::vector<std::shared_ptr<VROLight>> &lights = params.lights;
-    std::stack<int> &hierarchyDepths = params.hierarchyDepths;
-    std::stack<float> &distancesFromCamera = params.distancesFromCamera;
-
     /*
      Compute specific parameters for this node.
      */
-    _worldInverseTransposeTransform = _worldTransform.invert().transpose();
-    _computedOpacity = opacities.top() * _opacity * _opacityFromHiddenFlag;
-    opacities.push(_computedOpacity);
-    
-    _computedLights.clear();
-    for (std::shared_ptr<VROLight> &light : lights) {
-        if ((light->getInfluenceBitMask() & _lightReceivingBitMask) != 0) {
-
-            // Ambient and Directional lights do not attenuate so do not cull them here
-            if (light->getType() == VROLightType::Ambient ||
-                light->getType() == VROLightType::Directional ||
-                getBoundingBox().getDistanceToPoint(light->getTransformedPosition()) < light->getAttenuationEndDistance()) {
-                _computedLights.push_back(light);
-            }
-        }
+    if (_worldInverseTransposeDirty) {
+        _worldInverseTransposeTransform = _worldTransform.invert().transpose();
+        _worldInverseTransposeDirty = false;
+    }
+    float parentOpacity = params.opacity;
+    _computedOpacity = parentOpacity * _opacity * _opacityFromHiddenFlag;
+    
+    if (params.lightGrid) {
+        _computedLightSet = params.lightGrid->findLights(getBoundingBox(), _lightReceivingBitMask);
+    }
+    else {
+        _computedLightSet = VROLightSet::getEmptySet();
     }
-    _computedLightsHash = VROLight::hashLights(_computedLights);
 
     /*
      This node uses hierarchical rendering if its flag is set, or if its parent
      used hierarchical rendering.
      */
     int hierarchyDepth = 0;
-    int parentHierarchyDepth = hierarchyDepths.top();
-    float parentDistanceFromCamera = distancesFromCamera.top();
+    int parentHierarchyDepth = params.hierarchyDepth;
+    float parentDistanceFromCamera = params.distanceFromCamera;
     
     bool isParentHierarchical = (parentHierarchyDepth >= 0);
     bool isHierarchical = _hierarchicalRendering || isParentHierarchical;
@@ -401,7 +430,6 @@ void VRONode::updateSortKeys(uint32_t depth,
     
     if (isHierarchical) {
         hierarchyDepth = parentHierarchyDepth + 1;
-        hierarchyDepths.push(hierarchyDepth);
         
         if (isTopOfHierarchy) {
             hierarchyId = ++params.hierarchyId;
@@ -414,9 +442,6 @@ void VRONode::updateSortKeys(uint32_t depth,
             distanceFromCamera = parentDistanceFromCamera;
         }
     }
-    else {
-        hierarchyDepths.push(-1);
-    }
     
     /*
      Compute the sort key for this node's geometry elements.
@@ -441,12 +466,12 @@ void VRONode::updateSortKeys(uint32_t depth,
                 distanceFromCamera = params.furthestDistanceFromCamera;
             }
         }
-        _geometry->updateSortKeys(this, hierarchyId, hierarchyDepth, _computedLightsHash, _computedLights, _computedOpacity,
+        _geometry->updateSortKeys(this, &_sortKeys, hierarchyId, hierarchyDepth, _computedLightSet->getHash(), _computedLightSet->getLights(), _computedOpacity,
                                   distanceFromCamera, context.getZFar(), metadata, context, driver);
         
         if (kDebugSortOrder && context.getFrame() % kDebugSortOrderFrameFrequency == 0) {
             pinfo("   [%d] Pushed node with position [%f, %f, %f], rendering order %d, hierarchy depth %d (actual depth %d), distance to camera %f, hierarchy ID %d, lights %d",
-                  sDebugSortIndex, _worldPosition.x, _worldPosition.y, _worldPosition.z, _renderingOrder, hierarchyDepth, depth, distanceFromCamera, hierarchyId, _computedLightsHash);
+                  sDebugSortIndex, _worldPosition.x, _worldPosition.y, _worldPosition.z, _renderingOrder, hierarchyDepth, depth, distanceFromCamera, hierarchyId, _computedLightSet->getHash());
             _geometry->setName(VROStringUtil::toString(sDebugSortIndex));
         }
     }
@@ -456,28 +481,32 @@ void VRONode::updateSortKeys(uint32_t depth,
               hierarchyDepth, 0.0, depth, hierarchyId);
     }
 
-    distancesFromCamera.push(distanceFromCamera);
     params.furthestDistanceFromCamera = std::max(params.furthestDistanceFromCamera, furthestDistanceFromCamera);
     sDebugSortIndex++;
     
     /*
-     Move down the tree.
+     Move down the tree. The parameters inherited by children are saved on the
+     call stack and restored on the way back up.
      */
+    params.opacity = _computedOpacity;
+    params.hierarchyDepth = isHierarchical ? hierarchyDepth : -1;
+    params.distanceFromCamera = distanceFromCamera;
+    
     for (std::shared_ptr<VRONode> &childNode : _subnodes) {
         childNode->updateSortKeys(depth + 1, params, metadata, context, driver);
     }
     
-    opacities.pop();
-    hierarchyDepths.pop();
-    distancesFromCamera.pop();
+    params.opacity = parentOpacity;
+    params.hierarchyDepth = parentHierarchyDepth;
+    params.distanceFromCamera = parentDistanceFromCamera;
 }
 
-void VRONode::getSortKeysForVisibleNodes(std::vector<VROSortKey> *outKeys) {
+void VRONode::getSortKeysForVisibleNodes(VROSortKeyList *outKeys) {
     passert_thread(__func__);
     
     // Add the geometry of this node, if available
     if (_visible && _geometry && getType() == VRONodeType::Normal) {
-        _geometry->getSortKeys(outKeys);
+        outKeys->insert(outKeys->end(), _sortKeys.keys.begin(), _sortKeys.keys.end());
     }
     
     // Search down the scene graph. If a child is a portal or portal frame,
@@ -502,21 +531,45 @@ void VRONode::computeTransforms(VROMatrix4f parentTransform, VROMatrix4f parentR
     for (std::shared_ptr<VROSound> &sound : _sounds) {
         sound->setTransformedPosition(_worldTransform.multiply(sound->getPosition()));
     }
-    
-    // Compute the umbrella bounding box for this node
-    computeUmbrellaBounds();
 
-    // Recurse down the tree
+    // Recurse down the tree, then compute the umbrella bounding box for this
+    // node from the children's (now final) umbrella bounds
+    beginUmbrellaBounds();
     for (std::shared_ptr<VRONode> &childNode : _subnodes) {
         childNode->computeTransforms(_worldTransform, _worldRotation);
+        unionUmbrellaBounds(*childNode);
     }
+    endUmbrellaBounds();
 }
 
 void VRONode::doComputeTransform(VROMatrix4f parentTransform) {
+    computeLocalTransform();
+    
+    _worldTransform = parentTransform * _localTransform;
+    _worldInverseTransposeDirty = true;
+    _worldPosition = { _worldTransform[12], _worldTransform[13], _worldTransform[14] };
+    computeBounds();
+}
+
+void VRONode::computeLocalTransform() {
     /*
-     Compute the world transform for this node. The full formula is:
-     _worldTransform = parentTransform * T * Rpiv * R * Rpiv -1 * Spiv * S * Spiv-1
+     Compute the local transform for this node. The full formula is:
+     _localTransform = T * Rpiv * R * Rpiv -1 * Spiv * S * Spiv-1
      */
+    if (!_scalePivot && !_rotationPivot) {
+        /*
+         Fast path without pivots: T * R * S is simply the rotation matrix with
+         its columns scaled, and the translation in the last column.
+         */
+        _rotation.getMatrix(_localTransform, _position);
+        for (int i = 0; i < 3; i++) {
+            _localTransform[i]     *= _scale.x;
+            _localTransform[4 + i] *= _scale.y;
+            _localTransform[8 + i] *= _scale.z;
+        }
+        return;
+    }
+    
     _localTransform.toIdentity();
     
     /*
@@ -547,10 +600,35 @@ void VRONode::doComputeTransform(VROMatrix4f parentTransform) {
     VROMatrix4f translate;
     translate.translate(_position.x, _position.y, _position.z);
     _localTransform = translate * _localTransform;
+}
 
-    _worldTransform = parentTransform * _localTransform;
+void VRONode::setComputedWorldTransform(const VROMatrix4f &worldTransform, const VROMatrix4f &worldRotation) {
+    _worldTransform = worldTransform;
+    _worldRotation = worldRotation;
+    _worldInverseTransposeDirty = true;
     _worldPosition = { _worldTransform[12], _worldTransform[13], _worldTransform[14] };
+    computeBounds();
     
+    for (std::shared_ptr<VROSound> &sound : _sounds) {
+        sound->setTransformedPosition(_worldTransform.multiply(sound->getPosition()));
+    }
+}
+
+bool VRONode::refreshComputedBounds() {
+    bool updated = false;
+    if (_geometry) {
+        if (_geometry->getInstancedUBO() != nullptr || _geometry->getBoundingBox() != _geometryBoundingBox) {
+            computeBounds();
+            updated = true;
+        }
+    }
+    for (std::shared_ptr<VROSound> &sound : _sounds) {
+        sound->setTransformedPosition(_worldTransform.multiply(sound->getPosition()));
+    }
+    return updated;
+}
+
+void VRONode::computeBounds() {
     if (_geometry) {
         if (_geometry->getInstancedUBO() != nullptr) {
             _worldBoundingBox = _geometry->getInstancedUBO()->getInstancedBoundingBox();
@@ -623,6 +701,7 @@ void VRONode::applyConstraints(const VRORenderContext &context, VROMatrix4f pare
             }
         }
         
+        _worldInverseTransposeDirty = true;
         updated = true;
     }
 
@@ -664,6 +743,7 @@ void VRONode::setWorldTransform(VROVector3f finalPosition, VROQuaternion finalRo
         _scale = currentTransform.extractScale();
         _position = currentTransform.extractTranslation();
         _rotation = currentTransform.extractRotation(_scale);
+        _transformDirty = true;
     } else {
         // we want this "setWorldTransform" to animate to the new scale/position/rotation. This is
         // slightly problematic because the computeTransforms is recursive, but this is only used
@@ -681,6 +761,14 @@ void VRONode::setWorldTransform(VROVector3f finalPosition, VROQuaternion finalRo
 #pragma mark - Visibility
 
 void VRONode::updateVisibility(const VRORenderContext &context) {
+    if (updateVisibilityShallow(context)) {
+        for (std::shared_ptr<VRONode> &childNode : _subnodes) {
+            childNode->updateVisibility(context);
+        }
+    }
+}
+
+bool VRONode::updateVisibilityShallow(const VRORenderContext &context) {
     const VROFrustum &frustum = context.getCamera().getFrustum();
     VROFrustumResult result = VROFrustumResult::Outside;
     
@@ -700,15 +788,15 @@ void VRONode::updateVisibility(const VRORenderContext &context) {
     // in the other two cases.
     if (result == VROFrustumResult::Inside || !kEnableVisibilityFrustumTest) {
         setVisibilityRecursive(true);
+        return false;
     }
     else if (result == VROFrustumResult::Intersects) {
         _visible = true;
-        for (std::shared_ptr<VRONode> &childNode : _subnodes) {
-            childNode->updateVisibility(context);
-        }
+        return true;
     }
     else {
         setVisibilityRecursive(false);
+        return false;
     }
 }
 
@@ -720,60 +808,54 @@ void VRONode::setVisibilityRecursive(bool visible) {
     }
 }
 
-void VRONode::computeUmbrellaBounds() {
+void VRONode::beginUmbrellaBounds() {
     // The world umbrella bounding box is the bounding box of this Node in world coordinates,
     // union-ed with the bounding boxes of all children, and their children, etc.
     //
     // The local unbrella bounding box is similar, except its in the coordinate system of
     // the node. This means it is the bounding box of this Node's geometry (with no transforms
-    // applied), union-ed with the bounding box of each child's geometry multiplied by
-    // each child's transform, union-ed with the bounding box of each grandchild's geometry
-    // multiplied by the child and grandchild transforms, etc. Importantly, the transform of
-    // _this_ node is not applied.
-    bool isSet = false;
+    // applied), union-ed with the local umbrella bounding box of each child multiplied by
+    // that child's local transform. Importantly, the transform of _this_ node is not applied.
+    //
+    // Children must have their umbrella bounds finalized before they are union-ed into
+    // their parent, so this is computed bottom-up.
+    _umbrellaBoundsSet = false;
+    _umbrellaBoundsInexact = !_constraints.empty();
     if (_geometry) {
         // Use _geometryBoundingBox instead of _localBoundingBox because we do not apply this Node's transform
         _localUmbrellaBoundingBox = _geometryBoundingBox;
         _worldUmbrellaBoundingBox = _worldBoundingBox;
-        isSet = true;
+        _umbrellaBoundsSet = true;
     }
-    for (const std::shared_ptr<VRONode> &childNode : _subnodes) {
-        if (childNode->computeUmbrellaBounds(&_localUmbrellaBoundingBox, &_worldUmbrellaBoundingBox, VROMatrix4f::identity(), isSet)) {
-            isSet = true;
-        }
+}
+
+void VRONode::unionUmbrellaBounds(const VRONode &child) {
+    _umbrellaBoundsInexact |= child._umbrellaBoundsInexact;
+    if (!child._umbrellaBoundsSet) {
+        return;
     }
     
+    VROBoundingBox childLocalBounds = child._localUmbrellaBoundingBox.transform(child._localTransform);
+    if (!_umbrellaBoundsSet) {
+        _localUmbrellaBoundingBox = childLocalBounds;
+        _worldUmbrellaBoundingBox = child._worldUmbrellaBoundingBox;
+        _umbrellaBoundsSet = true;
+    } else {
+        _localUmbrellaBoundingBox.unionDestructive(childLocalBounds);
+        _worldUmbrellaBoundingBox.unionDestructive(child._worldUmbrellaBoundingBox);
+    }
+}
+
+void VRONode::endUmbrellaBounds() {
     // If the bounds were empty (e.g. no geometry all the way down), then set the
     // bounds to the position.
-    if (!isSet) {
+    if (!_umbrellaBoundsSet) {
         _worldUmbrellaBoundingBox.set(_worldPosition.x, _worldPosition.x, _worldPosition.y,
                                       _worldPosition.y, _worldPosition.z, _worldPosition.z);
         _localUmbrellaBoundingBox.set(0, 0, 0, 0, 0, 0);
     }
 }
 
-bool VRONode::computeUmbrellaBounds(VROBoundingBox *localBounds, VROBoundingBox *worldBounds, VROMatrix4f transform, bool isSet) const {
-    if (_geometry) {
-        if (!isSet) {
-            *localBounds = _localBoundingBox.transform(transform);
-            *worldBounds = _worldBoundingBox;
-            isSet = true;
-        } else {
-            localBounds->unionDestructive(_localBoundingBox.transform(transform));
-            worldBounds->unionDestructive(_worldBoundingBox);
-        }
-    }
-    
-    transform = transform * _localTransform;
-    
-    for (const std::shared_ptr<VRONode> &childNode : _subnodes) {
-        if (childNode->computeUmbrellaBounds(localBounds, worldBounds, transform, isSet)) {
-            isSet = true;
-        }
-    }
-    return isSet;
-}
-
 int VRONode::countVisibleNodes() const {
     int count = _visible ? 1 : 0;
     for (const std::shared_ptr<VRONode> &childNode : _subnodes) {
@@ -854,6 +936,7 @@ void VRONode::addChildNode(std::shared_ptr<VRONode> node) {
     
     _subnodes.push_back(node);
     node->_supernode = std::static_pointer_cast<VRONode>(shared_from_this());
+    ++sGraphVersion;
     
     /*
      If this node is attached to a VROScene, cascade and assign that scene to
@@ -877,6 +960,7 @@ void VRONode::removeFromParentNode() {
                                                 return node.get() == this;
                                             }), parentSubnodes.end());
         _supernode.reset();
+        ++sGraphVersion;
     }
     
     /*
@@ -971,6 +1055,7 @@ void VRONode::setRotation(VROQuaternion rotation) {
     animate(std::make_shared<VROAnimationQuaternion>([](VROAnimatable *const animatable, VROQuaternion r) {
                                                          ((VRONode *)animatable)->_rotation = r;
                                                          ((VRONode *)animatable)->_euler = r.toEuler();
+                                                         ((VRONode *)animatable)->_transformDirty = true;
                                                      }, _rotation, rotation));
 }
 
@@ -979,6 +1064,7 @@ void VRONode::setRotationEuler(VROVector3f euler) {
     animate(std::make_shared<VROAnimationVector3f>([](VROAnimatable *const animatable, VROVector3f r) {
                                                         ((VRONode *)animatable)->_euler = VROMathNormalizeAngles2PI(r);
                                                         ((VRONode *)animatable)->_rotation = { r.x, r.y, r.z };
+                                                        ((VRONode *)animatable)->_transformDirty = true;
                                                      }, _euler, euler));
     
     VROQuaternion rotation = { euler.x, euler.y, euler.z };
@@ -989,6 +1075,7 @@ void VRONode::setPosition(VROVector3f position) {
     animate(std::make_shared<VROAnimationVector3f>([](VROAnimatable *const animatable, VROVector3f p) {
                                                         VRONode *node = ((VRONode *)animatable);
                                                         node->_position = p;
+                                                        node->_transformDirty = true;
                                                         node->notifyTransformUpdate(false);
                                                    }, _position, position));
 }
@@ -997,6 +1084,7 @@ void VRONode::setScale(VROVector3f scale) {
     passert_thread(__func__);
     animate(std::make_shared<VROAnimationVector3f>([](VROAnimatable *const animatable, VROVector3f s) {
                                                        ((VRONode *)animatable)->_scale = s;
+                                                       ((VRONode *)animatable)->_transformDirty = true;
                                                    }, _scale, scale));
 }
 
@@ -1019,6 +1107,7 @@ void VRONode::setPositionX(float x) {
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float p) {
         VRONode *node = ((VRONode *)animatable);
         node->_position.x = p;
+        node->_transformDirty = true;
         node->notifyTransformUpdate(false);
     }, _position.x, x));
 }
@@ -1028,6 +1117,7 @@ void VRONode::setPositionY(float y) {
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float p) {
         VRONode *node = ((VRONode *)animatable);
         node->_position.y = p;
+        node->_transformDirty = true;
         node->notifyTransformUpdate(false);
     }, _position.y, y));
 }
@@ -1037,6 +1127,7 @@ void VRONode::setPositionZ(float z) {
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float p) {
         VRONode *node = ((VRONode *)animatable);
         node->_position.z = p;
+        node->_transformDirty = true;
         node->notifyTransformUpdate(false);
     }, _position.z, z));
 }
@@ -1045,6 +1136,7 @@ void VRONode::setScaleX(float x) {
     passert_thread(__func__);
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float s) {
         ((VRONode *)animatable)->_scale.x = s;
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _scale.x, x));
 }
 
@@ -1052,6 +1144,7 @@ void VRONode::setScaleY(float y) {
     passert_thread(__func__);
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float s) {
         ((VRONode *)animatable)->_scale.y = s;
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _scale.y, y));
 }
 
@@ -1059,6 +1152,7 @@ void VRONode::setScaleZ(float z) {
     passert_thread(__func__);
     animate(std::make_shared<VROAnimationFloat>([](VROAnimatable *const animatable, float s) {
         ((VRONode *)animatable)->_scale.z = s;
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _scale.z, z));
 }
 
@@ -1068,6 +1162,7 @@ void VRONode::setRotationEulerX(float radians) {
         VROVector3f &euler = ((VRONode *) animatable)->_euler;
         euler.x = VROMathNormalizeAngle2PI(r);
         ((VRONode *)animatable)->_rotation = { euler.x, euler.y, euler.z };
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _euler.x, radians));
 }
 
@@ -1077,6 +1172,7 @@ void VRONode::setRotationEulerY(float radians) {
         VROVector3f &euler = ((VRONode *) animatable)->_euler;
         euler.y = VROMathNormalizeAngle2PI(r);
         ((VRONode *)animatable)->_rotation = { euler.x, euler.y, euler.z };
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _euler.y, radians));
 }
 
@@ -1086,6 +1182,7 @@ void VRONode::setRotationEulerZ(float radians) {
         VROVector3f &euler = ((VRONode *) animatable)->_euler;
         euler.z = VROMathNormalizeAngle2PI(r);
         ((VRONode *)animatable)->_rotation = { euler.x, euler.y, euler.z };
+        ((VRONode *)animatable)->_transformDirty = true;
     }, _euler.z, radians));
 }
 
@@ -1093,12 +1190,14 @@ void VRONode::setRotationPivot(VROMatrix4f pivot) {
     passert_thread(__func__);
     _rotationPivot = pivot;
     _rotationPivotInverse = pivot.invert();
+    _transformDirty = true;
 }
 
 void VRONode::setScalePivot(VROMatrix4f pivot) {
     passert_thread(__func__);
     _scalePivot = pivot;
     _scalePivotInverse = pivot.invert();
+    _transformDirty = true;
 }
 
 void VRONode::setOpacity(float opacity) {
@@ -1563,6 +1662,11 @@ void VRONode::hitTest(const VROCamera &camera, VROVector3f origin, VROVector3f r
         return;
     }
     
+    // Skip the entire subtree if the ray misses its umbrella bounds
+    if (!_umbrellaBoundsInexact && !_worldUmbrellaBoundingBox.intersectsRay(ray, origin)) {
+        return;
+    }
+    
     VROMatrix4f transform = _worldTransform;
     boundsOnly = boundsOnly && !getHighAccuracyEvents();
     
@@ -1599,13 +1703,33 @@ void VRONode::hitTest(const VROCamera &camera, VROVector3f origin, VROVector3f r
 bool VRONode::hitTestGeometry(VROVector3f origin, VROVector3f ray,
                               VROMatrix4f transform, VROVector3f *intPt) {
     passert_thread(__func__);
+    
+    /*
+     When possible, transform the ray into the geometry's local space and intersect
+     it with the geometry's triangle BVH. The parameter t of the hit is the same in
+     both spaces, because the transform is affine.
+     */
+    std::shared_ptr<VROTriangleBVH> bvh = _geometry->getTriangleBVH();
+    VROVector3f scale = transform.extractScale();
+    if (bvh && scale.x != 0 && scale.y != 0 && scale.z != 0) {
+        VROMatrix4f inverse = transform.invert();
+        VROVector3f localOrigin = inverse.multiply(origin);
+        VROVector3f localRay = inverse.multiply(origin + ray) - localOrigin;
+        
+        float t;
+        if (bvh->intersectRay(localOrigin, localRay, &t)) {
+            *intPt = origin + ray * t;
+            return true;
+        }
+        return false;
+    }
+    
     std::shared_ptr<VROGeometrySource> vertexSource = _geometry->getGeometrySourcesForSemantic(VROGeometrySourceSemantic::Vertex).front();
     
     bool hit = false;
     float currentDistance = FLT_MAX;
-    std::string tag = getTag();
     for (std::shared_ptr<VROGeometryElement> element : _geometry->getGeometryElements()) {
-         element->processTriangles([&hit, ray, origin, transform, &intPt, &currentDistance, tag](int index, VROTriangle triangle) {
+         element->processTriangles([&hit, ray, origin, transform, &intPt, &currentDistance](int index, VROTriangle triangle) {
              VROTriangle transformed = triangle.transformByMatrix(transform);
              VROVector3f intPtGeom;
              if (transformed.intersectsRay(ray, origin, &intPtGeom)) {
@@ -1615,8 +1739,6 @@ bool VRONode::hitTestGeometry(VROVector3f origin, VROVector3f ray,
                      *intPt = intPtGeom;
                      hit = true;
                  }
-
-                 //TODO Offer a way to break out of here, as optimization
              }
          }, vertexSource);
     }
@@ -1675,26 +1797,32 @@ void VRONode::clearPhysicsBody() {
 #pragma mark - Particle Emitters
 
 void VRONode::updateParticles(const VRORenderContext &context) {
+    updateParticleEmitter(context);
+    
+    // Recurse to children
+    for (std::shared_ptr<VRONode> &child : _subnodes) {
+        child->updateParticles(context);
+    }
+}
+
+void VRONode::updateParticleEmitter(const VRORenderContext &context) {
     if (_particleEmitter) {
         // Check if the particle emitter's surface has changed
         if (_geometry != _particleEmitter->getParticleSurface()) {
             _geometry = _particleEmitter->getParticleSurface();
+            _transformDirty = true;
         }
         
         // Update the emitter
         _particleEmitter->update(context, _worldTransform);
     }
-    
-    // Recurse to children
-    for (std::shared_ptr<VRONode> &child : _subnodes) {
-        child->updateParticles(context);
-    }
 }
 
 void VRONode::setParticleEmitter(std::shared_ptr<VROParticleEmitter> emitter) {
     passert_thread(__func__);
     _particleEmitter = emitter;
     _geometry = emitter->getParticleSurface();
+    _transformDirty = true;
     setIgnoreEventHandling(true);
 }
 
@@ -1702,6 +1830,7 @@ void VRONode::removeParticleEmitter() {
     passert_thread(__func__);
     _particleEmitter.reset();
     _geometry.reset();
+    _transformDirty = true;
     setIgnoreEventHandling(false);
 }
 
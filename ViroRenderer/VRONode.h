@@ -41,6 +41,7 @@
 #include "VRORenderContext.h"
 #include "VRODriver.h"
 #include "VRORenderParameters.h"
+#include "VROLightGrid.h"
 #include "VROAnimatable.h"
 #include "VROBoundingBox.h"
 #include "VROSortKey.h"
@@ -71,6 +72,7 @@ class VROSkeletalAnimationLayer;
 class VROSkinner;
 class VROIKRig;
 
+extern bool kEnableVisibilityFrustumTest;
 extern bool kDebugSortOrder;
 extern int  kDebugSortOrderFrameFrequency;
 extern const std::string kDefaultNodeTag;
@@ -104,10 +106,21 @@ enum class VRODragType {
 
 class VRONode : public VROAnimatable, public VROThreadRestricted {
     
+    friend class VROTransformHierarchy;
+    friend class VROFrustumCuller;
+    
 public:
     
     static void resetDebugSortIndex();
     
+    /*
+     Returns a counter that is incremented each time a node is added to or
+     removed from a parent, anywhere in the application. Used to detect when
+     flattened representations of the scene graph (e.g. VROTransformHierarchy)
+     are out of date.
+     */
+    static uint32_t getGraphVersion();
+    
 #pragma mark - Initialization
     
     /*
@@ -171,11 +184,26 @@ public:
      */
     void updateVisibility(const VRORenderContext &context);
     
+    /*
+     Non-recursive form of updateVisibility. Updates the visibility of this node,
+     and returns true if the visibility of each child must then be updated with
+     updateVisibility(); otherwise all children have already been included or
+     excluded. The children can be processed in parallel.
+     */
+    bool updateVisibilityShallow(const VRORenderContext &context);
+    
     /*
      Update the particle emitters attached to this node. Recurses to children.
      */
     void updateParticles(const VRORenderContext &context);
     
+    /*
+     Update only the particle emitter attached to this node, if any. Particle
+     emitters are independent, so this may be invoked concurrently on different
+     nodes.
+     */
+    void updateParticleEmitter(const VRORenderContext &context);
+    
     /*
      Recursively applies transformation constraints (e.g. billboarding) to this node
      and its children.
@@ -208,7 +236,7 @@ public:
      Get the sort keys for all visible nodes in this portal. Stops the search
      when we reach the hit of the scene graph or hit another portal.
      */
-    void getSortKeysForVisibleNodes(std::vector<VROSortKey> *outKeys);
+    void getSortKeysForVisibleNodes(VROSortKeyList *outKeys);
     
     /*
      Render the given element of this node's geometry, using its latest computed transforms.
@@ -218,6 +246,20 @@ public:
                 const VRORenderContext &context,
                 std::shared_ptr<VRODriver> &driver);
     
+    /*
+     Returns true if this node's geometry, rendered with the given material, may be
+     drawn in an instanced batch with other nodes drawing the same geometry data
+     and an equivalent material.
+     */
+    bool isInstanceable(const std::shared_ptr<VROMaterial> &material) const;
+    
+    /*
+     Append this node's world transform and normal matrix to the given vectors,
+     for rendering this node as one instance of an instanced batch.
+     */
+    void appendInstance(std::vector<VROMatrix4f> *transforms,
+                        std::vector<VROMatrix4f> *normalMatrices) const;
+    
     /*
      Recursively render this node and all of its children, with full texture
      and lighting.
@@ -252,6 +294,7 @@ public:
     void setGeometry(std::shared_ptr<VROGeometry> geometry) {
         passert_thread(__func__);
         _geometry = geometry;
+        _transformDirty = true;
     }
     std::shared_ptr<VROGeometry> getGeometry() const {
         return _geometry;
@@ -442,6 +485,9 @@ public:
     float getOpacity() const {
         return _opacity;
     }
+    float getComputedOpacity() const {
+        return _computedOpacity;
+    }
     void setOpacity(float opacity);
 
     virtual bool isHidden() const {
@@ -493,6 +539,9 @@ public:
     void setParticleEmitter(std::shared_ptr<VROParticleEmitter> emitter);
     void removeParticleEmitter();
     std::shared_ptr<VROParticleEmitter> getParticleEmitter() const;
+    bool hasParticleEmitter() const {
+        return _particleEmitter != nullptr;
+    }
 
 #pragma mark - Lights
     
@@ -516,10 +565,10 @@ public:
         return _lights;
     }
     const std::vector<std::shared_ptr<VROLight>> &getComputedLights() const {
-        return _computedLights;
+        return _computedLightSet->getLights();
     }
     uint32_t getComputedLightsHash() const {
-        return _computedLightsHash;
+        return _computedLightSet->getHash();
     }
     
     void setLightReceivingBitMask(int bitMask, bool recursive = false) {
@@ -832,6 +881,12 @@ protected:
      The geometry in the node. Null means the node has no geometry.
      */
     std::shared_ptr<VROGeometry> _geometry;
+    
+    /*
+     The sort keys of this node's geometry elements, as of the last call to
+     updateSortKeys().
+     */
+    VROSortKeyCache _sortKeys;
 
     /*
      The inverse kinematic rig associated with this node, set when this node is
@@ -893,6 +948,13 @@ private:
     std::experimental::optional<VROMatrix4f> _scalePivot;
     std::experimental::optional<VROMatrix4f> _scalePivotInverse;
     
+    /*
+     True if the position, rotation, scale, pivots, or geometry of this node
+     have changed since its transforms were last computed by the scene's
+     VROTransformHierarchy.
+     */
+    bool _transformDirty;
+    
     /*
      User-defined rendering order for this node.
      */
@@ -906,9 +968,10 @@ private:
      matrix for the node. 
      
      worldRotation only takes into account rotations (not scale or translation).
-     computedLights are the lights that influence this node, based on distance from
+     computedLightSet holds the lights that influence this node, based on distance from
      the light and light attenuation, unrelated to the scene graph (e.g. the lights
-     in _computedLights may belong to any node in the scene).
+     in _computedLightSet may belong to any node in the scene). Nodes influenced by the
+     same lights share the same set.
      
      localTransform only takes into the account the transformations of _this_
      node.
@@ -919,8 +982,7 @@ private:
     VROMatrix4f _worldRotation;
     VROVector3f _worldPosition;
     float _computedOpacity;
-    std::vector<std::shared_ptr<VROLight>> _computedLights;
-    uint32_t _computedLightsHash;
+    std::shared_ptr<VROLightSet> _computedLightSet;
     std::weak_ptr<VROTransformDelegate> _transformDelegate;
 
     /*
@@ -969,6 +1031,28 @@ private:
     VROBoundingBox _worldUmbrellaBoundingBox;
     VROFrustumBoxIntersectionMetadata _umbrellaBoxMetadata;
     
+    /*
+     True if the umbrella bounding boxes above contain the bounds of at least one
+     geometry (from this node or from any descendant).
+     */
+    bool _umbrellaBoundsSet;
+    
+    /*
+     True if the world umbrella bounding box may not contain the bounds of every
+     node in this subtree. This is the case before the umbrella bounds are first
+     computed, and when this node or a descendant has constraints (which modify
+     world transforms after umbrella bounds are computed). Inexact umbrella bounds
+     cannot be used to skip subtrees during hit testing.
+     */
+    bool _umbrellaBoundsInexact;
+    
+    /*
+     True if _worldTransform has changed since _worldInverseTransposeTransform (the
+     normal matrix) was last computed. The inversion is skipped for nodes that
+     have not moved.
+     */
+    bool _worldInverseTransposeDirty;
+    
     /*
      True if this node is hidden. Hidden nodes are not rendered, and do not 
      respond to tap events. Hiding a node within an animation results in a 
@@ -1077,10 +1161,13 @@ private:
     void setVisibilityRecursive(bool visible);
     
     /*
-     Recursively expand the given bounding box by this node's _worldBoundingBox.
+     Umbrella bounds are computed bottom-up: begin resets the umbrella bounds to this
+     node's own bounds, union expands them by the (already final) umbrella bounds of
+     a child, and end handles the case where no geometry was found in the subtree.
      */
-    void computeUmbrellaBounds();
-    bool computeUmbrellaBounds(VROBoundingBox *localBounds, VROBoundingBox *worldBounds, VROMatrix4f transform, bool isSet) const;
+    void beginUmbrellaBounds();
+    void unionUmbrellaBounds(const VRONode &child);
+    void endUmbrellaBounds();
     
     /*
      Compute the transform for this node, taking into the account the parent's transform.
@@ -1092,6 +1179,30 @@ private:
      */
     void doComputeTransform(VROMatrix4f parentTransform);
     
+    /*
+     Compute _localTransform from this node's position, rotation, scale, and pivots.
+     */
+    void computeLocalTransform();
+    
+    /*
+     Set the world transform and rotation of this node, as computed externally (by
+     VROTransformHierarchy), and update the world position and bounding boxes.
+     */
+    void setComputedWorldTransform(const VROMatrix4f &worldTransform, const VROMatrix4f &worldRotation);
+    
+    /*
+     Update the bounding boxes from the current transforms and geometry.
+     */
+    void computeBounds();
+    
+    /*
+     Invoked on nodes whose transforms did not change this frame: recomputes the
+     bounding boxes only if the underlying geometry bounds changed, and updates
+     the transformed positions of spatial sounds. Returns true if the bounding
+     boxes were recomputed.
+     */
+    bool refreshComputedBounds();
+    
     /*
      Action processing: execute all current actions and remove those that are
      expired.
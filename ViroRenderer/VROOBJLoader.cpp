@@ -39,6 +39,7 @@
 #include "VROShapeUtils.h"
 #include "VROTaskQueue.h"
 #include "VROModelIOUtil.h"
+#include "VROTextureDecodePool.h"
 
 void VROOBJLoader::loadOBJFromResource(std::string resource, VROResourceType type,
                                        std::shared_ptr<VRONode> node,
@@ -140,7 +141,7 @@ void VROOBJLoader::readOBJFileAsync(std::string resource, VROResourceType type,
                                                                                loadingTexturesFromResourceMap
                                                                                ? fileMap : nullptr,
                                                                                textureCache,
-                                                                               taskQueue);
+                                                                               taskQueue, driver);
 
                                  // Run all the async tasks. When they're complete, inject the finished FBX into the
                                  // node
@@ -222,7 +223,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
                                                       VROResourceType type,
                                                       std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                       std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
-                                                      std::shared_ptr<VROTaskQueue> taskQueue) {
+                                                      std::shared_ptr<VROTaskQueue> taskQueue,
+                                                      std::shared_ptr<VRODriver> driver) {
     pinfo("OBJ # of vertices  = %d", (int)(attrib.vertices.size()) / 3);
     pinfo("OBJ # of normals   = %d", (int)(attrib.normals.size()) / 3);
     pinfo("OBJ # of texcoords = %d", (int)(attrib.texcoords.size()) / 2);
@@ -265,8 +267,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
         if (diffuseTexname.length() > 0) {
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
-            taskQueue->addTask([material, diffuseTexname, base, type, resourceMap, textureCache, taskQueue_w] {
-                VROModelIOUtil::loadTextureAsync(diffuseTexname, base, type, true, resourceMap, textureCache,
+            taskQueue->addTask([material, diffuseTexname, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                VROModelIOUtil::loadTextureAsync(diffuseTexname, base, type, true, VROTextureDecodePriority::High, resourceMap, textureCache, driver,
                      [material, taskQueue_w, diffuseTexname](std::shared_ptr<VROTexture> texture) {
                          if (texture) {
                              material->getDiffuse().setTexture(texture);
@@ -286,8 +288,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
         if (specularTexname.length() > 0) {
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
-            taskQueue->addTask([material, specularTexname, base, type, resourceMap, textureCache, taskQueue_w] {
-                VROModelIOUtil::loadTextureAsync(specularTexname, base, type, false, resourceMap, textureCache,
+            taskQueue->addTask([material, specularTexname, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                VROModelIOUtil::loadTextureAsync(specularTexname, base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                      [material, taskQueue_w, specularTexname](std::shared_ptr<VROTexture> texture) {
                          if (texture) {
                              material->getSpecular().setTexture(texture);
@@ -307,8 +309,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
         if (normalTexname.length() > 0) {
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
-            taskQueue->addTask([material, normalTexname, base, type, resourceMap, textureCache, taskQueue_w] {
-                VROModelIOUtil::loadTextureAsync(normalTexname, base, type, false, resourceMap, textureCache,
+            taskQueue->addTask([material, normalTexname, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                VROModelIOUtil::loadTextureAsync(normalTexname, base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                      [material, taskQueue_w, normalTexname](std::shared_ptr<VROTexture> texture) {
                          if (texture) {
                              material->getNormal().setTexture(texture);
@@ -330,8 +332,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
         if (roughnessTexname.length() > 0) {
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
 
-            taskQueue->addTask([material, roughnessTexname, base, type, resourceMap, textureCache, taskQueue_w] {
-                VROModelIOUtil::loadTextureAsync(roughnessTexname, base, type, false, resourceMap, textureCache,
+            taskQueue->addTask([material, roughnessTexname, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                VROModelIOUtil::loadTextureAsync(roughnessTexname, base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                      [material, taskQueue_w, roughnessTexname](std::shared_ptr<VROTexture> texture) {
                          if (texture) {
                              material->getRoughness().setTexture(texture);
@@ -352,8 +354,8 @@ std::shared_ptr<VROGeometry> VROOBJLoader::processOBJ(tinyobj::attrib_t &attrib,
         if (metalnessTexname.length() > 0) {
             std::weak_ptr<VROTaskQueue> taskQueue_w = taskQueue;
             
-            taskQueue->addTask([material, metalnessTexname, base, type, resourceMap, textureCache, taskQueue_w] {
-                VROModelIOUtil::loadTextureAsync(metalnessTexname, base, type, false, resourceMap, textureCache,
+            taskQueue->addTask([material, metalnessTexname, base, type, resourceMap, textureCache, driver, taskQueue_w] {
+                VROModelIOUtil::loadTextureAsync(metalnessTexname, base, type, false, VROTextureDecodePriority::Normal, resourceMap, textureCache, driver,
                      [material, taskQueue_w, metalnessTexname](std::shared_ptr<VROTexture> texture) {
                          if (texture) {
                              material->getMetalness().setTexture(texture);
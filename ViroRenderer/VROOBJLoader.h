@@ -83,7 +83,8 @@ private:
                                                    VROResourceType type,
                                                    std::shared_ptr<std::map<std::string, std::string>> resourceMap,
                                                    std::shared_ptr<std::map<std::string, std::shared_ptr<VROTexture>>> textureCache,
-                                                   std::shared_ptr<VROTaskQueue> taskQueue);
+                                                   std::shared_ptr<VROTaskQueue> taskQueue,
+                                                   std::shared_ptr<VRODriver> driver);
 };
 
 #endif /* VROOBJLoader_h */
@@ -437,7 +437,13 @@ std::shared_ptr<VROImage> VROPlatformLoadImageFromFile(std::string filename,
 
 std::shared_ptr<VROImage> VROPlatformLoadImageWithBufferedData(std::vector<unsigned char> rawData,
                                                                VROTextureInternalFormat format) {
-    return nullptr;
+    NSData *data = [NSData dataWithBytes:rawData.data() length:rawData.size()];
+    NSImage *image = [[NSImage alloc] initWithData:data];
+    if (!image) {
+        pwarn("Error when processing buffered image data.");
+        return nullptr;
+    }
+    return std::make_shared<VROImageMacOS>(image, format);
 }
 
 #endif
@@ -1405,6 +1411,11 @@ std::shared_ptr<VROImage> VROPlatformLoadImageFromFile(std::string filename,
     return std::make_shared<VROImageWasm>(filename, format);
 }
 
+std::shared_ptr<VROImage> VROPlatformLoadImageWithBufferedData(std::vector<unsigned char> rawData,
+                                                               VROTextureInternalFormat format) {
+    return std::make_shared<VROImageWasm>(rawData.data(), (int) rawData.size(), format);
+}
+
 void VROPlatformDispatchAsyncRenderer(std::function<void()> fcn) {
     // Multithreading not supported on WASM
     fcn();
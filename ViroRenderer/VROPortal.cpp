@@ -33,14 +33,20 @@
 #include "VROBoundingBox.h"
 #include "VROPortalFrame.h"
 #include "VROShaderModifier.h"
+#include "VROAssetCache.h"
 
 // Parameters for sphere backgrounds
 static const float kSphereBackgroundRadius = 1;
 static const float kSphereBackgroundNumSegments = 60;
 
+// Minimum number of nodes drawing the same geometry data with equivalent materials
+// that are rendered with instanced draws instead of one draw per node
+static const int kMinInstanceBatchSize = 4;
+
 VROPortal::VROPortal() :
     VRONode(),
-    _passable(false) {
+    _passable(false),
+    _numDraws(0) {
     _type = VRONodeType::Portal;
 }
 
@@ -100,11 +106,19 @@ void VROPortal::traversePortals(int frame, int recursionLevel,
     }
 }
 
-void VROPortal::sortNodesBySortKeys() {
-    _keys.clear();
+void VROPortal::sortNodesBySortKeys(VROFrameArena *arena) {
+    static_assert(std::is_trivially_destructible<VROSortKey>::value, "Sort keys outlive the arena memory they occupy");
+    
+    /*
+     Last frame's keys were in arena memory that has since been reset, so rather
+     than clearing them, the list is replaced with one on this frame's arena.
+     */
+    size_t numKeys = _keys.size();
+    _keys = VROSortKeyList(VROFrameAllocator<VROSortKey>(arena));
+    _keys.reserve(numKeys);
     getSortKeysForVisibleNodes(&_keys);
     
-    std::sort(_keys.begin(), _keys.end());
+    _sorter.sort(_keys);
 }
 
 #pragma mark - Rendering Contents
@@ -127,7 +141,13 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
     uint32_t boundMaterialId = UINT32_MAX;
     uint32_t boundHierarchyId = kMaxHierarchyId; // kMaxHierarchyId == Not a hierarchy
     VROSortKey *boundHierarchyParent = nullptr;
-    std::vector<std::shared_ptr<VROLight>> boundLights;
+    const std::vector<std::shared_ptr<VROLight>> *boundLights = nullptr;
+    bool boundInstanced = false;
+    bool batching = driver->isInstancedRenderingSupported();
+    if (batching) {
+        gatherInstanceBatches();
+    }
+    _numDraws = 0;
     
     if (kDebugSortOrder && context.getFrame() % kDebugSortOrderFrameFrequency == 0) {
         pinfo("Rendering");
@@ -135,7 +155,14 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
     
     // Note that since portals and portal frames are not returned in _keys,
     // they will not be rendered here
-    for (VROSortKey &key : _keys) {
+    for (size_t k = 0; k < _keys.size(); k++) {
+        // Keys that are part of an instanced batch are rendered with the batch's
+        // first key
+        if (batching && _batchSizes[k] == 0) {
+            continue;
+        }
+        
+        VROSortKey &key = _keys[k];
         VRONode *node = (VRONode *)key.node;
         int elementIndex = key.elementIndex;
         
@@ -144,16 +171,24 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
             continue;
         }
         
-        std::shared_ptr<VROMaterial> material = geometry->getMaterialForElement(elementIndex);
-        if (!key.incoming) {
-            material = material->getOutgoing();
+        std::shared_ptr<VROMaterial> material = getMaterialForKey(*geometry, key);
+        
+        bool instanced = batching && _batchSizes[k] > 1;
+        if (instanced) {
+            _instanceTransforms.clear();
+            _instanceNormalMatrices.clear();
+            for (int i = (int) k; i >= 0; i = _batchNext[i]) {
+                ((VRONode *) _keys[i].node)->appendInstance(&_instanceTransforms, &_instanceNormalMatrices);
+            }
         }
         
         // Rebind if materials or lights changed. We always have to rebind material
         // properties even if only the lights changed, because new lights imply
         // a potential change of shader -- and we have to upload our material's uniforms
-        // to any new shader.
-        if (key.material != boundMaterialId || boundLights != node->getComputedLights()) {
+        // to any new shader. Instanced batches use a different shader, so switching
+        // between instanced and regular rendering also requires a rebind.
+        if (key.material != boundMaterialId || boundLights != &node->getComputedLights() ||
+            instanced != boundInstanced) {
 
             // If we're rendering a hierarchical object -- meaning, an object that's part of a close-knit
             // 2D unit like a flex-view -- then the entire hierarchy of these 2D objects will appear
@@ -183,7 +218,7 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
             // TODO Perhaps we can check if the shader changed, and if so bind
             //      properties? We could also meld these two methods into one, simplifying
             //      the API?
-            if (!material->bindShader(key.lights, node->getComputedLights(), context, driver)) {
+            if (!material->bindShader(key.lights, node->getComputedLights(), context, driver, instanced)) {
                 pinfo("Failed to bind shader: will not render associated geometry");
                 continue;
             }
@@ -196,7 +231,8 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
             }
 
             boundMaterialId = key.material;
-            boundLights = node->getComputedLights();
+            boundLights = &node->getComputedLights();
+            boundInstanced = instanced;
         }
         
         // We render the material if at least one of the following is true:
@@ -206,22 +242,123 @@ void VROPortal::renderContents(const VRORenderContext &context, std::shared_ptr<
         // 2. The material is Constant. Constant materials do not need light to be visible. Or,
         // 3. The material is PBR, and we have an active lighting environment. Lighting environments
         //    provide ambient light for PBR materials
-        if (!boundLights.empty() ||
+        if (!boundLights->empty() ||
             material->getLightingModel() == VROLightingModel::Constant ||
             (material->getLightingModel() == VROLightingModel::PhysicallyBased && context.getIrradianceMap() != nullptr)) {
 
             if (kDebugSortOrder && context.getFrame() % kDebugSortOrderFrameFrequency == 0) {
                 if (node->getGeometry() && elementIndex == 0) {
-                    pinfo("   Rendering node [%s], element %d [transparent %d, distance from far plane %f, hierarchy [%d-%d]",
-                          node->getName().c_str(), elementIndex, key.transparent, key.distanceFromCamera, key.hierarchyId, key.hierarchyDepth);
+                    pinfo("   Rendering node [%s], element %d [transparent %d, distance from far plane %f, hierarchy [%d-%d], instances %d]",
+                          node->getName().c_str(), elementIndex, key.transparent, key.distanceFromCamera, key.hierarchyId, key.hierarchyDepth,
+                          instanced ? (int) _instanceTransforms.size() : 1);
                 }
             }
 
-            node->render(elementIndex, material, context, driver);
+            if (instanced) {
+                geometry->renderInstanced(elementIndex, material,
+                                          _instanceTransforms.data(), _instanceNormalMatrices.data(),
+                                          (int) _instanceTransforms.size(), node->getComputedOpacity(),
+                                          context, driver);
+            }
+            else {
+                node->render(elementIndex, material, context, driver);
+            }
+            ++_numDraws;
         }
     }
 }
 
+std::shared_ptr<VROMaterial> VROPortal::getMaterialForKey(VROGeometry &geometry, const VROSortKey &key) {
+    std::shared_ptr<VROMaterial> &material = geometry.getMaterialForElement(key.elementIndex);
+    if (!key.incoming) {
+        return material->getOutgoing();
+    }
+    return material;
+}
+
+void VROPortal::gatherInstanceBatches() {
+    size_t numKeys = _keys.size();
+    _batchSizes.assign(numKeys, 1);
+    _batchNext.assign(numKeys, -1);
+    _batchLeaders.clear();
+    
+    for (size_t k = 0; k < numKeys; k++) {
+        const VROSortKey &key = _keys[k];
+        VRONode *node = (VRONode *)key.node;
+        const std::shared_ptr<VROGeometry> &geometry = node->getGeometry();
+        if (!geometry) {
+            continue;
+        }
+        std::shared_ptr<VROMaterial> material = getMaterialForKey(*geometry, key);
+        
+        /*
+         Opaque geometry that reads and writes depth renders correctly in any order,
+         so these keys may be drawn ahead of their sort position, with the first
+         key of their batch. Moving a draw across any other key could change the
+         result, so batches do not span such keys. Hierarchies are rendered with
+         deferred depth writes that depend on the individual draw order, so they
+         are never batched.
+         */
+        bool orderInsensitive = !key.transparent && key.hierarchyId == kMaxHierarchyId &&
+                                material->getWritesToDepthBuffer() && material->getReadsFromDepthBuffer() &&
+                                !geometry->isScreenSpace() && !geometry->isCameraEnclosure();
+        if (!orderInsensitive) {
+            _batchLeaders.clear();
+            continue;
+        }
+        if (!node->isInstanceable(material)) {
+            continue;
+        }
+        
+        uint64_t signature = VROAssetCache::combine(geometry->getBatchKey(key.elementIndex), key.elementIndex);
+        signature = VROAssetCache::combine(signature, ((uint64_t) key.shader << 32) | key.textures);
+        signature = VROAssetCache::combine(signature, ((uint64_t) key.lights << 32) | (uint32_t) key.renderingOrder);
+        signature = VROAssetCache::combine(signature, key.incoming);
+        
+        auto it = _batchLeaders.find(signature);
+        if (it != _batchLeaders.end() && isBatchableWith(_keys[it->second], key)) {
+            int leader = it->second;
+            _batchNext[k] = _batchNext[leader];
+            _batchNext[leader] = (int) k;
+            _batchSizes[leader]++;
+            _batchSizes[k] = 0;
+        }
+        else {
+            _batchLeaders[signature] = (int) k;
+        }
+    }
+    
+    // Batches too small for an instanced draw are rendered one key at a time,
+    // in sort order
+    for (size_t k = 0; k < numKeys; k++) {
+        if (_batchSizes[k] > 1 && _batchSizes[k] < kMinInstanceBatchSize) {
+            int i = (int) k;
+            while (i >= 0) {
+                int next = _batchNext[i];
+                _batchSizes[i] = 1;
+                _batchNext[i] = -1;
+                i = next;
+            }
+        }
+    }
+}
+
+bool VROPortal::isBatchableWith(const VROSortKey &leader, const VROSortKey &key) {
+    VRONode *leaderNode = (VRONode *)leader.node;
+    VRONode *node = (VRONode *)key.node;
+    if (key.elementIndex != leader.elementIndex || key.incoming != leader.incoming ||
+        key.renderingOrder != leader.renderingOrder ||
+        &node->getComputedLights() != &leaderNode->getComputedLights() ||
+        node->getComputedOpacity() != leaderNode->getComputedOpacity()) {
+        return false;
+    }
+    
+    VROGeometry &leaderGeometry = *leaderNode->getGeometry();
+    VROGeometry &geometry = *node->getGeometry();
+    return leaderGeometry.isBatchableWith(geometry, key.elementIndex) &&
+           getMaterialForKey(leaderGeometry, leader)->isBatchableWith(*getMaterialForKey(geometry, key));
+}
+
 void VROPortal::writeHierarchyParentToDepthBuffer(VROSortKey &hierarchyParent,
                                                   const VRORenderContext &context,
                                                   std::shared_ptr<VRODriver> &driver) {
@@ -283,6 +420,9 @@ void VROPortal::deactivateCulling(std::shared_ptr<VRONode> node) {
 #pragma mark - Lighting Environment
 
 void VROPortal::setLightingEnvironment(std::shared_ptr<VROTexture> texture) {
+    if (texture) {
+        texture->retainSourceData();
+    }
     _lightingEnvironment = texture;
 }
 
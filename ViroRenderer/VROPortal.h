@@ -31,6 +31,8 @@
 #include "VROTree.h"
 #include "VROLineSegment.h"
 #include "VROPortalDelegate.h"
+#include "VROSortKeySorter.h"
+#include <unordered_map>
 
 class VROPortalFrame;
 
@@ -78,6 +80,14 @@ public:
      */
     void renderContents(const VRORenderContext &context, std::shared_ptr<VRODriver> &driver);
     
+    /*
+     Get the number of draws issued by the last call to renderContents(). An
+     instanced batch counts as a single draw.
+     */
+    int getNumDraws() const {
+        return _numDraws;
+    }
+    
     /*
      Iterate up and down the scene graph, starting at the active portal.
      Fill in the recursion level of each portal (defined as steps to
@@ -98,9 +108,10 @@ public:
     
     /*
      Sort the visible nodes in this portal's sub-graph by their sort-keys, and fill
-     the internal _keys vector with the results.
+     the internal _keys vector with the results. The keys are allocated from the
+     given frame arena, if provided, and are valid only until it is next reset.
      */
-    void sortNodesBySortKeys();
+    void sortNodesBySortKeys(VROFrameArena *arena);
     
     /*
      Represents how how many levels deep this portal is: for example, the active portal
@@ -172,7 +183,9 @@ public:
 #pragma mark - Environment Lighting
     
     /*
-     Set the lighting environment map for this portal.
+     Set the lighting environment map for this portal. The texture retains its
+     source data (if it has not yet been hydrated) so that its IBL maps can be
+     baked on the CPU.
      */
     void setLightingEnvironment(std::shared_ptr<VROTexture> texture);
     
@@ -229,9 +242,14 @@ private:
     
     /*
      The nodes in this portal's scene-graph, ordered for rendering by their
-     sort keys.
+     sort keys. Re-seated on the frame arena each frame.
+     */
+    VROSortKeyList _keys;
+    
+    /*
+     Sorts _keys each frame, reusing the previous frame's order when possible.
      */
-    std::vector<VROSortKey> _keys;
+    VROSortKeySorter _sorter;
     
     /*
      True if this portal can be entered; e.g, if it can be made into an
@@ -306,6 +324,55 @@ private:
      */
     void deactivateCulling(std::shared_ptr<VRONode> node);
 
+    /*
+     Number of draws issued by the last call to renderContents().
+     */
+    int _numDraws;
+    
+    /*
+     Per-instance transforms and normal matrices of the instanced batch being
+     rendered. Reused across frames to avoid reallocation.
+     */
+    std::vector<VROMatrix4f> _instanceTransforms;
+    std::vector<VROMatrix4f> _instanceNormalMatrices;
+    
+    /*
+     The instanced batches found in _keys by gatherInstanceBatches(). For each key,
+     _batchSizes holds the number of keys in the batch it leads (1 if it is rendered
+     alone, 0 if it is rendered in the batch of an earlier key), and _batchNext
+     holds the index of the next key in its batch, or -1.
+     */
+    std::vector<int> _batchSizes;
+    std::vector<int> _batchNext;
+    
+    /*
+     Map from batch signature to the index of the key leading the batch with that
+     signature, used while gathering batches. Reused across frames to avoid
+     reallocation.
+     */
+    std::unordered_map<uint64_t, int> _batchLeaders;
+    
+    /*
+     Group the keys in _keys into instanced batches. Keys draw the same batch if
+     their nodes draw the same geometry data (shared vertex buffers and equal
+     index data) with equivalent materials, lights, and opacity, regardless of
+     whether they share a VROGeometry or VROMaterial. Only opaque, depth-tested
+     keys are batched, as only they may be drawn out of sort order.
+     */
+    void gatherInstanceBatches();
+    
+    /*
+     Returns true if the given key may be rendered in the instanced batch led by
+     the given leader key.
+     */
+    bool isBatchableWith(const VROSortKey &leader, const VROSortKey &key);
+    
+    /*
+     Get the material to render for the given key of the given geometry: the
+     incoming or outgoing material of the key's element.
+     */
+    static std::shared_ptr<VROMaterial> getMaterialForKey(VROGeometry &geometry, const VROSortKey &key);
+    
     /*
      Write the hierarchy parent represented by the given sort key to the depth buffer
      (only).
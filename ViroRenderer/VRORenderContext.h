@@ -40,6 +40,8 @@
 class VROFrameSynchronizer;
 class VROTexture;
 class VROPencil;
+class VROJobSystem;
+class VROFrameArena;
 class VROInputControllerBase;
 enum class VROEyeType;
 
@@ -175,6 +177,20 @@ public:
         return _pencil;
     }
 
+    void setJobSystem(std::shared_ptr<VROJobSystem> jobSystem) {
+        _jobSystem = jobSystem;
+    }
+    std::shared_ptr<VROJobSystem> getJobSystem() const {
+        return _jobSystem;
+    }
+
+    void setFrameArena(std::shared_ptr<VROFrameArena> frameArena) {
+        _frameArena = frameArena;
+    }
+    std::shared_ptr<VROFrameArena> getFrameArena() const {
+        return _frameArena;
+    }
+
     void setInputController(std::shared_ptr<VROInputControllerBase> inputController) {
         _inputController = inputController;
     }
@@ -267,6 +283,18 @@ private:
      after having rendered the scene, mainly for representing debug information.
      */
     std::shared_ptr<VROPencil> _pencil;
+    
+    /*
+     Worker pool used to parallelize frame preparation. May be null, in which
+     case all work runs on the rendering thread.
+     */
+    std::shared_ptr<VROJobSystem> _jobSystem;
+    
+    /*
+     Arena for transient allocations made while preparing the frame. Reset at
+     the start of each frame by the renderer.
+     */
+    std::shared_ptr<VROFrameArena> _frameArena;
 
     /*
      The input controller being used.
@@ -39,7 +39,17 @@ public:
     
     VRORenderMetadata() :
             _requiresBloomPass(false),
-            _postProcessMaskPass(false) {}
+            _postProcessMaskPass(false),
+            _umbrellaBoundsUpdated(0) {}
+    
+    /*
+     Clear the metadata so it can be reused for the next frame.
+     */
+    void reset() {
+        _requiresBloomPass = false;
+        _postProcessMaskPass = false;
+        _umbrellaBoundsUpdated = 0;
+    }
 
     void setRequiresBloomPass(bool requiresBloomPass) {
         _requiresBloomPass = requiresBloomPass;
@@ -55,6 +65,13 @@ public:
         return _postProcessMaskPass;
     }
     
+    void addUmbrellaBoundsUpdated(int count) {
+        _umbrellaBoundsUpdated += count;
+    }
+    int getUmbrellaBoundsUpdated() const {
+        return _umbrellaBoundsUpdated;
+    }
+    
 private:
     
     /*
@@ -69,5 +86,11 @@ private:
      */
     bool _postProcessMaskPass;
     
+    /*
+     The number of umbrella bounding boxes that were recomputed during the
+     computeTransforms() phase of this frame, across all scenes.
+     */
+    int _umbrellaBoundsUpdated;
+    
 };
 #endif /* VRORenderMetadata_h */
@@ -28,32 +28,37 @@
 #define VRORenderParameters_h
 
 #include <vector>
-#include <stack>
 #include "VROMatrix4f.h"
 
-class VROLight;
+class VROLightGrid;
 
 /*
  Contains the per-frame render parameters for the current
  render pass.
+ 
+ The opacity, hierarchy depth, and distance from camera fields hold the values
+ inherited from the parent of the node currently being processed. Nodes set
+ them for their children and restore them afterward, so no per-node storage
+ is allocated as the graph is traversed.
  */
 class VRORenderParameters {
     
 public:
     
-    std::stack<float> opacities;
-    std::vector<std::shared_ptr<VROLight>> lights;
-    std::stack<int> hierarchyDepths;
-    std::stack<float> distancesFromCamera;
+    float opacity;
+    VROLightGrid *lightGrid;
+    int hierarchyDepth;
+    float distanceFromCamera;
     int hierarchyId;
     float furthestDistanceFromCamera;
     
     VRORenderParameters() {
-        opacities.push(1.0);
-        hierarchyDepths.push(-1);
+        opacity = 1.0;
+        hierarchyDepth = -1;
+        lightGrid = nullptr;
         hierarchyId = 0;
         furthestDistanceFromCamera = 0;
-        distancesFromCamera.push(0);
+        distanceFromCamera = 0;
     }
     
 };
@@ -49,12 +49,20 @@
 #include "VRORenderMetadata.h"
 #include "VROToneMappingRenderPass.h"
 #include "VRODebugHUD.h"
+#include "VROJobSystem.h"
+#include "VROFrameArena.h"
 #include "VROOpenGL.h" // For pglpush and pop
 
 // Target frames-per-second. Eventually this will be platform dependent,
 // but for now all of our platforms target 60.
 static const double kFPSTarget = 60;
 
+// Set to true to verify the frame arena after warmup: a frame that allocates no
+// more than the largest frame before it must not touch the heap. Frames that
+// legitimately grow the arena (e.g. because the scene grew) are logged.
+static const bool kDebugFrameAllocations = false;
+static const int kFrameAllocationsWarmupFrames = 10;
+
 #pragma mark - Initialization
 
 VRORenderer::VRORenderer(VRORendererConfiguration config, std::shared_ptr<VROInputControllerBase> inputController) :
@@ -72,8 +80,15 @@ VRORenderer::VRORenderer(VRORendererConfiguration config, std::shared_ptr<VROInp
     _debugHUD = std::unique_ptr<VRODebugHUD>(new VRODebugHUD());
 #endif
 
+    _jobSystem = std::make_shared<VROJobSystem>();
     _context = std::make_shared<VRORenderContext>(_frameSynchronizer);
     _context->setPencil(std::make_shared<VROPencil>());
+    _context->setJobSystem(_jobSystem);
+    
+    _frameArena = std::make_shared<VROFrameArena>();
+    _frameArenaPeakBytes = 0;
+    _context->setFrameArena(_frameArena);
+    _renderMetadata = std::make_shared<VRORenderMetadata>();
     memset(_fpsTickArray, 0x0, sizeof(_fpsTickArray));
 }
 
@@ -85,6 +100,7 @@ void VRORenderer::initRenderer(std::shared_ptr<VRODriver> driver) {
     initBlankTexture(*_context);
     initPointCloudTexture();
     driver->readGPUType();
+    driver->readTextureFormats();
     driver->readDisplayFramebuffer();
 
     _choreographer = std::make_shared<VROChoreographer>(_initialRendererConfig, driver);
@@ -414,6 +430,28 @@ void VRORenderer::prepareFrame(int frame, VROViewport viewport, VROFieldOfView f
     _context->getPencil()->clear();
     notifyFrameStart();
     
+    /*
+     Transient allocations from the last frame are released, and the metadata
+     is cleared for reuse. Nothing from the prior frame's preparation may be
+     referenced past this point.
+     */
+    if (kDebugFrameAllocations) {
+        size_t bytes = _frameArena->getBytesAllocated();
+        int heapAllocations = _frameArena->getNumHeapAllocations();
+        if (frame > kFrameAllocationsWarmupFrames) {
+            passert_msg(bytes > _frameArenaPeakBytes || heapAllocations == 0,
+                        "Frame %d allocated %d times from the heap in steady state (%zu bytes, peak %zu)",
+                        frame - 1, heapAllocations, bytes, _frameArenaPeakBytes);
+            if (heapAllocations > 0) {
+                pwarn("Frame arena grew during frame %d (%d heap allocations, %zu bytes used)",
+                      frame - 1, heapAllocations, bytes);
+            }
+        }
+        _frameArenaPeakBytes = std::max(_frameArenaPeakBytes, bytes);
+    }
+    _frameArena->reset();
+    _renderMetadata->reset();
+    
     /*
      Before updating the camera we have to compute all world transforms (because
      the camera is a part of the scene graph, we need the up-to-date position of
@@ -422,11 +460,11 @@ void VRORenderer::prepareFrame(int frame, VROViewport viewport, VROFieldOfView f
     if (_sceneController) {
         if (_outgoingSceneController) {
             std::shared_ptr<VROScene> outgoingScene = _outgoingSceneController->getScene();
-            outgoingScene->computeTransforms();
+            outgoingScene->computeTransforms(*_context.get(), _renderMetadata);
             
         }
         std::shared_ptr<VROScene> scene = _sceneController->getScene();
-        scene->computeTransforms();
+        scene->computeTransforms(*_context.get(), _renderMetadata);
     }
 
     VROCamera camera = updateCamera(viewport, fov, headRotation, projection);
@@ -448,30 +486,15 @@ void VRORenderer::prepareFrame(int frame, VROViewport viewport, VROFieldOfView f
      */
     _context->setOrthographicMatrix(viewport.getOrthographicProjection(0, kZFar));
     _context->setShadowMap(nullptr);
-    
-    _renderMetadata = std::make_shared<VRORenderMetadata>();
 
     const VRORenderContext &context = *_context.get();
     if (_sceneController) {
         if (_outgoingSceneController) {
-            std::shared_ptr<VROScene> outgoingScene = _outgoingSceneController->getScene();
-            outgoingScene->computeIKRig(context);
-            outgoingScene->computePhysics(context);
-            outgoingScene->applyConstraints(context);
-            outgoingScene->updateParticles(context);
-            outgoingScene->updateVisibility(context);
-            outgoingScene->updateSortKeys(_renderMetadata, context, driver);
-            outgoingScene->syncAtomicRenderProperties();
+            prepareScene(_outgoingSceneController->getScene(), context, driver);
         }
 
         std::shared_ptr<VROScene> scene = _sceneController->getScene();
-        scene->computeIKRig(context);
-        scene->computePhysics(context);
-        scene->applyConstraints(context);
-        scene->updateParticles(context);
-        scene->updateVisibility(context);
-        scene->updateSortKeys(_renderMetadata, context, driver);
-        scene->syncAtomicRenderProperties();
+        prepareScene(scene, context, driver);
         updateSceneEffects(driver, scene);
 
         _inputController->onProcess(camera);
@@ -481,11 +504,36 @@ void VRORenderer::prepareFrame(int frame, VROViewport viewport, VROFieldOfView f
 
     driver->willRenderFrame(context);
 #if VRO_PLATFORM_IOS || VRO_PLATFORM_ANDROID
-    _debugHUD->prepare(context);
+    _debugHUD->prepare(context, _renderMetadata);
 #endif
     pglpop();
 }
 
+void VRORenderer::prepareScene(std::shared_ptr<VROScene> scene, const VRORenderContext &context,
+                               std::shared_ptr<VRODriver> driver) {
+    scene->computeIKRig(context);
+    scene->computePhysics(context);
+    scene->applyConstraints(context);
+    
+    /*
+     Particle emitters only read world transforms and write their own node's
+     geometry, while visibility only reads umbrella bounds and writes visibility
+     state, so the two run concurrently. Sort keys depend on both, and access the
+     driver, so they remain on the rendering thread.
+     */
+    VROJobGraph graph(context.getFrameArena().get());
+    graph.addJob([&scene, &context] {
+        scene->updateParticles(context);
+    });
+    graph.addJob([&scene, &context] {
+        scene->updateVisibility(context);
+    });
+    graph.execute(_jobSystem);
+    
+    scene->updateSortKeys(_renderMetadata, context, driver);
+    scene->syncAtomicRenderProperties();
+}
+
 void VRORenderer::renderEye(VROEyeType eye, VROMatrix4f eyeView, VROMatrix4f eyeProjection,
                             VROViewport viewport, std::shared_ptr<VRODriver> driver) {
     pglpush("Viro Render Eye [%s]", VROEye::toString(eye).c_str());
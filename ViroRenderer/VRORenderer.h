@@ -53,6 +53,8 @@ class VRORenderDelegateInternal;
 class VROFrameScheduler;
 class VROChoreographer;
 class VRORenderMetadata;
+class VROJobSystem;
+class VROFrameArena;
 enum class VROCameraRotationType;
 enum class VROEyeType;
 enum class VROTimingFunctionType;
@@ -417,6 +419,33 @@ private:
     std::shared_ptr<VROSceneController> _sceneController;
     std::shared_ptr<VROSceneController> _outgoingSceneController;
     bool _hasIncomingSceneTransition;
+    
+    /*
+     Run the frame preparation stages that follow transform computation for
+     the given scene. Stages that touch disjoint state run concurrently on the
+     job system.
+     */
+    void prepareScene(std::shared_ptr<VROScene> scene, const VRORenderContext &context,
+                      std::shared_ptr<VRODriver> driver);
+    
+#pragma mark - [Private] Frame Preparation Workers
+    
+    /*
+     Worker pool used to parallelize frame preparation.
+     */
+    std::shared_ptr<VROJobSystem> _jobSystem;
+    
+    /*
+     Arena for transient per-frame allocations, reset at the start of each
+     frame.
+     */
+    std::shared_ptr<VROFrameArena> _frameArena;
+    
+    /*
+     The most bytes any frame has allocated from the arena, used to verify that
+     the arena does not grow in steady state (see kDebugFrameAllocations).
+     */
+    size_t _frameArenaPeakBytes;
 
 #pragma mark - [Private] Frame Listeners
     
@@ -58,6 +58,14 @@
 #include "VROObjectRecognitionTest.h"
 #include "VROBodyRecognitionTest.h"
 #include "VROBodyMesherTest.h"
+#include "VROSortKeyTest.h"
+#include "VROFrustumCullingTest.h"
+#include "VROKeyframeTest.h"
+#include "VROInstancingTest.h"
+#include "VROSkeletonPoseTest.h"
+#include "VROCrowdTest.h"
+#include "VROGeometryPackTest.h"
+#include "VROTextureTranscoderTest.h"
 
 VRORendererTestHarness::VRORendererTestHarness(std::shared_ptr<VRORenderer> renderer,
                                                std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
@@ -160,6 +168,22 @@ std::shared_ptr<VRORendererTest> VRORendererTestHarness::createTest(VRORendererT
             return std::make_shared<VROBodyRecognitionTest>();
         case VRORendererTestType::BodyMesher:
             return std::make_shared<VROBodyMesherTest>();
+        case VRORendererTestType::SortKey:
+            return std::make_shared<VROSortKeyTest>();
+        case VRORendererTestType::FrustumCulling:
+            return std::make_shared<VROFrustumCullingTest>();
+        case VRORendererTestType::KeyframeLookup:
+            return std::make_shared<VROKeyframeTest>();
+        case VRORendererTestType::Instancing:
+            return std::make_shared<VROInstancingTest>();
+        case VRORendererTestType::SkeletonPose:
+            return std::make_shared<VROSkeletonPoseTest>();
+        case VRORendererTestType::Crowd:
+            return std::make_shared<VROCrowdTest>();
+        case VRORendererTestType::GeometryPack:
+            return std::make_shared<VROGeometryPackTest>();
+        case VRORendererTestType::TextureTranscoder:
+            return std::make_shared<VROTextureTranscoderTest>();
         default:
             pabort();
             return nullptr;
@@ -67,6 +67,14 @@ enum class VRORendererTestType {
     ObjectRecognition,
     BodyRecognition,
     BodyMesher,
+    SortKey,
+    FrustumCulling,
+    KeyframeLookup,
+    Instancing,
+    SkeletonPose,
+    Crowd,
+    GeometryPack,
+    TextureTranscoder,
     NumTests,
 };
 
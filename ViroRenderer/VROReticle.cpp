@@ -54,6 +54,7 @@ VROReticle::VROReticle(std::shared_ptr<VROTexture> reticleTexture) :
     _fuseNode = std::make_shared<VRONode>();
     _fuseBackgroundNode = std::make_shared<VRONode>();
     _fuseTriggeredNode = std::make_shared<VRONode>();
+    _renderMetadata = std::make_shared<VRORenderMetadata>();
 
     // Polyline Reticle
     if (!reticleTexture) {
@@ -215,10 +216,10 @@ void VROReticle::renderNode(std::shared_ptr<VRONode> node, const VRORenderContex
 
     VRORenderParameters renderParams;
     VROMatrix4f identity;
-    std::shared_ptr<VRORenderMetadata> metadata = std::make_shared<VRORenderMetadata>();
+    _renderMetadata->reset();
     node->computeTransforms(identity, {});
     node->applyConstraints(context, identity, false);
-    node->updateSortKeys(0, renderParams, metadata, context, driver);
+    node->updateSortKeys(0, renderParams, _renderMetadata, context, driver);
     node->syncAppThreadProperties();
     
     const std::shared_ptr<VROGeometry> &geometry = node->getGeometry();
@@ -38,6 +38,7 @@ class VROPolyline;
 class VROVector3f;
 class VRORenderContext;
 class VRODriver;
+class VRORenderMetadata;
 enum class VROEyeType;
 
 class VROReticle {
@@ -124,5 +125,11 @@ private:
      */
     bool _fuseTriggered;
     void animateFuseTriggered();
+    
+    /*
+     Metadata passed to updateSortKeys() when rendering the reticle's nodes,
+     reused each frame.
+     */
+    std::shared_ptr<VRORenderMetadata> _renderMetadata;
 };
 #endif
@@ -35,6 +35,8 @@
 #include "VROAudioPlayer.h"
 #include "VROPencil.h"
 #include "VROToneMappingRenderPass.h"
+#include "VRORenderMetadata.h"
+#include "VROJobSystem.h"
 #include <stack>
 #include <algorithm>
 
@@ -60,12 +62,21 @@ VROScene::~VROScene() {
 
 #pragma mark - Render Cycle
 
-void VROScene::computeTransforms() {
-    _rootNode->computeTransforms({}, {});
+void VROScene::computeTransforms(const VRORenderContext &context, std::shared_ptr<VRORenderMetadata> &metadata) {
+    passert_thread(__func__);
+    _transformHierarchy.update(_rootNode, context.getJobSystem());
+    metadata->addUmbrellaBoundsUpdated(_transformHierarchy.getNumBoundsUpdated());
 }
 
 void VROScene::updateVisibility(const VRORenderContext &context) {
-    _rootNode->updateVisibility(context);
+    // The hierarchy is out of date only if the graph changed after computeTransforms;
+    // in that case fall back to the recursive cull
+    if (_transformHierarchy.isCurrent()) {
+        _frustumCuller.cull(_transformHierarchy, context);
+    }
+    else {
+        _rootNode->updateVisibility(context);
+    }
 }
 
 void VROScene::applyConstraints(const VRORenderContext &context) {
@@ -81,7 +92,24 @@ void VROScene::syncAtomicRenderProperties() {
 }
 
 void VROScene::updateParticles(const VRORenderContext &context) {
-    _rootNode->updateParticles(context);
+    std::shared_ptr<VROJobSystem> jobSystem = context.getJobSystem();
+    if (!jobSystem || !_transformHierarchy.isCurrent()) {
+        _rootNode->updateParticles(context);
+        return;
+    }
+    
+    // Use the flattened hierarchy to find the emitters without walking the graph
+    _particleNodes.clear();
+    for (VRONode *node : _transformHierarchy.getNodes()) {
+        if (node->hasParticleEmitter()) {
+            _particleNodes.push_back(node);
+        }
+    }
+    jobSystem->parallelFor((int) _particleNodes.size(), 1, [this, &context] (int start, int end) {
+        for (int i = start; i < end; i++) {
+            _particleNodes[i]->updateParticleEmitter(context);
+        }
+    });
 }
 
 void VROScene::updateSortKeys(std::shared_ptr<VRORenderMetadata> &metadata,
@@ -96,13 +124,16 @@ void VROScene::updateSortKeys(std::shared_ptr<VRORenderMetadata> &metadata,
     _lights.clear();
     _rootNode->collectLights(&_lights);
 
+    _lightGrid.build(_lights, context.getCamera());
+
     VRORenderParameters renderParams;
-    renderParams.lights = _lights;
+    renderParams.lightGrid = &_lightGrid;
     _rootNode->updateSortKeys(0, renderParams, metadata, context, driver);
     
     createPortalTree(context);
-    _portals.walkTree([] (std::shared_ptr<VROPortal> portal) {
-        portal->sortNodesBySortKeys();
+    VROFrameArena *arena = context.getFrameArena().get();
+    _portals.walkTree([arena] (std::shared_ptr<VROPortal> portal) {
+        portal->sortNodesBySortKeys(arena);
     });
     
     _distanceOfFurthestObjectFromCamera = renderParams.furthestDistanceFromCamera;
@@ -37,6 +37,9 @@
 #include "VROThreadRestricted.h"
 #include "VROPhysicsWorld.h"
 #include "VROTree.h"
+#include "VROTransformHierarchy.h"
+#include "VROFrustumCuller.h"
+#include "VROLightGrid.h"
 
 class VRONode;
 class VROPortal;
@@ -62,17 +65,24 @@ public:
 #pragma mark - Core Render Cycle
     
     /*
-     Compute the transforms, recursively, for all nodes in this scene.
+     Compute the transforms for all nodes in this scene. Only nodes whose
+     transforms changed (or whose ancestors' transforms changed) since the
+     last frame are recomputed. Umbrella bounds are likewise only recomputed
+     along the ancestor chains of nodes whose bounds changed. Independent
+     subtrees are processed in parallel on the context's job system.
      */
-    void computeTransforms();
+    void computeTransforms(const VRORenderContext &context, std::shared_ptr<VRORenderMetadata> &metadata);
 
     /*
-     Update the visibility status of all nodes in the scene graph.
+     Update the visibility status of all nodes in the scene graph. Culling
+     runs over the flattened transform hierarchy, so this must follow
+     computeTransforms().
      */
     void updateVisibility(const VRORenderContext &context);
     
     /*
-     Update the particle emitters in the scene graph.
+     Update the particle emitters in the scene graph. Emitters are updated in
+     parallel. This may run concurrently with updateVisibility().
      */
     virtual void updateParticles(const VRORenderContext &context);
     
@@ -123,6 +133,17 @@ public:
         return _lights;
     }
     
+    /*
+     The flattened transform hierarchy of the scene, and the culler that computes
+     visibility over it.
+     */
+    const VROTransformHierarchy &getTransformHierarchy() const {
+        return _transformHierarchy;
+    }
+    const VROFrustumCuller &getFrustumCuller() const {
+        return _frustumCuller;
+    }
+    
 #pragma mark - Physics
     
     bool hasPhysicsWorld() const {
@@ -257,6 +278,27 @@ private:
      */
     tree<std::shared_ptr<VROPortal>> _portals;
     
+    /*
+     Flattened transform hierarchy of the scene graph, used to incrementally
+     compute node transforms each frame.
+     */
+    VROTransformHierarchy _transformHierarchy;
+    
+    /*
+     Culls the nodes of the transform hierarchy against the camera frustum.
+     */
+    VROFrustumCuller _frustumCuller;
+    
+    /*
+     Assigns the scene's lights to the nodes they influence.
+     */
+    VROLightGrid _lightGrid;
+    
+    /*
+     The nodes with particle emitters, gathered each frame for parallel update.
+     */
+    std::vector<VRONode *> _particleNodes;
+    
     /*
      All the lights in the scene, as collected during the last render cycle.
      */
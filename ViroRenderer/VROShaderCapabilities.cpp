@@ -173,6 +173,7 @@ VROLightingShaderCapabilities VROShaderCapabilities::deriveLightingCapabilitiesK
     cap.pbr = context.isPBREnabled();
     cap.diffuseIrradiance = false;
     cap.specularIrradiance = false;
+    cap.instanced = false;
     
     if (context.getShadowMap() != nullptr) {
         for (const std::shared_ptr<VROLight> &light : lights) {
@@ -97,23 +97,33 @@ struct VROLightingShaderCapabilities {
     bool diffuseIrradiance;
     bool specularIrradiance;
     
+    /*
+     True if the shader reads model and normal matrices per instance, for
+     rendering batches of the same geometry and material in one draw call.
+     This is not derived from the lights; it is set by the renderer when it
+     draws an instanced batch.
+     */
+    bool instanced;
+    
     bool operator< (const VROLightingShaderCapabilities &r) const {
-        return std::tie(  shadows,   hdr,   pbr,   diffuseIrradiance,   specularIrradiance)
-             < std::tie(r.shadows, r.hdr, r.pbr, r.diffuseIrradiance, r.specularIrradiance);
+        return std::tie(  shadows,   hdr,   pbr,   diffuseIrradiance,   specularIrradiance,   instanced)
+             < std::tie(r.shadows, r.hdr, r.pbr, r.diffuseIrradiance, r.specularIrradiance, r.instanced);
     }
     bool operator== (const VROLightingShaderCapabilities& r) const {
         return shadows == r.shadows &&
                hdr == r.hdr &&
                pbr == r.pbr &&
                diffuseIrradiance == r.diffuseIrradiance &&
-               specularIrradiance == r.specularIrradiance;
+               specularIrradiance == r.specularIrradiance &&
+               instanced == r.instanced;
     }
     bool operator!= (const VROLightingShaderCapabilities& r) const {
         return shadows != r.shadows ||
                hdr != r.hdr ||
                pbr != r.pbr ||
                diffuseIrradiance != r.diffuseIrradiance ||
-               specularIrradiance != r.specularIrradiance;
+               specularIrradiance != r.specularIrradiance ||
+               instanced != r.instanced;
     }
 };
 
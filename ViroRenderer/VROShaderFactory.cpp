@@ -38,6 +38,7 @@
 #include "VROShadowMapRenderPass.h"
 #include "VROShaderCapabilities.h"
 #include "VRODriverOpenGL.h"
+#include "VROInstanceBatchUBO.h"
 #include <tuple>
 
 static thread_local std::shared_ptr<VROShaderModifier> sDiffuseTextureModifier;
@@ -60,6 +61,7 @@ static thread_local std::shared_ptr<VROShaderModifier> sRGTextureModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sYCbCrTextureModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sShadowMapGeometryModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sShadowMapLightModifier;
+static thread_local std::shared_ptr<VROShaderModifier> sInstancedTransformModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sBloomModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sPostProcesMaskModifier;
 static thread_local std::shared_ptr<VROShaderModifier> sToneMappingMaskModifier;
@@ -156,6 +158,12 @@ std::shared_ptr<VROShaderProgram> VROShaderFactory::buildShader(VROShaderCapabil
     std::vector<std::string> samplers;
     std::vector<std::shared_ptr<VROShaderModifier>> modifiers;
     
+    // Instancing replaces the model and normal matrices, so it must precede every
+    // other geometry modifier
+    if (lightingCapabilities.instanced) {
+        modifiers.push_back(createInstancedTransformModifier());
+    }
+    
     // Stereo mode must be placed prior to diffuse texture (because it modifies
     // the texture coordinates used when sampling the diffuse texture)
     if (materialCapabilities.diffuseTextureStereoMode != VROStereoMode::None) {
@@ -291,6 +299,14 @@ std::shared_ptr<VROShaderProgram> VROShaderFactory::buildShader(VROShaderCapabil
     for (std::shared_ptr<VROShaderModifier> &modifier : modifiers) {
         attributes |= modifier->getAttributes();
     }
+    
+    // Samplers declared by modifiers follow the material's samplers; the textures
+    // are resolved against the modifiers by VROMaterialShaderBinding
+    for (std::shared_ptr<VROShaderModifier> &modifier : modifiers) {
+        for (auto &sampler : modifier->getSamplers()) {
+            samplers.push_back(sampler.first);
+        }
+    }
 
     // The tone mapping mask generator must be the absolute *last* shader modifier
     // applied; otherwise it will be based on outdated alpha data (causing, for example
@@ -415,6 +431,29 @@ std::shared_ptr<VROShaderModifier> VROShaderFactory::createReflectiveTextureModi
     return sReflectiveTextureModifier;
 }
 
+#pragma mark - Instancing Modifiers
+
+std::shared_ptr<VROShaderModifier> VROShaderFactory::createInstancedTransformModifier() {
+    /*
+     Modifier that reads the model and normal matrices of each instance from the
+     instances uniform block. Each instance occupies two consecutive matrices;
+     the layout must match VROInstanceBatchUBOVertexData.
+     */
+    if (!sInstancedTransformModifier) {
+        std::vector<std::string> modifierCode = {
+            "layout (std140) uniform instances_vertex_data { mat4 instances_vertex_transforms[" +
+                VROStringUtil::toString(kMaxInstancesPerUBO * 2) + "]; };",
+            "_transforms.model_matrix = instances_vertex_transforms[v_instance_id * 2];",
+            "_transforms.normal_matrix = instances_vertex_transforms[v_instance_id * 2 + 1];",
+        };
+        
+        sInstancedTransformModifier = std::make_shared<VROShaderModifier>(VROShaderEntryPoint::Geometry,
+                                                                          modifierCode);
+        sInstancedTransformModifier->setName("instanced");
+    }
+    return sInstancedTransformModifier;
+}
+
 #pragma mark - Shadow Modifiers
 
 std::shared_ptr<VROShaderModifier> VROShaderFactory::createShadowMapGeometryModifier() {
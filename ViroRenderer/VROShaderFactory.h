@@ -101,6 +101,8 @@ private:
     std::shared_ptr<VROShaderModifier> createShadowMapGeometryModifier();
     std::shared_ptr<VROShaderModifier> createShadowMapLightModifier();
     std::shared_ptr<VROShaderModifier> createShadowMapFragmentModifier();
+    
+    std::shared_ptr<VROShaderModifier> createInstancedTransformModifier();
 
     std::shared_ptr<VROShaderModifier> createPBRSurfaceModifier();
     std::shared_ptr<VROShaderModifier> createPBRDirectLightingModifier();
@@ -40,6 +40,7 @@ class VROUniform;
 class VROGeometry;
 class VROMaterial;
 class VROUniformBinder;
+class VROTexture;
 enum class VROShaderProperty;
 
 /*
@@ -252,6 +253,20 @@ public:
     void setUniformBinder(std::string uniform, VROShaderProperty type, VROUniformBindingBlock bindingBlock);
     VROUniformBinder *getUniformBinder(std::string uniform) { return _uniformBinders[uniform]; }
     
+    /*
+     Attach a texture to the sampler of the given name, which must be declared
+     as a uniform in the modifier's source. Modifier textures are bound after
+     the material's own textures each time a shader containing this modifier
+     is bound. The texture may not be null.
+     */
+    void addSampler(std::string sampler, std::shared_ptr<VROTexture> texture) {
+        passert_msg (texture != nullptr, "Null texture attached to modifier sampler %s", sampler.c_str());
+        _samplers.push_back({ sampler, texture });
+    }
+    const std::vector<std::pair<std::string, std::shared_ptr<VROTexture>>> &getSamplers() const {
+        return _samplers;
+    }
+    
     /*
      Get the pragma directive that corresponds to this modifier's entry point and
      the given section within a shader. This is the point in the shader where the
@@ -325,6 +340,11 @@ private:
      */
     std::map<std::string, VROUniformBinder *> _uniformBinders;
     
+    /*
+     Samplers declared by this modifier and the textures bound to them.
+     */
+    std::vector<std::pair<std::string, std::shared_ptr<VROTexture>>> _samplers;
+    
     /*
      Return true if the given line is a variable declaration, and false
      if not. Variable declarations are lines that declare a uniform, in,
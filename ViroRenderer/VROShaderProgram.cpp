@@ -68,6 +68,8 @@ VROShaderProgram::VROShaderProgram(std::string vertexShader, std::string fragmen
     _bonesBlockIndex(GL_INVALID_INDEX),
     _particlesVertexBlockIndex(GL_INVALID_INDEX),
     _particlesFragmentBlockIndex(GL_INVALID_INDEX),
+    _instancesVertexBlockIndex(GL_INVALID_INDEX),
+    _crowdVertexBlockIndex(GL_INVALID_INDEX),
     _attributes(attributes),
     _uniformsNeedRebind(true),
     _shaderName(fragmentShader),
@@ -507,6 +509,16 @@ void VROShaderProgram::bindUniformBlocks() {
     if (_particlesFragmentBlockIndex != GL_INVALID_INDEX) {
         GL( glUniformBlockBinding(_program, _particlesFragmentBlockIndex, sParticleFragmentUBOBindingPoint) );
     }
+    
+    _instancesVertexBlockIndex = GL( glGetUniformBlockIndex(_program, "instances_vertex_data") );
+    if (_instancesVertexBlockIndex != GL_INVALID_INDEX) {
+        GL( glUniformBlockBinding(_program, _instancesVertexBlockIndex, sInstanceVertexUBOBindingPoint) );
+    }
+    
+    _crowdVertexBlockIndex = GL( glGetUniformBlockIndex(_program, "crowd_vertex_data") );
+    if (_crowdVertexBlockIndex != GL_INVALID_INDEX) {
+        GL( glUniformBlockBinding(_program, _crowdVertexBlockIndex, sCrowdVertexUBOBindingPoint) );
+    }
 }
 
 void VROShaderProgram::addStandardUniforms() {
@@ -81,6 +81,8 @@ public:
     static const int sBonesUBOBindingPoint = 2;
     static const int sParticleVertexUBOBindingPoint = 3;
     static const int sParticleFragmentUBOBindingPoint = 4;
+    static const int sInstanceVertexUBOBindingPoint = 5;
+    static const int sCrowdVertexUBOBindingPoint = 6;
 
     /*
      Create a new shader program with the given source. This constructor assumes that the
@@ -187,6 +189,20 @@ public:
     GLuint getParticlesFragmentBlockIndex() const {
         return _particlesFragmentBlockIndex;
     }
+    
+    bool hasInstancesVertexBlock() const {
+        return _instancesVertexBlockIndex != GL_INVALID_INDEX;
+    }
+    GLuint getInstancesVertexBlockIndex() const {
+        return _instancesVertexBlockIndex;
+    }
+    
+    bool hasCrowdVertexBlock() const {
+        return _crowdVertexBlockIndex != GL_INVALID_INDEX;
+    }
+    GLuint getCrowdVertexBlockIndex() const {
+        return _crowdVertexBlockIndex;
+    }
 
     const std::vector<std::shared_ptr<VROShaderModifier>> &getModifiers() const {
         return _modifiers;
@@ -232,6 +248,18 @@ private:
      */
     GLuint _particlesVertexBlockIndex;
     GLuint _particlesFragmentBlockIndex;
+    
+    /*
+     The uniform block holding per-instance transforms, used by shaders that render
+     batches of identical geometry with instancing.
+     */
+    GLuint _instancesVertexBlockIndex;
+    
+    /*
+     The uniform block holding per-instance transforms and animation times, used by
+     shaders that render crowds of skinned geometry (see VROCrowdUBO).
+     */
+    GLuint _crowdVertexBlockIndex;
 
     /*
      The attributes supported by this shader, as defined by the VROShaderMask enum.
@@ -84,7 +84,7 @@ void VROShadowPreprocess::execute(std::shared_ptr<VROScene> scene, VRORenderCont
         return;
     }
     
-    std::map<std::shared_ptr<VROLight>, std::shared_ptr<VROShadowMapRenderPass>> activeShadowPasses;
+    int frame = context->getFrame();
     int i = 0;
     for (const std::shared_ptr<VROLight> &light : lights) {
         if (!light->getCastsShadow()) {
@@ -92,18 +92,14 @@ void VROShadowPreprocess::execute(std::shared_ptr<VROScene> scene, VRORenderCont
         }
         passert (light->getType() != VROLightType::Ambient && light->getType() != VROLightType::Omni);
         
-        std::shared_ptr<VROShadowMapRenderPass> shadowPass;
-        
         // Get the shadow pass for this light if we already have one from the last frame;
         // otherwise, create a new one
         auto it = _shadowPasses.find(light);
         if (it == _shadowPasses.end()) {
-            shadowPass = std::make_shared<VROShadowMapRenderPass>(light, driver);
-        }
-        else {
-            shadowPass = it->second;
+            it = _shadowPasses.emplace(light, std::make_pair(std::make_shared<VROShadowMapRenderPass>(light, driver), frame)).first;
         }
-        activeShadowPasses[light] = shadowPass;
+        it->second.second = frame;
+        std::shared_ptr<VROShadowMapRenderPass> &shadowPass = it->second.first;
         
         pglpush("Shadow Pass");
         if (!kDebugShadowMaps) {
@@ -130,7 +126,13 @@ void VROShadowPreprocess::execute(std::shared_ptr<VROScene> scene, VRORenderCont
         context->setShadowMap(nullptr);
     }
     
-    // Shadow passes that weren't used this frame (e.g. are not in activeShadowPasses),
-    // are removed
-    _shadowPasses = activeShadowPasses;
+    // Shadow passes that weren't used this frame are removed
+    for (auto it = _shadowPasses.begin(); it != _shadowPasses.end();) {
+        if (it->second.second != frame) {
+            it = _shadowPasses.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
 }
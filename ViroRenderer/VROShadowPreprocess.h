@@ -62,9 +62,11 @@ private:
     std::shared_ptr<VRORenderTarget> _shadowTarget;
     
     /*
-     The shadow passes for creating the depth maps for each light.
+     The shadow passes for creating the depth maps for each light, each with the
+     last frame it was used. Passes are updated in place so that the map is not
+     rebuilt each frame.
      */
-    std::map<std::shared_ptr<VROLight>, std::shared_ptr<VROShadowMapRenderPass>> _shadowPasses;
+    std::map<std::shared_ptr<VROLight>, std::pair<std::shared_ptr<VROShadowMapRenderPass>, int>> _shadowPasses;
     
 };
 
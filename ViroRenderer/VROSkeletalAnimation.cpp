@@ -27,14 +27,38 @@
 #include "VROSkeletalAnimation.h"
 #include "VROTransaction.h"
 #include "VROLog.h"
-#include "VROAnimationMatrix4f.h"
 #include "VROSkeleton.h"
 #include "VROShaderModifier.h"
 #include "VROBone.h"
 #include "VROSkinner.h"
+#include "VROSkeletalClip.h"
+#include "VROAnimation.h"
+#include "VROThreadRestricted.h"
 #include <sstream>
 #include <map>
 
+/*
+ Animation that samples an entire skeletal clip each frame, so that a
+ running skeletal animation adds one animation to its transaction
+ instead of one per bone.
+ */
+class VROSkeletalPoseAnimation : public VROAnimation {
+public:
+    VROSkeletalPoseAnimation(std::function<void(float)> applyPose) :
+        _applyPose(applyPose) {}
+    virtual ~VROSkeletalPoseAnimation() {}
+    
+    void processAnimationFrame(float t) {
+        _applyPose(t);
+    }
+    void finish() {
+        _applyPose(1.0);
+    }
+    
+private:
+    std::function<void(float)> _applyPose;
+};
+
 std::shared_ptr<VROExecutableAnimation> VROSkeletalAnimation::copy() {
     std::vector<std::unique_ptr<VROSkeletalAnimationFrame>> frames;
     for (std::unique_ptr<VROSkeletalAnimationFrame> &origFrame : _frames) {
@@ -48,32 +72,34 @@ std::shared_ptr<VROExecutableAnimation> VROSkeletalAnimation::copy() {
     }
 
     std::shared_ptr<VROSkeletalAnimation> animation = std::make_shared<VROSkeletalAnimation>(_skinner, frames, _duration);
+    animation->_clip = _clip;
     animation->setName(_name);
     animation->setTimeOffset(_timeOffset);
     animation->setSpeed(_speed);
     return animation;
 }
 
+std::shared_ptr<VROSkeletalClip> VROSkeletalAnimation::getClip() {
+    if (!_clip) {
+        _clip = VROSkeletalClip::build(_frames);
+    }
+    return _clip;
+}
+
+void VROSkeletalAnimation::applyPose(float t) {
+    _clip->sample(t, _pose.data(), _cursors.data());
+    _skinner->getSkeleton()->setBoneTransforms(_clip->getTrackBones(), _pose.data());
+}
+
 void VROSkeletalAnimation::execute(std::shared_ptr<VRONode> node, std::function<void()> onFinished) {
     std::weak_ptr<VROSkeletalAnimation> shared_w = shared_from_this();
     
     /*
-     Build the key frame animation data.
+     Build the clip, and the pose buffer it is sampled into.
      */
-    std::map<int, std::vector<float>> boneKeyTimes;
-    std::map<int, std::vector<VROMatrix4f>> boneKeyValues;
-
-    for (std::unique_ptr<VROSkeletalAnimationFrame> &frame : _frames) {
-        passert (frame->boneIndices.size() == frame->boneTransforms.size());
-        
-        for (int i = 0; i < frame->boneIndices.size(); i++) {
-            int boneIndex = frame->boneIndices[i];
-            VROMatrix4f &transform = frame->boneTransforms[i];
-            
-            boneKeyValues[boneIndex].push_back(transform);
-            boneKeyTimes[boneIndex].push_back(frame->time);
-        }
-    }
+    std::shared_ptr<VROSkeletalClip> clip = getClip();
+    _pose.resize(clip->getNumTracks());
+    _cursors.assign(clip->getNumTracks(), VROKeyframeCursor());
     
     VROTransaction::begin();
     VROTransaction::setAnimationDuration(_duration);
@@ -81,22 +107,21 @@ void VROSkeletalAnimation::execute(std::shared_ptr<VRONode> node, std::function<
     VROTransaction::setAnimationSpeed(_speed);
     VROTransaction::setTimingFunction(VROTimingFunctionType::Linear);
     
-    for (auto kv : boneKeyTimes) {
-        int boneIndex = kv.first;
-        std::shared_ptr<VROBone> bone = _skinner->getSkeleton()->getBone(boneIndex);
-        
-        std::vector<float> &keyTimes = kv.second;
-        std::vector<VROMatrix4f> &keyValues = boneKeyValues[boneIndex];
-        std::shared_ptr<VROAnimation> animation = std::make_shared<VROAnimationMatrix4f>([shared_w, boneIndex](VROAnimatable *const animatable, VROMatrix4f m) {
-            std::shared_ptr<VROSkeletalAnimation> shared = shared_w.lock();
-            if (!shared) {
-                return;
-            }
-            VROBone *bone = ((VROBone *)animatable);
-            bone->setTransform(m, bone->getTransformType());
-        }, keyTimes, keyValues);
-        
-        bone->animate(animation);
+    std::shared_ptr<VROAnimation> animation = std::make_shared<VROSkeletalPoseAnimation>([shared_w](float t) {
+        std::shared_ptr<VROSkeletalAnimation> shared = shared_w.lock();
+        if (!shared) {
+            return;
+        }
+        shared->applyPose(t);
+    });
+    
+    // As with VROAnimatable::animate, skip straight to the final pose if we're not
+    // on the rendering thread or the transaction has no duration
+    std::shared_ptr<VROTransaction> current = VROTransaction::get();
+    if (VROThreadRestricted::isThread(VROThreadName::Renderer) && current && !current->isDegenerate()) {
+        current->addAnimation(animation);
+    } else {
+        animation->onTermination();
     }
     
     VROTransaction::setFinishCallback([shared_w, onFinished](bool terminate) {
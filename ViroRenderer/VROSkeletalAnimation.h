@@ -30,10 +30,12 @@
 #include <memory>
 #include <vector>
 #include "VROMatrix4f.h"
+#include "VROKeyframeCursor.h"
 #include "VROExecutableAnimation.h"
 
 class VROShaderModifier;
 class VROSkinner;
+class VROSkeletalClip;
 
 /*
  Single frame of a skeletal animation. Identifies the bones
@@ -72,6 +74,11 @@ struct VROSkeletalAnimationFrame {
  achieved by animating the transform matrices of VROBones in
  a VROSkeleton. The VROSkinners associated with the skeleton 
  propagate these bone animations to geometries.
+ 
+ When executed, the frames are converted into a VROSkeletalClip,
+ and a single animation in the transaction samples every bone of
+ the clip into a pose buffer each frame, which is then applied to
+ the skeleton in one pass.
  */
 class VROSkeletalAnimation : public VROExecutableAnimation, public std::enable_shared_from_this<VROSkeletalAnimation> {
     
@@ -101,6 +108,12 @@ public:
         return _frames;
     }
     
+    /*
+     Get the compact clip built from this animation's frames, building it
+     if necessary. The clip is shared with copies of this animation.
+     */
+    std::shared_ptr<VROSkeletalClip> getClip();
+    
 #pragma mark - Executable Animation API
     
     /*
@@ -155,11 +168,26 @@ private:
      */
     float _duration;
     
+    /*
+     The clip built from _frames, and the pose buffer it is sampled into
+     while the animation runs (one transform and one keyframe cursor per
+     clip track).
+     */
+    std::shared_ptr<VROSkeletalClip> _clip;
+    std::vector<VROMatrix4f> _pose;
+    std::vector<VROKeyframeCursor> _cursors;
+    
     /*
      If the animation is running, this is its associated transaction.
      */
     std::weak_ptr<VROTransaction> _transaction;
     
+    /*
+     Sample the clip at the given time [0, 1] and apply the pose to the
+     skeleton.
+     */
+    void applyPose(float t);
+    
 };
 
 #endif /* VROSkeletalAnimation_h */
@@ -45,11 +45,21 @@ public:
         name(name), defaultBoneWeight(defaultBoneWeight) {
     }
     
+    /*
+     Set the weights of this layer. If the layer is already part of a layered animation,
+     the new weights take effect from the animation's next frame.
+     */
+    void setDefaultBoneWeight(float weight) {
+        defaultBoneWeight = weight;
+        updateInternalWeights();
+    }
     void setBoneWeight(int boneIndex, float weight) {
         boneWeights[boneIndex] = weight;
+        updateInternalWeights();
     }
     void setBoneWeights(std::map<int, float> weights) {
         boneWeights = weights;
+        updateInternalWeights();
     }
     
 private:
@@ -66,6 +76,9 @@ private:
     // an animation
     std::map<std::shared_ptr<VROSkinner>, std::shared_ptr<VROSkeletalAnimationLayerInternal>> _internal;
     
+    // Push the current weights to every layered animation built from this layer
+    // (implemented in VROLayeredSkeletalAnimation.cpp)
+    void updateInternalWeights();
     
 };
 
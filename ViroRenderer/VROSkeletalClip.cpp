@@ -0,0 +1,232 @@
+//
+//  VROSkeletalClip.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/30/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROSkeletalClip.h"
+#include "VROSkeletalAnimation.h"
+#include "VROMath.h"
+#include "VROQuaternion.h"
+#include "VROVector3f.h"
+#include "VROLog.h"
+#include <algorithm>
+#include <map>
+#include <cmath>
+
+// Quantization scale for rotation components in [-1, 1]
+static const float kRotationQuantization = 32767.0f;
+
+// Decomposed keys must reproduce the source matrix to within this tolerance,
+// relative to the matrix's largest component, or the track is stored as matrices
+static const float kDecompositionTolerance = 1e-3f;
+
+// Keys within this tolerance of the first key are considered unchanged
+static const float kConstantTolerance = 1e-6f;
+
+static void VRODequantizeRotation(const int16_t *quantized, float *rotation) {
+    for (int i = 0; i < 4; i++) {
+        rotation[i] = quantized[i] / kRotationQuantization;
+    }
+}
+
+#pragma mark - Building
+
+std::shared_ptr<VROSkeletalClip> VROSkeletalClip::build(const std::vector<std::unique_ptr<VROSkeletalAnimationFrame>> &frames) {
+    std::map<int, std::vector<float>> boneKeyTimes;
+    std::map<int, std::vector<const VROMatrix4f *>> boneKeyTransforms;
+
+    for (const std::unique_ptr<VROSkeletalAnimationFrame> &frame : frames) {
+        passert (frame->boneIndices.size() == frame->boneTransforms.size());
+
+        for (size_t i = 0; i < frame->boneIndices.size(); i++) {
+            int boneIndex = frame->boneIndices[i];
+            boneKeyTimes[boneIndex].push_back(frame->time);
+            boneKeyTransforms[boneIndex].push_back(&frame->boneTransforms[i]);
+        }
+    }
+
+    std::shared_ptr<VROSkeletalClip> clip = std::make_shared<VROSkeletalClip>();
+    for (auto &kv : boneKeyTimes) {
+        clip->addTrack(kv.first, kv.second, boneKeyTransforms[kv.first]);
+    }
+    return clip;
+}
+
+void VROSkeletalClip::addTrack(int bone, const std::vector<float> &times, const std::vector<const VROMatrix4f *> &transforms) {
+    int numKeys = (int) times.size();
+    
+    // Collapse tracks whose transform never changes to a single key
+    bool constant = true;
+    for (int k = 1; k < numKeys && constant; k++) {
+        for (int j = 0; j < 16; j++) {
+            if (fabs((*transforms[k])[j] - (*transforms[0])[j]) > kConstantTolerance) {
+                constant = false;
+                break;
+            }
+        }
+    }
+    if (constant) {
+        numKeys = 1;
+    }
+
+    // Decompose each key, verifying that the decomposition (with its quantized
+    // rotation) reproduces the source matrix
+    std::vector<float> translations(numKeys * 3);
+    std::vector<int16_t> rotations(numKeys * 4);
+    std::vector<float> scales(numKeys * 3);
+    bool decomposable = true;
+
+    for (int k = 0; k < numKeys && decomposable; k++) {
+        const VROMatrix4f &transform = *transforms[k];
+        VROVector3f scale = transform.extractScale();
+        if (scale.x < 1e-8 || scale.y < 1e-8 || scale.z < 1e-8) {
+            decomposable = false;
+            break;
+        }
+        VROQuaternion rotation = transform.extractRotation(scale);
+        rotation.normalize();
+        
+        // Keep consecutive rotations in the same hemisphere, so that they can be
+        // interpolated without a sign check
+        float q[4] = { rotation.X, rotation.Y, rotation.Z, rotation.W };
+        if (k > 0) {
+            const int16_t *previous = &rotations[(k - 1) * 4];
+            float dot = q[0] * previous[0] + q[1] * previous[1] + q[2] * previous[2] + q[3] * previous[3];
+            if (dot < 0) {
+                for (int i = 0; i < 4; i++) {
+                    q[i] = -q[i];
+                }
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            rotations[k * 4 + i] = (int16_t) lroundf(std::max(-1.0f, std::min(1.0f, q[i])) * kRotationQuantization);
+        }
+        translations[k * 3 + 0] = transform[12];
+        translations[k * 3 + 1] = transform[13];
+        translations[k * 3 + 2] = transform[14];
+        scales[k * 3 + 0] = scale.x;
+        scales[k * 3 + 1] = scale.y;
+        scales[k * 3 + 2] = scale.z;
+
+        float dequantized[4];
+        float recomposed[16];
+        VRODequantizeRotation(&rotations[k * 4], dequantized);
+        VROMathComposeTRS(&translations[k * 3], dequantized, &scales[k * 3], recomposed);
+
+        float magnitude = 1;
+        float error = 0;
+        for (int j = 0; j < 16; j++) {
+            magnitude = std::max(magnitude, (float) fabs(transform[j]));
+            error = std::max(error, (float) fabs(recomposed[j] - transform[j]));
+        }
+        if (error > kDecompositionTolerance * magnitude) {
+            decomposable = false;
+        }
+    }
+
+    _trackBones.push_back(bone);
+    _trackFirstKey.push_back((int) _times.size());
+    _trackNumKeys.push_back(numKeys);
+    _times.insert(_times.end(), times.begin(), times.begin() + numKeys);
+    
+    if (decomposable) {
+        _trackFirstMatrix.push_back(-1);
+        _translations.insert(_translations.end(), translations.begin(), translations.end());
+        _rotations.insert(_rotations.end(), rotations.begin(), rotations.end());
+        _scales.insert(_scales.end(), scales.begin(), scales.end());
+    }
+    else {
+        _trackFirstMatrix.push_back((int) (_matrices.size() / 16));
+        for (int k = 0; k < numKeys; k++) {
+            _matrices.insert(_matrices.end(), transforms[k]->getArray(), transforms[k]->getArray() + 16);
+        }
+        // Keep the key arrays aligned with _times
+        _translations.resize(_translations.size() + numKeys * 3);
+        _rotations.resize(_rotations.size() + numKeys * 4);
+        _scales.resize(_scales.size() + numKeys * 3);
+    }
+}
+
+size_t VROSkeletalClip::getDataSize() const {
+    return _times.size() * sizeof(float) + _translations.size() * sizeof(float) + _rotations.size() * sizeof(int16_t) +
+           _scales.size() * sizeof(float) + _matrices.size() * sizeof(float) +
+           _trackBones.size() * 4 * sizeof(int);
+}
+
+#pragma mark - Sampling
+
+void VROSkeletalClip::sample(float t, VROMatrix4f *pose, VROKeyframeCursor *cursors) const {
+    int numTracks = (int) _trackBones.size();
+    
+    for (int i = 0; i < numTracks; i++) {
+        int first = _trackFirstKey[i];
+        int numKeys = _trackNumKeys[i];
+        const float *times = &_times[first];
+
+        // Find the keys bracketing t, and the blend factor between them
+        int k0 = 0, k1 = 0;
+        float f = 0;
+        if (numKeys > 1 && t >= times[0]) {
+            if (t >= times[numKeys - 1]) {
+                k0 = k1 = numKeys - 1;
+            } else {
+                k0 = cursors ? cursors[i].find(t, times, numKeys) : VROKeyframeCursor::search(t, times, numKeys);
+                k1 = k0 + 1;
+                f = (t - times[k0]) / (times[k1] - times[k0]);
+            }
+        }
+
+        float m[16];
+        if (_trackFirstMatrix[i] < 0) {
+            int a = first + k0;
+            int b = first + k1;
+
+            float translation[3], scale[3], rotation[4];
+            for (int j = 0; j < 3; j++) {
+                translation[j] = _translations[a * 3 + j] + f * (_translations[b * 3 + j] - _translations[a * 3 + j]);
+                scale[j] = _scales[a * 3 + j] + f * (_scales[b * 3 + j] - _scales[a * 3 + j]);
+            }
+
+            // Normalized lerp; keys were stored in the same hemisphere
+            float length = 0;
+            for (int j = 0; j < 4; j++) {
+                rotation[j] = (_rotations[a * 4 + j] + f * (_rotations[b * 4 + j] - _rotations[a * 4 + j]));
+                length += rotation[j] * rotation[j];
+            }
+            float inverseLength = length > 0 ? 1.0f / sqrtf(length) : 0;
+            for (int j = 0; j < 4; j++) {
+                rotation[j] *= inverseLength;
+            }
+            VROMathComposeTRS(translation, rotation, scale, m);
+        }
+        else {
+            const float *a = &_matrices[(_trackFirstMatrix[i] + k0) * 16];
+            const float *b = &_matrices[(_trackFirstMatrix[i] + k1) * 16];
+            for (int j = 0; j < 16; j++) {
+                m[j] = a[j] + f * (b[j] - a[j]);
+            }
+        }
+        pose[i] = VROMatrix4f(m);
+    }
+}
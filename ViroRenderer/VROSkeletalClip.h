@@ -0,0 +1,123 @@
+//
+//  VROSkeletalClip.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/30/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROSkeletalClip_h
+#define VROSkeletalClip_h
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "VROMatrix4f.h"
+#include "VROKeyframeCursor.h"
+
+struct VROSkeletalAnimationFrame;
+
+/*
+ Compact, sampling-friendly form of a skeletal animation. The animation's
+ frames (which list a full matrix per animated bone, per frame) are
+ converted into one track per animated bone. Each track holds its key
+ times and its keys decomposed into translation, rotation, and scale,
+ stored as structure-of-arrays across all tracks. Rotations are quantized
+ to four signed 16-bit integers, and tracks whose keys never change are
+ collapsed to a single key.
+
+ Bone transforms that cannot be decomposed into translation, rotation and
+ scale (e.g. those with shear or reflection) are stored as full matrices
+ for that track, and interpolated component-wise.
+
+ The clip is immutable once built, and may be shared by any number of
+ animations.
+ */
+class VROSkeletalClip {
+
+public:
+
+    /*
+     Build a clip from the given frames, which must be in order of time.
+     */
+    static std::shared_ptr<VROSkeletalClip> build(const std::vector<std::unique_ptr<VROSkeletalAnimationFrame>> &frames);
+
+    VROSkeletalClip() {}
+    virtual ~VROSkeletalClip() {}
+
+    /*
+     Number of tracks, and the skeleton bone animated by each.
+     */
+    int getNumTracks() const {
+        return (int) _trackBones.size();
+    }
+    const std::vector<int> &getTrackBones() const {
+        return _trackBones;
+    }
+
+    /*
+     Evaluate every track at the given time, defined between [0, 1], writing
+     the transform of track i into pose[i]. Times outside the keys of a track
+     clamp to its first or last key.
+ 
+     If cursors is not null it must hold one cursor per track; each track's
+     segment is then found from where the last sample left off instead of by
+     binary search.
+     */
+    void sample(float t, VROMatrix4f *pose, VROKeyframeCursor *cursors = nullptr) const;
+
+    /*
+     Approximate size of the clip's key data, in bytes.
+     */
+    size_t getDataSize() const;
+
+private:
+
+    /*
+     Per-track data: the bone animated, the range of the track's keys in the
+     key arrays below, and, for tracks stored as matrices, the offset of the
+     track's first matrix in _matrices (or -1 for decomposed tracks).
+     */
+    std::vector<int> _trackBones;
+    std::vector<int> _trackFirstKey;
+    std::vector<int> _trackNumKeys;
+    std::vector<int> _trackFirstMatrix;
+
+    /*
+     Key data for all tracks, concatenated. Translation and scale have three
+     floats per key, rotation four quantized components per key (unused for
+     tracks stored as matrices).
+     */
+    std::vector<float> _times;
+    std::vector<float> _translations;
+    std::vector<int16_t> _rotations;
+    std::vector<float> _scales;
+
+    /*
+     Full matrices, 16 floats per key, for tracks that could not be decomposed.
+     */
+    std::vector<float> _matrices;
+
+    void addTrack(int bone, const std::vector<float> &times, const std::vector<const VROMatrix4f *> &transforms);
+
+};
+
+#endif /* VROSkeletalClip_h */
@@ -31,8 +31,11 @@
 #include "VRONode.h"
 #include "VROBoneConstraint.h"
 
-VROSkeleton::VROSkeleton(std::vector<std::shared_ptr<VROBone>> bones) {
+VROSkeleton::VROSkeleton(std::vector<std::shared_ptr<VROBone>> bones) :
+    _poseVersion(0),
+    _poseValid(false) {
     _bones = bones;
+    buildPoseOrder();
 
     for (auto &bone : bones) {
         std::string boneName = bone->getName();
@@ -86,6 +89,111 @@ void VROSkeleton::setSkinnerRootNode(std::shared_ptr<VRONode> modelRootNode) {
     }
 }
 
+void VROSkeleton::setBoneTransforms(const std::vector<int> &boneIndices, const VROMatrix4f *transforms) {
+    for (size_t i = 0; i < boneIndices.size(); i++) {
+        VROBone *bone = _bones[boneIndices[i]].get();
+        bone->setTransform(transforms[i], bone->getTransformType());
+    }
+}
+
+void VROSkeleton::buildPoseOrder() {
+    int numBones = getNumBones();
+    _poseParents.assign(numBones, -1);
+    _poseOrder.clear();
+    _poseOrder.reserve(numBones);
+
+    std::vector<std::vector<int>> children(numBones);
+    for (int i = 0; i < numBones; i++) {
+        int parent = _bones[i]->getParentIndex();
+        if (parent >= 0 && parent < numBones && parent != i) {
+            children[parent].push_back(i);
+        }
+    }
+
+    // Depth-first from each root, so every bone is visited after its parent
+    std::vector<uint8_t> visited(numBones, 0);
+    std::vector<int> stack;
+    for (int i = 0; i < numBones; i++) {
+        int parent = _bones[i]->getParentIndex();
+        if (parent >= 0 && parent < numBones && parent != i) {
+            continue;
+        }
+        stack.push_back(i);
+        while (!stack.empty()) {
+            int bone = stack.back();
+            stack.pop_back();
+            visited[bone] = 1;
+            _poseOrder.push_back(bone);
+
+            for (int child : children[bone]) {
+                _poseParents[child] = bone;
+                stack.push_back(child);
+            }
+        }
+    }
+
+    // Bones caught in a parent cycle are never reached from a root; pose them as roots
+    for (int i = 0; i < numBones; i++) {
+        if (!visited[i]) {
+            pwarn("Bone %d is not reachable from a root bone, treating as root", i);
+            _poseOrder.push_back(i);
+        }
+    }
+
+    _poseTransforms.assign(numBones, VROMatrix4f::identity());
+    _poseChains.assign(numBones, VROMatrix4f::identity());
+    _poseDirty.assign(numBones, 0);
+    _poseValid = false;
+}
+
+const std::vector<VROMatrix4f> &VROSkeleton::getBonePoseTransforms() {
+    updatePose();
+    return _poseTransforms;
+}
+
+void VROSkeleton::updatePose() {
+    uint64_t version = VROBone::getPoseVersion();
+    if (_poseValid && version == _poseVersion) {
+        return;
+    }
+
+    /*
+     Parents precede children in _poseOrder, so each bone's parent chain is final
+     by the time the bone is reached, and each bone costs one multiply (plus the
+     bind inversion of Legacy bones). A bone is recomputed if it was moved since
+     the last pass or its parent was recomputed during this one.
+     */
+    for (int b : _poseOrder) {
+        const VROBone *bone = _bones[b].get();
+        int parent = _poseParents[b];
+
+        bool dirty = !_poseValid || bone->getTransformVersion() > _poseVersion ||
+                     (parent >= 0 && _poseDirty[parent]);
+        _poseDirty[b] = dirty;
+        if (!dirty) {
+            continue;
+        }
+
+        _poseChains[b] = parent >= 0 ? _poseChains[parent].multiply(bone->getTransform()) :
+                                       bone->getTransform();
+
+        switch (bone->getTransformType()) {
+            case VROBoneTransformType::Local:
+                _poseTransforms[b] = _poseChains[b];
+                break;
+            case VROBoneTransformType::Concatenated:
+                _poseTransforms[b] = bone->getTransform();
+                break;
+            case VROBoneTransformType::Legacy:
+                _poseTransforms[b] = bone->getBindTransform().invert().multiply(bone->getTransform());
+                break;
+        }
+    }
+
+    _poseVersion = version;
+    _poseValid = true;
+}
+
 std::shared_ptr<VRONode> VROSkeleton::getSkinnerRootNode() {
     return _modelRootNode_w.lock();
 }
@@ -116,8 +224,8 @@ VROMatrix4f VROSkeleton::getCurrentBoneWorldTransform(std::shared_ptr<VROBone> b
         modelRootWorldTrans = modelRootNode->getWorldTransform();
     }
 
-    // Grab the bone's transform, convert it into geometry and then finally world space.
-    // TODO VIRO-4758: Account for Local Bones when setting bone transforms
+    // Grab the bone's transform, convert it into geometry and then finally world space. Local
+    // bones depend on their ancestors, so they are read from the skeleton's cached pose.
     VROMatrix4f transform = VROMatrix4f::identity();
     switch(bone->getTransformType()) {
         case VROBoneTransformType::Legacy:
@@ -126,8 +234,9 @@ VROMatrix4f VROSkeleton::getCurrentBoneWorldTransform(std::shared_ptr<VROBone> b
         case VROBoneTransformType::Concatenated:
             transform = bone->getTransform();
             break;
-        default:
-            return VROMatrix4f::identity();
+        case VROBoneTransformType::Local:
+            transform = getBonePoseTransforms()[bone->getIndex()];
+            break;
     }
 
     return modelRootWorldTrans * transform;
@@ -34,6 +34,7 @@ class VRONode;
 #include <vector>
 #include <map>
 #include <string>
+#include <stdint.h>
 #include "VROMatrix4f.h"
 #include "VROVector3f.h"
 
@@ -67,6 +68,28 @@ public:
         return nullptr;
     }
 
+    /*
+     Set the transforms of the given bones in a single pass, keeping the transform
+     type of each bone. Used by skeletal animations to apply a sampled pose, where
+     transforms[i] is the transform for bone boneIndices[i].
+     */
+    void setBoneTransforms(const std::vector<int> &boneIndices, const VROMatrix4f *transforms);
+
+    /*
+     Returns the current pose of every bone, indexed by bone index. Each matrix
+     moves from the bone's bind position in bone local space to its animated
+     position in model space; for Concatenated bones this is the bone transform
+     itself, for Local bones it is the product of the transforms of the bone
+     and all of its ancestors (whatever their transform type), and for Legacy
+     bones it is the bone transform followed by the inverse of the bone's bind
+     transform.
+
+     The pose is computed lazily in a single parent-before-child pass, and only
+     for the bones moved since the last pass (and their descendants). The
+     returned array remains valid until the next bone transform is set.
+     */
+    const std::vector<VROMatrix4f> &getBonePoseTransforms();
+
     /*
      Returns a map of bone attachment nodes associated with this skeleton.
      */
@@ -138,6 +161,42 @@ private:
     void scaleBoneTransform(int currentBoneIndex, std::vector<int> &bonesChildFirst,
                             VROMatrix4f parentTransform, float scaleFactor,
                             VROVector3f scaleDirection);
+
+    /*
+     The bone indices in parent-before-child order, and the parent of each bone
+     (-1 for roots, and for bones whose parent index is invalid). Computed at
+     construction, since the hierarchy never changes.
+     */
+    std::vector<int> _poseOrder;
+    std::vector<int> _poseParents;
+
+    /*
+     The cached pose (see getBonePoseTransforms()), the VROBone pose version at
+     which it was computed, and scratch flags marking the bones recomputed during
+     the last pass.
+     */
+    std::vector<VROMatrix4f> _poseTransforms;
+    std::vector<uint8_t> _poseDirty;
+
+    /*
+     The product of the transforms of each bone and all of its ancestors. This is
+     the pose of Local bones. It is kept apart from _poseTransforms because the
+     pose of a Legacy or Concatenated parent is already in model space, while a
+     Local child is posed from its ancestors' raw transforms.
+     */
+    std::vector<VROMatrix4f> _poseChains;
+    uint64_t _poseVersion;
+    bool _poseValid;
+
+    /*
+     Build _poseOrder and _poseParents from the bone hierarchy.
+     */
+    void buildPoseOrder();
+
+    /*
+     Bring _poseTransforms up to date with the bones.
+     */
+    void updatePose();
 };
 
 #endif /* VROSkeleton_h */
@@ -0,0 +1,173 @@
+//
+//  VROSkeletonPoseTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/5/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROSkeletonPoseTest.h"
+#include "VROSkeleton.h"
+#include "VROBone.h"
+#include "VROQuaternion.h"
+#include "VROTestUtil.h"
+#include "VROStringUtil.h"
+
+// Number of bones per skeleton, and the number moved each frame
+static const int kNumBones = 24;
+static const int kBonesMovedPerFrame = 3;
+
+// Number of frames between each report
+static const int kReportFrames = 120;
+
+/*
+ The pose of a bone as VROSkinner computed it before poses were cached: a Local
+ bone walks up its parent chain multiplying each ancestor's raw transform,
+ whatever that ancestor's transform type.
+ */
+static VROMatrix4f VROSkeletonWalkPose(std::shared_ptr<VROSkeleton> skeleton, int boneIndex) {
+    std::shared_ptr<VROBone> bone = skeleton->getBone(boneIndex);
+    switch (bone->getTransformType()) {
+        case VROBoneTransformType::Concatenated:
+            return bone->getTransform();
+        case VROBoneTransformType::Legacy:
+            return bone->getBindTransform().invert().multiply(bone->getTransform());
+        case VROBoneTransformType::Local:
+        default:
+            break;
+    }
+    
+    VROMatrix4f transform = VROMatrix4f::identity();
+    while (boneIndex >= 0) {
+        bone = skeleton->getBone(boneIndex);
+        transform = bone->getTransform().multiply(transform);
+        boneIndex = bone->getParentIndex();
+    }
+    return transform;
+}
+
+static VROMatrix4f VROSkeletonRandomTransform() {
+    VROMatrix4f transform;
+    transform.rotate(VROQuaternion(drand48() * M_PI, drand48() * M_PI, drand48() * M_PI));
+    transform.translate(drand48() - 0.5, drand48() - 0.5, drand48() - 0.5);
+    return transform;
+}
+
+VROSkeletonPoseTest::VROSkeletonPoseTest() :
+    VRORendererTest(VRORendererTestType::SkeletonPose),
+    _numFrames(0) {
+        
+}
+
+VROSkeletonPoseTest::~VROSkeletonPoseTest() {
+    
+}
+
+void VROSkeletonPoseTest::build(std::shared_ptr<VRORenderer> renderer,
+                                std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                                std::shared_ptr<VRODriver> driver) {
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    _localSkeleton = createSkeleton({ VROBoneTransformType::Local });
+    _mixedSkeleton = createSkeleton({ VROBoneTransformType::Concatenated, VROBoneTransformType::Local,
+                                      VROBoneTransformType::Legacy, VROBoneTransformType::Local,
+                                      VROBoneTransformType::Local });
+    verifyPose(_localSkeleton, "local");
+    verifyPose(_mixedSkeleton, "mixed");
+    
+    std::shared_ptr<VROBox> box = VROBox::createBox(0.5, 0.5, 0.5);
+    std::shared_ptr<VROMaterial> material = box->getMaterials()[0];
+    material->setLightingModel(VROLightingModel::Constant);
+    material->getDiffuse().setColor({ 0.4, 1.0, 0.7, 1.0 });
+    
+    std::shared_ptr<VRONode> boxNode = std::make_shared<VRONode>();
+    boxNode->setGeometry(box);
+    boxNode->setPosition({ 0, 0, -3 });
+    boxNode->runAction(VROAction::perpetualPerFrameAction([](VRONode *const node, float seconds) {
+        node->setRotation({ 0, node->getRotationEuler().y + 0.02f, 0 });
+        return true;
+    }));
+    rootNode->addChildNode(boxNode);
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+    frameSynchronizer->addFrameListener(shared_from_this());
+}
+
+std::shared_ptr<VROSkeleton> VROSkeletonPoseTest::createSkeleton(const std::vector<VROBoneTransformType> &types) {
+    /*
+     The parent of the i-th bone in the hierarchy is the (i - 1) / 2-th, so the
+     skeleton branches and is several bones deep. Bones are stored child-first
+     (the i-th bone has index kNumBones - 1 - i), as some loaders store them, so
+     the skeleton has to order them itself.
+     */
+    std::vector<std::shared_ptr<VROBone>> bones(kNumBones);
+    for (int i = 0; i < kNumBones; i++) {
+        int index = kNumBones - 1 - i;
+        int parentIndex = (i == 0) ? -1 : kNumBones - 1 - (i - 1) / 2;
+        bones[index] = std::make_shared<VROBone>(index, parentIndex, "bone_" + VROStringUtil::toString(i),
+                                                 VROSkeletonRandomTransform(), VROSkeletonRandomTransform());
+        bones[index]->setTransform(VROSkeletonRandomTransform(), types[i % types.size()]);
+    }
+    return std::make_shared<VROSkeleton>(bones);
+}
+
+void VROSkeletonPoseTest::moveBones(std::shared_ptr<VROSkeleton> skeleton, int count) {
+    for (int i = 0; i < count; i++) {
+        std::shared_ptr<VROBone> bone = skeleton->getBone((int) (drand48() * skeleton->getNumBones()) % skeleton->getNumBones());
+        bone->setTransform(VROSkeletonRandomTransform(), bone->getTransformType());
+    }
+}
+
+void VROSkeletonPoseTest::verifyPose(std::shared_ptr<VROSkeleton> skeleton, std::string name) {
+    const std::vector<VROMatrix4f> &pose = skeleton->getBonePoseTransforms();
+    passert ((int) pose.size() == skeleton->getNumBones());
+    
+    for (int i = 0; i < skeleton->getNumBones(); i++) {
+        VROMatrix4f expected = VROSkeletonWalkPose(skeleton, i);
+        passert_msg(pose[i] == expected, "Pose of bone %d of the %s skeleton is %s, expected %s",
+                    i, name.c_str(), pose[i].toString().c_str(), expected.toString().c_str());
+    }
+}
+
+void VROSkeletonPoseTest::onFrameWillRender(const VRORenderContext &context) {
+    
+}
+
+void VROSkeletonPoseTest::onFrameDidRender(const VRORenderContext &context) {
+    moveBones(_localSkeleton, kBonesMovedPerFrame);
+    moveBones(_mixedSkeleton, kBonesMovedPerFrame);
+    verifyPose(_localSkeleton, "local");
+    verifyPose(_mixedSkeleton, "mixed");
+    
+    if (++_numFrames == kReportFrames) {
+        pinfo("Skeleton poses matched the parent chain walk for %d frames", _numFrames);
+        _numFrames = 0;
+    }
+}
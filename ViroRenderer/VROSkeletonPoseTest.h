@@ -0,0 +1,92 @@
+//
+//  VROSkeletonPoseTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/5/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROSkeletonPoseTest_h
+#define VROSkeletonPoseTest_h
+
+#include "VRORendererTest.h"
+
+#include "VROBone.h"
+
+class VROSkeleton;
+
+/*
+ Verifies the cached skeleton pose (VROSkeleton::getBonePoseTransforms()) against
+ a direct walk of each bone's parent chain. Each frame a few bones of two branching
+ skeletons are moved, so the incremental recompute of moved bones and their
+ descendants is exercised as well as the first full pass. One skeleton uses only
+ Local bones; the other mixes Local, Concatenated and Legacy bones, including Local
+ children of non-Local parents. A box spins while the test runs.
+ */
+class VROSkeletonPoseTest : public VROFrameListener, public VRORendererTest, public std::enable_shared_from_this<VROFrameListener> {
+public:
+    
+    VROSkeletonPoseTest();
+    virtual ~VROSkeletonPoseTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+    void onFrameWillRender(const VRORenderContext &context);
+    void onFrameDidRender(const VRORenderContext &context);
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    
+    std::shared_ptr<VROSkeleton> _localSkeleton;
+    std::shared_ptr<VROSkeleton> _mixedSkeleton;
+    int _numFrames;
+    
+    /*
+     Create a skeleton of branching bones, with the transform types of the bones
+     taken from the given list in turn.
+     */
+    static std::shared_ptr<VROSkeleton> createSkeleton(const std::vector<VROBoneTransformType> &types);
+    
+    /*
+     Move the given number of randomly chosen bones of the skeleton, keeping
+     each bone's transform type.
+     */
+    static void moveBones(std::shared_ptr<VROSkeleton> skeleton, int count);
+    
+    /*
+     Assert that the skeleton's cached pose matches a walk of each bone's parent
+     chain.
+     */
+    static void verifyPose(std::shared_ptr<VROSkeleton> skeleton, std::string name);
+    
+};
+
+#endif /* VROSkeletonPoseTest_h */
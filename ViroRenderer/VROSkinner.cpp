@@ -76,22 +76,12 @@ VROMatrix4f VROSkinner::getModelTransform(int boneIndex) {
     
     /*
      With the local transform, each time we multiply by a bone's transform we end up in the bone local
-     space of the parent bone. We have to therefore loop up and continually multiply by parent transforms
-     until we reach the top-most bone. (This makes intuitive sense: the finger transform moves us to the
-     arm, the arm transform to the torso, etc.).
+     space of the parent bone, so the animated position in model space is reached by multiplying by every
+     ancestor's transform (the finger transform moves us to the arm, the arm transform to the torso, etc.).
+     The skeleton computes these chains for all bones in a single parent-before-child pass, so here we
+     only have to append the bind transform.
      */
     else {
-        std::shared_ptr<VROBone> bone;
-        VROMatrix4f transform = _bindTransforms[boneIndex];
-        VROMatrix4f inverseBind;
-        
-        while (boneIndex >= 0) {
-            bone = _skeleton->getBone(boneIndex);
-            transform = bone->getTransform().multiply(transform);
-            inverseBind = _inverseBindTransforms[boneIndex];
-            
-            boneIndex = bone->getParentIndex();
-        }
-        return transform;
+        return _skeleton->getBonePoseTransforms()[boneIndex].multiply(_bindTransforms[boneIndex]);
     }
 }
@@ -28,14 +28,20 @@
 #define VROSortKey_hpp
 
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <tuple>
+#include <vector>
+#include "VROFrameArena.h"
+#include "VROShaderCapabilities.h"
 
 static const int kMaxHierarchyId = 100;
 
 /*
  Sort keys are used to quickly sort geometry elements into optimal batch rendering order,
- to limit state changes on the GPU. They consist of a large byte[] that can be sorted
- quickly via memcmp.
+ to limit state changes on the GPU. For fast sorting each key can be packed into two
+ 64-bit integers that compare in the same order as operator< (see pack()); these are
+ radix sorted by VROSortKeySorter.
  */
 class VROSortKey {
     
@@ -69,6 +75,53 @@ public:
         return std::tie(renderingOrder, hierarchyId, hierarchyDepth, transparent, distanceFromCamera, incoming, materialRenderingOrder, shader, textures, lights, material, node, elementIndex) <
                std::tie(r.renderingOrder, r.hierarchyId, r.hierarchyDepth, r.transparent, r.distanceFromCamera, r.incoming, r.materialRenderingOrder, r.shader, r.textures, r.lights, r.material, r.node, r.elementIndex);
     }
+    
+    /*
+     Pack this key into two 64-bit integers, such that comparing (high, low)
+     lexicographically as unsigned integers orders keys exactly as operator< does
+     for all the rendering order concerns (renderingOrder through
+     materialRenderingOrder). The layout, from most to least significant bit, is:
+     
+     high: renderingOrder (16, biased) | hierarchyId (8) | hierarchyDepth (7) |
+           transparent (1) | distanceFromCamera (32, order-preserving float bits)
+     low:  incoming (1) | materialRenderingOrder (7) | shader (16) | textures (8) |
+           lights (8) | material (24)
+     
+     The state-change concerns (shader, textures, lights, material) are truncated
+     or folded; they only affect batching efficiency, not correctness. The
+     tie-breakers (node, elementIndex) are not packed at all: the radix sort is
+     stable, so ties retain the order in which the keys were gathered.
+     
+     Returns false if any rendering order concern is out of the packable range, in
+     which case the key must be sorted with operator<.
+     */
+    bool pack(uint64_t *high, uint64_t *low) const {
+        if (renderingOrder < INT16_MIN || renderingOrder > INT16_MAX ||
+            hierarchyId > 0xFF || hierarchyDepth > 0x7F || materialRenderingOrder > 0x7F) {
+            return false;
+        }
+        
+        // Map the float to an unsigned integer with the same ordering: flip all bits
+        // of negative values, and just the sign bit of positive values. Zero is
+        // normalized so that -0 and +0 compare equal, as they do in operator<
+        float distance = (distanceFromCamera == 0) ? 0 : distanceFromCamera;
+        uint32_t distanceBits;
+        memcpy(&distanceBits, &distance, sizeof(float));
+        distanceBits = (distanceBits & 0x80000000) ? ~distanceBits : (distanceBits | 0x80000000);
+        
+        *high = ((uint64_t) (uint16_t) (renderingOrder - INT16_MIN) << 48) |
+                ((uint64_t) hierarchyId << 40) |
+                ((uint64_t) hierarchyDepth << 33) |
+                ((uint64_t) (transparent ? 1 : 0) << 32) |
+                (uint64_t) distanceBits;
+        *low  = ((uint64_t) (incoming ? 1 : 0) << 63) |
+                ((uint64_t) materialRenderingOrder << 56) |
+                ((uint64_t) (shader & 0xFFFF) << 40) |
+                ((uint64_t) fold8(textures) << 32) |
+                ((uint64_t) fold8(lights) << 24) |
+                (uint64_t) (material & 0xFFFFFF);
+        return true;
+    }
             
     /*
      Manual rendering order setting (set from VRONode) is the highest sorting concern.
@@ -144,10 +197,42 @@ public:
     uintptr_t node;
     uint32_t elementIndex;
     
+private:
+    
+    static uint32_t fold8(uint32_t hash) {
+        hash ^= hash >> 16;
+        hash ^= hash >> 8;
+        return hash & 0xFF;
+    }
+    
 };
 
 // Uncomment to see a compiler error indicating the size of each VROSortKey
 // template<int s> struct SortKeySize;
 // SortKeySize<sizeof(VROSortKey)> sortKeySize;
 
+/*
+ List of sort keys gathered for a frame. Allocated from the frame arena when the
+ allocator is given one, and from the heap otherwise.
+ */
+typedef std::vector<VROSortKey, VROFrameAllocator<VROSortKey>> VROSortKeyList;
+
+/*
+ The sort keys for the geometry elements of a single node, retained by the node
+ across frames. A geometry may be shared by many nodes, so its keys are stored
+ with each node rather than with the geometry.
+ 
+ The sort key version of the material that produced each key, and the lighting
+ capabilities the keys were computed with, are retained as well: while both are
+ unchanged, the material-derived fields of each key (shader, textures) are reused
+ instead of being queried from the material substrate again.
+ */
+struct VROSortKeyCache {
+    VROSortKeyCache() : capabilities() {}
+    
+    std::vector<VROSortKey> keys;
+    std::vector<uint32_t> versions;
+    VROLightingShaderCapabilities capabilities;
+};
+
 #endif /* VROSortKey_hpp */
@@ -0,0 +1,223 @@
+//
+//  VROSortKeySorter.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/17/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROSortKeySorter.h"
+#include "VROLog.h"
+#include <algorithm>
+#include <string.h>
+
+// The number of element moves we allow the insertion sort to make when
+// repairing last frame's order, as a fraction of the number of keys. Beyond
+// this the radix sort is faster.
+static const size_t kMaxInsertionShiftsDivisor = 4;
+static const size_t kMinInsertionShifts = 16;
+
+static inline bool packedLessThan(const uint64_t aHigh, const uint64_t aLow,
+                                  const uint64_t bHigh, const uint64_t bLow) {
+    return aHigh < bHigh || (aHigh == bHigh && aLow < bLow);
+}
+
+static inline uint32_t identityOf(const VROSortKey &key) {
+    return key.elementIndex | (key.incoming ? 0x80000000 : 0);
+}
+
+VROSortKeySorter::VROSortKeySorter() :
+    _lastOrderReused(false) {
+
+}
+
+VROSortKeySorter::~VROSortKeySorter() {
+
+}
+
+void VROSortKeySorter::sort(VROSortKeyList &keys) {
+    _lastOrderReused = false;
+    size_t count = keys.size();
+
+    if (!packKeys(keys)) {
+        std::sort(keys.begin(), keys.end());
+        _previousIdentity.clear();
+        _previousOrder.clear();
+        return;
+    }
+
+    /*
+     If the same elements were gathered in the same order as last frame, start
+     from last frame's sorted order and repair it.
+     */
+    _sorted.resize(count);
+    if (_previousOrder.size() == count && isSameIdentity(keys)) {
+        for (size_t i = 0; i < count; i++) {
+            _sorted[i] = _packed[_previousOrder[i]];
+        }
+        _lastOrderReused = insertionSort(std::max(count / kMaxInsertionShiftsDivisor, kMinInsertionShifts));
+    }
+    if (!_lastOrderReused) {
+        radixSort();
+        storeIdentity(keys);
+    }
+
+    /*
+     Permute the keys into sorted order, and remember the order for next frame.
+     */
+    _scratch.resize(count);
+    _previousOrder.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t index = _sorted[i].index;
+        _scratch[i] = keys[index];
+        _previousOrder[i] = index;
+    }
+    std::copy(_scratch.begin(), _scratch.end(), keys.begin());
+}
+
+bool VROSortKeySorter::packKeys(const VROSortKeyList &keys) {
+    size_t count = keys.size();
+    _packed.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        VROPackedSortKey &packed = _packed[i];
+        if (!keys[i].pack(&packed.high, &packed.low)) {
+            return false;
+        }
+        packed.index = (uint32_t) i;
+    }
+    return true;
+}
+
+bool VROSortKeySorter::isSameIdentity(const VROSortKeyList &keys) const {
+    if (_previousIdentity.size() != keys.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (_previousIdentity[i].first != keys[i].node ||
+            _previousIdentity[i].second != identityOf(keys[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VROSortKeySorter::storeIdentity(const VROSortKeyList &keys) {
+    _previousIdentity.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        _previousIdentity[i] = { keys[i].node, identityOf(keys[i]) };
+    }
+}
+
+bool VROSortKeySorter::insertionSort(size_t maxShifts) {
+    size_t count = _sorted.size();
+    size_t shifts = 0;
+
+    /*
+     Ties are broken by gathered index so that the result is identical to the
+     stable radix sort.
+     */
+    for (size_t i = 1; i < count; i++) {
+        VROPackedSortKey key = _sorted[i];
+        size_t j = i;
+        while (j > 0) {
+            const VROPackedSortKey &prev = _sorted[j - 1];
+            if (packedLessThan(key.high, key.low, prev.high, prev.low) ||
+                (key.high == prev.high && key.low == prev.low && key.index < prev.index)) {
+                _sorted[j] = prev;
+                --j;
+                if (++shifts > maxShifts) {
+                    _sorted[j] = key;
+                    return false;
+                }
+            }
+            else {
+                break;
+            }
+        }
+        _sorted[j] = key;
+    }
+    return true;
+}
+
+void VROSortKeySorter::radixSort() {
+    size_t count = _packed.size();
+    _radixScratch.resize(count);
+
+    /*
+     Build the histograms for all 16 bytes in a single pass. Bytes 0-7 are the
+     low word and 8-15 the high word, so processing them in order is LSD.
+     */
+    uint32_t histograms[16][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (const VROPackedSortKey &key : _packed) {
+        for (int b = 0; b < 8; b++) {
+            histograms[b][(key.low >> (b * 8)) & 0xFF]++;
+            histograms[b + 8][(key.high >> (b * 8)) & 0xFF]++;
+        }
+    }
+
+    const VROPackedSortKey *source = _packed.data();
+    VROPackedSortKey *destination = _sorted.data();
+    VROPackedSortKey *spare = _radixScratch.data();
+
+    for (int b = 0; b < 16; b++) {
+        uint32_t *histogram = histograms[b];
+
+        // Skip bytes that are identical across all keys
+        bool trivial = false;
+        for (int v = 0; v < 256; v++) {
+            if (histogram[v] == count) {
+                trivial = true;
+                break;
+            }
+            if (histogram[v] != 0) {
+                break;
+            }
+        }
+        if (trivial) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int v = 0; v < 256; v++) {
+            uint32_t c = histogram[v];
+            histogram[v] = offset;
+            offset += c;
+        }
+
+        int shift = (b % 8) * 8;
+        for (size_t i = 0; i < count; i++) {
+            const VROPackedSortKey &key = source[i];
+            uint64_t word = (b < 8) ? key.low : key.high;
+            destination[histogram[(word >> shift) & 0xFF]++] = key;
+        }
+
+        // The destination becomes the next source; _packed is only ever read
+        source = destination;
+        std::swap(destination, spare);
+    }
+
+    if (source != _sorted.data()) {
+        memcpy(_sorted.data(), source, count * sizeof(VROPackedSortKey));
+    }
+}
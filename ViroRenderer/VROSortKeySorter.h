@@ -0,0 +1,115 @@
+//
+//  VROSortKeySorter.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/17/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROSortKeySorter_h
+#define VROSortKeySorter_h
+
+#include <vector>
+#include <stdint.h>
+#include "VROSortKey.h"
+
+/*
+ Sorts VROSortKeys into rendering order. Keys are packed into 128-bit integers
+ (see VROSortKey::pack()) and sorted with a stable LSD radix sort, which is
+ linear in the number of keys and skips any byte that is identical across all
+ keys.
+
+ The sorter also exploits frame-to-frame coherence: if this frame's keys were
+ gathered for the same geometry elements in the same order as last frame's,
+ last frame's sorted order is reapplied and repaired with a bounded insertion
+ sort. When the scene is mostly static, this makes the sort a single linear
+ pass.
+
+ If any key cannot be packed, the sorter falls back to std::sort with
+ VROSortKey::operator<.
+ */
+class VROSortKeySorter {
+
+public:
+
+    VROSortKeySorter();
+    virtual ~VROSortKeySorter();
+
+    /*
+     Sort the given keys into rendering order, in place.
+     */
+    void sort(VROSortKeyList &keys);
+
+    /*
+     Returns true if the last sort reused the previous frame's order, false
+     if it performed a full sort.
+     */
+    bool isLastOrderReused() const {
+        return _lastOrderReused;
+    }
+
+private:
+
+    struct VROPackedSortKey {
+        uint64_t high;
+        uint64_t low;
+        uint32_t index;
+    };
+
+    /*
+     The packed keys, in the order they were gathered, and the same keys in
+     sorted order. The radix scratch buffer is used for ping-ponging between
+     radix passes.
+     */
+    std::vector<VROPackedSortKey> _packed;
+    std::vector<VROPackedSortKey> _sorted;
+    std::vector<VROPackedSortKey> _radixScratch;
+
+    /*
+     Buffer used to permute the VROSortKeys into sorted order.
+     */
+    std::vector<VROSortKey> _scratch;
+
+    /*
+     Identity (node, element, incoming) of each key gathered last frame, in
+     gathered order, along with the sorted order of those keys (as indices
+     into the gathered order).
+     */
+    std::vector<std::pair<uintptr_t, uint32_t>> _previousIdentity;
+    std::vector<uint32_t> _previousOrder;
+    bool _lastOrderReused;
+
+    bool packKeys(const VROSortKeyList &keys);
+    bool isSameIdentity(const VROSortKeyList &keys) const;
+    void storeIdentity(const VROSortKeyList &keys);
+
+    /*
+     Repair the nearly sorted _sorted vector with an insertion sort. Returns
+     false, leaving _sorted partially sorted, if more than maxShifts element
+     moves would be required.
+     */
+    bool insertionSort(size_t maxShifts);
+    void radixSort();
+
+};
+
+#endif /* VROSortKeySorter_h */
@@ -0,0 +1,207 @@
+//
+//  VROSortKeyTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/17/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROSortKeyTest.h"
+#include "VROTestUtil.h"
+#include "VROSortKeySorter.h"
+#include <random>
+#include <algorithm>
+
+static const int kNumTestKeys = 2000;
+static const int kGridSize = 8;
+
+VROSortKeyTest::VROSortKeyTest() :
+    VRORendererTest(VRORendererTestType::SortKey),
+    _angle(0) {
+        
+}
+
+VROSortKeyTest::~VROSortKeyTest() {
+    
+}
+
+void VROSortKeyTest::build(std::shared_ptr<VRORenderer> renderer,
+                           std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                           std::shared_ptr<VRODriver> driver) {
+    verifySorter();
+    
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    std::shared_ptr<VROLight> ambient = std::make_shared<VROLight>(VROLightType::Ambient);
+    ambient->setColor({ 0.6, 0.6, 0.6 });
+    rootNode->addLight(ambient);
+    
+    std::shared_ptr<VROLight> directional = std::make_shared<VROLight>(VROLightType::Directional);
+    directional->setColor({ 1.0, 1.0, 1.0 });
+    directional->setDirection({ 0, -1, -1 });
+    rootNode->addLight(directional);
+    
+    /*
+     A grid of boxes cycling through four materials, every third of which is
+     transparent, so that the sort interleaves opaque and transparent objects.
+     */
+    std::vector<VROVector4f> colors = { { 1.0, 0.2, 0.2, 1.0 }, { 0.2, 1.0, 0.2, 1.0 },
+                                        { 0.2, 0.2, 1.0, 1.0 }, { 1.0, 1.0, 0.2, 1.0 } };
+    
+    std::shared_ptr<VRONode> gridNode = std::make_shared<VRONode>();
+    gridNode->setPosition({ 0, 0, -12 });
+    
+    int i = 0;
+    for (int x = 0; x < kGridSize; x++) {
+        for (int z = 0; z < kGridSize; z++) {
+            std::shared_ptr<VROBox> box = VROBox::createBox(0.5, 0.5, 0.5);
+            std::shared_ptr<VROMaterial> material = box->getMaterials()[0];
+            material->setLightingModel(VROLightingModel::Lambert);
+            material->getDiffuse().setColor(colors[i % colors.size()]);
+            if (i % 3 == 0) {
+                material->setTransparency(0.5);
+            }
+            
+            std::shared_ptr<VRONode> boxNode = std::make_shared<VRONode>();
+            boxNode->setGeometry(box);
+            boxNode->setPosition({ (x - kGridSize / 2.0f) * 1.2f, 0, (z - kGridSize / 2.0f) * 1.2f });
+            gridNode->addChildNode(boxNode);
+            ++i;
+        }
+    }
+    rootNode->addChildNode(gridNode);
+    
+    std::shared_ptr<VROAction> action = VROAction::perpetualPerFrameAction([this](VRONode *const node, float seconds) {
+        _angle += .002;
+        node->setRotation({ 0, _angle, 0 });
+        return true;
+    });
+    gridNode->runAction(action);
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    cameraNode->setPosition({ 0, 4, 0 });
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+}
+
+void VROSortKeyTest::verifySorter() {
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> small(0, 3);
+    std::uniform_int_distribution<int> id(0, 1 << 20);
+    std::uniform_real_distribution<float> distance(-10, 100);
+    
+    /*
+     Generate keys with few distinct values for the rendering order concerns,
+     so that ties are frequent and every field participates in the ordering.
+     */
+    std::vector<VROSortKey> keys(kNumTestKeys);
+    for (int i = 0; i < kNumTestKeys; i++) {
+        VROSortKey &key = keys[i];
+        key.renderingOrder = small(random) - 1;
+        key.hierarchyId = kMaxHierarchyId - small(random);
+        key.hierarchyDepth = small(random);
+        key.transparent = small(random) == 0;
+        key.distanceFromCamera = (i % 5 == 0) ? 0 : distance(random);
+        key.incoming = small(random) != 0;
+        key.materialRenderingOrder = small(random);
+        key.shader = id(random);
+        key.textures = id(random);
+        key.lights = id(random);
+        key.material = id(random);
+        key.node = (uintptr_t) (i / 2 + 1);
+        key.elementIndex = i % 2;
+    }
+    
+    VROSortKeySorter sorter;
+    std::vector<VROSortKey> expected = keys;
+    VROSortKeyList actual(keys.begin(), keys.end());
+    std::sort(expected.begin(), expected.end());
+    sorter.sort(actual);
+    passert_msg (isSameRenderingOrder(expected, actual), "Radix sort order differs from VROSortKey::operator<");
+    passert (!sorter.isLastOrderReused());
+    
+    /*
+     Perturb a few distances, as happens when objects move slightly between
+     frames. The sorter should repair last frame's order instead of sorting.
+     */
+    for (int i = 0; i < kNumTestKeys; i += 97) {
+        keys[i].distanceFromCamera += 0.5;
+    }
+    expected = keys;
+    actual.assign(keys.begin(), keys.end());
+    std::sort(expected.begin(), expected.end());
+    sorter.sort(actual);
+    passert_msg (isSameRenderingOrder(expected, actual), "Repaired order differs from VROSortKey::operator<");
+    passert (sorter.isLastOrderReused());
+    
+    /*
+     Keys that cannot be packed fall back to operator<, which must match
+     exactly, including tie-breakers.
+     */
+    keys[0].renderingOrder = 100000;
+    expected = keys;
+    actual.assign(keys.begin(), keys.end());
+    std::sort(expected.begin(), expected.end());
+    sorter.sort(actual);
+    for (int i = 0; i < kNumTestKeys; i++) {
+        passert (expected[i].node == actual[i].node && expected[i].elementIndex == actual[i].elementIndex);
+    }
+    
+    pinfo("Sort key verification passed for %d keys", kNumTestKeys);
+}
+
+bool VROSortKeyTest::isSameRenderingOrder(const std::vector<VROSortKey> &a, const VROSortKeyList &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    
+    /*
+     Every rendering order concern must match position by position. The state
+     change concerns and tie-breakers may legitimately differ among keys that
+     tie on all rendering order concerns.
+     */
+    for (size_t i = 0; i < a.size(); i++) {
+        const VROSortKey &l = a[i];
+        const VROSortKey &r = b[i];
+        if (std::tie(l.renderingOrder, l.hierarchyId, l.hierarchyDepth, l.transparent, l.distanceFromCamera, l.incoming, l.materialRenderingOrder) !=
+            std::tie(r.renderingOrder, r.hierarchyId, r.hierarchyDepth, r.transparent, r.distanceFromCamera, r.incoming, r.materialRenderingOrder)) {
+            return false;
+        }
+    }
+    
+    // Every element must appear exactly once
+    std::vector<std::pair<uintptr_t, uint32_t>> la, lb;
+    for (size_t i = 0; i < a.size(); i++) {
+        la.push_back({ a[i].node, a[i].elementIndex | (a[i].incoming ? 0x80000000 : 0) });
+        lb.push_back({ b[i].node, b[i].elementIndex | (b[i].incoming ? 0x80000000 : 0) });
+    }
+    std::sort(la.begin(), la.end());
+    std::sort(lb.begin(), lb.end());
+    return la == lb;
+}
@@ -34,8 +34,8 @@
 #include "VROImage.h"
 #include "VROMaterialVisual.h"
 #include "VROFrameScheduler.h"
-#include "VROStringUtil.h"
 #include <atomic>
+#include <algorithm>
 
 static std::atomic_int sTextureId;
 
@@ -53,7 +53,8 @@ VROTexture::VROTexture(VROTextureType type, VROTextureInternalFormat internalFor
     _wrapT(VROWrapMode::Clamp),
     _minificationFilter(VROFilterMode::Linear),
     _magnificationFilter(VROFilterMode::Linear),
-    _mipFilter(VROFilterMode::Linear) {
+    _mipFilter(VROFilterMode::Linear),
+    _uploadPending(false) {
     
     setNumSubstrates(getNumSubstratesForFormat(internalFormat));
     ALLOCATION_TRACKER_ADD(Textures, 1);
@@ -74,7 +75,8 @@ VROTexture::VROTexture(VROTextureType type, VROTextureInternalFormat internalFor
     _wrapT(VROWrapMode::Clamp),
     _minificationFilter(VROFilterMode::Linear),
     _magnificationFilter(VROFilterMode::Linear),
-    _mipFilter(VROFilterMode::Linear) {
+    _mipFilter(VROFilterMode::Linear),
+    _uploadPending(false) {
     
     _substrates.push_back(std::move(substrate));
     ALLOCATION_TRACKER_ADD(Textures, 1);
@@ -91,14 +93,18 @@ VROTexture::VROTexture(bool sRGB,
     _internalFormat(image->getInternalFormat()),
     _width(image->getWidth()),
     _height(image->getHeight()),
-    _mipmapMode(mipmapMode),
+    
+    // Images that carry their own mip chain (e.g. transcoded images) use it
+    _mipmapMode(image->getMipSizes().empty() ? mipmapMode : VROMipmapMode::Pregenerated),
+    _mipSizes(image->getMipSizes()),
     _sRGB(sRGB),
     _stereoMode(stereoMode),
     _wrapS(VROWrapMode::Clamp),
     _wrapT(VROWrapMode::Clamp),
     _minificationFilter(VROFilterMode::Linear),
     _magnificationFilter(VROFilterMode::Linear),
-    _mipFilter(VROFilterMode::Linear) {
+    _mipFilter(VROFilterMode::Linear),
+    _uploadPending(false) {
     
     setNumSubstrates(getNumSubstratesForFormat(_internalFormat));
     ALLOCATION_TRACKER_ADD(Textures, 1);
@@ -121,7 +127,8 @@ VROTexture::VROTexture(bool sRGB,
     _wrapT(VROWrapMode::Clamp),
     _minificationFilter(VROFilterMode::Linear),
     _magnificationFilter(VROFilterMode::Linear),
-    _mipFilter(VROFilterMode::Linear) {
+    _mipFilter(VROFilterMode::Linear),
+    _uploadPending(false) {
     
     setNumSubstrates(getNumSubstratesForFormat(_internalFormat));
     ALLOCATION_TRACKER_ADD(Textures, 1);
@@ -150,7 +157,8 @@ VROTexture::VROTexture(VROTextureType type,
     _wrapT(VROWrapMode::Clamp),
     _minificationFilter(VROFilterMode::Linear),
     _magnificationFilter(VROFilterMode::Linear),
-    _mipFilter(VROFilterMode::Linear) {
+    _mipFilter(VROFilterMode::Linear),
+    _uploadPending(false) {
     
     setNumSubstrates(getNumSubstratesForFormat(internalFormat));
     ALLOCATION_TRACKER_ADD(Textures, 1);
@@ -172,16 +180,19 @@ void VROTexture::hydrateAsync(std::function<void()> callback,
     
     _hydrationCallbacks.push_back(callback);
     
+    // Asynchronous hydration is requested for content that is loaded and
+    // about to be displayed
     const std::shared_ptr<VROFrameScheduler> &scheduler = driver->getFrameScheduler();
-    std::string key = getHydrationTaskKey();
-    if (!scheduler->isTaskQueued(key)) {
-        std::function<void()> hydrationTask = createHydrationTask(driver);
-        scheduler->scheduleTask(key, hydrationTask);
-    }
+    scheduler->scheduleTask(getHydrationTaskKey(), createHydrationTask(driver),
+                            VROFrameTaskPriority::NearCamera, getHydrationWorkUnits());
+}
+
+uint64_t VROTexture::getHydrationTaskKey() const {
+    return VROFrameTaskKey(VROFrameTaskType::TextureHydration, _textureId);
 }
 
-std::string VROTexture::getHydrationTaskKey() const {
-    return "th_" + VROStringUtil::toString(_textureId);
+double VROTexture::getHydrationWorkUnits() const {
+    return (double) _width * (double) _height * std::max((int) _images.size(), 1);
 }
 
 std::function<void()> VROTexture::createHydrationTask(std::shared_ptr<VRODriver> &driver) {
@@ -195,7 +206,7 @@ std::function<void()> VROTexture::createHydrationTask(std::shared_ptr<VRODriver>
         std::shared_ptr<VRODriver> driver_s = driver_w.lock();
         
         if (texture_s && driver_s) {
-            texture_s->hydrate(driver_s);
+            texture_s->upload(driver_s);
         }
     };
     return hydrationTask;
@@ -214,11 +225,14 @@ VROTextureSubstrate *VROTexture::getSubstrate(int index, std::shared_ptr<VRODriv
         if (immediate) {
             hydrate(driver);
         }
-        else {
-            std::string key = getHydrationTaskKey();
-            if (!driver->getFrameScheduler()->isTaskQueued(key)) {
-                std::function<void()> hydrationTask = createHydrationTask(driver);
-                driver->getFrameScheduler()->scheduleTask(key, hydrationTask);
+        else if (!_uploadPending) {
+            // The texture is needed to draw this frame: schedule its hydration
+            // ahead of everything else (promoting it if it's already queued)
+            const std::shared_ptr<VROFrameScheduler> &scheduler = driver->getFrameScheduler();
+            uint64_t key = getHydrationTaskKey();
+            if (!scheduler->isTaskQueued(key, VROFrameTaskPriority::VisibleNow)) {
+                scheduler->scheduleTask(key, createHydrationTask(driver),
+                                        VROFrameTaskPriority::VisibleNow, getHydrationWorkUnits());
             }
         }
     }
@@ -236,6 +250,13 @@ void VROTexture::setSubstrate(int index, std::unique_ptr<VROTextureSubstrate> su
     _substrates[index] = std::move(substrate);
 }
 
+bool VROTexture::retainSourceData() {
+    if (!_sourceData && _type == VROTextureType::Texture2D && _data.size() == 1) {
+        _sourceData = _data.front();
+    }
+    return _sourceData != nullptr;
+}
+
 void VROTexture::prewarm(std::shared_ptr<VRODriver> driver) {
     hydrate(driver);
 }
@@ -277,6 +298,65 @@ void VROTexture::hydrate(std::shared_ptr<VRODriver> &driver) {
     _hydrationCallbacks.clear();
 }
 
+void VROTexture::upload(std::shared_ptr<VRODriver> &driver) {
+    if (isHydrated() || _uploadPending) {
+        return;
+    }
+    if (_images.empty() && _data.empty()) {
+        hydrate(driver);
+        return;
+    }
+    
+    // Images remain locked until the driver has read their data
+    std::vector<std::shared_ptr<VROData>> data = _data;
+    for (std::shared_ptr<VROImage> &image : _images) {
+        image->lock();
+        
+        size_t length;
+        void *bytes = image->getData(&length);
+        data.push_back(std::make_shared<VROData>(bytes, length, VRODataOwnership::Wrap));
+    }
+    
+    std::weak_ptr<VROTexture> texture_w = shared_from_this();
+    _uploadPending = driver->newTextureSubstrateAsync(_type, _format, _internalFormat, _sRGB, _mipmapMode,
+                                                      data, _images, _width, _height, _mipSizes, _wrapS, _wrapT,
+                                                      _minificationFilter, _magnificationFilter, _mipFilter,
+                                                      [texture_w] (std::unique_ptr<VROTextureSubstrate> substrate) {
+        std::shared_ptr<VROTexture> texture = texture_w.lock();
+        if (texture) {
+            texture->finishUpload(std::move(substrate));
+        }
+    });
+    
+    if (!_uploadPending) {
+        for (std::shared_ptr<VROImage> &image : _images) {
+            image->unlock();
+        }
+        hydrate(driver);
+    }
+}
+
+void VROTexture::finishUpload(std::unique_ptr<VROTextureSubstrate> substrate) {
+    _uploadPending = false;
+    
+    // The texture may have been hydrated synchronously while the upload was in
+    // flight, in which case the uploaded substrate is discarded
+    if (isHydrated()) {
+        return;
+    }
+    
+    // Wrap modes may have changed while the upload was in flight
+    _substrates[0] = std::move(substrate);
+    _substrates[0]->updateWrapMode(_wrapS, _wrapT);
+    _images.clear();
+    _data.clear();
+    
+    for (auto &callback : _hydrationCallbacks) {
+        callback();
+    }
+    _hydrationCallbacks.clear();
+}
+
 int VROTexture::getNumSubstratesForFormat(VROTextureInternalFormat format) const {
     if (format == VROTextureInternalFormat::YCBCR) {
         return 2;
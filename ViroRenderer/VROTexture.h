@@ -59,6 +59,7 @@ enum class VROTextureFormat {
     RGB8,
     RGB9_E5,
     RGB16F,
+    RGBA32F,
 };
 
 // Texture formats for storage on the GPU
@@ -75,6 +76,7 @@ enum class VROTextureInternalFormat {
     RGB9_E5,
     RGB16F,
     RG8,
+    RGBA32F,
 };
 
 enum class VROMipmapMode {
@@ -259,6 +261,25 @@ public:
         _mipFilter = filter;
     }
 
+    /*
+     Retain this texture's source data (in its source format) past hydration, so
+     that it can be read back on the CPU. Used by lighting environments, which
+     are baked into IBL maps on the CPU. Only 2D textures created from a single
+     VROData that have not yet been hydrated can retain their source; returns
+     false otherwise. Once hydrated, the retained data is held in addition to the
+     GPU copy, so it should be released as soon as it has been read.
+     */
+    bool retainSourceData();
+    void releaseSourceData() {
+        _sourceData.reset();
+    }
+    std::shared_ptr<VROData> getSourceData() const {
+        return _sourceData;
+    }
+    VROTextureFormat getFormat() const {
+        return _format;
+    }
+
     /*
      Width and height (available for any 2D texture created through an image).
      */
@@ -297,6 +318,11 @@ private:
      */
     std::vector<std::shared_ptr<VROData>> _data;
     
+    /*
+     Source data retained past hydration, if requested via retainSourceData().
+     */
+    std::shared_ptr<VROData> _sourceData;
+    
     /*
      The format of the source data (_data).
      */
@@ -344,6 +370,11 @@ private:
     VROWrapMode _wrapS, _wrapT;
     VROFilterMode _minificationFilter, _magnificationFilter, _mipFilter;
     
+    /*
+     True while the texture is being uploaded asynchronously by the driver.
+     */
+    bool _uploadPending;
+    
     /*
      Callbacks invoked when the texture is hydrated.
      */
@@ -355,9 +386,19 @@ private:
     void hydrate(std::shared_ptr<VRODriver> &driver);
     
     /*
-     Create a task to hydrate the texture.
+     Converts the image(s) into a substrate over subsequent frames, if the driver
+     supports asynchronous uploads; otherwise hydrates immediately. The upload
+     is completed by finishUpload().
+     */
+    void upload(std::shared_ptr<VRODriver> &driver);
+    void finishUpload(std::unique_ptr<VROTextureSubstrate> substrate);
+    
+    /*
+     Create a task to hydrate the texture. The work units estimate the
+     relative cost of the upload for the VROFrameScheduler.
      */
-    std::string getHydrationTaskKey() const;
+    uint64_t getHydrationTaskKey() const;
+    double getHydrationWorkUnits() const;
     std::function<void()> createHydrationTask(std::shared_ptr<VRODriver> &driver);
     
     /*
@@ -0,0 +1,246 @@
+//
+//  VROTextureDecodePool.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/25/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROTextureDecodePool.h"
+#include "VROTexture.h"
+#include "VROImage.h"
+#include "VROPlatformUtil.h"
+#include "VROLog.h"
+#include <algorithm>
+
+// Decoding is memory bound as much as CPU bound: each in-flight decode
+// holds a compressed and an uncompressed copy of its image, so we keep
+// the pool small even on devices with many cores
+static const int kMaxDecodeWorkers = 3;
+
+std::shared_ptr<VROTextureDecodePool> VROTextureDecodePool::getSharedPool() {
+    static std::shared_ptr<VROTextureDecodePool> sPool = [] {
+        int numWorkers = 0;
+#if !VRO_PLATFORM_WASM
+        numWorkers = std::min((int) std::thread::hardware_concurrency() - 1, kMaxDecodeWorkers);
+        numWorkers = std::max(numWorkers, 1);
+#endif
+        return std::make_shared<VROTextureDecodePool>(numWorkers);
+    }();
+    return sPool;
+}
+
+VROTextureDecodePool::VROTextureDecodePool(int numWorkers) :
+    _stopped(false) {
+    for (int i = 0; i < numWorkers; i++) {
+        _workers.push_back(std::thread(&VROTextureDecodePool::workerLoop, this));
+    }
+    pinfo("Texture decode pool started with %d workers", numWorkers);
+}
+
+VROTextureDecodePool::~VROTextureDecodePool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_all();
+    
+    for (std::thread &worker : _workers) {
+        worker.join();
+    }
+}
+
+#pragma mark - Workers
+
+void VROTextureDecodePool::workerLoop() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this, &job] {
+                if (_stopped) {
+                    return true;
+                }
+                job = nextJob();
+                return job != nullptr;
+            });
+            if (_stopped) {
+                return;
+            }
+        }
+        job->work();
+    }
+}
+
+void VROTextureDecodePool::submit(std::shared_ptr<Job> job) {
+    if (_workers.empty()) {
+        job->started = true;
+        job->work();
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queues[(int) job->priority].push_back(job);
+    }
+    _condition.notify_one();
+}
+
+std::shared_ptr<VROTextureDecodePool::Job> VROTextureDecodePool::nextJob() {
+    for (int p = (int) VROTextureDecodePriority::High; p >= (int) VROTextureDecodePriority::Low; p--) {
+        std::deque<std::shared_ptr<Job>> &queue = _queues[p];
+        while (!queue.empty()) {
+            std::shared_ptr<Job> job = queue.front();
+            queue.pop_front();
+            
+            // Promoted jobs appear in more than one queue; skip the stale entries
+            if (!job->started) {
+                job->started = true;
+                return job;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void VROTextureDecodePool::promoteJob(std::shared_ptr<Job> job, VROTextureDecodePriority priority) {
+    if (job->started || priority <= job->priority) {
+        return;
+    }
+    job->priority = priority;
+    if (!_workers.empty()) {
+        _queues[(int) priority].push_back(job);
+    }
+}
+
+void VROTextureDecodePool::promote(const std::string &key, VROTextureDecodePriority priority) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    auto texture = _textureRequests.find(key);
+    if (texture != _textureRequests.end()) {
+        TextureRequest &request = texture->second;
+        request.priority = std::max(request.priority, priority);
+        if (request.job) {
+            promoteJob(request.job, priority);
+        }
+    }
+    auto image = _imageRequests.find(key);
+    if (image != _imageRequests.end()) {
+        promoteJob(image->second.job, priority);
+    }
+}
+
+#pragma mark - Textures
+
+bool VROTextureDecodePool::requestTexture(const std::string &key, VROTextureDecodePriority priority,
+                                          std::function<void(std::shared_ptr<VROTexture>)> onFinished) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    auto it = _textureRequests.find(key);
+    if (it != _textureRequests.end()) {
+        TextureRequest &request = it->second;
+        request.callbacks.push_back(onFinished);
+        request.priority = std::max(request.priority, priority);
+        if (request.job) {
+            promoteJob(request.job, priority);
+        }
+        return false;
+    }
+    
+    TextureRequest &request = _textureRequests[key];
+    request.priority = priority;
+    request.callbacks.push_back(onFinished);
+    return true;
+}
+
+void VROTextureDecodePool::decodeTexture(const std::string &key, std::function<std::shared_ptr<VROTexture>()> decoder) {
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->key = key;
+    job->started = false;
+    job->work = [this, key, decoder] {
+        completeTexture(key, decoder());
+    };
+    
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        TextureRequest &request = _textureRequests[key];
+        request.job = job;
+        job->priority = request.priority;
+    }
+    submit(job);
+}
+
+void VROTextureDecodePool::completeTexture(const std::string &key, std::shared_ptr<VROTexture> texture) {
+    std::vector<std::function<void(std::shared_ptr<VROTexture>)>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _textureRequests.find(key);
+        if (it == _textureRequests.end()) {
+            return;
+        }
+        callbacks = std::move(it->second.callbacks);
+        _textureRequests.erase(it);
+    }
+    
+    VROPlatformDispatchAsyncRenderer([callbacks, texture] {
+        for (const std::function<void(std::shared_ptr<VROTexture>)> &callback : callbacks) {
+            callback(texture);
+        }
+    });
+}
+
+#pragma mark - Images
+
+std::shared_future<std::shared_ptr<VROImage>> VROTextureDecodePool::decodeImage(const std::string &key, VROTextureDecodePriority priority,
+                                                                                 std::function<std::shared_ptr<VROImage>()> decoder) {
+    std::shared_ptr<Job> job;
+    std::shared_future<std::shared_ptr<VROImage>> future;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _imageRequests.find(key);
+        if (it != _imageRequests.end()) {
+            promoteJob(it->second.job, priority);
+            return it->second.future;
+        }
+        
+        std::shared_ptr<std::promise<std::shared_ptr<VROImage>>> promise = std::make_shared<std::promise<std::shared_ptr<VROImage>>>();
+        future = promise->get_future().share();
+        
+        job = std::make_shared<Job>();
+        job->key = key;
+        job->priority = priority;
+        job->started = false;
+        job->work = [this, key, decoder, promise] {
+            std::shared_ptr<VROImage> image = decoder();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _imageRequests.erase(key);
+            }
+            promise->set_value(image);
+        };
+        
+        ImageRequest &request = _imageRequests[key];
+        request.future = future;
+        request.job = job;
+    }
+    submit(job);
+    return future;
+}
@@ -0,0 +1,197 @@
+//
+//  VROTextureDecodePool.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/25/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROTextureDecodePool_h
+#define VROTextureDecodePool_h
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+class VROTexture;
+class VROImage;
+
+/*
+ Decode priority. Requests are serviced highest priority first, and in
+ request order within a priority. Color maps, which dominate how a model
+ looks while it streams in, should be High; auxiliary maps (normal,
+ specular, roughness, etc.) Normal.
+ */
+enum class VROTextureDecodePriority {
+    Low = 0,
+    Normal = 1,
+    High = 2,
+};
+
+/*
+ Process-wide service that decodes textures for the model loaders on a
+ small, fixed pool of worker threads. Without it every texture of every
+ model would be decoded at once on its own background task, so loading
+ many models at the same time would hold hundreds of decoded images in
+ memory simultaneously.
+
+ Requests are deduplicated by content key: while a texture or image with
+ a given key is being decoded, further requests for that key attach to
+ the in-flight decode instead of starting another. If a duplicate request
+ has a higher priority, the in-flight decode is promoted.
+
+ On platforms without thread support the pool has no workers, and decodes
+ run inline on the requesting thread.
+ */
+class VROTextureDecodePool {
+
+public:
+
+    /*
+     The pool shared by all model loaders.
+     */
+    static std::shared_ptr<VROTextureDecodePool> getSharedPool();
+
+    VROTextureDecodePool(int numWorkers);
+    virtual ~VROTextureDecodePool();
+
+    int getNumWorkers() const {
+        return (int) _workers.size();
+    }
+
+    /*
+     Register a request for the texture with the given content key. Returns
+     true if there is no in-flight decode for the key: the caller must then
+     produce the texture, by either invoking decodeTexture() or
+     completeTexture() with the same key. Otherwise the callback is attached
+     to the in-flight decode and false is returned.
+
+     Callbacks are always invoked on the rendering thread.
+     */
+    bool requestTexture(const std::string &key, VROTextureDecodePriority priority,
+                        std::function<void(std::shared_ptr<VROTexture>)> onFinished);
+
+    /*
+     Run the given decoder on a pool worker and deliver the texture it
+     returns to every request attached to the key.
+     */
+    void decodeTexture(const std::string &key, std::function<std::shared_ptr<VROTexture>()> decoder);
+
+    /*
+     Deliver the given texture (which may be null on failure) to every
+     request attached to the key, without decoding.
+     */
+    void completeTexture(const std::string &key, std::shared_ptr<VROTexture> texture);
+
+    /*
+     Decode an image on a pool worker, returning a future for the result. If
+     an image with the same content key is already being decoded, the future
+     of that decode is returned instead (and promoted to the given priority).
+     This is used by loaders that build their scene off the rendering thread
+     and can block on the result.
+     */
+    std::shared_future<std::shared_ptr<VROImage>> decodeImage(const std::string &key, VROTextureDecodePriority priority,
+                                                              std::function<std::shared_ptr<VROImage>()> decoder);
+
+    /*
+     Raise the priority of the in-flight texture or image decode with the
+     given key, if any. Priorities are never lowered.
+     */
+    void promote(const std::string &key, VROTextureDecodePriority priority);
+
+private:
+
+    /*
+     A unit of work in the queue. A job may be queued at several priorities
+     after promotion; it is run once, by whichever queue reaches it first.
+     */
+    struct Job {
+        std::string key;
+        VROTextureDecodePriority priority;
+        bool started;
+        std::function<void()> work;
+    };
+
+    /*
+     In-flight texture request: the callbacks waiting on the decode, and its
+     job once it has been submitted.
+     */
+    struct TextureRequest {
+        VROTextureDecodePriority priority;
+        std::vector<std::function<void(std::shared_ptr<VROTexture>)>> callbacks;
+        std::shared_ptr<Job> job;
+    };
+
+    /*
+     In-flight image decode.
+     */
+    struct ImageRequest {
+        std::shared_future<std::shared_ptr<VROImage>> future;
+        std::shared_ptr<Job> job;
+    };
+
+    /*
+     Guards everything below.
+     */
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopped;
+
+    /*
+     One FIFO queue per priority, indexed by VROTextureDecodePriority.
+     */
+    std::deque<std::shared_ptr<Job>> _queues[3];
+
+    std::map<std::string, TextureRequest> _textureRequests;
+    std::map<std::string, ImageRequest> _imageRequests;
+
+    std::vector<std::thread> _workers;
+
+    void workerLoop();
+
+    /*
+     Queue the job, or run it inline if the pool has no workers. Must be
+     invoked without holding the mutex.
+     */
+    void submit(std::shared_ptr<Job> job);
+
+    /*
+     Pop the highest priority job that has not yet started. Must be invoked
+     with the mutex held.
+     */
+    std::shared_ptr<Job> nextJob();
+
+    /*
+     Queue an in-flight job at a higher priority. Must be invoked with the
+     mutex held.
+     */
+    void promoteJob(std::shared_ptr<Job> job, VROTextureDecodePriority priority);
+
+};
+
+#endif /* VROTextureDecodePool_h */
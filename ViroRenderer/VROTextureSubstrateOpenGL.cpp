@@ -29,6 +29,7 @@
 #include "VROData.h"
 #include "VRODriverOpenGL.h"
 #include "VROLog.h"
+#include <algorithm>
 
 VROTextureSubstrateOpenGL::VROTextureSubstrateOpenGL(VROTextureType type,
                                                      VROTextureFormat format,
@@ -93,8 +94,8 @@ void VROTextureSubstrateOpenGL::loadTexture(VROTextureType type,
                  mipmapMode, data.front(), width, height, mipSizes);
     }
     else if (type == VROTextureType::TextureCube) {
-        passert_msg (mipmapMode == VROMipmapMode::None,
-                     "Cube textures should not be mipmapped!");
+        passert_msg (mipmapMode != VROMipmapMode::Runtime,
+                     "Cube textures can only use pregenerated mipmaps!");
         passert_msg (data.size() == 6,
                      "Cube textures can only be created from exactly six images");
         
@@ -107,6 +108,11 @@ void VROTextureSubstrateOpenGL::loadTexture(VROTextureType type,
         GL( glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE) );
         GL( glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE) );
         
+        if (mipmapMode == VROMipmapMode::Pregenerated) {
+            // The mip chain need not extend to 1x1
+            GL( glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, (int) mipSizes.size() - 1) );
+        }
+        
         for (int slice = 0; slice < 6; ++slice) {
             loadFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X + slice, format, internalFormat, sRGB,
                      mipmapMode, data[slice], width, height, mipSizes);
@@ -136,7 +142,7 @@ void VROTextureSubstrateOpenGL::loadFace(GLenum target,
             for (int level = 0; level < mipSizes.size(); level++) {
                 uint32_t mipSize = mipSizes[level];
                 GL( glCompressedTexImage2D(target, level, internalFormat,
-                                           width >> level, height >> level, 0,
+                                           std::max(1, width >> level), std::max(1, height >> level), 0,
                                            mipSize, ((const char *)faceData->getData()) + offset) );
                 offset += mipSize;
             }
@@ -177,12 +183,22 @@ void VROTextureSubstrateOpenGL::loadFace(GLenum target,
     else if (format == VROTextureFormat::RGB9_E5) {
         // RGB9_E5 is not color renderable so automatic mipmap generation is not
         // supported
-        passert (mipmapMode == VROMipmapMode::None);
+        passert (mipmapMode != VROMipmapMode::Runtime);
         passert_msg (internalFormat == VROTextureInternalFormat::RGB9_E5,
                      "RGB9_E5 internal format requires RGB9_E5 source data!");
         
-        GL( glTexImage2D(target, 0, GL_RGB9_E5, width, height, 0,
-                         GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, faceData->getData()) );
+        if (mipmapMode == VROMipmapMode::Pregenerated) {
+            uint32_t offset = 0;
+            for (int level = 0; level < (int) mipSizes.size(); level++) {
+                GL( glTexImage2D(target, level, GL_RGB9_E5, std::max(1, width >> level), std::max(1, height >> level), 0,
+                                 GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, ((const char *)faceData->getData()) + offset) );
+                offset += mipSizes[level];
+            }
+        }
+        else {
+            GL( glTexImage2D(target, 0, GL_RGB9_E5, width, height, 0,
+                             GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, faceData->getData()) );
+        }
     }
     else if (format == VROTextureFormat::RGB16F) {
         passert_msg (internalFormat == VROTextureInternalFormat::RGB16F,
@@ -191,6 +207,16 @@ void VROTextureSubstrateOpenGL::loadFace(GLenum target,
         GL( glTexImage2D(target, 0, GL_RGB16F, width, height, 0,
                          GL_RGB, GL_FLOAT, faceData->getData()) );
     }
+    else if (format == VROTextureFormat::RGBA32F) {
+        // RGBA32F is not filterable, so these textures are only used for data
+        // read with texelFetch (e.g. baked animations) and have no mipmaps
+        passert (mipmapMode == VROMipmapMode::None);
+        passert_msg (internalFormat == VROTextureInternalFormat::RGBA32F,
+                     "RGBA32F internal format requires RGBA32F source data!");
+        
+        GL( glTexImage2D(target, 0, GL_RGBA32F, width, height, 0,
+                         GL_RGBA, GL_FLOAT, faceData->getData()) );
+    }
     else if (format == VROTextureFormat::RGB565) {
         passert_msg (internalFormat == VROTextureInternalFormat::RGB565,
                      "RGB565 source format is only compatible with RGB565 internal format!");
@@ -0,0 +1,661 @@
+//
+//  VROTextureTranscoder.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/28/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROTextureTranscoder.h"
+#include "VROData.h"
+#include "VRODefines.h"
+#include "VROLog.h"
+#include <atomic>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+// Images smaller than this (in either dimension) are not worth transcoding
+static const int kMinTranscodeSize = 64;
+
+// Re-encoding is lossy, so it is opt-in
+static std::atomic<bool> sTranscodingEnabled(false);
+
+// Compressed formats the device can sample, as read by the driver; see
+// VRODriver::readTextureFormats()
+static std::atomic<bool> sETC2Supported(false);
+static std::atomic<bool> sASTCSupported(false);
+
+#pragma mark - ETC2 Tables
+
+// ETC1 intensity modifiers: {small, large} per table. Pixel index 0 = +small,
+// 1 = +large, 2 = -small, 3 = -large
+static const int kETCModifiers[8][2] = {
+    {  2,   8 }, {  5,  17 }, {  9,  29 }, { 13,  42 },
+    { 18,  60 }, { 24,  80 }, { 33, 106 }, { 47, 183 },
+};
+
+// Distances for the ETC2 T and H modes
+static const int kETCDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+// EAC alpha modifier tables
+static const int kEACModifiers[16][8] = {
+    { -3, -6,  -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5,  -8, -13, 1, 4, 7, 12 },
+    { -2, -4,  -6, -13, 1, 3, 5, 12 },
+    { -3, -6,  -8, -12, 2, 5, 7, 11 },
+    { -3, -7,  -9, -11, 2, 6, 8, 10 },
+    { -4, -7,  -8, -11, 3, 6, 7, 10 },
+    { -3, -5,  -8, -11, 2, 4, 7, 10 },
+    { -2, -6,  -8, -10, 1, 5, 7,  9 },
+    { -2, -5,  -8, -10, 1, 4, 7,  9 },
+    { -2, -4,  -8, -10, 1, 3, 7,  9 },
+    { -2, -5,  -7, -10, 1, 4, 6,  9 },
+    { -3, -4,  -7, -10, 2, 3, 6,  9 },
+    { -1, -2,  -3, -10, 0, 1, 2,  9 },
+    { -4, -6,  -8,  -9, 3, 5, 7,  8 },
+    { -3, -5,  -7,  -9, 2, 4, 6,  8 },
+};
+
+static inline int clamp255(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+static inline int extend4(int c) {
+    return (c << 4) | c;
+}
+
+static inline int extend5(int c) {
+    return (c << 3) | (c >> 2);
+}
+
+static inline int extend6(int c) {
+    return (c << 2) | (c >> 4);
+}
+
+static inline int extend7(int c) {
+    return (c << 1) | (c >> 6);
+}
+
+static inline uint64_t readBlock(const uint8_t *bytes) {
+    uint64_t block = 0;
+    for (int i = 0; i < 8; i++) {
+        block = (block << 8) | bytes[i];
+    }
+    return block;
+}
+
+static inline void writeBlock(uint64_t block, uint8_t *bytes) {
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = (uint8_t) (block & 0xFF);
+        block >>= 8;
+    }
+}
+
+static inline int bits(uint64_t block, int high, int low) {
+    return (int) ((block >> low) & ((1ULL << (high - low + 1)) - 1));
+}
+
+#pragma mark - ETC2 Decoding
+
+/*
+ Decode an ETC2 RGB block into 16 RGBA pixels (alpha untouched), in row-major
+ order. Pixel indices within the block are stored column-major.
+ */
+static void decodeColorBlock(uint64_t block, uint8_t out[16][4]) {
+    uint32_t indices = (uint32_t) (block & 0xFFFFFFFF);
+    bool diff = (block >> 33) & 1;
+    bool flip = (block >> 32) & 1;
+    
+    int base[2][3];
+    if (!diff) {
+        for (int c = 0; c < 3; c++) {
+            base[0][c] = extend4(bits(block, 63 - c * 8, 60 - c * 8));
+            base[1][c] = extend4(bits(block, 59 - c * 8, 56 - c * 8));
+        }
+    }
+    else {
+        int b1[3], b2[3];
+        for (int c = 0; c < 3; c++) {
+            b1[c] = bits(block, 63 - c * 8, 59 - c * 8);
+            int delta = bits(block, 58 - c * 8, 56 - c * 8);
+            b2[c] = b1[c] + (delta >= 4 ? delta - 8 : delta);
+        }
+        
+        if (b2[0] < 0 || b2[0] > 31) {
+            // T mode
+            int c1[3] = { extend4((bits(block, 60, 59) << 2) | bits(block, 57, 56)),
+                          extend4(bits(block, 55, 52)), extend4(bits(block, 51, 48)) };
+            int c2[3] = { extend4(bits(block, 47, 44)), extend4(bits(block, 43, 40)), extend4(bits(block, 39, 36)) };
+            int d = kETCDistances[(bits(block, 35, 34) << 1) | bits(block, 32, 32)];
+            
+            int paint[4][3];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = c1[c];
+                paint[1][c] = clamp255(c2[c] + d);
+                paint[2][c] = c2[c];
+                paint[3][c] = clamp255(c2[c] - d);
+            }
+            for (int i = 0; i < 16; i++) {
+                int x = i / 4, y = i % 4;
+                int index = (((indices >> (i + 16)) & 1) << 1) | ((indices >> i) & 1);
+                for (int c = 0; c < 3; c++) {
+                    out[y * 4 + x][c] = (uint8_t) paint[index][c];
+                }
+            }
+            return;
+        }
+        else if (b2[1] < 0 || b2[1] > 31) {
+            // H mode
+            int r1 = bits(block, 62, 59);
+            int g1 = (bits(block, 58, 56) << 1) | bits(block, 52, 52);
+            int bl1 = (bits(block, 51, 51) << 3) | bits(block, 49, 47);
+            int r2 = bits(block, 46, 43);
+            int g2 = bits(block, 42, 39);
+            int bl2 = bits(block, 38, 35);
+            
+            int v1 = (r1 << 8) | (g1 << 4) | bl1;
+            int v2 = (r2 << 8) | (g2 << 4) | bl2;
+            int d = kETCDistances[(bits(block, 34, 34) << 2) | (bits(block, 32, 32) << 1) | (v1 >= v2 ? 1 : 0)];
+            
+            int c1[3] = { extend4(r1), extend4(g1), extend4(bl1) };
+            int c2[3] = { extend4(r2), extend4(g2), extend4(bl2) };
+            int paint[4][3];
+            for (int c = 0; c < 3; c++) {
+                paint[0][c] = clamp255(c1[c] + d);
+                paint[1][c] = clamp255(c1[c] - d);
+                paint[2][c] = clamp255(c2[c] + d);
+                paint[3][c] = clamp255(c2[c] - d);
+            }
+            for (int i = 0; i < 16; i++) {
+                int x = i / 4, y = i % 4;
+                int index = (((indices >> (i + 16)) & 1) << 1) | ((indices >> i) & 1);
+                for (int c = 0; c < 3; c++) {
+                    out[y * 4 + x][c] = (uint8_t) paint[index][c];
+                }
+            }
+            return;
+        }
+        else if (b2[2] < 0 || b2[2] > 31) {
+            // Planar mode
+            int o[3] = { extend6(bits(block, 62, 57)),
+                         extend7((bits(block, 56, 56) << 6) | bits(block, 54, 49)),
+                         extend6((bits(block, 48, 48) << 5) | (bits(block, 44, 43) << 3) | bits(block, 41, 39)) };
+            int h[3] = { extend6((bits(block, 38, 34) << 1) | bits(block, 32, 32)),
+                         extend7(bits(block, 31, 25)),
+                         extend6(bits(block, 24, 19)) };
+            int v[3] = { extend6(bits(block, 18, 13)),
+                         extend7(bits(block, 12, 6)),
+                         extend6(bits(block, 5, 0)) };
+            for (int y = 0; y < 4; y++) {
+                for (int x = 0; x < 4; x++) {
+                    for (int c = 0; c < 3; c++) {
+                        int value = (x * (h[c] - o[c]) + y * (v[c] - o[c]) + 4 * o[c] + 2) >> 2;
+                        out[y * 4 + x][c] = (uint8_t) clamp255(value);
+                    }
+                }
+            }
+            return;
+        }
+        
+        for (int c = 0; c < 3; c++) {
+            base[0][c] = extend5(b1[c]);
+            base[1][c] = extend5(b2[c]);
+        }
+    }
+    
+    // Individual or differential mode
+    int tables[2] = { bits(block, 39, 37), bits(block, 36, 34) };
+    for (int i = 0; i < 16; i++) {
+        int x = i / 4, y = i % 4;
+        int subblock = flip ? (y >= 2) : (x >= 2);
+        int index = (((indices >> (i + 16)) & 1) << 1) | ((indices >> i) & 1);
+        
+        const int *modifiers = kETCModifiers[tables[subblock]];
+        int modifier = (index & 1) ? modifiers[1] : modifiers[0];
+        if (index & 2) {
+            modifier = -modifier;
+        }
+        for (int c = 0; c < 3; c++) {
+            out[y * 4 + x][c] = (uint8_t) clamp255(base[subblock][c] + modifier);
+        }
+    }
+}
+
+static void decodeAlphaBlock(uint64_t block, uint8_t out[16][4]) {
+    int base = bits(block, 63, 56);
+    int multiplier = bits(block, 55, 52);
+    const int *modifiers = kEACModifiers[bits(block, 51, 48)];
+    
+    for (int i = 0; i < 16; i++) {
+        int x = i / 4, y = i % 4;
+        int index = bits(block, 47 - i * 3, 45 - i * 3);
+        out[y * 4 + x][3] = (uint8_t) clamp255(base + modifiers[index] * multiplier);
+    }
+}
+
+#pragma mark - ETC2 Encoding
+
+/*
+ Find the best intensity table for the given pixels around the given base color.
+ Returns the error, and writes the table and per-pixel index values.
+ */
+static int fitSubblock(const int base[3], const uint8_t *pixels[8], int *outTable, int outIndices[8]) {
+    int bestError = INT_MAX;
+    for (int table = 0; table < 8; table++) {
+        int small = kETCModifiers[table][0];
+        int large = kETCModifiers[table][1];
+        
+        int tableError = 0;
+        int indices[8];
+        for (int p = 0; p < 8 && tableError < bestError; p++) {
+            // The modifier is applied equally to all channels, so (ignoring clamping)
+            // the best one is that nearest the mean channel difference
+            int offset = (pixels[p][0] - base[0]) + (pixels[p][1] - base[1]) + (pixels[p][2] - base[2]);
+            bool useLarge = std::abs(offset) * 2 > (small + large) * 3;
+            int index = (offset >= 0 ? 0 : 2) | (useLarge ? 1 : 0);
+            int modifier = (useLarge ? large : small) * (offset >= 0 ? 1 : -1);
+            
+            for (int c = 0; c < 3; c++) {
+                int d = clamp255(base[c] + modifier) - pixels[p][c];
+                tableError += d * d;
+            }
+            indices[p] = index;
+        }
+        if (tableError < bestError) {
+            bestError = tableError;
+            *outTable = table;
+            memcpy(outIndices, indices, sizeof(indices));
+        }
+    }
+    return bestError;
+}
+
+/*
+ Encode 16 RGBA pixels (row-major) into an ETC1-compatible ETC2 color block,
+ trying both subblock orientations in individual and differential modes.
+ */
+static uint64_t encodeColorBlock(const uint8_t pixels[16][4]) {
+    int bestError = INT_MAX;
+    uint64_t bestBlock = 0;
+    
+    for (int flip = 0; flip < 2; flip++) {
+        // Gather the pixels of each subblock, remembering their positions
+        const uint8_t *subPixels[2][8];
+        int subPositions[2][8];
+        int counts[2] = { 0, 0 };
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                int subblock = flip ? (y >= 2) : (x >= 2);
+                subPixels[subblock][counts[subblock]] = pixels[y * 4 + x];
+                subPositions[subblock][counts[subblock]] = x * 4 + y;
+                counts[subblock]++;
+            }
+        }
+        
+        float average[2][3];
+        for (int s = 0; s < 2; s++) {
+            for (int c = 0; c < 3; c++) {
+                int sum = 0;
+                for (int p = 0; p < 8; p++) {
+                    sum += subPixels[s][p][c];
+                }
+                average[s][c] = sum / 8.0f;
+            }
+        }
+        
+        for (int diff = 0; diff < 2; diff++) {
+            int quantized[2][3];
+            int base[2][3];
+            bool representable = true;
+            for (int s = 0; s < 2; s++) {
+                for (int c = 0; c < 3; c++) {
+                    if (diff) {
+                        quantized[s][c] = std::min(31, (int) (average[s][c] * 31.0f / 255.0f + 0.5f));
+                        base[s][c] = extend5(quantized[s][c]);
+                    }
+                    else {
+                        quantized[s][c] = std::min(15, (int) (average[s][c] * 15.0f / 255.0f + 0.5f));
+                        base[s][c] = extend4(quantized[s][c]);
+                    }
+                }
+            }
+            if (diff) {
+                for (int c = 0; c < 3; c++) {
+                    int delta = quantized[1][c] - quantized[0][c];
+                    if (delta < -4 || delta > 3) {
+                        representable = false;
+                    }
+                }
+            }
+            if (!representable) {
+                continue;
+            }
+            
+            int tables[2];
+            int indices[2][8];
+            int error = fitSubblock(base[0], subPixels[0], &tables[0], indices[0]);
+            if (error >= bestError) {
+                continue;
+            }
+            error += fitSubblock(base[1], subPixels[1], &tables[1], indices[1]);
+            if (error >= bestError) {
+                continue;
+            }
+            bestError = error;
+            
+            uint64_t block = 0;
+            for (int c = 0; c < 3; c++) {
+                int shift = 56 - c * 8;
+                if (diff) {
+                    int delta = (quantized[1][c] - quantized[0][c]) & 0x7;
+                    block |= (uint64_t) ((quantized[0][c] << 3) | delta) << shift;
+                }
+                else {
+                    block |= (uint64_t) ((quantized[0][c] << 4) | quantized[1][c]) << shift;
+                }
+            }
+            block |= (uint64_t) tables[0] << 37;
+            block |= (uint64_t) tables[1] << 34;
+            block |= (uint64_t) diff << 33;
+            block |= (uint64_t) flip << 32;
+            for (int s = 0; s < 2; s++) {
+                for (int p = 0; p < 8; p++) {
+                    int position = subPositions[s][p];
+                    int index = indices[s][p];
+                    block |= (uint64_t) (index >> 1) << (position + 16);
+                    block |= (uint64_t) (index & 1) << position;
+                }
+            }
+            bestBlock = block;
+        }
+    }
+    return bestBlock;
+}
+
+static uint64_t encodeAlphaBlock(const uint8_t pixels[16][4]) {
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; i++) {
+        minAlpha = std::min(minAlpha, (int) pixels[i][3]);
+        maxAlpha = std::max(maxAlpha, (int) pixels[i][3]);
+    }
+    
+    // Constant alpha (typically opaque) is encoded exactly with the table that
+    // contains a zero modifier
+    if (minAlpha == maxAlpha) {
+        uint64_t block = ((uint64_t) minAlpha << 56) | ((uint64_t) 1 << 52) | ((uint64_t) 13 << 48);
+        for (int i = 0; i < 16; i++) {
+            block |= (uint64_t) 4 << (45 - i * 3);
+        }
+        return block;
+    }
+    
+    int bestError = INT_MAX;
+    int bestBase = 0, bestMultiplier = 1, bestTable = 0;
+    int bestIndices[16] = { 0 };
+    
+    for (int table = 0; table < 16; table++) {
+        const int *modifiers = kEACModifiers[table];
+        int low = modifiers[3], high = modifiers[7];
+        
+        // Scale the table to span the alpha range, centered on it
+        int multiplier = std::max(1, std::min(15, (maxAlpha - minAlpha + (high - low) - 1) / (high - low)));
+        int center = (int) ((minAlpha + maxAlpha) / 2.0f - (low + high) * multiplier / 2.0f + 0.5f);
+        
+        for (int base = center - 1; base <= center + 1; base++) {
+            if (base < 0 || base > 255) {
+                continue;
+            }
+            int error = 0;
+            int indices[16];
+            for (int i = 0; i < 16 && error < bestError; i++) {
+                int bestPixelError = INT_MAX;
+                for (int index = 0; index < 8; index++) {
+                    int d = clamp255(base + modifiers[index] * multiplier) - pixels[i][3];
+                    if (d * d < bestPixelError) {
+                        bestPixelError = d * d;
+                        indices[i] = index;
+                    }
+                }
+                error += bestPixelError;
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestBase = base;
+                bestMultiplier = multiplier;
+                bestTable = table;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+        if (bestError == 0) {
+            break;
+        }
+    }
+    
+    uint64_t block = ((uint64_t) bestBase << 56) | ((uint64_t) bestMultiplier << 52) | ((uint64_t) bestTable << 48);
+    for (int i = 0; i < 16; i++) {
+        // Pixels are stored column-major
+        int x = i / 4, y = i % 4;
+        block |= (uint64_t) bestIndices[y * 4 + x] << (45 - i * 3);
+    }
+    return block;
+}
+
+static size_t getETC2LevelSize(int width, int height) {
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * 16;
+}
+
+static void encodeETC2Level(const uint8_t *rgba, int width, int height, uint8_t *out) {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    
+    uint8_t pixels[16][4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            // Edge blocks replicate the last row and column
+            for (int y = 0; y < 4; y++) {
+                int sy = std::min(by * 4 + y, height - 1);
+                for (int x = 0; x < 4; x++) {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    memcpy(pixels[y * 4 + x], rgba + ((size_t) sy * width + sx) * 4, 4);
+                }
+            }
+            
+            uint8_t *block = out + ((size_t) by * blocksX + bx) * 16;
+            writeBlock(encodeAlphaBlock(pixels), block);
+            writeBlock(encodeColorBlock(pixels), block + 8);
+        }
+    }
+}
+
+/*
+ Downsample RGBA8 data by half with a box filter. Odd dimensions clamp.
+ */
+static std::vector<uint8_t> downsample(const uint8_t *rgba, int width, int height, int *outWidth, int *outHeight) {
+    int w = std::max(1, width / 2);
+    int h = std::max(1, height / 2);
+    std::vector<uint8_t> result((size_t) w * h * 4);
+    
+    for (int y = 0; y < h; y++) {
+        int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < w; x++) {
+            int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = rgba[((size_t) y0 * width + x0) * 4 + c] + rgba[((size_t) y0 * width + x1) * 4 + c] +
+                          rgba[((size_t) y1 * width + x0) * 4 + c] + rgba[((size_t) y1 * width + x1) * 4 + c];
+                result[((size_t) y * w + x) * 4 + c] = (uint8_t) ((sum + 2) / 4);
+            }
+        }
+    }
+    *outWidth = w;
+    *outHeight = h;
+    return result;
+}
+
+#pragma mark - VROTranscodedImage
+
+VROTranscodedImage::VROTranscodedImage(std::shared_ptr<VROData> data, VROTextureFormat format,
+                                       int width, int height, std::vector<uint32_t> mipSizes) :
+    _data(data),
+    _width(width),
+    _height(height),
+    _mipSizes(mipSizes) {
+    _format = format;
+    _internalFormat = VROTextureInternalFormat::RGBA8;
+}
+
+VROTranscodedImage::~VROTranscodedImage() {
+    
+}
+
+unsigned char *VROTranscodedImage::getData(size_t *length) {
+    *length = _data->getDataLength();
+    return (unsigned char *) _data->getData();
+}
+
+#pragma mark - VROTextureTranscoder
+
+bool VROTextureTranscoder::isFormatSupported(VROTextureFormat format) {
+    switch (format) {
+        case VROTextureFormat::ETC2_RGBA8_EAC:
+            return sETC2Supported;
+        case VROTextureFormat::ASTC_4x4_LDR:
+            return sASTCSupported;
+        default:
+            return true;
+    }
+}
+
+void VROTextureTranscoder::setFormatSupported(VROTextureFormat format, bool supported) {
+    switch (format) {
+        case VROTextureFormat::ETC2_RGBA8_EAC:
+            sETC2Supported = supported;
+            break;
+        case VROTextureFormat::ASTC_4x4_LDR:
+            sASTCSupported = supported;
+            break;
+        default:
+            pwarn("Support for uncompressed texture format %d is assumed", (int) format);
+            break;
+    }
+}
+
+void VROTextureTranscoder::setTranscodingEnabled(bool enabled) {
+    sTranscodingEnabled = enabled;
+}
+
+bool VROTextureTranscoder::isTranscodingEnabled() {
+    return sTranscodingEnabled;
+}
+
+std::shared_ptr<VROImage> VROTextureTranscoder::transcode(std::shared_ptr<VROImage> image) {
+    if (!image || !sTranscodingEnabled || !isFormatSupported(VROTextureFormat::ETC2_RGBA8_EAC)) {
+        return image;
+    }
+    if (image->getFormat() != VROTextureFormat::RGBA8 || image->getInternalFormat() != VROTextureInternalFormat::RGBA8) {
+        return image;
+    }
+    
+    int width = image->getWidth();
+    int height = image->getHeight();
+    if (width < kMinTranscodeSize || height < kMinTranscodeSize) {
+        return image;
+    }
+    
+    std::shared_ptr<VROData> data;
+    std::vector<uint32_t> mipSizes;
+    
+    image->lock();
+    {
+        size_t length;
+        const uint8_t *rgba = image->getData(&length);
+        if (rgba != nullptr && length >= (size_t) width * height * 4) {
+            data = encodeETC2(rgba, width, height, &mipSizes);
+        }
+    }
+    image->unlock();
+    
+    if (!data) {
+        return image;
+    }
+    return std::make_shared<VROTranscodedImage>(data, VROTextureFormat::ETC2_RGBA8_EAC, width, height, mipSizes);
+}
+
+std::shared_ptr<VROData> VROTextureTranscoder::encodeETC2(const uint8_t *rgba, int width, int height,
+                                                          std::vector<uint32_t> *outMipSizes) {
+    size_t total = 0;
+    for (int w = width, h = height; ; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        total += getETC2LevelSize(w, h);
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+    
+    uint8_t *out = (uint8_t *) malloc(total);
+    size_t offset = 0;
+    
+    std::vector<uint8_t> level;
+    const uint8_t *levelData = rgba;
+    int w = width, h = height;
+    while (true) {
+        size_t levelSize = getETC2LevelSize(w, h);
+        encodeETC2Level(levelData, w, h, out + offset);
+        outMipSizes->push_back((uint32_t) levelSize);
+        offset += levelSize;
+        
+        if (w == 1 && h == 1) {
+            break;
+        }
+        level = downsample(levelData, w, h, &w, &h);
+        levelData = level.data();
+    }
+    return std::make_shared<VROData>(out, total, VRODataOwnership::Move);
+}
+
+std::shared_ptr<VROData> VROTextureTranscoder::decodeETC2(const uint8_t *data, size_t length, int width, int height) {
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    if (length < getETC2LevelSize(width, height)) {
+        pwarn("ETC2 data too short for %d x %d texture", width, height);
+        return nullptr;
+    }
+    
+    size_t outLength = (size_t) width * height * 4;
+    uint8_t *out = (uint8_t *) malloc(outLength);
+    
+    uint8_t pixels[16][4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            const uint8_t *block = data + ((size_t) by * blocksX + bx) * 16;
+            decodeAlphaBlock(readBlock(block), pixels);
+            decodeColorBlock(readBlock(block + 8), pixels);
+            
+            for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    memcpy(out + ((size_t) (by * 4 + y) * width + bx * 4 + x) * 4, pixels[y * 4 + x], 4);
+                }
+            }
+        }
+    }
+    return std::make_shared<VROData>(out, outLength, VRODataOwnership::Move);
+}
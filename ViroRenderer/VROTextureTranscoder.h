@@ -0,0 +1,129 @@
+//
+//  VROTextureTranscoder.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/28/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROTextureTranscoder_h
+#define VROTextureTranscoder_h
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "VROImage.h"
+
+class VROData;
+
+/*
+ An image whose data has been transcoded into a GPU (typically block
+ compressed) format. The data contains the full mip chain, with successive
+ levels concatenated; getMipSizes() returns the size of each level.
+ */
+class VROTranscodedImage : public VROImage {
+    
+public:
+    
+    VROTranscodedImage(std::shared_ptr<VROData> data, VROTextureFormat format,
+                       int width, int height, std::vector<uint32_t> mipSizes);
+    virtual ~VROTranscodedImage();
+    
+    int getWidth() const {
+        return _width;
+    }
+    int getHeight() const {
+        return _height;
+    }
+    unsigned char *getData(size_t *length);
+    std::vector<uint32_t> getMipSizes() const {
+        return _mipSizes;
+    }
+    
+private:
+    
+    std::shared_ptr<VROData> _data;
+    int _width, _height;
+    std::vector<uint32_t> _mipSizes;
+    
+};
+
+/*
+ Converts decoded images into the most compact texture format the device
+ supports, and converts compressed texture data the device cannot sample into
+ uncompressed RGBA8.
+ 
+ Where the device supports ETC2 (it is core in OpenGL ES 3.0, but only an
+ extension in WebGL), RGBA8 color textures may be encoded to ETC2 RGBA8 EAC (a
+ quarter of the memory) with a pregenerated mip chain. This encoding is lossy,
+ so it is only performed if the app opts in with setTranscodingEnabled().
+ Input that is already ETC2 (e.g. KTX files) is always used as is where
+ supported, and decoded to RGBA8 elsewhere.
+ 
+ Transcoding is CPU intensive, and is meant to be run on the background threads
+ that decode images (see VROTextureDecodePool). It is only applied to color
+ textures: block compression artifacts are far more visible in normal maps and
+ other data textures.
+ */
+class VROTextureTranscoder {
+    
+public:
+    
+    /*
+     True if the device can sample textures in the given format. Support for
+     compressed formats is read from the GPU by the driver when the renderer
+     initializes (see VRODriver::readTextureFormats()); until then they are
+     reported as unsupported.
+     */
+    static bool isFormatSupported(VROTextureFormat format);
+    static void setFormatSupported(VROTextureFormat format, bool supported);
+    
+    /*
+     Enable or disable lossy transcoding of decoded color textures (PNG, JPEG,
+     etc.) to ETC2. Disabled by default. Decoding of ETC2 input on devices that
+     cannot sample it is unaffected.
+     */
+    static void setTranscodingEnabled(bool enabled);
+    static bool isTranscodingEnabled();
+    
+    /*
+     Transcode the given RGBA8 color image to the best supported compressed
+     format. Returns the image itself if transcoding is disabled, not supported,
+     or not worthwhile (e.g. for very small images).
+     */
+    static std::shared_ptr<VROImage> transcode(std::shared_ptr<VROImage> image);
+    
+    /*
+     Encode RGBA8 data to ETC2 RGBA8 EAC, generating the full mip chain. The size
+     of each level is returned in outMipSizes.
+     */
+    static std::shared_ptr<VROData> encodeETC2(const uint8_t *rgba, int width, int height,
+                                               std::vector<uint32_t> *outMipSizes);
+    
+    /*
+     Decode a single level of ETC2 RGBA8 EAC data to RGBA8.
+     */
+    static std::shared_ptr<VROData> decodeETC2(const uint8_t *data, size_t length, int width, int height);
+    
+};
+
+#endif /* VROTextureTranscoder_h */
@@ -0,0 +1,212 @@
+//
+//  VROTextureTranscoderTest.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/7/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROTextureTranscoderTest.h"
+#include "VROTestUtil.h"
+#include "VROPortal.h"
+#include "VROSurface.h"
+#include "VROTextureTranscoder.h"
+#include "VROData.h"
+#include <cmath>
+
+static const int kGradientSize = 128;
+
+// ETC2 typically reaches 40dB on smooth gradients; this leaves headroom while
+// still catching broken modes or mismatched block layouts
+static const double kMinRoundTripPSNR = 35.0;
+
+/*
+ A 4x4 ETC2 RGBA8 EAC block (EAC alpha followed by ETC2 color) and its expected
+ decoding, in row-major RGBA. Pixels within a block are indexed column-major.
+ */
+struct VROETC2TestBlock {
+    const char *name;
+    uint8_t block[16];
+    uint8_t defaultPixel[4];
+    
+    // Pixels that differ from the default, as { x, y, r, g, b, a }
+    int numExceptions;
+    uint8_t exceptions[3][6];
+};
+
+static const VROETC2TestBlock kTestBlocks[] = {
+    {
+        /*
+         Alpha: base 200, multiplier 1, table 0, every index 4 (+2) -> 202.
+         Color: individual mode, both subblocks RGB444 (8, 4, 2) -> (136, 68, 34),
+         table 0, every index 0 (+2).
+         */
+        "individual",
+        { 200, 0x10, 0x92, 0x49, 0x24, 0x92, 0x49, 0x24,
+          0x88, 0x44, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00 },
+        { 138, 70, 36, 202 },
+        0, {},
+    },
+    {
+        /*
+         Alpha: base 100, multiplier 2, table 0. Pixel (0, 0) has index 7 (+28),
+         (1, 0) index 0 (-6), and the rest index 4 (+4).
+         Color: differential mode, base RGB555 (16, 8, 4) -> (132, 66, 33) with zero
+         deltas, table 1 (5, 17). Pixel (0, 0) has index 1 (+17), (1, 0) index 2 (-5),
+         (0, 1) index 3 (-17), and the rest index 0 (+5).
+         */
+        "differential",
+        { 100, 0x20, 0xF2, 0x41, 0x24, 0x92, 0x49, 0x24,
+          0x80, 0x40, 0x20, 0x26, 0x00, 0x12, 0x00, 0x03 },
+        { 137, 71, 38, 104 },
+        3, { { 0, 0, 149, 83, 50, 128 },
+             { 1, 0, 127, 61, 28,  94 },
+             { 0, 1, 115, 49, 16, 104 } },
+    },
+};
+
+VROTextureTranscoderTest::VROTextureTranscoderTest() :
+    VRORendererTest(VRORendererTestType::TextureTranscoder) {
+        
+}
+
+VROTextureTranscoderTest::~VROTextureTranscoderTest() {
+    
+}
+
+void VROTextureTranscoderTest::build(std::shared_ptr<VRORenderer> renderer,
+                                     std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+                                     std::shared_ptr<VRODriver> driver) {
+    _sceneController = std::make_shared<VROSceneController>();
+    std::shared_ptr<VROScene> scene = _sceneController->getScene();
+    
+    std::shared_ptr<VROPortal> rootNode = scene->getRootNode();
+    rootNode->setPosition({0, 0, 0});
+    
+    verifyFixedBlocks();
+    
+    /*
+     Round-trip a gradient, with a varying alpha and a wave in blue so that every
+     block has some detail.
+     */
+    std::vector<uint8_t> source(kGradientSize * kGradientSize * 4);
+    for (int y = 0; y < kGradientSize; y++) {
+        for (int x = 0; x < kGradientSize; x++) {
+            uint8_t *pixel = &source[(y * kGradientSize + x) * 4];
+            pixel[0] = x * 255 / (kGradientSize - 1);
+            pixel[1] = y * 255 / (kGradientSize - 1);
+            pixel[2] = (uint8_t) (128 + 100 * sin(x * 0.1) * cos(y * 0.07));
+            pixel[3] = (x + y) * 255 / (2 * kGradientSize - 2);
+        }
+    }
+    
+    std::vector<uint32_t> mipSizes;
+    std::shared_ptr<VROData> encoded = VROTextureTranscoder::encodeETC2(source.data(), kGradientSize, kGradientSize, &mipSizes);
+    passert_msg(mipSizes.size() == (size_t) log2(kGradientSize) + 1, "Expected a full mip chain, found %d levels",
+                (int) mipSizes.size());
+    
+    std::shared_ptr<VROData> decoded = VROTextureTranscoder::decodeETC2((const uint8_t *) encoded->getData(), mipSizes[0],
+                                                                        kGradientSize, kGradientSize);
+    double psnr = computePSNR(source.data(), (const uint8_t *) decoded->getData(), source.size());
+    pinfo("ETC2 round trip of %dx%d gradient: PSNR %f dB", kGradientSize, kGradientSize, psnr);
+    passert_msg(psnr >= kMinRoundTripPSNR, "ETC2 round trip PSNR %f dB is below %f dB", psnr, kMinRoundTripPSNR);
+    
+    std::vector<std::shared_ptr<VROData>> sourceData = { std::make_shared<VROData>(source.data(), source.size()) };
+    std::shared_ptr<VROTexture> sourceTexture = std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::RGBA8,
+                                                                             VROTextureInternalFormat::RGBA8, true, VROMipmapMode::Runtime,
+                                                                             sourceData, kGradientSize, kGradientSize,
+                                                                             std::vector<uint32_t>());
+    std::shared_ptr<VROTexture> transcodedTexture;
+    if (VROTextureTranscoder::isFormatSupported(VROTextureFormat::ETC2_RGBA8_EAC)) {
+        std::vector<std::shared_ptr<VROData>> encodedData = { encoded };
+        transcodedTexture = std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::ETC2_RGBA8_EAC,
+                                                         VROTextureInternalFormat::RGBA8, true, VROMipmapMode::Pregenerated,
+                                                         encodedData, kGradientSize, kGradientSize, mipSizes);
+    }
+    else {
+        pinfo("ETC2 not supported by this GPU, displaying decoded RGBA8");
+        std::vector<std::shared_ptr<VROData>> decodedData = { decoded };
+        transcodedTexture = std::make_shared<VROTexture>(VROTextureType::Texture2D, VROTextureFormat::RGBA8,
+                                                         VROTextureInternalFormat::RGBA8, true, VROMipmapMode::Runtime,
+                                                         decodedData, kGradientSize, kGradientSize,
+                                                         std::vector<uint32_t>());
+    }
+    
+    rootNode->addChildNode(createQuad(sourceTexture, { -0.6, 0, -3 }));
+    rootNode->addChildNode(createQuad(transcodedTexture, { 0.6, 0, -3 }));
+    
+    std::shared_ptr<VRONodeCamera> camera = std::make_shared<VRONodeCamera>();
+    std::shared_ptr<VRONode> cameraNode = std::make_shared<VRONode>();
+    cameraNode->setCamera(camera);
+    rootNode->addChildNode(cameraNode);
+    
+    _pointOfView = cameraNode;
+}
+
+void VROTextureTranscoderTest::verifyFixedBlocks() {
+    for (const VROETC2TestBlock &test : kTestBlocks) {
+        std::shared_ptr<VROData> decoded = VROTextureTranscoder::decodeETC2(test.block, sizeof(test.block), 4, 4);
+        const uint8_t *pixels = (const uint8_t *) decoded->getData();
+        
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 4; x++) {
+                const uint8_t *expected = test.defaultPixel;
+                for (int e = 0; e < test.numExceptions; e++) {
+                    if (test.exceptions[e][0] == x && test.exceptions[e][1] == y) {
+                        expected = &test.exceptions[e][2];
+                    }
+                }
+                
+                const uint8_t *actual = &pixels[(y * 4 + x) * 4];
+                passert_msg(memcmp(actual, expected, 4) == 0,
+                            "ETC2 %s block: pixel (%d, %d) decoded to (%d, %d, %d, %d), expected (%d, %d, %d, %d)",
+                            test.name, x, y, actual[0], actual[1], actual[2], actual[3],
+                            expected[0], expected[1], expected[2], expected[3]);
+            }
+        }
+    }
+    pinfo("Verified %d fixed ETC2 blocks", (int) (sizeof(kTestBlocks) / sizeof(VROETC2TestBlock)));
+}
+
+double VROTextureTranscoderTest::computePSNR(const uint8_t *a, const uint8_t *b, size_t length) {
+    double squaredError = 0;
+    for (size_t i = 0; i < length; i++) {
+        double difference = (double) a[i] - (double) b[i];
+        squaredError += difference * difference;
+    }
+    if (squaredError == 0) {
+        return INFINITY;
+    }
+    double mse = squaredError / length;
+    return 10 * log10(255.0 * 255.0 / mse);
+}
+
+std::shared_ptr<VRONode> VROTextureTranscoderTest::createQuad(std::shared_ptr<VROTexture> texture, VROVector3f position) {
+    std::shared_ptr<VROSurface> surface = VROSurface::createSurface(1, 1);
+    surface->getMaterials().front()->setLightingModel(VROLightingModel::Constant);
+    surface->getMaterials().front()->getDiffuse().setTexture(texture);
+    
+    std::shared_ptr<VRONode> node = std::make_shared<VRONode>();
+    node->setGeometry(surface);
+    node->setPosition(position);
+    return node;
+}
@@ -0,0 +1,70 @@
+//
+//  VROTextureTranscoderTest.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 11/7/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROTextureTranscoderTest_h
+#define VROTextureTranscoderTest_h
+
+#include "VRORendererTest.h"
+
+class VROTexture;
+
+/*
+ Verifies the ETC2 RGBA8 EAC encoder and decoder of VROTextureTranscoder. Fixed
+ blocks, exercising the individual and differential ETC1 modes and the EAC alpha
+ indices, are decoded and compared against values worked out from the format
+ specification. A gradient is then encoded and decoded, and must round-trip above
+ a minimum PSNR. The source gradient and its transcoded counterpart are displayed
+ side by side; the latter is sampled as ETC2 if the GPU supports it.
+ */
+class VROTextureTranscoderTest : public VRORendererTest {
+public:
+    
+    VROTextureTranscoderTest();
+    virtual ~VROTextureTranscoderTest();
+    
+    void build(std::shared_ptr<VRORenderer> renderer,
+               std::shared_ptr<VROFrameSynchronizer> frameSynchronizer,
+               std::shared_ptr<VRODriver> driver);
+    std::shared_ptr<VRONode> getPointOfView() {
+        return _pointOfView;
+    }
+    std::shared_ptr<VROSceneController> getSceneController() {
+        return _sceneController;
+    }
+    
+private:
+    
+    std::shared_ptr<VRONode> _pointOfView;
+    std::shared_ptr<VROSceneController> _sceneController;
+    
+    static void verifyFixedBlocks();
+    static double computePSNR(const uint8_t *a, const uint8_t *b, size_t length);
+    static std::shared_ptr<VRONode> createQuad(std::shared_ptr<VROTexture> texture, VROVector3f position);
+    
+};
+
+#endif /* VROTextureTranscoderTest_h */
@@ -59,6 +59,10 @@ void VROThreadRestricted::unsetThread() {
     tThreadName = VROThreadName::Undefined;
 }
 
+void VROThreadRestricted::adoptThread(VROThreadName name) {
+    tThreadName = name;
+}
+
 bool VROThreadRestricted::isThread(VROThreadName name) {
     return tThreadName == name;
 }
@@ -36,7 +36,8 @@ std::string print_thread_id(pthread_t id);
 
 enum class VROThreadName {
     Undefined,
-    Renderer
+    Renderer,
+    Worker
 };
 
 /*
@@ -56,6 +57,13 @@ public:
     static void setThread(VROThreadName name);
     static void unsetThread();
     static bool isThread(VROThreadName name);
+    
+    /*
+     Associate the current thread with the given VROThreadName without marking
+     that thread as set. Used by helper threads (e.g. VROJobSystem workers, which
+     adopt VROThreadName::Worker) to identify themselves.
+     */
+    static void adoptThread(VROThreadName name);
 
     /*
      Restrict this object to the thread with the given name. The name must have been set
@@ -0,0 +1,334 @@
+//
+//  VROTransformHierarchy.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/16/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROTransformHierarchy.h"
+#include "VRONode.h"
+#include "VROGeometry.h"
+#include "VROJobSystem.h"
+#include "VROLog.h"
+#include <algorithm>
+
+enum VROTransformFlag : uint8_t {
+    // The node's world transform must be recomputed this frame
+    VROTransformFlagDirty = 1 << 0,
+
+    // The node has geometry or sounds, which must be refreshed even if
+    // the node's transform did not change
+    VROTransformFlagRefresh = 1 << 1,
+
+    // The node's umbrella bounds must be recomputed this frame, because
+    // its own bounds or those of a descendant changed
+    VROTransformFlagBoundsDirty = 1 << 2,
+};
+
+// Hierarchies smaller than this are always updated serially; distributing
+// the work would cost more than it saves
+static const int kMinParallelNodes = 1024;
+
+// The smallest range of nodes given to a single job
+static const int kMinRangeSize = 128;
+
+VROTransformHierarchy::VROTransformHierarchy() :
+    _valid(false),
+    _graphVersion(0),
+    _numNodesUpdated(0),
+    _numBoundsUpdated(0),
+    _partitionWorkers(0) {
+
+}
+
+VROTransformHierarchy::~VROTransformHierarchy() {
+
+}
+
+void VROTransformHierarchy::rebuild(const std::shared_ptr<VRONode> &root) {
+    _nodes.clear();
+    _parents.clear();
+    _subtreeEnds.clear();
+    flatten(root.get(), -1);
+
+    size_t count = _nodes.size();
+    _localTransforms.resize(count);
+    _localRotations.resize(count);
+    _worldTransforms.resize(count);
+    _worldRotations.resize(count);
+    _flags.resize(count);
+
+    _graphVersion = VRONode::getGraphVersion();
+    _valid = true;
+    partition(_partitionWorkers);
+}
+
+void VROTransformHierarchy::flatten(VRONode *node, int parent) {
+    int index = (int) _nodes.size();
+    _nodes.push_back(node);
+    _parents.push_back(parent);
+    _subtreeEnds.push_back(0);
+
+    for (std::shared_ptr<VRONode> &child : node->_subnodes) {
+        flatten(child.get(), index);
+    }
+    _subtreeEnds[index] = (int) _nodes.size();
+}
+
+void VROTransformHierarchy::partition(int numWorkers) {
+    _partitionWorkers = numWorkers;
+    _serialNodes.clear();
+    _ranges.clear();
+
+    int count = (int) _nodes.size();
+    if (numWorkers == 0 || count < kMinParallelNodes) {
+        return;
+    }
+
+    // Aim for a few ranges per thread so that work stealing can balance
+    // uneven subtrees
+    int grain = std::max(count / ((numWorkers + 1) * 4), kMinRangeSize);
+    partitionSubtree(0, grain);
+    _rangeCounts.resize(_ranges.size());
+}
+
+void VROTransformHierarchy::partitionSubtree(int index, int grain) {
+    int end = _subtreeEnds[index];
+    if (end - index <= grain) {
+        // Merge with the previous range if adjacent and small enough
+        if (!_ranges.empty() && _ranges.back().second == index &&
+            end - _ranges.back().first <= grain) {
+            _ranges.back().second = end;
+        }
+        else {
+            _ranges.push_back({ index, end });
+        }
+        return;
+    }
+
+    _serialNodes.push_back(index);
+    for (int child = index + 1; child < end; child = _subtreeEnds[child]) {
+        partitionSubtree(child, grain);
+    }
+}
+
+bool VROTransformHierarchy::isCurrent() const {
+    return _valid && _graphVersion == VRONode::getGraphVersion();
+}
+
+void VROTransformHierarchy::update(const std::shared_ptr<VRONode> &root, std::shared_ptr<VROJobSystem> jobSystem) {
+    bool forceAll = false;
+    if (!_valid || _graphVersion != VRONode::getGraphVersion() ||
+        _nodes.empty() || _nodes.front() != root.get()) {
+        rebuild(root);
+        forceAll = true;
+    }
+    int numWorkers = jobSystem ? jobSystem->getNumWorkers() : 0;
+    if (numWorkers != _partitionWorkers) {
+        partition(numWorkers);
+    }
+
+    int count = (int) _nodes.size();
+
+    /*
+     Gather: recompute the local transforms of nodes that changed since the
+     last update. Nodes with constraints are always considered dirty, because
+     constraints overwrite the world transform after this pass.
+     
+     This pass also ensures geometry bounding boxes (which are lazily computed
+     and may be shared between nodes) are computed before the parallel passes
+     read them.
+     */
+    for (int i = 0; i < count; i++) {
+        VRONode *node = _nodes[i];
+        uint8_t flags = 0;
+
+        if (forceAll || node->_transformDirty || !node->_constraints.empty()) {
+            node->computeLocalTransform();
+            node->_rotation.getMatrix(_localRotations[i]);
+            _localTransforms[i] = node->_localTransform;
+            node->_transformDirty = false;
+
+            flags |= VROTransformFlagDirty;
+        }
+        if (node->_geometry) {
+            node->_geometry->getBoundingBox();
+            flags |= VROTransformFlagRefresh;
+        }
+        else if (!node->_sounds.empty()) {
+            flags |= VROTransformFlagRefresh;
+        }
+        _flags[i] = flags;
+    }
+
+    /*
+     Propagate dirty flags down the hierarchy, compute world transforms, and
+     scatter the results back to the nodes. Serial nodes are ancestors of the
+     ranges, so they go first.
+     */
+    if (_ranges.empty()) {
+        _numNodesUpdated = updateWorldTransforms(0, count);
+    }
+    else {
+        int numUpdated = 0;
+        for (int index : _serialNodes) {
+            numUpdated += updateWorldTransforms(index, index + 1);
+        }
+        jobSystem->parallelFor((int) _ranges.size(), 1, [this] (int start, int end) {
+            for (int r = start; r < end; r++) {
+                _rangeCounts[r] = updateWorldTransforms(_ranges[r].first, _ranges[r].second);
+            }
+        });
+        for (int rangeCount : _rangeCounts) {
+            numUpdated += rangeCount;
+        }
+        _numNodesUpdated = numUpdated;
+    }
+    updateUmbrellaBounds(jobSystem);
+}
+
+int VROTransformHierarchy::updateWorldTransforms(int start, int end) {
+    int numUpdated = 0;
+    for (int i = start; i < end; i++) {
+        int parent = _parents[i];
+        if (parent < 0) {
+            if (_flags[i] & VROTransformFlagDirty) {
+                _worldTransforms[i] = _localTransforms[i];
+                _worldRotations[i] = _localRotations[i];
+                ++numUpdated;
+            }
+        }
+        else if ((_flags[i] | _flags[parent]) & VROTransformFlagDirty) {
+            _flags[i] |= VROTransformFlagDirty;
+            _worldTransforms[i] = _worldTransforms[parent].multiply(_localTransforms[i]);
+            _worldRotations[i] = _worldRotations[parent].multiply(_localRotations[i]);
+            ++numUpdated;
+        }
+
+        /*
+         Scatter the result back to the node if it changed, or refresh the
+         bounds of static nodes whose geometry may have changed.
+         */
+        uint8_t flags = _flags[i];
+        if (flags & VROTransformFlagDirty) {
+            _nodes[i]->setComputedWorldTransform(_worldTransforms[i], _worldRotations[i]);
+            _flags[i] |= VROTransformFlagBoundsDirty;
+        }
+        else if (flags & VROTransformFlagRefresh) {
+            if (_nodes[i]->refreshComputedBounds()) {
+                _flags[i] |= VROTransformFlagBoundsDirty;
+            }
+        }
+    }
+    return numUpdated;
+}
+
+void VROTransformHierarchy::updateUmbrellaBounds(std::shared_ptr<VROJobSystem> &jobSystem) {
+    int count = (int) _nodes.size();
+    if (_ranges.empty()) {
+        _numBoundsUpdated = beginUmbrellaBounds(0, count, 0);
+        endUmbrellaBounds(0, count, 0);
+        return;
+    }
+
+    /*
+     Reset the umbrella bounds within each range in parallel, then propagate
+     the bounds dirty flags from the range roots up through the serial nodes.
+     Serial nodes are visited in reverse depth-first order, so each is reached
+     after all of its descendants.
+     */
+    jobSystem->parallelFor((int) _ranges.size(), 1, [this] (int start, int end) {
+        for (int r = start; r < end; r++) {
+            _rangeCounts[r] = beginUmbrellaBounds(_ranges[r].first, _ranges[r].second, _ranges[r].first);
+        }
+    });
+    int numUpdated = 0;
+    for (size_t r = 0; r < _ranges.size(); r++) {
+        numUpdated += _rangeCounts[r];
+        for (int i = _ranges[r].first; i < _ranges[r].second; i = _subtreeEnds[i]) {
+            if (_flags[i] & VROTransformFlagBoundsDirty) {
+                _flags[_parents[i]] |= VROTransformFlagBoundsDirty;
+            }
+        }
+    }
+    for (auto it = _serialNodes.rbegin(); it != _serialNodes.rend(); ++it) {
+        numUpdated += beginUmbrellaBounds(*it, *it + 1, 0);
+    }
+    _numBoundsUpdated = numUpdated;
+
+    /*
+     Finish the ranges in parallel, then union the range roots into their
+     serial parents, and finally finish the serial nodes bottom-up.
+     */
+    jobSystem->parallelFor((int) _ranges.size(), 1, [this] (int start, int end) {
+        for (int r = start; r < end; r++) {
+            endUmbrellaBounds(_ranges[r].first, _ranges[r].second, _ranges[r].first);
+        }
+    });
+    for (const std::pair<int, int> &range : _ranges) {
+        for (int i = range.first; i < range.second; i = _subtreeEnds[i]) {
+            int parent = _parents[i];
+            if (_flags[parent] & VROTransformFlagBoundsDirty) {
+                _nodes[parent]->unionUmbrellaBounds(*_nodes[i]);
+            }
+        }
+    }
+    for (auto it = _serialNodes.rbegin(); it != _serialNodes.rend(); ++it) {
+        endUmbrellaBounds(*it, *it + 1, 0);
+    }
+}
+
+int VROTransformHierarchy::beginUmbrellaBounds(int start, int end, int boundary) {
+    /*
+     Propagate the bounds dirty flag up to all ancestors. Iterating in reverse
+     guarantees that when we reach a node, all of its descendants have been
+     visited, so its flag is final and we can reset its umbrella bounds.
+     */
+    int numUpdated = 0;
+    for (int i = end - 1; i >= start; i--) {
+        if (_flags[i] & VROTransformFlagBoundsDirty) {
+            int parent = _parents[i];
+            if (parent >= boundary) {
+                _flags[parent] |= VROTransformFlagBoundsDirty;
+            }
+            _nodes[i]->beginUmbrellaBounds();
+            ++numUpdated;
+        }
+    }
+    return numUpdated;
+}
+
+void VROTransformHierarchy::endUmbrellaBounds(int start, int end, int boundary) {
+    /*
+     Union each node's umbrella bounds into its parent, bottom-up. Clean
+     children still contribute their (cached) umbrella bounds to dirty parents.
+     */
+    for (int i = end - 1; i >= start; i--) {
+        if (_flags[i] & VROTransformFlagBoundsDirty) {
+            _nodes[i]->endUmbrellaBounds();
+        }
+        int parent = _parents[i];
+        if (parent >= boundary && (_flags[parent] & VROTransformFlagBoundsDirty)) {
+            _nodes[parent]->unionUmbrellaBounds(*_nodes[i]);
+        }
+    }
+}
@@ -0,0 +1,222 @@
+//
+//  VROTransformHierarchy.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/16/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VROTransformHierarchy_h
+#define VROTransformHierarchy_h
+
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "VROMatrix4f.h"
+
+class VRONode;
+class VROJobSystem;
+
+/*
+ Flattened, data-oriented representation of a scene graph's transform
+ hierarchy. Nodes are stored in depth-first order (every parent precedes
+ its children), with parallel arrays holding each node's parent index,
+ local transform, and computed world transform.
+
+ Each frame the hierarchy gathers the local transforms of nodes that were
+ modified since the last frame, then runs a single linear pass over the
+ arrays, recomputing world transforms only for dirty nodes and their
+ descendants. Results are then scattered back to the dirty VRONodes.
+ Subtrees that have not moved are never touched beyond a dirty-flag check.
+
+ The node's local position, rotation, and scale remain the source of truth
+ (they are what animations and the application write to); this structure
+ only caches the derived matrices.
+
+ The flattened ordering is rebuilt whenever the scene graph topology
+ changes, as tracked by VRONode::getGraphVersion().
+
+ When a VROJobSystem is provided, large hierarchies are partitioned into
+ contiguous subtree ranges that are processed in parallel. The few nodes
+ above those ranges (their ancestors) are processed serially, before the
+ ranges for world transforms and after them for umbrella bounds.
+ */
+class VROTransformHierarchy {
+
+public:
+
+    VROTransformHierarchy();
+    virtual ~VROTransformHierarchy();
+
+    /*
+     Recompute the transforms of all dirty nodes in the graph rooted at the
+     given node. Rebuilds the flattened ordering first if the graph's topology
+     has changed since the last update. If the job system is not null, independent
+     subtrees are processed in parallel.
+     */
+    void update(const std::shared_ptr<VRONode> &root, std::shared_ptr<VROJobSystem> jobSystem);
+
+    /*
+     Force every node to be recomputed during the next update.
+     */
+    void invalidate() {
+        _valid = false;
+    }
+
+    /*
+     Number of nodes in the flattened hierarchy, and the number of those
+     whose world transforms were recomputed during the last update.
+     */
+    int getNumNodes() const {
+        return (int) _nodes.size();
+    }
+    int getNumNodesUpdated() const {
+        return _numNodesUpdated;
+    }
+    
+    /*
+     Number of umbrella bounding boxes recomputed during the last update.
+     Umbrella bounds are only recomputed along the ancestor chains of nodes
+     whose bounds changed.
+     */
+    int getNumBoundsUpdated() const {
+        return _numBoundsUpdated;
+    }
+    
+    /*
+     The nodes in the hierarchy, in depth-first order. Only valid until the
+     scene graph topology next changes.
+     */
+    const std::vector<VRONode *> &getNodes() const {
+        return _nodes;
+    }
+    
+    /*
+     Index one past the last descendant of each node in getNodes(), so that
+     the subtree of node i occupies the range [i, getSubtreeEnds()[i]).
+     */
+    const std::vector<int> &getSubtreeEnds() const {
+        return _subtreeEnds;
+    }
+    
+    /*
+     True if the flattened hierarchy reflects the current scene graph topology.
+     */
+    bool isCurrent() const;
+
+private:
+
+    /*
+     True if the flattened ordering below is up to date with the scene graph.
+     When false, the hierarchy is rebuilt and all nodes are treated as dirty.
+     */
+    bool _valid;
+
+    /*
+     The VRONode graph version at which this hierarchy was last flattened.
+     */
+    uint32_t _graphVersion;
+
+    /*
+     The nodes, in depth-first order. These are raw pointers: they are only
+     dereferenced when _graphVersion matches the node graph version, which
+     guarantees every node here is still attached to the root.
+     */
+    std::vector<VRONode *> _nodes;
+
+    /*
+     Index of each node's parent in the arrays, or -1 for the root.
+     */
+    std::vector<int> _parents;
+    
+    /*
+     Index one past the last descendant of each node, so that each node's
+     subtree occupies [i, _subtreeEnds[i]).
+     */
+    std::vector<int> _subtreeEnds;
+
+    /*
+     Local transform and local rotation matrices, refreshed only for nodes
+     whose position, rotation, scale or pivots changed.
+     */
+    std::vector<VROMatrix4f> _localTransforms;
+    std::vector<VROMatrix4f> _localRotations;
+
+    /*
+     World transform and world rotation matrices.
+     */
+    std::vector<VROMatrix4f> _worldTransforms;
+    std::vector<VROMatrix4f> _worldRotations;
+
+    /*
+     Per-node flags (see VROTransformFlag in the implementation) indicating
+     whether the node is dirty this frame and whether it has state that must
+     be refreshed even when its transform is unchanged.
+     */
+    std::vector<uint8_t> _flags;
+
+    int _numNodesUpdated;
+    int _numBoundsUpdated;
+    
+    /*
+     Partition used for parallel updates. _serialNodes are the ancestors of
+     all ranges, in depth-first order. Each range [start, end) is a run of
+     whole subtrees whose roots have their parents among the serial nodes.
+     Empty when the hierarchy is updated serially.
+     */
+    int _partitionWorkers;
+    std::vector<int> _serialNodes;
+    std::vector<std::pair<int, int>> _ranges;
+    std::vector<int> _rangeCounts;
+
+    /*
+     Flatten the graph rooted at the given node into the arrays above.
+     */
+    void rebuild(const std::shared_ptr<VRONode> &root);
+    void flatten(VRONode *node, int parent);
+    void partition(int numWorkers);
+    void partitionSubtree(int index, int grain);
+    
+    /*
+     Compute world transforms for the nodes in [start, end) and scatter them
+     to the dirty nodes. Parents must already be up to date. Returns the number
+     of nodes updated.
+     */
+    int updateWorldTransforms(int start, int end);
+
+    /*
+     Recompute umbrella bounding boxes, bottom-up, for every node flagged
+     as bounds dirty and all of its ancestors.
+     */
+    void updateUmbrellaBounds(std::shared_ptr<VROJobSystem> &jobSystem);
+    
+    /*
+     The two bottom-up umbrella passes, restricted to [start, end). Flags and
+     bounds are only propagated to parents at or after the boundary index;
+     propagation to parents outside a parallel range is done serially. The
+     first pass returns the number of umbrella boxes it reset.
+     */
+    int beginUmbrellaBounds(int start, int end, int boundary);
+    void endUmbrellaBounds(int start, int end, int boundary);
+
+};
+
+#endif /* VROTransformHierarchy_h */
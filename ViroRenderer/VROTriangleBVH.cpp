@@ -0,0 +1,274 @@
+//
+//  VROTriangleBVH.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/19/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "VROTriangleBVH.h"
+#include "VROGeometry.h"
+#include "VROGeometrySource.h"
+#include "VROGeometryElement.h"
+#include "VROTriangle.h"
+#include "VROLog.h"
+#include <algorithm>
+#include <float.h>
+
+// Maximum number of triangles in a leaf
+static const int kMaxLeafTriangles = 4;
+
+// Maximum depth of the traversal stack; the tree is balanced (median split)
+// so this supports far more triangles than any mesh will have
+static const int kMaxTraversalDepth = 64;
+
+std::shared_ptr<VROTriangleBVH> VROTriangleBVH::build(const VROGeometry &geometry) {
+    std::vector<std::shared_ptr<VROGeometrySource>> vertexSources = geometry.getGeometrySourcesForSemantic(VROGeometrySourceSemantic::Vertex);
+    if (vertexSources.empty()) {
+        return nullptr;
+    }
+    std::shared_ptr<VROGeometrySource> vertexSource = vertexSources.front();
+    
+    std::vector<VROVector3f> vertices;
+    for (const std::shared_ptr<VROGeometryElement> &element : geometry.getGeometryElements()) {
+        element->processTriangles([&vertices](int index, VROTriangle triangle) {
+            vertices.push_back(triangle.getA());
+            vertices.push_back(triangle.getB());
+            vertices.push_back(triangle.getC());
+        }, vertexSource);
+    }
+    
+    int numTriangles = (int) vertices.size() / 3;
+    if (numTriangles == 0) {
+        return nullptr;
+    }
+    
+    std::vector<VROVector3f> centroids(numTriangles);
+    std::vector<int> triangles(numTriangles);
+    for (int i = 0; i < numTriangles; i++) {
+        centroids[i] = (vertices[i * 3] + vertices[i * 3 + 1] + vertices[i * 3 + 2]) / 3.0f;
+        triangles[i] = i;
+    }
+    
+    std::shared_ptr<VROTriangleBVH> bvh = std::make_shared<VROTriangleBVH>();
+    bvh->_nodes.reserve(2 * (numTriangles / kMaxLeafTriangles + 1));
+    bvh->_vertices.reserve(vertices.size());
+    bvh->buildNode(triangles, 0, numTriangles, vertices, centroids);
+    return bvh;
+}
+
+int VROTriangleBVH::buildNode(std::vector<int> &triangles, int start, int end,
+                              const std::vector<VROVector3f> &vertices,
+                              const std::vector<VROVector3f> &centroids) {
+    int index = (int) _nodes.size();
+    _nodes.push_back({});
+    
+    // Compute the bounds of the triangles and of their centroids
+    float min[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    float cmin[3] = {  FLT_MAX,  FLT_MAX,  FLT_MAX };
+    float cmax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int i = start; i < end; i++) {
+        int t = triangles[i];
+        for (int v = 0; v < 3; v++) {
+            const VROVector3f &p = vertices[t * 3 + v];
+            min[0] = std::min(min[0], p.x); max[0] = std::max(max[0], p.x);
+            min[1] = std::min(min[1], p.y); max[1] = std::max(max[1], p.y);
+            min[2] = std::min(min[2], p.z); max[2] = std::max(max[2], p.z);
+        }
+        const VROVector3f &c = centroids[t];
+        cmin[0] = std::min(cmin[0], c.x); cmax[0] = std::max(cmax[0], c.x);
+        cmin[1] = std::min(cmin[1], c.y); cmax[1] = std::max(cmax[1], c.y);
+        cmin[2] = std::min(cmin[2], c.z); cmax[2] = std::max(cmax[2], c.z);
+    }
+    
+    VROTriangleBVHNode node;
+    for (int a = 0; a < 3; a++) {
+        node.min[a] = min[a];
+        node.max[a] = max[a];
+    }
+    
+    // Choose the axis along which the centroids are most spread
+    int axis = 0;
+    for (int a = 1; a < 3; a++) {
+        if (cmax[a] - cmin[a] > cmax[axis] - cmin[axis]) {
+            axis = a;
+        }
+    }
+    
+    int count = end - start;
+    if (count <= kMaxLeafTriangles || cmax[axis] - cmin[axis] <= 0) {
+        node.start = (int) _vertices.size() / 3;
+        node.count = count;
+        for (int i = start; i < end; i++) {
+            int t = triangles[i];
+            _vertices.push_back(vertices[t * 3]);
+            _vertices.push_back(vertices[t * 3 + 1]);
+            _vertices.push_back(vertices[t * 3 + 2]);
+        }
+        _nodes[index] = node;
+        return index;
+    }
+    
+    // Split at the median centroid along the chosen axis
+    int mid = start + count / 2;
+    std::nth_element(triangles.begin() + start, triangles.begin() + mid, triangles.begin() + end,
+                     [&centroids, axis](int a, int b) {
+                         const VROVector3f &ca = centroids[a];
+                         const VROVector3f &cb = centroids[b];
+                         return (axis == 0 ? ca.x : axis == 1 ? ca.y : ca.z) <
+                                (axis == 0 ? cb.x : axis == 1 ? cb.y : cb.z);
+                     });
+    
+    buildNode(triangles, start, mid, vertices, centroids);
+    node.start = buildNode(triangles, mid, end, vertices, centroids);
+    node.count = 0;
+    _nodes[index] = node;
+    return index;
+}
+
+/*
+ Slab test of the ray against the node's box. Returns the entry parameter in
+ outEntry if the ray enters the box before maxT.
+ */
+static inline bool intersectsBox(const float *min, const float *max, const float *origin,
+                                 const float *invRay, float maxT, float *outEntry) {
+    float tmin = 0;
+    float tmax = maxT;
+    for (int a = 0; a < 3; a++) {
+        float t0 = (min[a] - origin[a]) * invRay[a];
+        float t1 = (max[a] - origin[a]) * invRay[a];
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        // Written so that NaNs (from 0 * inf, when the ray lies on a slab
+        // plane) leave the interval unchanged
+        tmin = t0 > tmin ? t0 : tmin;
+        tmax = t1 < tmax ? t1 : tmax;
+        if (tmin > tmax) {
+            return false;
+        }
+    }
+    *outEntry = tmin;
+    return true;
+}
+
+/*
+ Moller-Trumbore ray/triangle intersection, two-sided.
+ */
+static inline bool intersectsTriangle(const VROVector3f &origin, const VROVector3f &ray,
+                                      const VROVector3f &a, const VROVector3f &b, const VROVector3f &c,
+                                      float *outT) {
+    VROVector3f edge1 = b - a;
+    VROVector3f edge2 = c - a;
+    VROVector3f p = ray.cross(edge2);
+    float det = edge1.dot(p);
+    if (det == 0) {
+        return false;
+    }
+    
+    float invDet = 1.0f / det;
+    VROVector3f s = origin - a;
+    float u = s.dot(p) * invDet;
+    if (u < 0 || u > 1) {
+        return false;
+    }
+    
+    VROVector3f q = s.cross(edge1);
+    float v = ray.dot(q) * invDet;
+    if (v < 0 || u + v > 1) {
+        return false;
+    }
+    
+    float t = edge2.dot(q) * invDet;
+    if (t < 0) {
+        return false;
+    }
+    *outT = t;
+    return true;
+}
+
+bool VROTriangleBVH::intersectRay(const VROVector3f &origin, const VROVector3f &ray, float *outT) const {
+    if (_nodes.empty()) {
+        return false;
+    }
+    
+    float o[3] = { origin.x, origin.y, origin.z };
+    float invRay[3] = { 1.0f / ray.x, 1.0f / ray.y, 1.0f / ray.z };
+    
+    float nearest = FLT_MAX;
+    bool hit = false;
+    
+    int stack[kMaxTraversalDepth];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const VROTriangleBVHNode &node = _nodes[stack[--stackSize]];
+        float entry;
+        if (!intersectsBox(node.min, node.max, o, invRay, nearest, &entry)) {
+            continue;
+        }
+        
+        if (node.count > 0) {
+            for (int i = node.start; i < node.start + node.count; i++) {
+                float t;
+                if (intersectsTriangle(origin, ray, _vertices[i * 3], _vertices[i * 3 + 1], _vertices[i * 3 + 2], &t) &&
+                    t < nearest) {
+                    nearest = t;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+        
+        // Visit the nearer child first, so that the far child is more likely
+        // to be culled by the nearest hit
+        int left = (int) (&node - &_nodes[0]) + 1;
+        int right = node.start;
+        float leftEntry, rightEntry;
+        bool hitLeft  = intersectsBox(_nodes[left].min,  _nodes[left].max,  o, invRay, nearest, &leftEntry);
+        bool hitRight = intersectsBox(_nodes[right].min, _nodes[right].max, o, invRay, nearest, &rightEntry);
+        
+        passert (stackSize + 2 <= kMaxTraversalDepth);
+        if (hitLeft && hitRight) {
+            if (leftEntry < rightEntry) {
+                stack[stackSize++] = right;
+                stack[stackSize++] = left;
+            } else {
+                stack[stackSize++] = left;
+                stack[stackSize++] = right;
+            }
+        }
+        else if (hitLeft) {
+            stack[stackSize++] = left;
+        }
+        else if (hitRight) {
+            stack[stackSize++] = right;
+        }
+    }
+    
+    if (hit) {
+        *outT = nearest;
+    }
+    return hit;
+}
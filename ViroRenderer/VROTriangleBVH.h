@@ -0,0 +1,104 @@
+//
+//  VROTriangleBVH.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/19/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROTriangleBVH_h
+#define VROTriangleBVH_h
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include "VROVector3f.h"
+
+class VROGeometry;
+
+/*
+ Bounding volume hierarchy over the triangles of a VROGeometry, in the
+ geometry's local coordinate space. Used to accelerate ray intersection
+ (hit testing): rays are transformed into local space and tested against
+ the hierarchy in logarithmic time, instead of transforming and testing
+ every triangle.
+ 
+ Nodes are stored depth-first in a flat array: the left child of an
+ interior node immediately follows it, and the right child's index is
+ stored in the node. Leaves reference a contiguous run of triangles.
+ */
+class VROTriangleBVH {
+    
+public:
+    
+    /*
+     Build a BVH over all triangle and triangle strip elements of the given
+     geometry, using its vertex source. Returns nullptr if the geometry has
+     no triangles.
+     */
+    static std::shared_ptr<VROTriangleBVH> build(const VROGeometry &geometry);
+    
+    VROTriangleBVH() {}
+    virtual ~VROTriangleBVH() {}
+    
+    /*
+     Find the nearest intersection of the given ray with the triangles. The
+     ray is origin + t * ray for t >= 0, and need not be normalized. Returns
+     true on a hit, storing the parameter t of the nearest hit in outT.
+     Triangles are two-sided.
+     */
+    bool intersectRay(const VROVector3f &origin, const VROVector3f &ray, float *outT) const;
+    
+    int getNumTriangles() const {
+        return (int) _vertices.size() / 3;
+    }
+    int getNumNodes() const {
+        return (int) _nodes.size();
+    }
+    
+private:
+    
+    struct VROTriangleBVHNode {
+        float min[3];
+        float max[3];
+        
+        // For leaves, the first triangle and the number of triangles. For
+        // interior nodes count is zero and start is the right child's index
+        int32_t start;
+        int32_t count;
+    };
+    
+    std::vector<VROTriangleBVHNode> _nodes;
+    
+    /*
+     Triangle vertices, three per triangle, ordered so that each leaf's
+     triangles are contiguous.
+     */
+    std::vector<VROVector3f> _vertices;
+    
+    int buildNode(std::vector<int> &triangles, int start, int end,
+                  const std::vector<VROVector3f> &vertices,
+                  const std::vector<VROVector3f> &centroids);
+    
+};
+
+#endif /* VROTriangleBVH_h */
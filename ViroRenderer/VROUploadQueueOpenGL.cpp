@@ -0,0 +1,260 @@
+//
+//  VROUploadQueueOpenGL.cpp
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/27/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "VROUploadQueueOpenGL.h"
+#include "VROTextureSubstrateOpenGL.h"
+#include "VRODriverOpenGL.h"
+#include "VROTexture.h"
+#include "VROImage.h"
+#include "VROData.h"
+#include "VROPlatformUtil.h"
+#include "VROLog.h"
+#include "VRODefines.h"
+#include <thread>
+
+// Bytes that may begin staging each frame. The first upload of each frame is
+// always started, regardless of its size
+static const size_t kDefaultUploadBytesPerFrame = 8 * 1024 * 1024;
+
+// Maximum bytes staged (mapped, but not yet transferred) at any time
+static const size_t kMaxUploadBytesStaging = 32 * 1024 * 1024;
+
+// Alignment of each face within a PBO
+static const size_t kUploadFaceAlignment = 16;
+
+bool VROUploadQueueOpenGL::isSupported() {
+#if VRO_PLATFORM_WASM
+    return false;
+#else
+    return true;
+#endif
+}
+
+VROUploadQueueOpenGL::VROUploadQueueOpenGL() :
+    _bytesPerFrame(kDefaultUploadBytesPerFrame),
+    _bytesStaging(0) {
+    
+}
+
+VROUploadQueueOpenGL::~VROUploadQueueOpenGL() {
+    // Background copies write into mapped buffers, so they must finish before
+    // we go away. The GL objects themselves are released with the context.
+    for (std::shared_ptr<Upload> &upload : _staging) {
+        while (!upload->staged->load()) {
+            std::this_thread::yield();
+        }
+        releaseImages(upload);
+    }
+    for (std::shared_ptr<Upload> &upload : _queued) {
+        releaseImages(upload);
+    }
+}
+
+void VROUploadQueueOpenGL::uploadTexture(VROTextureUploadParams params,
+                                         std::function<void(std::unique_ptr<VROTextureSubstrate>)> onUploaded) {
+    std::shared_ptr<Upload> upload = std::make_shared<Upload>();
+    upload->params = std::move(params);
+    upload->onUploaded = onUploaded;
+    upload->pbo = 0;
+    upload->mapped = nullptr;
+    upload->fence = 0;
+    
+    size_t size = 0;
+    for (std::shared_ptr<VROData> &face : upload->params.data) {
+        size = (size + kUploadFaceAlignment - 1) / kUploadFaceAlignment * kUploadFaceAlignment;
+        size += face->getDataLength();
+    }
+    upload->size = size;
+    _queued.push_back(upload);
+}
+
+void VROUploadQueueOpenGL::update(std::shared_ptr<VRODriverOpenGL> driver) {
+    /*
+     Complete transfers whose fences have signaled.
+     */
+    for (auto it = _transferring.begin(); it != _transferring.end();) {
+        std::shared_ptr<Upload> upload = *it;
+        GLenum status = glClientWaitSync(upload->fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++it;
+            continue;
+        }
+        
+        GL( glDeleteSync(upload->fence) );
+        driver->deleteBuffer(upload->pbo);
+        it = _transferring.erase(it);
+        
+        upload->onUploaded(std::move(upload->substrate));
+    }
+    
+    /*
+     Transfer uploads whose data has been staged.
+     */
+    for (auto it = _staging.begin(); it != _staging.end();) {
+        std::shared_ptr<Upload> upload = *it;
+        if (!upload->staged->load()) {
+            ++it;
+            continue;
+        }
+        
+        it = _staging.erase(it);
+        _bytesStaging -= upload->size;
+        beginTransfer(upload, driver);
+    }
+    
+    /*
+     Begin staging new uploads, within the per-frame budget.
+     */
+    size_t bytesThisFrame = 0;
+    while (!_queued.empty()) {
+        std::shared_ptr<Upload> upload = _queued.front();
+        bool first = bytesThisFrame == 0 && _bytesStaging == 0;
+        if (!first && (bytesThisFrame + upload->size > _bytesPerFrame ||
+                       _bytesStaging + upload->size > kMaxUploadBytesStaging)) {
+            break;
+        }
+        _queued.pop_front();
+        bytesThisFrame += upload->size;
+        
+        if (beginStaging(upload)) {
+            _staging.push_back(upload);
+            _bytesStaging += upload->size;
+        }
+        else {
+            uploadImmediately(upload, driver);
+        }
+    }
+}
+
+bool VROUploadQueueOpenGL::beginStaging(std::shared_ptr<Upload> &upload) {
+#if VRO_PLATFORM_WASM
+    return false;
+#else
+    if (upload->size == 0) {
+        return false;
+    }
+    
+    GL( glGenBuffers(1, &upload->pbo) );
+    GL( glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo) );
+    GL( glBufferData(GL_PIXEL_UNPACK_BUFFER, upload->size, nullptr, GL_STREAM_DRAW) );
+    upload->mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, upload->size,
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    GL( glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0) );
+    
+    if (upload->mapped == nullptr) {
+        pwarn("Failed to map pixel buffer for texture upload, uploading synchronously");
+        GL( glDeleteBuffers(1, &upload->pbo) );
+        upload->pbo = 0;
+        return false;
+    }
+    
+    /*
+     Copy the data into the mapped buffer on a background thread. The data and
+     staged flag are captured directly, so the copy never touches the upload.
+     */
+    std::vector<std::shared_ptr<VROData>> data = upload->params.data;
+    uint8_t *mapped = (uint8_t *) upload->mapped;
+    
+    std::shared_ptr<std::atomic<bool>> staged = std::make_shared<std::atomic<bool>>(false);
+    upload->staged = staged;
+    
+    VROPlatformDispatchAsyncBackground([data, mapped, staged] {
+        size_t offset = 0;
+        for (const std::shared_ptr<VROData> &face : data) {
+            offset = (offset + kUploadFaceAlignment - 1) / kUploadFaceAlignment * kUploadFaceAlignment;
+            memcpy(mapped + offset, face->getData(), face->getDataLength());
+            offset += face->getDataLength();
+        }
+        staged->store(true);
+    });
+    return true;
+#endif
+}
+
+void VROUploadQueueOpenGL::beginTransfer(std::shared_ptr<Upload> &upload, std::shared_ptr<VRODriverOpenGL> &driver) {
+    releaseImages(upload);
+    
+    GL( glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo) );
+#if VRO_PLATFORM_WASM
+    GLboolean intact = GL_FALSE;
+#else
+    GLboolean intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+#endif
+    upload->mapped = nullptr;
+    
+    if (!intact) {
+        // The buffer's contents were lost (e.g. the display mode changed)
+        GL( glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0) );
+        driver->deleteBuffer(upload->pbo);
+        uploadImmediately(upload, driver);
+        return;
+    }
+    
+    /*
+     While a PBO is bound, the data pointers given to glTexImage2D are offsets into
+     the PBO. The substrate reads each face through VROData::getData(), so we give
+     it VROData holding those offsets.
+     */
+    std::vector<std::shared_ptr<VROData>> offsets;
+    size_t offset = 0;
+    for (std::shared_ptr<VROData> &face : upload->params.data) {
+        offset = (offset + kUploadFaceAlignment - 1) / kUploadFaceAlignment * kUploadFaceAlignment;
+        offsets.push_back(std::make_shared<VROData>((void *) offset, face->getDataLength(), VRODataOwnership::Wrap));
+        offset += face->getDataLength();
+    }
+    
+    VROTextureUploadParams &p = upload->params;
+    upload->substrate = std::unique_ptr<VROTextureSubstrate>(
+        new VROTextureSubstrateOpenGL(p.type, p.format, p.internalFormat, p.sRGB, p.mipmapMode, offsets,
+                                      p.width, p.height, p.mipSizes, p.wrapS, p.wrapT,
+                                      p.minFilter, p.magFilter, p.mipFilter, driver));
+    GL( glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0) );
+    
+    // The CPU copy is no longer needed
+    p.data.clear();
+    
+    upload->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _transferring.push_back(upload);
+}
+
+void VROUploadQueueOpenGL::uploadImmediately(std::shared_ptr<Upload> &upload, std::shared_ptr<VRODriverOpenGL> &driver) {
+    VROTextureUploadParams &p = upload->params;
+    std::unique_ptr<VROTextureSubstrate> substrate(
+        new VROTextureSubstrateOpenGL(p.type, p.format, p.internalFormat, p.sRGB, p.mipmapMode, p.data,
+                                      p.width, p.height, p.mipSizes, p.wrapS, p.wrapT,
+                                      p.minFilter, p.magFilter, p.mipFilter, driver));
+    releaseImages(upload);
+    p.data.clear();
+    
+    upload->onUploaded(std::move(substrate));
+}
+
+void VROUploadQueueOpenGL::releaseImages(std::shared_ptr<Upload> &upload) {
+    for (std::shared_ptr<VROImage> &image : upload->params.images) {
+        image->unlock();
+    }
+    upload->params.images.clear();
+}
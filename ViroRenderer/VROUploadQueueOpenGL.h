@@ -0,0 +1,175 @@
+//
+//  VROUploadQueueOpenGL.h
+//  ViroRenderer
+//
+//  Created by Raj Advani on 10/27/19.
+//  Copyright © 2019 Viro Media. All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining
+//  a copy of this software and associated documentation files (the
+//  "Software"), to deal in the Software without restriction, including
+//  without limitation the rights to use, copy, modify, merge, publish,
+//  distribute, sublicense, and/or sell copies of the Software, and to
+//  permit persons to whom the Software is furnished to do so, subject to
+//  the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included
+//  in all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+//  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+//  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+//  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+//  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+//  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef VROUploadQueueOpenGL_h
+#define VROUploadQueueOpenGL_h
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <functional>
+#include "VROOpenGL.h"
+
+class VROData;
+class VROImage;
+class VROTextureSubstrate;
+class VRODriverOpenGL;
+enum class VROTextureType;
+enum class VROTextureFormat;
+enum class VROTextureInternalFormat;
+enum class VROMipmapMode;
+enum class VROWrapMode;
+enum class VROFilterMode;
+
+/*
+ Parameters for a texture upload; these mirror the arguments of the
+ VROTextureSubstrateOpenGL constructor.
+ */
+struct VROTextureUploadParams {
+    VROTextureType type;
+    VROTextureFormat format;
+    VROTextureInternalFormat internalFormat;
+    bool sRGB;
+    VROMipmapMode mipmapMode;
+    std::vector<std::shared_ptr<VROData>> data;
+    int width, height;
+    std::vector<uint32_t> mipSizes;
+    VROWrapMode wrapS, wrapT;
+    VROFilterMode minFilter, magFilter, mipFilter;
+    
+    /*
+     Images backing the data, if any. These must be locked by the caller; the
+     queue holds them and unlocks them once their data has been read.
+     */
+    std::vector<std::shared_ptr<VROImage>> images;
+};
+
+/*
+ Uploads texture data to the GPU without stalling the rendering thread.
+ 
+ Each upload moves through three stages, advanced once per frame by update():
+ 
+ 1. Staging: a pixel buffer object (PBO) is allocated and mapped on the
+    rendering thread, and the texture data is copied into it on a background
+    thread.
+ 2. Transfer: once the copy completes, the PBO is unmapped and the texture is
+    created from it. The driver transfers the data asynchronously; a fence is
+    inserted after the transfer.
+ 3. Completion: once the fence signals (typically a frame or two later), the
+    PBO is released and the finished substrate is handed to the requester. The
+    texture is never drawn before its data is resident, so the first draw
+    does not stall on the transfer.
+ 
+ Staging is metered by a per-frame byte budget, and by a cap on the bytes
+ staged but not yet transferred, so that large model loads spread their
+ uploads over several frames.
+ 
+ All methods must be invoked on the rendering thread.
+ */
+class VROUploadQueueOpenGL {
+    
+public:
+    
+    /*
+     True if asynchronous uploads are supported on this platform. WebGL does
+     not support mapping buffers.
+     */
+    static bool isSupported();
+    
+    VROUploadQueueOpenGL();
+    virtual ~VROUploadQueueOpenGL();
+    
+    /*
+     Queue a texture upload. The callback is invoked on the rendering thread
+     once the texture is resident on the GPU.
+     */
+    void uploadTexture(VROTextureUploadParams params,
+                       std::function<void(std::unique_ptr<VROTextureSubstrate>)> onUploaded);
+    
+    /*
+     Advance queued uploads. Invoked once per frame, with the driver's context
+     bound.
+     */
+    void update(std::shared_ptr<VRODriverOpenGL> driver);
+    
+    /*
+     Set the number of bytes that may begin staging each frame.
+     */
+    void setBytesPerFrame(size_t bytes) {
+        _bytesPerFrame = bytes;
+    }
+    
+    /*
+     Number of uploads not yet completed.
+     */
+    int getNumPendingUploads() const {
+        return (int) (_queued.size() + _staging.size() + _transferring.size());
+    }
+    
+private:
+    
+    struct Upload {
+        VROTextureUploadParams params;
+        std::function<void(std::unique_ptr<VROTextureSubstrate>)> onUploaded;
+        
+        size_t size;
+        GLuint pbo;
+        void *mapped;
+        std::shared_ptr<std::atomic<bool>> staged;
+        GLsync fence;
+        std::unique_ptr<VROTextureSubstrate> substrate;
+    };
+    
+    std::deque<std::shared_ptr<Upload>> _queued;
+    std::deque<std::shared_ptr<Upload>> _staging;
+    std::deque<std::shared_ptr<Upload>> _transferring;
+    
+    size_t _bytesPerFrame;
+    size_t _bytesStaging;
+    
+    /*
+     Map a PBO for the given upload and copy its data in the background.
+     Returns false if the buffer could not be mapped.
+     */
+    bool beginStaging(std::shared_ptr<Upload> &upload);
+    
+    /*
+     Create the texture from the staged PBO and fence the transfer.
+     */
+    void beginTransfer(std::shared_ptr<Upload> &upload, std::shared_ptr<VRODriverOpenGL> &driver);
+    
+    /*
+     Create the texture synchronously from the CPU data. Used when staging fails.
+     */
+    void uploadImmediately(std::shared_ptr<Upload> &upload, std::shared_ptr<VRODriverOpenGL> &driver);
+    
+    void releaseImages(std::shared_ptr<Upload> &upload);
+    
+};
+
+#endif /* VROUploadQueueOpenGL_h */
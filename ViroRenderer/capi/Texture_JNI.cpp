@@ -34,6 +34,7 @@
 #include "VROCompress.h"
 #include "VROLog.h"
 #include "VROModelIOUtil.h"
+#include "VROTextureTranscoder.h"
 #include "VROPlatformUtil.h"
 
 #if VRO_PLATFORM_ANDROID
@@ -366,4 +367,15 @@ VRO_METHOD(void, nativeDestroyTexture)(VRO_ARGS
     VRO_REF_DELETE(VROTexture, nativeRef);
 }
 
+VRO_METHOD(void, nativeSetTranscodingEnabled)(VRO_ARGS_STATIC
+                                              VRO_BOOL enabled) {
+    // Read by the texture decode threads, so this takes effect for textures
+    // loaded from here on
+    VROTextureTranscoder::setTranscodingEnabled(enabled);
+}
+
+VRO_METHOD(VRO_BOOL, nativeIsTranscodingEnabled)(VRO_NO_ARGS_STATIC) {
+    return VROTextureTranscoder::isTranscodingEnabled();
+}
+
 } // extern "C"
\ No newline at end of file
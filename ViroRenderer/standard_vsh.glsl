@@ -25,6 +25,7 @@ struct VROTransforms {
     mat4 model_matrix;
     mat4 view_matrix;
     mat4 projection_matrix;
+    mat4 normal_matrix;
 } _transforms;
 
 in vec3 position;
@@ -61,6 +62,7 @@ void main() {
     _transforms.model_matrix = model_matrix;
     _transforms.view_matrix = view_matrix;
     _transforms.projection_matrix = projection_matrix;
+    _transforms.normal_matrix = normal_matrix;
 
     v_instance_id = gl_InstanceID;
 
@@ -69,9 +71,9 @@ void main() {
     v_texcoord = _geometry.texcoord;
     v_surface_position = (_transforms.model_matrix * vec4(_geometry.position, 1.0)).xyz;
 
-    vec3 n = normalize((normal_matrix * vec4(_geometry.normal, 0.0)).xyz);
-    vec3 t = normalize((normal_matrix * vec4(_geometry.tangent.xyz, 0.0)).xyz);
-    vec3 b = normalize((normal_matrix * vec4((cross(_geometry.normal, _geometry.tangent.xyz) * _geometry.tangent.w), 0.0)).xyz);
+    vec3 n = normalize((_transforms.normal_matrix * vec4(_geometry.normal, 0.0)).xyz);
+    vec3 t = normalize((_transforms.normal_matrix * vec4(_geometry.tangent.xyz, 0.0)).xyz);
+    vec3 b = normalize((_transforms.normal_matrix * vec4((cross(_geometry.normal, _geometry.tangent.xyz) * _geometry.tangent.w), 0.0)).xyz);
     v_tbn = mat3(t, b, n);
 
     _vertex.position = _transforms.projection_matrix * _transforms.view_matrix * _transforms.model_matrix * vec4(_geometry.position, 1.0);
@@ -20,6 +20,7 @@ vec4 _vertex_position;
 mat4 _transforms_model_matrix;
 mat4 _transforms_view_matrix;
 mat4 _transforms_projection_matrix;
+mat4 _transforms_normal_matrix;
 
 in vec3 position;
 in vec3 normal;
@@ -59,6 +60,7 @@ void main() {
     _transforms_model_matrix = model_matrix;
     _transforms_view_matrix = view_matrix;
     _transforms_projection_matrix = projection_matrix;
+    _transforms_normal_matrix = normal_matrix;
 
     v_instance_id = gl_InstanceID;
 
@@ -67,9 +69,9 @@ void main() {
     v_texcoord = _geometry_texcoord;
     v_surface_position = (_transforms_model_matrix * vec4(_geometry_position, 1.0)).xyz;
 
-    vec3 n = normalize((normal_matrix * vec4(_geometry_normal,  0.0)).xyz);
-    vec3 t = normalize((normal_matrix * vec4(_geometry_tangent.xyz, 0.0)).xyz);
-    vec3 b = normalize((normal_matrix * vec4((cross(_geometry_normal, _geometry_tangent.xyz) * _geometry_tangent.w), 0.0)).xyz);
+    vec3 n = normalize((_transforms_normal_matrix * vec4(_geometry_normal,  0.0)).xyz);
+    vec3 t = normalize((_transforms_normal_matrix * vec4(_geometry_tangent.xyz, 0.0)).xyz);
+    vec3 b = normalize((_transforms_normal_matrix * vec4((cross(_geometry_normal, _geometry_tangent.xyz) * _geometry_tangent.w), 0.0)).xyz);
     v_tbn = mat3(t, b, n);
 
     _vertex_position = _transforms_projection_matrix * _transforms_view_matrix * _transforms_model_matrix * vec4(_geometry_position, 1.0);
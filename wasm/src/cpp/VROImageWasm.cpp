@@ -20,7 +20,24 @@ VROImageWasm::VROImageWasm(std::string file, VROTextureInternalFormat internalFo
     if (ext) {
         ext++;
     }
+    
+    decode(data, length, ext);
+    free (data);
+    
+    if (_surface == NULL) {
+        pinfo("Failed to load image at path [%s], error [%s]", file.c_str(), SDL_GetError());
+    }
+}
 
+VROImageWasm::VROImageWasm(const unsigned char *data, int length, VROTextureInternalFormat internalFormat) {
+    decode((void *) data, length, NULL);
+    
+    if (_surface == NULL) {
+        pinfo("Failed to load image from data, error [%s]", SDL_GetError());
+    }
+}
+
+void VROImageWasm::decode(void *data, int length, const char *ext) {
     _surface = NULL;
     if (VROJpegReader::isJPG(data, length)) {
         _surface = VROJpegReader::loadJPG(data, length);
@@ -28,10 +45,8 @@ VROImageWasm::VROImageWasm(std::string file, VROTextureInternalFormat internalFo
         SDL_RWops *src = SDL_RWFromMem(data, length);
         _surface = IMG_LoadTyped_RW(src, 1, ext);
     }
-    free (data);
     
     if (_surface == NULL) {
-        pinfo("Failed to load image at path [%s], error [%s]", file.c_str(), SDL_GetError());
         return;
     }
  
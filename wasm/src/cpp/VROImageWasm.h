@@ -22,6 +22,12 @@ public:
      or downloaded.
      */
     VROImageWasm(std::string file, VROTextureInternalFormat format);
+    
+    /*
+     Construct a new VROImage from the given encoded image data (PNG, JPEG,
+     etc.). The data is not retained.
+     */
+    VROImageWasm(const unsigned char *data, int length, VROTextureInternalFormat format);
     virtual ~VROImageWasm();
     
     int getWidth() const;
@@ -36,6 +42,12 @@ private:
     SDL_Surface *_surface;
     SDL_Surface *convertToRGBA8(SDL_Surface *surface);
     
+    /*
+     Decode the given encoded image into _surface. The extension, if known,
+     hints the image type; otherwise the type is detected.
+     */
+    void decode(void *data, int length, const char *ext);
+    
 };
 
 #endif /* VROImageWasm_h */